@@ -0,0 +1,491 @@
+﻿// ImageBatch: 레시피(연산 목록)를 디렉터리/파일 목록의 영상 전체에 적용하는 배치 처리기.
+//
+//   ImageBatch --recipe gaussian,sobel,binarization:128,dilation:3 --output out_dir
+//              [--format bmp|pgm|ppm] [--threads N] [--readers N] [--workers N] [--writers N]
+//              [--queue N] [--stats] [--trace trace.json] input...
+//
+// input은 영상 파일, 디렉터리(.bmp/.pgm/.ppm), 또는 @목록파일(한 줄에 경로 하나)이다.
+// 읽기(디코딩) → 처리 → 쓰기(인코딩)를 크기가 제한된 큐로 이은 단계별 스레드로 겹쳐 실행하므로
+// 디스크 입출력과 연산이 동시에 진행되고, 메모리에 올라가는 영상 수는 큐 크기로 제한된다.
+// 처리 단계의 FilterPipeline은 공용 스레드 풀(--threads)에서 영상 하나를 다시 병렬로 나눠 처리한다.
+// 끝나면 처리량(images/s, MPix/s)과 단계별 지연 백분위수를 출력한다.
+// --stats는 연산/파이프라인 단계별 계측 집계를, --trace는 Chrome trace JSON(ui.perfetto.dev에서 열기)을 남긴다.
+
+#include "FilterPipeline.h"
+#include "ImageCodec.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct BatchOptions
+    {
+        std::string recipe;
+        std::string outputDir;
+        std::vector<std::string> inputs;
+        ImageCodec::Format format = ImageCodec::Format::Unknown;   // Unknown이면 입력과 같은 형식
+        int threads = 0;        // 공용 스레드 풀 크기 (0 = 하드웨어 스레드 수)
+        int readers = 2;
+        int workers = 2;
+        int writers = 2;
+        int queueSize = 4;      // 단계 사이 큐에 대기할 수 있는 최대 영상 수
+        bool stats = false;     // 연산별 계측 집계 출력
+        std::string tracePath;  // 비어 있지 않으면 Chrome trace JSON 기록
+    };
+
+    // 레시피 이름 → FilterOp (파라미터 생략 시 기본값)
+    struct RecipeOp
+    {
+        const char* name;
+        FilterOp op;
+        int defaultParam;
+    };
+
+    const RecipeOp kRecipeOps[] = {
+        { "grayscale", FilterOp::Grayscale, 0 },
+        { "gaussian", FilterOp::GaussianBlur, 0 },
+        { "sobel", FilterOp::Sobel, 0 },
+        { "laplacian", FilterOp::Laplacian, 0 },
+        { "binarization", FilterOp::Binarization, 128 },
+        { "dilation", FilterOp::Dilation, 3 },
+        { "erosion", FilterOp::Erosion, 3 },
+        { "median", FilterOp::MedianFilter, 3 },
+        { "opening", FilterOp::Opening, 3 },
+        { "closing", FilterOp::Closing, 3 },
+        { "morph-gradient", FilterOp::MorphologyGradient, 3 },
+        { "tophat", FilterOp::TopHat, 3 },
+        { "blackhat", FilterOp::BlackHat, 3 },
+    };
+
+    // 영상 한 장의 처리 상태. 단계 사이에서는 unique_ptr로 소유권만 넘긴다
+    struct BatchItem
+    {
+        std::string input;
+        std::string output;
+        std::vector<unsigned char> pixels;
+        int width = 0;
+        int height = 0;
+        double decodeMs = 0.0;
+        double processMs = 0.0;
+        double encodeMs = 0.0;
+        bool ok = false;
+    };
+
+    using ItemPtr = std::unique_ptr<BatchItem>;
+
+    // 크기가 제한된 다중 생산자/소비자 큐. 생산자가 모두 Close하면 Pop은 남은 항목 뒤에 false를 돌려준다
+    class BoundedQueue
+    {
+    public:
+        BoundedQueue(size_t capacity, int producers) : m_capacity(std::max<size_t>(1, capacity)), m_producers(producers) {}
+
+        void Push(ItemPtr item)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notFull.wait(lock, [this] { return m_items.size() < m_capacity; });
+            m_items.push_back(std::move(item));
+            m_notEmpty.notify_one();
+        }
+
+        bool Pop(ItemPtr& item)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock, [this] { return !m_items.empty() || m_producers == 0; });
+            if (m_items.empty()) return false;
+            item = std::move(m_items.front());
+            m_items.pop_front();
+            m_notFull.notify_one();
+            return true;
+        }
+
+        // 생산자 하나가 끝났음을 알린다
+        void Close()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_producers == 0) m_notEmpty.notify_all();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_notFull;
+        std::condition_variable m_notEmpty;
+        std::deque<ItemPtr> m_items;
+        size_t m_capacity;
+        int m_producers;
+    };
+
+    double ElapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void PrintUsage()
+    {
+        std::printf(
+            "usage: ImageBatch --recipe op[:param][,op[:param]...] --output DIR\n"
+            "                  [--format bmp|pgm|ppm] [--threads N] [--readers N] [--workers N]\n"
+            "                  [--writers N] [--queue N] [--stats] [--trace FILE] input...\n"
+            "input: image file, directory, or @listfile (one path per line)\n"
+            "ops:");
+        for (const RecipeOp& op : kRecipeOps) std::printf(" %s", op.name);
+        std::printf("\n");
+    }
+
+    bool ParseRecipe(const std::string& text, FilterPipeline& pipeline)
+    {
+        size_t pos = 0;
+        while (pos <= text.size())
+        {
+            size_t comma = text.find(',', pos);
+            std::string item = text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            if (!item.empty())
+            {
+                const size_t colon = item.find(':');
+                const std::string name = item.substr(0, colon);
+                const RecipeOp* found = nullptr;
+                for (const RecipeOp& op : kRecipeOps)
+                {
+                    if (name == op.name) found = &op;
+                }
+                if (found == nullptr)
+                {
+                    std::fprintf(stderr, "unknown op: %s\n", name.c_str());
+                    return false;
+                }
+                const int param = (colon == std::string::npos) ? found->defaultParam : std::atoi(item.c_str() + colon + 1);
+                // Dilation 이후 연산의 파라미터는 커널 크기다 (ImageEngine의 파이프라인 검사와 같은 규칙)
+                if (found->op >= FilterOp::Dilation && param < 1)
+                {
+                    std::fprintf(stderr, "invalid kernel size for %s: %s\n", name.c_str(), item.c_str() + colon + 1);
+                    return false;
+                }
+                pipeline.Add(found->op, param);
+            }
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+        return !pipeline.Steps().empty();
+    }
+
+    bool ParseFormat(const std::string& text, ImageCodec::Format& format)
+    {
+        format = ImageCodec::FormatFromPath("." + text);
+        return format != ImageCodec::Format::Unknown;
+    }
+
+    bool ParseOptions(int argc, char** argv, BatchOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--recipe" && hasValue)
+            {
+                options.recipe = argv[++i];
+            }
+            else if (arg == "--output" && hasValue)
+            {
+                options.outputDir = argv[++i];
+            }
+            else if (arg == "--format" && hasValue)
+            {
+                if (!ParseFormat(argv[++i], options.format)) return false;
+            }
+            else if (arg == "--threads" && hasValue)
+            {
+                options.threads = std::atoi(argv[++i]);
+            }
+            else if (arg == "--readers" && hasValue)
+            {
+                options.readers = std::atoi(argv[++i]);
+            }
+            else if (arg == "--workers" && hasValue)
+            {
+                options.workers = std::atoi(argv[++i]);
+            }
+            else if (arg == "--writers" && hasValue)
+            {
+                options.writers = std::atoi(argv[++i]);
+            }
+            else if (arg == "--queue" && hasValue)
+            {
+                options.queueSize = std::atoi(argv[++i]);
+            }
+            else if (arg == "--stats")
+            {
+                options.stats = true;
+            }
+            else if (arg == "--trace" && hasValue)
+            {
+                options.tracePath = argv[++i];
+            }
+            else if (!arg.empty() && arg[0] != '-')
+            {
+                options.inputs.push_back(arg);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return !options.recipe.empty() && !options.outputDir.empty() && !options.inputs.empty() &&
+               options.threads >= 0 && options.readers > 0 && options.workers > 0 && options.writers > 0 &&
+               options.queueSize > 0;
+    }
+
+    // 입력 인자를 영상 파일 목록으로 펼친다 (디렉터리는 한 단계만, 이름순)
+    bool CollectInputs(const std::vector<std::string>& inputs, std::vector<std::string>& files)
+    {
+        for (const std::string& input : inputs)
+        {
+            if (input[0] == '@')
+            {
+                std::ifstream list(fs::u8path(input.substr(1)));
+                if (!list)
+                {
+                    std::fprintf(stderr, "cannot open list: %s\n", input.c_str() + 1);
+                    return false;
+                }
+                std::string line;
+                while (std::getline(list, line))
+                {
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    if (!line.empty()) files.push_back(line);
+                }
+                continue;
+            }
+
+            std::error_code error;
+            const fs::path path = fs::u8path(input);
+            if (fs::is_directory(path, error))
+            {
+                std::vector<std::string> found;
+                for (const fs::directory_entry& entry : fs::directory_iterator(path, error))
+                {
+                    const std::string name = entry.path().u8string();
+                    if (entry.is_regular_file(error) && ImageCodec::FormatFromPath(name) != ImageCodec::Format::Unknown)
+                        found.push_back(name);
+                }
+                std::sort(found.begin(), found.end());
+                files.insert(files.end(), found.begin(), found.end());
+            }
+            else
+            {
+                files.push_back(input);
+            }
+        }
+        return true;
+    }
+
+    // 결과 경로: 출력 디렉터리 / 입력 파일 이름 (--format 지정 시 확장자 교체)
+    std::string OutputPath(const BatchOptions& options, const std::string& input)
+    {
+        fs::path name = fs::u8path(input).filename();
+        if (options.format != ImageCodec::Format::Unknown) name.replace_extension(ImageCodec::Extension(options.format));
+        return (fs::u8path(options.outputDir) / name).u8string();
+    }
+
+    // 결과 경로가 겹치는 입력(다른 디렉터리의 같은 이름, 같은 파일을 두 번 지정, --format으로 확장자만 다른 이름)을
+    // 찾아 알린다. 겹치면 나중 결과가 앞의 결과를 덮어쓰므로(쓰기 스레드끼리 경합도 생김) 처리 전에 거부한다
+    bool CheckOutputCollisions(const BatchOptions& options, const std::vector<std::string>& files)
+    {
+        std::map<std::string, const std::string*> owners;
+        bool ok = true;
+        for (const std::string& input : files)
+        {
+            std::string key = fs::u8path(OutputPath(options, input)).lexically_normal().generic_u8string();
+#if defined(_WIN32)
+            // Windows 파일 이름은 대소문자를 구분하지 않는다
+            std::transform(key.begin(), key.end(), key.begin(),
+                           [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; });
+#endif
+            auto inserted = owners.emplace(key, &input);
+            if (!inserted.second)
+            {
+                std::fprintf(stderr, "output collision: %s and %s both write %s\n", inserted.first->second->c_str(),
+                             input.c_str(), OutputPath(options, input).c_str());
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    double Percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty()) return 0.0;
+        const size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    void PrintLatency(const char* stage, std::vector<double> samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        std::printf("%-8s %10.2f %10.2f %10.2f %10.2f\n", stage, Percentile(samples, 0.50), Percentile(samples, 0.90),
+            Percentile(samples, 0.99), samples.empty() ? 0.0 : samples.back());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BatchOptions options;
+    FilterPipeline pipeline;
+    if (!ParseOptions(argc, argv, options) || !ParseRecipe(options.recipe, pipeline))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<std::string> files;
+    if (!CollectInputs(options.inputs, files)) return 1;
+    if (files.empty())
+    {
+        std::fprintf(stderr, "no input images\n");
+        return 1;
+    }
+    if (!CheckOutputCollisions(options, files)) return 1;
+
+    std::error_code error;
+    fs::create_directories(fs::u8path(options.outputDir), error);
+    ThreadPool::Shared().SetThreadCount(options.threads);
+    Profiler::Shared().SetEnabled(options.stats);
+    Profiler::Shared().SetTracing(!options.tracePath.empty());
+
+    BoundedQueue decoded(options.queueSize, options.readers);
+    BoundedQueue processed(options.queueSize, options.workers);
+    std::atomic<size_t> nextFile(0);
+
+    std::mutex resultMutex;
+    std::vector<ItemPtr> results;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+
+    // 읽기: 파일을 하나씩 가져가 BGRA로 디코딩 (실패한 항목도 결과 집계를 위해 넘긴다)
+    for (int i = 0; i < options.readers; ++i)
+    {
+        threads.emplace_back([&]
+            {
+                for (size_t index = nextFile++; index < files.size(); index = nextFile++)
+                {
+                    ItemPtr item = std::make_unique<BatchItem>();
+                    item->input = files[index];
+                    item->output = OutputPath(options, item->input);
+
+                    const auto t0 = std::chrono::steady_clock::now();
+                    item->ok = ImageCodec::Read(item->input, item->pixels, item->width, item->height);
+                    item->decodeMs = ElapsedMs(t0);
+                    if (!item->ok) std::fprintf(stderr, "decode failed: %s\n", item->input.c_str());
+                    decoded.Push(std::move(item));
+                }
+                decoded.Close();
+            });
+    }
+
+    // 처리: 레시피 적용 (영상 내부는 공용 스레드 풀이 다시 나눠 처리)
+    for (int i = 0; i < options.workers; ++i)
+    {
+        threads.emplace_back([&]
+            {
+                ItemPtr item;
+                while (decoded.Pop(item))
+                {
+                    if (item->ok)
+                    {
+                        const auto t0 = std::chrono::steady_clock::now();
+                        pipeline.Run(item->pixels.data(), item->width, item->height);
+                        item->processMs = ElapsedMs(t0);
+                    }
+                    processed.Push(std::move(item));
+                }
+                processed.Close();
+            });
+    }
+
+    // 쓰기: 인코딩 후 화소 버퍼를 바로 해제하고 통계만 남긴다
+    for (int i = 0; i < options.writers; ++i)
+    {
+        threads.emplace_back([&]
+            {
+                ItemPtr item;
+                while (processed.Pop(item))
+                {
+                    if (item->ok)
+                    {
+                        const ImageCodec::Format format = (options.format != ImageCodec::Format::Unknown)
+                            ? options.format : ImageCodec::FormatFromPath(item->input);
+                        const auto t0 = std::chrono::steady_clock::now();
+                        item->ok = ImageCodec::Write(item->output, format, item->pixels.data(), item->width, item->height);
+                        item->encodeMs = ElapsedMs(t0);
+                        if (!item->ok) std::fprintf(stderr, "encode failed: %s\n", item->output.c_str());
+                    }
+                    std::vector<unsigned char>().swap(item->pixels);
+
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    results.push_back(std::move(item));
+                }
+            });
+    }
+
+    for (std::thread& thread : threads) thread.join();
+    const double seconds = ElapsedMs(start) / 1000.0;
+
+    std::vector<double> decodeMs, processMs, encodeMs;
+    size_t succeeded = 0;
+    double megapixels = 0.0;
+    for (const ItemPtr& item : results)
+    {
+        if (!item->ok) continue;
+        ++succeeded;
+        megapixels += static_cast<double>(item->width) * item->height / 1e6;
+        decodeMs.push_back(item->decodeMs);
+        processMs.push_back(item->processMs);
+        encodeMs.push_back(item->encodeMs);
+    }
+
+    std::printf("images: %zu ok, %zu failed in %.2f s (threads %d, readers %d, workers %d, writers %d)\n",
+        succeeded, results.size() - succeeded, seconds, ThreadPool::Shared().ThreadCount(),
+        options.readers, options.workers, options.writers);
+    std::printf("throughput: %.2f images/s, %.2f MPix/s\n",
+        seconds > 0.0 ? succeeded / seconds : 0.0, seconds > 0.0 ? megapixels / seconds : 0.0);
+    std::printf("%-8s %10s %10s %10s %10s\n", "stage", "p50 ms", "p90 ms", "p99 ms", "max ms");
+    PrintLatency("decode", decodeMs);
+    PrintLatency("process", processMs);
+    PrintLatency("encode", encodeMs);
+
+    if (options.stats)
+    {
+        // 파이프라인 단계(pipeline/*)는 모든 밴드 스레드 시간의 합이다
+        std::printf("\n%-24s %7s %10s %10s %10s %10s %10s  %s\n", "op", "calls", "mean ms", "p50 ms", "p95 ms",
+            "ns/pixel", "scratch MB", "backend");
+        for (const ProfileStats& stats : Profiler::Shared().Stats())
+        {
+            std::printf("%-24s %7llu %10.3f %10.3f %10.3f %10.3f %10.1f  %s\n", stats.name.c_str(),
+                static_cast<unsigned long long>(stats.calls), stats.meanMs, stats.p50Ms, stats.p95Ms, stats.nsPerPixel,
+                static_cast<double>(stats.scratchBytes) / (1024.0 * 1024.0), stats.backend.c_str());
+        }
+    }
+    if (!options.tracePath.empty() && !Profiler::Shared().WriteChromeTrace(options.tracePath))
+    {
+        std::fprintf(stderr, "trace write failed: %s\n", options.tracePath.c_str());
+    }
+
+    return succeeded == results.size() ? 0 : 2;
+}
@@ -0,0 +1,550 @@
+﻿// ImageBenchmark: 네이티브 코어의 연산별 처리량(ns/pixel, MPix/s)을 측정한다.
+//
+//   ImageBenchmark [--sizes 640x480,1920x1080] [--ops sobel,median]
+//                  [--kernel 5] [--threshold 128] [--sigma 2] [--window 31] [--min-time 0.5] [--csv]
+//                  [--simd scalar|sse4.1|avx2|avx512] [--threads N] [--pin]
+//
+// 기본값은 640x480부터 16384x16384까지 전체 크기, 전체 연산이다.
+
+#include "NativeProcessor.h"
+#include "CpuFeatures.h"
+#include "FFTProcessor.h"
+#include "FrequencyFilter.h"
+#include "FilterPipeline.h"
+#include "GrayImage.h"
+#include "TemplateMatcher.h"
+#include "TiledProcessor.h"
+#include "ThreadPool.h"
+#include "ScratchArena.h"
+#include "TileHistory.h"
+#include "IntegralImage.h"
+#include "Thresholding.h"
+#include "ImagePyramid.h"
+#include "ProgressivePreview.h"
+#include "ConnectedComponents.h"
+#include "EdgeDetection.h"
+#include "JobControl.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct ImageSize
+    {
+        int width;
+        int height;
+    };
+
+    struct BenchOptions
+    {
+        std::vector<ImageSize> sizes;
+        std::vector<std::string> ops;
+        int kernelSize = 3;
+        int threshold = 128;
+        float sigma = 2.0f;     // gaussian-sigma/-separable-sigma/-recursive
+        int window = 31;        // 적응형 이진화 창 크기
+        double minTime = 0.5;   // 연산당 최소 측정 시간(초)
+        bool csv = false;
+        bool hasSimd = false;
+        SimdLevel simd = SimdLevel::Scalar;   // --simd 지정 시에만 사용
+        int threads = 0;        // 공용 스레드 풀 크기 (0 = 하드웨어 스레드 수)
+        bool pin = false;       // 작업 스레드를 코어에 고정
+    };
+
+    struct BenchOp
+    {
+        const char* name;
+        // 측정 전 준비 작업(시간 측정 제외). 없으면 nullptr
+        std::function<void(unsigned char*, int, int)> prepare;
+        std::function<void(unsigned char*, int, int)> run;
+        // 반복마다 입력을 되돌리는 작업(시간 측정 제외). 없으면 BGRA 원본을 복사
+        std::function<void()> reset = nullptr;
+    };
+
+    const ImageSize kDefaultSizes[] = {
+        { 640, 480 },
+        { 1920, 1080 },
+        { 4096, 3000 },
+        { 5472, 3648 },     // 20 MP
+        { 8192, 8192 },
+        { 16384, 16384 },
+    };
+
+    // 웨이퍼 패턴과 비슷한 격자 + 노이즈 영상 생성 (재현 가능하도록 고정 시드)
+    void FillTestImage(std::vector<unsigned char>& pixels, int width, int height)
+    {
+        uint32_t state = 0x12345678u;
+        for (int y = 0; y < height; ++y)
+        {
+            unsigned char* row = pixels.data() + static_cast<size_t>(y) * width * 4;
+            for (int x = 0; x < width; ++x)
+            {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                int base = (((x >> 5) + (y >> 5)) & 1) ? 180 : 60;
+                int noise = static_cast<int>(state & 31) - 16;
+                int v = std::min(255, std::max(0, base + noise));
+                row[x * 4 + 0] = static_cast<unsigned char>(v);
+                row[x * 4 + 1] = static_cast<unsigned char>(std::min(255, v + 8));
+                row[x * 4 + 2] = static_cast<unsigned char>(std::max(0, v - 8));
+                row[x * 4 + 3] = 255;
+            }
+        }
+    }
+
+    bool ParseSizes(const char* text, std::vector<ImageSize>& sizes)
+    {
+        std::string s(text);
+        size_t pos = 0;
+        while (pos < s.size())
+        {
+            size_t comma = s.find(',', pos);
+            std::string item = s.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            int w = 0, h = 0;
+            if (std::sscanf(item.c_str(), "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0)
+            {
+                return false;
+            }
+            sizes.push_back({ w, h });
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+        return !sizes.empty();
+    }
+
+    void ParseList(const char* text, std::vector<std::string>& items)
+    {
+        std::string s(text);
+        size_t pos = 0;
+        while (pos <= s.size())
+        {
+            size_t comma = s.find(',', pos);
+            std::string item = s.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            if (!item.empty()) items.push_back(item);
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+    }
+
+    void PrintUsage()
+    {
+        std::printf(
+            "usage: ImageBenchmark [--sizes WxH[,WxH...]] [--ops name[,name...]]\n"
+            "                      [--kernel N] [--threshold N] [--sigma S] [--window N] [--min-time SEC] [--csv]\n"
+            "                      [--simd scalar|sse4.1|avx2|avx512] [--threads N] [--pin]\n"
+            "ops: grayscale gaussian gaussian-separable gaussian-sigma gaussian-separable-sigma\n"
+            "     gaussian-recursive sobel canny gradient gradient-scharr laplacian binarization otsu\n"
+            "     adaptive-mean adaptive-niblack adaptive-sauvola integral\n"
+            "     dilation erosion opening closing morph-gradient tophat blackhat\n"
+            "     median median-job median-roi convolution convolution-spatial convolution-fft convolution-fixed\n"
+            "     fft ifft fft-lowpass pipeline pipeline-sequential pipeline-tiled\n"
+            "     gray-convert gray-to-bgra gray-gaussian gray-sobel gray-canny gray-laplacian\n"
+            "     gray-binarization gray-otsu gray-adaptive gray-dilation gray-erosion gray-opening gray-tophat\n"
+            "     gray-median gray-convolution gray-convolution-spatial gray-pipeline\n"
+            "     history-undo template-match\n");
+    }
+
+    bool ParseOptions(int argc, char** argv, BenchOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--sizes" && hasValue)
+            {
+                if (!ParseSizes(argv[++i], options.sizes)) return false;
+            }
+            else if (arg == "--ops" && hasValue)
+            {
+                ParseList(argv[++i], options.ops);
+            }
+            else if (arg == "--kernel" && hasValue)
+            {
+                options.kernelSize = std::atoi(argv[++i]);
+            }
+            else if (arg == "--threshold" && hasValue)
+            {
+                options.threshold = std::atoi(argv[++i]);
+            }
+            else if (arg == "--sigma" && hasValue)
+            {
+                options.sigma = static_cast<float>(std::atof(argv[++i]));
+            }
+            else if (arg == "--window" && hasValue)
+            {
+                options.window = std::atoi(argv[++i]);
+            }
+            else if (arg == "--min-time" && hasValue)
+            {
+                options.minTime = std::atof(argv[++i]);
+            }
+            else if (arg == "--simd" && hasValue)
+            {
+                if (!ParseSimdLevel(argv[++i], options.simd)) return false;
+                options.hasSimd = true;
+            }
+            else if (arg == "--threads" && hasValue)
+            {
+                options.threads = std::atoi(argv[++i]);
+            }
+            else if (arg == "--pin")
+            {
+                options.pin = true;
+            }
+            else if (arg == "--csv")
+            {
+                options.csv = true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        if (options.sizes.empty())
+        {
+            options.sizes.assign(std::begin(kDefaultSizes), std::end(kDefaultSizes));
+        }
+        return options.kernelSize > 0 && options.minTime >= 0.0 && options.threads >= 0;
+    }
+
+    bool IsSelected(const BenchOptions& options, const char* name)
+    {
+        if (options.ops.empty()) return true;
+        return std::find(options.ops.begin(), options.ops.end(), name) != options.ops.end();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    // 요청한 SIMD 수준이 CPU에서 지원되지 않으면 지원되는 최고 수준으로 낮아진다
+    if (options.hasSimd)
+        SetSimdLevel(options.simd);
+    ThreadPool::Shared().SetThreadCount(options.threads);
+    ThreadPool::Shared().SetAffinity(options.pin);
+    if (!options.csv)
+    {
+        std::printf("simd: %s (detected %s), threads: %d%s\n", SimdLevelName(ActiveSimdLevel()),
+            SimdLevelName(DetectSimdLevel()), ThreadPool::Shared().ThreadCount(), options.pin ? " (pinned)" : "");
+    }
+
+    NativeProcessor processor;
+    FFTProcessor fft;
+    const int k = options.kernelSize;
+    const int threshold = options.threshold;
+    const float sigma = options.sigma;
+    const int window = options.window;
+    IntegralImage integral;
+
+    // 임의 커널 컨볼루션용 k x k 가우시안 (sigma = k / 6, 합 1)
+    std::vector<float> kernel(static_cast<size_t>(k) * k);
+    {
+        const float sigma = std::max(1.0f, k / 6.0f);
+        float sum = 0.f;
+        for (int y = 0; y < k; ++y)
+            for (int x = 0; x < k; ++x)
+            {
+                const float dy = static_cast<float>(y - k / 2), dx = static_cast<float>(x - k / 2);
+                kernel[static_cast<size_t>(y) * k + x] = std::exp(-(dx * dx + dy * dy) / (2.f * sigma * sigma));
+                sum += kernel[static_cast<size_t>(y) * k + x];
+            }
+        for (float& v : kernel) v /= sum;
+    }
+
+    FrequencyFilter lowPass;
+    lowPass.type = FrequencyFilterType::LowPass;
+    lowPass.shape = FrequencyFilterShape::Gaussian;
+    lowPass.cutoff = 0.05f;
+
+    // 대표 레시피: Gaussian → Sobel → Binarization → Dilation
+    FilterPipeline recipe;
+    recipe.Add(FilterOp::GaussianBlur)
+          .Add(FilterOp::Sobel)
+          .Add(FilterOp::Binarization, threshold)
+          .Add(FilterOp::Dilation, k);
+
+    // 그레이 평면 연산용 원본/작업 영상
+    GrayImage graySource;
+    GrayImage grayWork;
+    auto prepareGray = [&](unsigned char* p, int w, int h) { graySource.FromBGRA(p, w, h); };
+    auto resetGray = [&]() { grayWork = graySource; };
+
+    // 템플릿 매칭: 영상 가운데 128x128(작은 영상은 1/4 크기)을 템플릿으로 잘라 찾는다
+    TemplateMatcher matcher;
+    auto prepareMatch = [&](unsigned char* p, int w, int h)
+        {
+            graySource.FromBGRA(p, w, h);
+            const int side = std::max(8, std::min(128, std::min(w, h) / 4));
+            GrayImage templ(side, side);
+            for (int y = 0; y < side; ++y)
+                std::memcpy(templ.Row(y), graySource.Row(h / 2 + y - side / 2) + w / 2 - side / 2, side);
+            matcher.SetTemplate(templ);
+        };
+
+    // 타일 out-of-core: 원본을 원시 파일로 한 번 써 두고 파일 → 파일 처리 시간을 잰다 (페이지 캐시 상태)
+    const char* tiledInput = "ImageBenchmark_tiled_in.raw";
+    const char* tiledOutput = "ImageBenchmark_tiled_out.raw";
+    TiledProcessor tiled(recipe);
+    auto prepareTiled = [&](unsigned char* p, int w, int h)
+        {
+            if (FILE* file = std::fopen(tiledInput, "wb"))
+            {
+                std::fwrite(p, 4, static_cast<size_t>(w) * h, file);
+                std::fclose(file);
+            }
+        };
+
+    // 되돌리기 기록: 가운데 1/4 영역만 바꾼 상태를 기록해 두고 되돌리기 + 다시 실행 복원 시간을 잰다
+    TileHistory history;
+    history.SetCompression(true);
+    auto prepareHistory = [&](unsigned char* p, int w, int h)
+        {
+            const ImageView image = ImageView::BGRA(p, w, h);
+            history.Clear();
+            history.Push(image);
+            for (int y = h / 4; y < h / 4 + h / 2; ++y)
+                for (int x = w / 4; x < w / 4 + w / 2; ++x) p[(static_cast<size_t>(y) * w + x) * 4] ^= 0x55;
+            history.Push(image);
+        };
+    auto runHistory = [&](unsigned char* p, int w, int h)
+        {
+            const ImageView image = ImageView::BGRA(p, w, h);
+            uint64_t basis = history.CurrentState();
+            history.Undo();
+            history.Restore(image, basis);
+            basis = history.CurrentState();
+            history.Redo();
+            history.Restore(image, basis);
+        };
+
+    // 점진적 미리보기: 피라미드 전체 생성, 그리고 같은 원본에 대한 반복 미리보기 (피라미드 재사용, 16 ms 예산)
+    ImagePyramid pyramid;
+    auto runPyramid = [&](unsigned char* p, int w, int h)
+        {
+            pyramid.SetSource(ImageView::BGRA(p, w, h), 0);
+            for (int level = 1; level < pyramid.LevelCount(); ++level) pyramid.Level(level);
+        };
+    ProgressivePreview preview;
+    FilterPipeline previewRecipe;
+    previewRecipe.Add(FilterOp::MedianFilter, k);
+    auto preparePreview = [&](unsigned char* p, int w, int h) { preview.Clear(); preview.Run(previewRecipe, ImageView::BGRA(p, w, h), 1, 16.0); };
+
+    // 연결 요소 라벨링: 이진화한 그레이 평면 (8-연결), 밝기는 원본 BGRA
+    ConnectedComponents components;
+    auto prepareComponents = [&](unsigned char* p, int w, int h)
+        {
+            graySource.FromBGRA(p, w, h);
+            processor.ApplyBinarization(graySource, threshold);
+        };
+
+    // 엣지: 캐니(Sobel L2, 임계값 50/150)와 그래디언트 크기 + 방향 코드 (그레이 평면 입력)
+    CannyDetector canny;
+    const int cannyLow = 50, cannyHigh = 150;
+    std::vector<uint16_t> gradientMagnitude;
+    std::vector<unsigned char> gradientOrientation;
+    auto prepareGradient = [&](unsigned char* p, int w, int h)
+        {
+            graySource.FromBGRA(p, w, h);
+            gradientMagnitude.resize(static_cast<size_t>(w) * h);
+            gradientOrientation.resize(static_cast<size_t>(w) * h);
+        };
+    auto runGradient = [&](int w, int h, GradientOperator op)
+        {
+            EdgeDetection::Gradient(ImageView::Gray(graySource.Data(), w, h), op, GradientNorm::L2,
+                                    gradientMagnitude.data(), w, gradientOrientation.data(), w);
+        };
+
+    std::vector<BenchOp> ops = {
+        { "grayscale", nullptr, [&](unsigned char* p, int w, int h) { processor.ToGrayscale(p, w, h); } },
+        { "gaussian", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyGaussianBlur(p, w, h); } },
+        { "gaussian-separable", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyGaussianBlur(p, w, h, 2, 1.0f); } },
+        { "gaussian-sigma", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyGaussianBlur(p, w, h, sigma); } },
+        { "gaussian-separable-sigma", nullptr, [&](unsigned char* p, int w, int h)
+            { processor.ApplyGaussianBlur(p, w, h, sigma, GaussianMethod::Separable); } },
+        { "gaussian-recursive", nullptr, [&](unsigned char* p, int w, int h)
+            { processor.ApplyGaussianBlur(p, w, h, sigma, GaussianMethod::Recursive); } },
+        { "sobel", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplySobel(p, w, h); } },
+        { "canny", nullptr, [&](unsigned char* p, int w, int h)
+            { canny.Detect(ImageView::BGRA(p, w, h), ImageView::BGRA(p, w, h), cannyLow, cannyHigh); } },
+        { "gradient", prepareGradient, [&](unsigned char*, int w, int h) { runGradient(w, h, GradientOperator::Sobel); }, [] {} },
+        { "gradient-scharr", prepareGradient, [&](unsigned char*, int w, int h) { runGradient(w, h, GradientOperator::Scharr); }, [] {} },
+        { "laplacian", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyLaplacian(p, w, h); } },
+        { "binarization", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyBinarization(p, w, h, threshold); } },
+        { "otsu", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyOtsuBinarization(p, w, h); } },
+        { "adaptive-mean", nullptr, [&](unsigned char* p, int w, int h)
+            { processor.ApplyAdaptiveThreshold(p, w, h, AdaptiveMethod::Mean, window, Thresholding::DefaultK(AdaptiveMethod::Mean)); } },
+        { "adaptive-niblack", nullptr, [&](unsigned char* p, int w, int h)
+            { processor.ApplyAdaptiveThreshold(p, w, h, AdaptiveMethod::Niblack, window, Thresholding::DefaultK(AdaptiveMethod::Niblack)); } },
+        { "adaptive-sauvola", nullptr, [&](unsigned char* p, int w, int h)
+            { processor.ApplyAdaptiveThreshold(p, w, h, AdaptiveMethod::Sauvola, window, Thresholding::DefaultK(AdaptiveMethod::Sauvola)); } },
+        { "integral", prepareGray, [&](unsigned char*, int w, int h) { integral.Build(graySource.Data(), w, h, graySource.Stride()); }, [] {} },
+        { "dilation", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyDilation(p, w, h, k); } },
+        { "erosion", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyErosion(p, w, h, k); } },
+        { "opening", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyOpening(p, w, h, k); } },
+        { "closing", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyClosing(p, w, h, k); } },
+        { "morph-gradient", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyMorphologyGradient(p, w, h, k); } },
+        { "tophat", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyTopHat(p, w, h, k); } },
+        { "blackhat", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyBlackHat(p, w, h, k); } },
+        { "median", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyMedianFilter(p, w, h, k); } },
+        { "median-job", nullptr, [&](unsigned char* p, int w, int h)
+            {
+                // 취소 가능한 작업으로 실행 (밴드마다 취소 확인/진행률 비용)
+                JobControl job;
+                JobControl::Scope scope(&job);
+                processor.ApplyMedianFilter(p, w, h, k);
+            } },
+        { "median-roi", nullptr, [&](unsigned char* p, int w, int h)
+            {
+                // 가운데 1/4 면적 선택 영역만 처리
+                const ImageView image = ImageView::BGRA(p, w, h);
+                processor.Apply(FilterOp::MedianFilter, k, image, image, ImageRect{ w / 4, h / 4, w / 2, h / 2 });
+            } },
+        { "convolution", nullptr, [&](unsigned char* p, int w, int h) { processor.ApplyConvolution(p, w, h, kernel.data(), k); } },
+        { "convolution-spatial", nullptr, [&](unsigned char* p, int w, int h)
+            { processor.ApplyConvolution(p, w, h, kernel.data(), k, ConvolutionMethod::Spatial); } },
+        { "convolution-fft", nullptr, [&](unsigned char* p, int w, int h)
+            { processor.ApplyConvolution(p, w, h, kernel.data(), k, ConvolutionMethod::FFT); } },
+        { "convolution-fixed", nullptr, [&](unsigned char* p, int w, int h)
+            { processor.ApplyConvolution(p, w, h, kernel.data(), k, ConvolutionMethod::FixedPoint); } },
+        { "fft", nullptr, [&](unsigned char* p, int w, int h) { fft.ApplyFFT(p, w, h); } },
+        { "ifft",
+          [&](unsigned char* p, int w, int h) { fft.ApplyFFT(p, w, h); },
+          [&](unsigned char* p, int w, int h) { fft.ApplyIFFT(p, w, h); } },
+        { "fft-lowpass", nullptr, [&](unsigned char* p, int w, int h)
+            {
+                fft.ApplyFFT(p, w, h);
+                fft.FilterSpectrum(lowPass);
+                fft.ApplyIFFT(p, w, h);
+            } },
+        { "pipeline", nullptr, [&](unsigned char* p, int w, int h) { recipe.Run(p, w, h); } },
+        { "pipeline-sequential", nullptr, [&](unsigned char* p, int w, int h)
+            {
+                processor.ApplyGaussianBlur(p, w, h);
+                processor.ApplySobel(p, w, h);
+                processor.ApplyBinarization(p, w, h, threshold);
+                processor.ApplyDilation(p, w, h, k);
+            } },
+        { "pipeline-tiled", prepareTiled, [&](unsigned char*, int w, int h) { tiled.Run(tiledInput, tiledOutput, w, h, 4); } },
+        { "pyramid", nullptr, runPyramid },
+        { "preview-median", preparePreview, [&](unsigned char* p, int w, int h)
+            { preview.Run(previewRecipe, ImageView::BGRA(p, w, h), 1, 16.0); }, [] {} },
+        { "gray-convert", nullptr, [&](unsigned char* p, int w, int h) { grayWork.FromBGRA(p, w, h); } },
+        { "gray-to-bgra", prepareGray, [&](unsigned char* p, int, int) { graySource.ToBGRA(p); } },
+        { "gray-gaussian", prepareGray, [&](unsigned char*, int, int) { processor.ApplyGaussianBlur(grayWork); }, resetGray },
+        { "gray-sobel", prepareGray, [&](unsigned char*, int, int) { processor.ApplySobel(grayWork); }, resetGray },
+        { "gray-canny", prepareGray, [&](unsigned char*, int w, int h)
+            { canny.Detect(ImageView::Gray(graySource.Data(), w, h), ImageView::Gray(grayWork.Data(), w, h), cannyLow, cannyHigh); }, resetGray },
+        { "gray-laplacian", prepareGray, [&](unsigned char*, int, int) { processor.ApplyLaplacian(grayWork); }, resetGray },
+        { "gray-binarization", prepareGray, [&](unsigned char*, int, int) { processor.ApplyBinarization(grayWork, threshold); }, resetGray },
+        { "gray-otsu", prepareGray, [&](unsigned char*, int, int) { processor.ApplyOtsuBinarization(grayWork); }, resetGray },
+        { "gray-adaptive", prepareGray, [&](unsigned char*, int, int)
+            { processor.ApplyAdaptiveThreshold(grayWork, AdaptiveMethod::Sauvola, window, Thresholding::DefaultK(AdaptiveMethod::Sauvola)); }, resetGray },
+        { "gray-dilation", prepareGray, [&](unsigned char*, int, int) { processor.ApplyDilation(grayWork, k); }, resetGray },
+        { "gray-erosion", prepareGray, [&](unsigned char*, int, int) { processor.ApplyErosion(grayWork, k); }, resetGray },
+        { "gray-opening", prepareGray, [&](unsigned char*, int, int) { processor.ApplyOpening(grayWork, k); }, resetGray },
+        { "gray-tophat", prepareGray, [&](unsigned char*, int, int) { processor.ApplyTopHat(grayWork, k); }, resetGray },
+        { "gray-convolution", prepareGray, [&](unsigned char*, int, int) { processor.ApplyConvolution(grayWork, kernel.data(), k); }, resetGray },
+        { "gray-convolution-spatial", prepareGray, [&](unsigned char*, int, int)
+            { processor.ApplyConvolution(grayWork, kernel.data(), k, ConvolutionMethod::Spatial); }, resetGray },
+        { "gray-median", prepareGray, [&](unsigned char*, int, int) { processor.ApplyMedianFilter(grayWork, k); }, resetGray },
+        { "history-undo", prepareHistory, runHistory, [] {} },
+        { "components", prepareComponents, [&](unsigned char* p, int w, int h)
+            { components.Label(ImageView::Gray(graySource.Data(), w, h), Connectivity::Eight, ImageView::BGRA(p, w, h)); }, [] {} },
+        { "template-match", prepareMatch, [&](unsigned char*, int, int) { matcher.Match(graySource); }, [] {} },
+        { "gray-pipeline", prepareGray, [&](unsigned char*, int, int) { recipe.Run(grayWork); }, resetGray },
+    };
+
+    if (options.csv)
+    {
+        std::printf("op,width,height,iterations,ns_per_pixel,mpix_per_s,scratch_peak_kb,steady_allocs\n");
+    }
+    else
+    {
+        std::printf("%-20s %13s %6s %12s %10s %12s %7s\n", "op", "size", "iters", "ns/pixel", "MPix/s", "scratch KB", "allocs");
+    }
+
+    for (const ImageSize& size : options.sizes)
+    {
+        const size_t bytes = static_cast<size_t>(size.width) * size.height * 4;
+        const double pixelCount = static_cast<double>(size.width) * size.height;
+        std::vector<unsigned char> source(bytes);
+        std::vector<unsigned char> work(bytes);
+        FillTestImage(source, size.width, size.height);
+
+        for (const BenchOp& op : ops)
+        {
+            if (!IsSelected(options, op.name)) continue;
+
+            if (op.prepare)
+            {
+                std::memcpy(work.data(), source.data(), bytes);
+                op.prepare(work.data(), size.width, size.height);
+            }
+            std::memcpy(work.data(), source.data(), bytes);
+
+            // 반복마다 원본을 복사해 동일 입력으로 측정 (복사 시간은 제외)
+            // 작업 버퍼 풀: 연산 중 최고 사용량과, 첫 반복 이후(정상 상태) 새로 할당한 횟수를 함께 기록
+            ScratchArena& arena = ScratchArena::Shared();
+            arena.ResetPeaks();
+            uint64_t warmAllocations = 0;
+            std::vector<double> samples;
+            double total = 0.0;
+            do
+            {
+                if (op.reset)
+                    op.reset();
+                else
+                    std::memcpy(work.data(), source.data(), bytes);
+                auto t0 = std::chrono::steady_clock::now();
+                op.run(work.data(), size.width, size.height);
+                auto t1 = std::chrono::steady_clock::now();
+                double sec = std::chrono::duration<double>(t1 - t0).count();
+                samples.push_back(sec);
+                total += sec;
+                if (samples.size() == 1) warmAllocations = arena.GetStats().systemAllocations;
+            } while (total < options.minTime);
+            const ScratchArena::Stats scratch = arena.GetStats();
+            const double scratchPeakKB = static_cast<double>(scratch.peakBytesInUse) / 1024.0;
+            const unsigned long long steadyAllocations = scratch.systemAllocations - warmAllocations;
+
+            std::sort(samples.begin(), samples.end());
+            double median = samples[samples.size() / 2];
+            double nsPerPixel = median * 1e9 / pixelCount;
+            double mpixPerSec = median > 0.0 ? pixelCount / median / 1e6 : 0.0;
+
+            if (options.csv)
+            {
+                std::printf("%s,%d,%d,%zu,%.4f,%.2f,%.0f,%llu\n", op.name, size.width, size.height,
+                    samples.size(), nsPerPixel, mpixPerSec, scratchPeakKB, steadyAllocations);
+            }
+            else
+            {
+                char sizeText[32];
+                std::snprintf(sizeText, sizeof(sizeText), "%dx%d", size.width, size.height);
+                std::printf("%-20s %13s %6zu %12.4f %10.2f %12.0f %7llu\n", op.name, sizeText,
+                    samples.size(), nsPerPixel, mpixPerSec, scratchPeakKB, steadyAllocations);
+            }
+            std::fflush(stdout);
+        }
+        fft.Clear();
+    }
+    std::remove(tiledInput);
+    std::remove(tiledOutput);
+    return 0;
+}
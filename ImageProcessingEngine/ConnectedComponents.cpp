@@ -0,0 +1,291 @@
+﻿#include "pch.h"
+#include "ConnectedComponents.h"
+#include "NativeKernels.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace
+{
+    // 띠가 너무 얇으면 경계 병합 비용이 커지므로 최소 행 수를 둔다
+    const int kMinBandRows = 32;
+
+    // 임시 라벨 하나의 통계 누적값
+    struct BlobAccumulator
+    {
+        uint64_t area;
+        uint64_t sumX;
+        uint64_t sumY;
+        uint64_t sumIntensity;
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+    // 경로 절반 압축. 부모는 항상 자신보다 작거나 같은 라벨이다
+    inline uint32_t FindRoot(uint32_t* parent, uint32_t label)
+    {
+        while (parent[label] != label)
+        {
+            parent[label] = parent[parent[label]];
+            label = parent[label];
+        }
+        return label;
+    }
+
+    // 작은 루트 쪽으로 합친다 (평탄화가 한 번의 순방향 훑기로 끝나도록)
+    inline void Union(uint32_t* parent, uint32_t a, uint32_t b)
+    {
+        a = FindRoot(parent, a);
+        b = FindRoot(parent, b);
+        if (a < b) parent[b] = a;
+        else if (b < a) parent[a] = b;
+    }
+
+    inline bool IsForeground(const unsigned char* row, int x, int bpp)
+    {
+        if (bpp == 1) return row[x] != 0;
+        const unsigned char* p = row + static_cast<size_t>(x) * 4;
+        return (p[0] | p[1] | p[2]) != 0;
+    }
+
+    inline unsigned IntensityAt(const unsigned char* row, int x, int bpp)
+    {
+        return bpp == 1 ? row[x] : NativeKernels::GrayOf(row + static_cast<size_t>(x) * 4);
+    }
+}
+
+struct ConnectedComponents::Band
+{
+    int y0 = 0;
+    int y1 = 0;
+    uint32_t base = 0;                      // 이 띠의 지역 라벨 l의 전역 라벨은 base + l
+    std::vector<uint32_t> parent;           // 지역 라벨 → 부모 (0은 배경)
+    std::vector<BlobAccumulator> stats;     // 지역 라벨별 누적값 (0은 사용 안 함)
+
+    uint32_t NewLabel(int x, int y)
+    {
+        const uint32_t label = static_cast<uint32_t>(parent.size());
+        parent.push_back(label);
+        stats.push_back(BlobAccumulator{ 0, 0, 0, 0, x, y, x, y });
+        return label;
+    }
+};
+
+ConnectedComponents::ConnectedComponents() = default;
+ConnectedComponents::~ConnectedComponents() = default;
+
+// 띠 [y0, y1)을 래스터 순서로 라벨링한다. 띠 첫 행은 위 행을 보지 않는다 (경계 병합에서 처리)
+template <Connectivity connectivity>
+static void LabelBand(ConnectedComponents::Band& band, const ImageView& mask, const ImageView& intensity,
+                      uint32_t* labels, int width)
+{
+    band.parent.assign(1, 0);
+    band.stats.assign(1, BlobAccumulator{});
+    const int bpp = mask.bytesPerPixel;
+
+    for (int y = band.y0; y < band.y1; ++y)
+    {
+        const unsigned char* m = mask.Row(y);
+        const unsigned char* v = intensity.Row(y);
+        uint32_t* out = labels + static_cast<size_t>(y) * width;
+        const uint32_t* up = y > band.y0 ? out - width : nullptr;
+
+        for (int x = 0; x < width; ++x)
+        {
+            if (!IsForeground(m, x, bpp))
+            {
+                out[x] = 0;
+                continue;
+            }
+
+            const uint32_t left = x > 0 ? out[x - 1] : 0;
+            uint32_t label = 0;
+            if (up == nullptr)
+            {
+                label = left;
+            }
+            else if (connectivity == Connectivity::Four)
+            {
+                label = up[x] ? up[x] : left;
+                if (up[x] && left && up[x] != left) Union(band.parent.data(), up[x], left);
+            }
+            else
+            {
+                // 위 화소가 전경이면 왼쪽/왼쪽 위/오른쪽 위는 이미 위 화소와 같은 요소다
+                const uint32_t upLeft = x > 0 ? up[x - 1] : 0;
+                const uint32_t upRight = x + 1 < width ? up[x + 1] : 0;
+                if (up[x])
+                {
+                    label = up[x];
+                }
+                else if (upRight)
+                {
+                    label = upRight;
+                    const uint32_t other = left ? left : upLeft;
+                    if (other && other != upRight) Union(band.parent.data(), upRight, other);
+                }
+                else
+                {
+                    label = upLeft ? upLeft : left;
+                }
+            }
+            if (label == 0) label = band.NewLabel(x, y);
+            out[x] = label;
+
+            BlobAccumulator& s = band.stats[label];
+            ++s.area;
+            s.sumX += static_cast<uint64_t>(x);
+            s.sumY += static_cast<uint64_t>(y);
+            s.sumIntensity += IntensityAt(v, x, intensity.bytesPerPixel);
+            s.minX = std::min(s.minX, x);
+            s.maxX = std::max(s.maxX, x);
+            s.maxY = y;
+        }
+    }
+}
+
+int ConnectedComponents::Label(const ImageView& mask, Connectivity connectivity, const ImageView& intensity)
+{
+    ProfileScope profile("components", mask.width, mask.height);
+    m_blobs.clear();
+    if (!mask.IsValid()) return -1;
+    if (intensity.data != nullptr &&
+        (!intensity.IsValid() || intensity.width != mask.width || intensity.height != mask.height)) return -1;
+
+    const ImageView values = intensity.data != nullptr ? intensity : mask;
+    const int width = mask.width;
+    const int height = mask.height;
+    m_width = width;
+    m_height = height;
+    m_labels.resize(static_cast<size_t>(width) * height);
+    uint32_t* labels = m_labels.data();
+
+    // 1) 띠별 라벨링 (병렬)
+    const int targetBands = std::max(1, ThreadPool::Shared().ThreadCount() * 4);
+    const int bandRows = std::max(kMinBandRows, (height + targetBands - 1) / targetBands);
+    const int bandCount = (height + bandRows - 1) / bandRows;
+    if (static_cast<int>(m_bands.size()) < bandCount) m_bands.resize(bandCount);
+    for (int b = 0; b < bandCount; ++b)
+    {
+        m_bands[b].y0 = b * bandRows;
+        m_bands[b].y1 = std::min(height, (b + 1) * bandRows);
+    }
+
+    ThreadPool::Shared().ParallelFor(0, bandCount, 1, [&](int b0, int b1)
+        {
+            for (int b = b0; b < b1; ++b)
+            {
+                if (connectivity == Connectivity::Four) LabelBand<Connectivity::Four>(m_bands[b], mask, values, labels, width);
+                else LabelBand<Connectivity::Eight>(m_bands[b], mask, values, labels, width);
+            }
+        });
+
+    // 지역 라벨 → 전역 라벨 (띠 순서대로 이어 붙인다)
+    uint32_t total = 0;
+    for (int b = 0; b < bandCount; ++b)
+    {
+        m_bands[b].base = total;
+        total += static_cast<uint32_t>(m_bands[b].parent.size() - 1);
+    }
+    m_parent.resize(static_cast<size_t>(total) + 1);
+    uint32_t* parent = m_parent.data();
+    parent[0] = 0;
+    ThreadPool::Shared().ParallelFor(0, bandCount, 1, [&](int b0, int b1)
+        {
+            for (int b = b0; b < b1; ++b)
+            {
+                const Band& band = m_bands[b];
+                for (size_t l = 1; l < band.parent.size(); ++l) parent[band.base + l] = band.base + band.parent[l];
+            }
+        });
+
+    // 2) 띠 경계 병합: 띠 첫 행과 바로 위 행 (순차)
+    for (int b = 1; b < bandCount; ++b)
+    {
+        const int y = m_bands[b].y0;
+        const uint32_t base = m_bands[b].base;
+        const uint32_t upperBase = m_bands[b - 1].base;
+        const uint32_t* row = labels + static_cast<size_t>(y) * width;
+        const uint32_t* up = row - width;
+        for (int x = 0; x < width; ++x)
+        {
+            if (!row[x]) continue;
+            const uint32_t label = base + row[x];
+            if (up[x]) Union(parent, label, upperBase + up[x]);
+            if (connectivity == Connectivity::Eight)
+            {
+                if (x > 0 && up[x - 1]) Union(parent, label, upperBase + up[x - 1]);
+                if (x + 1 < width && up[x + 1]) Union(parent, label, upperBase + up[x + 1]);
+            }
+        }
+    }
+
+    // 3) 평탄화: 부모는 항상 더 작은 라벨이므로 순서대로 훑으면 부모의 최종 라벨이 이미 정해져 있다
+    uint32_t count = 0;
+    for (uint32_t l = 1; l <= total; ++l)
+    {
+        parent[l] = parent[l] < l ? parent[parent[l]] : ++count;
+    }
+
+    // 블롭별 합계: 합치는 동안 bounds는 (minX, minY, maxX, maxY), 중심/밝기는 합을 담는다 (2^53 미만이라 정확)
+    m_blobs.assign(count, BlobStats{ 0, ImageRect{ width, height, -1, -1 }, 0.0, 0.0, 0.0 });
+    for (int b = 0; b < bandCount; ++b)
+    {
+        const Band& band = m_bands[b];
+        for (size_t l = 1; l < band.stats.size(); ++l)
+        {
+            const BlobAccumulator& s = band.stats[l];
+            BlobStats& blob = m_blobs[parent[band.base + l] - 1];
+            blob.area += static_cast<int64_t>(s.area);
+            blob.bounds.x = std::min(blob.bounds.x, s.minX);
+            blob.bounds.y = std::min(blob.bounds.y, s.minY);
+            blob.bounds.width = std::max(blob.bounds.width, s.maxX);
+            blob.bounds.height = std::max(blob.bounds.height, s.maxY);
+            blob.centroidX += static_cast<double>(s.sumX);
+            blob.centroidY += static_cast<double>(s.sumY);
+            blob.meanIntensity += static_cast<double>(s.sumIntensity);
+        }
+    }
+    for (BlobStats& blob : m_blobs)
+    {
+        const double area = static_cast<double>(blob.area);
+        blob.bounds.width -= blob.bounds.x - 1;
+        blob.bounds.height -= blob.bounds.y - 1;
+        blob.centroidX /= area;
+        blob.centroidY /= area;
+        blob.meanIntensity /= area;
+    }
+
+    // 4) 라벨 맵을 최종 라벨로 (병렬)
+    ThreadPool::Shared().ParallelFor(0, bandCount, 1, [&](int b0, int b1)
+        {
+            for (int b = b0; b < b1; ++b)
+            {
+                const Band& band = m_bands[b];
+                const uint32_t* map = parent + band.base;
+                uint32_t* p = labels + static_cast<size_t>(band.y0) * width;
+                uint32_t* end = labels + static_cast<size_t>(band.y1) * width;
+                for (; p != end; ++p)
+                {
+                    if (*p) *p = map[*p];
+                }
+            }
+        });
+
+    return static_cast<int>(count);
+}
+
+void ConnectedComponents::Clear()
+{
+    m_width = m_height = 0;
+    m_labels.clear();
+    m_labels.shrink_to_fit();
+    m_parent.clear();
+    m_parent.shrink_to_fit();
+    m_bands.clear();
+    m_bands.shrink_to_fit();
+    m_blobs.clear();
+    m_blobs.shrink_to_fit();
+}
@@ -0,0 +1,65 @@
+﻿#pragma once
+
+#include "ImageView.h"
+#include <cstdint>
+#include <vector>
+
+// 연결 요소 판정 기준: 상하좌우(4) 또는 대각선 포함(8)
+enum class Connectivity
+{
+    Four = 4,
+    Eight = 8,
+};
+
+// 연결 요소(블롭) 통계. 라벨 i의 통계는 Blobs()[i - 1]
+struct BlobStats
+{
+    int64_t area = 0;           // 화소 수
+    ImageRect bounds;           // 외접 사각형
+    double centroidX = 0.0;     // 화소 중심 좌표의 평균
+    double centroidY = 0.0;
+    double meanIntensity = 0.0; // 밝기 영상 값의 평균 (0 ~ 255)
+};
+
+// =====================================================
+//  병렬 연결 요소 라벨링 (union-find)
+//  1) 영상을 가로 띠로 나눠 띠마다 독립적으로 래스터 순서 라벨링 + 통계 누적 (병렬)
+//  2) 띠 경계 행만 위 띠와 union (순차, 경계마다 O(width))
+//  3) 임시 라벨을 순서대로 한 번 훑어 최종 라벨(1..N)로 평탄화하고 통계를 합친다
+//  4) 라벨 맵을 최종 라벨로 바꾼다 (병렬)
+//  모든 단계가 화소 수/임시 라벨 수에 선형이므로 블롭이 수십만 개여도 느려지지 않는다.
+//  최종 라벨은 띠 나누기와 무관하게 각 블롭의 첫 화소(래스터 순서) 순이다.
+//  작업 버퍼는 객체가 보관해 같은 크기 영상을 반복 처리하면 새 할당이 없다. 스레드 안전하지 않다.
+// =====================================================
+class ConnectedComponents
+{
+public:
+    ConnectedComponents();
+    ~ConnectedComponents();
+
+    // mask의 전경(그레이: 0이 아닌 값, BGRA: B/G/R 중 하나라도 0이 아닌 화소)을 라벨링하고 블롭 수를 돌려준다.
+    // intensity(mask와 같은 크기, BGRA면 그레이 변환 값)로 평균 밝기를 구한다. 비어 있으면 mask 자체를 쓴다.
+    // 잘못된 입력이면 -1
+    int Label(const ImageView& mask, Connectivity connectivity, const ImageView& intensity = ImageView());
+
+    int Count() const { return static_cast<int>(m_blobs.size()); }
+    const std::vector<BlobStats>& Blobs() const { return m_blobs; }
+
+    // 라벨 맵 (Width() x Height(), 빈틈 없음). 0은 배경, 1..Count()는 블롭
+    const uint32_t* Labels() const { return m_labels.data(); }
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+
+    void Clear();
+
+    // 띠 하나의 임시 라벨 상태 (내부용)
+    struct Band;
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<uint32_t> m_labels;
+    std::vector<uint32_t> m_parent;     // 전역 임시 라벨 → 부모 (평탄화 후 최종 라벨)
+    std::vector<Band> m_bands;
+    std::vector<BlobStats> m_blobs;
+};
@@ -0,0 +1,95 @@
+﻿#include "pch.h"
+#include "CpuFeatures.h"
+#include <cstring>
+
+#if defined(IMAGEPROCESSING_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(IMAGEPROCESSING_X86)
+static void QueryCpuid(unsigned int leaf, unsigned int subLeaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subLeaf));
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned int>(r[i]);
+#else
+    if (!__get_cpuid_count(leaf, subLeaf, &regs[0], &regs[1], &regs[2], &regs[3]))
+    {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    }
+#endif
+}
+
+static unsigned long long QueryXcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+SimdLevel DetectSimdLevel()
+{
+#if defined(IMAGEPROCESSING_X86)
+    unsigned int regs[4];
+    QueryCpuid(0, 0, regs);
+    const unsigned int maxLeaf = regs[0];
+    if (maxLeaf < 1) return SimdLevel::Scalar;
+
+    QueryCpuid(1, 0, regs);
+    const bool sse41 = (regs[2] & (1u << 19)) != 0;
+    const bool osxsave = (regs[2] & (1u << 27)) != 0;
+    const bool avx = (regs[2] & (1u << 28)) != 0;
+    if (!sse41) return SimdLevel::Scalar;
+    if (!osxsave || !avx || maxLeaf < 7) return SimdLevel::SSE41;
+
+    // OS가 YMM(XMM|YMM) / ZMM(opmask|ZMM_Hi256|Hi16_ZMM) 상태를 저장하는지 확인
+    const unsigned long long xcr0 = QueryXcr0();
+    if ((xcr0 & 0x6) != 0x6) return SimdLevel::SSE41;
+
+    QueryCpuid(7, 0, regs);
+    const bool avx2 = (regs[1] & (1u << 5)) != 0;
+    const bool avx512f = (regs[1] & (1u << 16)) != 0;
+    const bool avx512bw = (regs[1] & (1u << 30)) != 0;
+    if (!avx2) return SimdLevel::SSE41;
+    if (avx512f && avx512bw && (xcr0 & 0xE6) == 0xE6) return SimdLevel::AVX512;
+    return SimdLevel::AVX2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const char* SimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::SSE41:  return "sse4.1";
+    case SimdLevel::AVX2:   return "avx2";
+    case SimdLevel::AVX512: return "avx512";
+    default:                return "scalar";
+    }
+}
+
+bool ParseSimdLevel(const char* text, SimdLevel& level)
+{
+    if (text == nullptr) return false;
+    const SimdLevel all[] = { SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512 };
+    for (SimdLevel candidate : all)
+    {
+        if (std::strcmp(text, SimdLevelName(candidate)) == 0)
+        {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,25 @@
+﻿#pragma once
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define IMAGEPROCESSING_X86 1
+#endif
+
+// 런타임 CPU 기능 검출 (CPUID + OS의 AVX 상태 저장 지원 여부)
+enum class SimdLevel
+{
+    Scalar = 0,
+    SSE41,
+    AVX2,
+    AVX512,     // AVX-512 F + BW
+};
+
+// 이 CPU/OS에서 사용할 수 있는 최고 SIMD 수준
+SimdLevel DetectSimdLevel();
+
+// 현재 커널 디스패치에 사용 중인 수준 / 강제 지정 (검출된 수준을 넘지 않음, 실제 적용 수준 반환)
+// 환경 변수 IMAGEPROCESSING_SIMD=scalar|sse4.1|avx2|avx512 로도 최초 수준을 제한할 수 있다.
+SimdLevel ActiveSimdLevel();
+SimdLevel SetSimdLevel(SimdLevel level);
+
+const char* SimdLevelName(SimdLevel level);
+bool ParseSimdLevel(const char* text, SimdLevel& level);
@@ -0,0 +1,467 @@
+﻿#include "pch.h"
+#include "EdgeDetection.h"
+#include "SimdKernels.h"
+#include "ScratchArena.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // 그래디언트 밴드의 최소 크기 (NativeProcessor의 밴드 기준과 같음)
+    const int kMinBandPixels = 1 << 16;
+    const int kMinBandRows = 8;
+
+    // 캐니 밴드가 너무 얇으면 halo 행 재계산과 경계 병합 비용이 커지므로 최소 행 수를 둔다
+    const int kMinCannyBandRows = 32;
+
+    // 비최대 억제에서 한 번에 걸러내는 화소 수와, 묶음 전체를 분기 없이 계산할 후보 수 하한
+    // (후보가 드문 묶음은 후보만 따로 계산하는 편이 빠르다)
+    const int kSkipBlock = 16;
+    const int kDenseCandidates = 4;
+
+    // tan(22.5°)를 2^15 배 한 값. |gy| 2^15 와 |gx| tan 을 정수로 비교해 나눗셈/atan 없이 방향을 정한다.
+    // tan(67.5°) = 2 + tan(22.5°) 이므로 수직 판정도 같은 곱 하나로 한다 (16비트 x 16비트 곱만 사용)
+    const int kTan22 = 13573;
+
+    // 방향 코드 0..7. 분기 없이 고른다 (행 루프가 벡터화됨): 수평 0/4, 수직 2/6, 대각선 1/3/5/7
+    inline int OrientationCode(int dx, int dy)
+    {
+        const int ax = std::abs(dx), ay = std::abs(dy);
+        const int limit = ax * kTan22;
+        const int negX = dx < 0, negY = dy < 0;
+        const int horizontal = 4 * negX;
+        const int vertical = 2 + 4 * negY;
+        const int diagonal = 1 + 2 * (negX ^ negY) + 4 * negY;
+        return (ay * 32768 <= limit) ? horizontal : (((ay - 2 * ax) * 32768 > limit) ? vertical : diagonal);
+    }
+
+    // 세로 평활(side, center, side)과 세로 미분(아래 - 위). 양 끝 한 칸은 가장자리 반복
+    template <int bpp, int side, int center>
+    void VerticalPass(const unsigned char* up, const unsigned char* mid, const unsigned char* down, int width,
+                      int16_t* smooth, int16_t* diff)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const int u = up[x * bpp], m = mid[x * bpp], d = down[x * bpp];
+            smooth[x + 1] = static_cast<int16_t>(side * (u + d) + center * m);
+            diff[x + 1] = static_cast<int16_t>(d - u);
+        }
+        smooth[0] = smooth[1];
+        smooth[width + 1] = smooth[width];
+        diff[0] = diff[1];
+        diff[width + 1] = diff[width];
+    }
+
+    // 가로 미분(오른쪽 - 왼쪽)과 가로 평활. 최대 |값|은 Scharr 16 x 255로 16비트 안이다
+    template <int side, int center>
+    void HorizontalPass(const int16_t* smooth, const int16_t* diff, int width, int16_t* gx, int16_t* gy)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            gx[x] = static_cast<int16_t>(smooth[x + 2] - smooth[x]);
+            gy[x] = static_cast<int16_t>(side * (diff[x] + diff[x + 2]) + center * diff[x + 1]);
+        }
+    }
+
+    template <int side, int center>
+    void GradientRowT(const unsigned char* up, const unsigned char* mid, const unsigned char* down, int width,
+                      int bytesPerPixel, int16_t* gx, int16_t* gy, int16_t* work)
+    {
+        int16_t* smooth = work;
+        int16_t* diff = work + width + 2;
+        if (bytesPerPixel == 4) VerticalPass<4, side, center>(up, mid, down, width, smooth, diff);
+        else VerticalPass<1, side, center>(up, mid, down, width, smooth, diff);
+        HorizontalPass<side, center>(smooth, diff, width, gx, gy);
+    }
+
+    // 밴드 하나가 행 y의 gx, gy를 구하는 계산기. 영상 밖 행은 가장자리 행을 반복한다.
+    // 그레이 영상은 행을 그대로 읽고, BGRA는 세 행 버퍼를 돌려 쓰며 행마다 한 번만 그레이로 변환한다
+    class RowGradient
+    {
+    public:
+        RowGradient(const ImageView& src, GradientOperator op)
+            : m_src(src), m_op(op),
+              m_buffer(ScratchArena::Shared().Acquire(static_cast<size_t>(src.width + 2) * 2 * sizeof(int16_t) +
+                                                      (src.bytesPerPixel == 4 ? static_cast<size_t>(src.width) * 3 : 0)))
+        {
+            m_work = m_buffer.As<int16_t>();
+            m_gray = reinterpret_cast<unsigned char*>(m_work + 2 * (static_cast<size_t>(src.width) + 2));
+        }
+
+        void Compute(int y, int16_t* gx, int16_t* gy)
+        {
+            const int last = m_src.height - 1;
+            EdgeDetection::GradientRow(GrayRow(std::max(0, y - 1)), GrayRow(y), GrayRow(std::min(last, y + 1)),
+                                       m_src.width, 1, m_op, gx, gy, m_work);
+        }
+
+    private:
+        const unsigned char* GrayRow(int y)
+        {
+            if (m_src.bytesPerPixel == 1) return m_src.Row(y);
+            const int slot = y % 3;
+            unsigned char* row = m_gray + static_cast<size_t>(slot) * m_src.width;
+            if (m_cached[slot] != y)
+            {
+                SimdKernels::Active().grayFromBGRA(m_src.Row(y), row, m_src.width);
+                m_cached[slot] = y;
+            }
+            return row;
+        }
+
+        ImageView m_src;
+        GradientOperator m_op;
+        ScratchArena::Buffer m_buffer;
+        int16_t* m_work;
+        unsigned char* m_gray;
+        int m_cached[3] = { -1, -1, -1 };
+    };
+
+    // 캐니가 비교하는 세기: L1은 크기 그대로, L2는 제곱 (제곱근/절삭 없이 크기 순서가 정확하다)
+    void StrengthRow(const int16_t* gx, const int16_t* gy, int width, GradientNorm norm, int32_t* strength)
+    {
+        if (norm == GradientNorm::L1)
+        {
+            for (int x = 0; x < width; ++x) strength[x] = std::abs(gx[x]) + std::abs(gy[x]);
+            return;
+        }
+        for (int x = 0; x < width; ++x) strength[x] = gx[x] * gx[x] + gy[x] * gy[x];
+    }
+
+    // 비최대 억제 → 0 / 1(약한 후보) / 2(강한 엣지). 방향 축의 두 이웃보다 커야 남으며
+    // a(그래디언트 반대쪽: 위/왼쪽)와 같으면 버리고 b와 같으면 남겨 같은 세기가 이어져도 한 화소만 남긴다.
+    // 이웃을 모두 읽은 뒤 분기 없이 고른다 (조건부 읽기는 벡터화를 막는다)
+    inline unsigned char SuppressPixel(const int32_t* m0, const int32_t* m1, const int32_t* m2, const int16_t* dx,
+                                       const int16_t* dy, int x, int32_t low, int32_t high)
+    {
+        const int axis = OrientationCode(dx[x], dy[x]) & 3;
+        const int32_t m = m1[x];
+        const int32_t left = m1[x - 1], right = m1[x + 1];
+        const int32_t upLeft = m0[x - 1], up = m0[x], upRight = m0[x + 1];
+        const int32_t downLeft = m2[x - 1], down = m2[x], downRight = m2[x + 1];
+        const int32_t a = axis == 0 ? left : (axis == 1 ? upLeft : (axis == 2 ? up : upRight));
+        const int32_t b = axis == 0 ? right : (axis == 1 ? downRight : (axis == 2 ? down : downLeft));
+        const int keep = (m > low) & (m > a) & (m >= b);
+        return static_cast<unsigned char>(keep * (1 + (m > high)));
+    }
+
+    // stack의 엣지에서 8-연결 약한 후보(1)로 확장한다. 위치 [lo, hi) 밖은 건드리지 않는다.
+    // 엣지는 가장자리 화소가 아니므로 이웃은 항상 영상 안이다
+    void Grow(unsigned char* map, std::vector<uint32_t>& stack, int width, size_t lo, size_t hi)
+    {
+        const ptrdiff_t w = width;
+        const ptrdiff_t offsets[8] = { -w - 1, -w, -w + 1, -1, 1, w - 1, w, w + 1 };
+        while (!stack.empty())
+        {
+            const ptrdiff_t p = stack.back();
+            stack.pop_back();
+            for (ptrdiff_t d : offsets)
+            {
+                const size_t q = static_cast<size_t>(p + d);
+                if (q < lo || q >= hi || map[q] != 1) continue;
+                map[q] = 2;
+                stack.push_back(static_cast<uint32_t>(q));
+            }
+        }
+    }
+
+    // a 행의 엣지와 맞닿은 b 행의 약한 후보를 엣지로 올리고 stack에 넣는다
+    void LinkRows(const unsigned char* a, unsigned char* b, int width, size_t bOffset, std::vector<uint32_t>& stack)
+    {
+        for (int x = 1; x < width - 1; ++x)
+        {
+            if (a[x] != 2) continue;
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                if (b[x + dx] != 1) continue;
+                b[x + dx] = 2;
+                stack.push_back(static_cast<uint32_t>(bOffset + x + dx));
+            }
+        }
+    }
+}
+
+int EdgeDetection::MaxMagnitude(GradientOperator op, GradientNorm norm)
+{
+    // 3x3 창의 0/255 조합 중 최대 (크기는 화소 값에 대해 볼록이므로 꼭짓점에서 최대)
+    if (op == GradientOperator::Scharr) return norm == GradientNorm::L1 ? 6630 : 4811;
+    return norm == GradientNorm::L1 ? 1530 : 1140;
+}
+
+void EdgeDetection::GradientRow(const unsigned char* up, const unsigned char* mid, const unsigned char* down, int width,
+                                int bytesPerPixel, GradientOperator op, int16_t* gx, int16_t* gy, int16_t* work)
+{
+    if (op == GradientOperator::Scharr) GradientRowT<3, 10>(up, mid, down, width, bytesPerPixel, gx, gy, work);
+    else GradientRowT<1, 2>(up, mid, down, width, bytesPerPixel, gx, gy, work);
+}
+
+void EdgeDetection::MagnitudeRow(const int16_t* gx, const int16_t* gy, int width, GradientNorm norm, uint16_t* magnitude)
+{
+    if (norm == GradientNorm::L1)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            magnitude[x] = static_cast<uint16_t>(std::abs(gx[x]) + std::abs(gy[x]));
+        }
+        return;
+    }
+
+    // 제곱합은 2^24 미만(Sobel)이면 float로 정확하며, 정수 제곱근 근처에서도 절삭 결과가 바뀌지 않는다
+    for (int x = 0; x < width; ++x)
+    {
+        const int n = gx[x] * gx[x] + gy[x] * gy[x];
+        magnitude[x] = static_cast<uint16_t>(std::sqrt(static_cast<float>(n)));
+    }
+}
+
+void EdgeDetection::MagnitudeRow8(const int16_t* gx, const int16_t* gy, int width, unsigned char* magnitude)
+{
+    for (int x = 0; x < width; ++x)
+    {
+        const int n = gx[x] * gx[x] + gy[x] * gy[x];
+        const int m = static_cast<int>(std::sqrt(static_cast<float>(n)));
+        magnitude[x] = static_cast<unsigned char>(m < 255 ? m : 255);
+    }
+}
+
+void EdgeDetection::OrientationRow(const int16_t* gx, const int16_t* gy, int width, unsigned char* orientation)
+{
+    for (int x = 0; x < width; ++x)
+    {
+        orientation[x] = static_cast<unsigned char>(OrientationCode(gx[x], gy[x]));
+    }
+}
+
+bool EdgeDetection::Gradient(const ImageView& src, GradientOperator op, GradientNorm norm, uint16_t* magnitude,
+                             size_t magnitudeStride, unsigned char* orientation, size_t orientationStride)
+{
+    ProfileScope profile("gradient", src.width, src.height);
+    if (!src.IsValid() || magnitude == nullptr || magnitudeStride < static_cast<size_t>(src.width) ||
+        (orientation != nullptr && orientationStride < static_cast<size_t>(src.width))) return false;
+
+    const int width = src.width;
+    const int grain = std::max(kMinBandRows, kMinBandPixels / width);
+    ThreadPool::Shared().ParallelFor(0, src.height, grain, [&](int y0, int y1)
+        {
+            RowGradient rows(src, op);
+            ScratchArena::Buffer buffer = ScratchArena::Shared().Acquire(static_cast<size_t>(width) * 2 * sizeof(int16_t));
+            int16_t* gx = buffer.As<int16_t>();
+            int16_t* gy = gx + width;
+            for (int y = y0; y < y1; ++y)
+            {
+                rows.Compute(y, gx, gy);
+                MagnitudeRow(gx, gy, width, norm, magnitude + static_cast<size_t>(y) * magnitudeStride);
+                if (orientation != nullptr)
+                {
+                    OrientationRow(gx, gy, width, orientation + static_cast<size_t>(y) * orientationStride);
+                }
+            }
+        });
+    return true;
+}
+
+// ==================== 캐니 ====================
+
+struct CannyDetector::Band
+{
+    int y0 = 0;
+    int y1 = 0;
+    std::vector<uint32_t> stack;    // 확장할 엣지 위치 (화소 번호)
+    int64_t edges = 0;
+};
+
+CannyDetector::CannyDetector() = default;
+CannyDetector::~CannyDetector() = default;
+
+// 밴드 [y0, y1)의 비최대 억제 + 이중 임계값 → 엣지 맵, 이어서 밴드 안에서만 확장한다.
+// 그래디언트는 세 행을 돌려 쓰며 밴드 위아래 한 행씩만 다시 계산한다. low/high는 세기(StrengthRow) 기준
+static void SuppressBand(CannyDetector::Band& band, const ImageView& src, GradientOperator op, GradientNorm norm,
+                         int32_t low, int32_t high, unsigned char* map)
+{
+    const int width = src.width;
+    const int height = src.height;
+    band.stack.clear();
+
+    // 가장자리 행은 엣지가 아니다
+    if (band.y0 == 0) memset(map, 0, static_cast<size_t>(width));
+    if (band.y1 == height) memset(map + static_cast<size_t>(height - 1) * width, 0, static_cast<size_t>(width));
+    const int first = std::max(1, band.y0);
+    const int last = std::min(height - 1, band.y1);
+    if (first >= last) return;
+
+    // 행마다 gx, gy, 세기를 담는 세 행 고리 버퍼
+    const size_t n = static_cast<size_t>(width);
+    ScratchArena::Buffer ring = ScratchArena::Shared().Acquire(n * 3 * (2 * sizeof(int16_t) + sizeof(int32_t)));
+    int32_t* strength[3];
+    int16_t* gx[3];
+    int16_t* gy[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        strength[i] = ring.As<int32_t>() + n * i;
+        gx[i] = reinterpret_cast<int16_t*>(ring.As<int32_t>() + n * 3) + n * (2 * i);
+        gy[i] = gx[i] + n;
+    }
+
+    RowGradient rows(src, op);
+    auto compute = [&](int y)
+        {
+            const int slot = y % 3;
+            rows.Compute(y, gx[slot], gy[slot]);
+            StrengthRow(gx[slot], gy[slot], width, norm, strength[slot]);
+        };
+
+    compute(first - 1);
+    compute(first);
+    for (int y = first; y < last; ++y)
+    {
+        compute(y + 1);
+        const int32_t* m0 = strength[(y - 1) % 3];
+        const int32_t* m1 = strength[y % 3];
+        const int32_t* m2 = strength[(y + 1) % 3];
+        const int16_t* dx = gx[y % 3];
+        const int16_t* dy = gy[y % 3];
+        unsigned char* out = map + static_cast<size_t>(y) * width;
+        const size_t offset = static_cast<size_t>(y) * width;
+
+        out[0] = 0;
+        out[width - 1] = 0;
+        // 대부분의 화소는 low 이하이므로 kSkipBlock개 묶음의 후보 수로 먼저 걸러낸다
+        for (int x0 = 1; x0 < width - 1; x0 += kSkipBlock)
+        {
+            const int x1 = std::min(width - 1, x0 + kSkipBlock);
+            int candidates = 0;
+            for (int x = x0; x < x1; ++x) candidates += m1[x] > low;
+            if (candidates == 0)
+            {
+                memset(out + x0, 0, static_cast<size_t>(x1 - x0));
+                continue;
+            }
+
+            if (candidates >= kDenseCandidates)
+            {
+                for (int x = x0; x < x1; ++x) out[x] = SuppressPixel(m0, m1, m2, dx, dy, x, low, high);
+            }
+            else
+            {
+                for (int x = x0; x < x1; ++x)
+                    out[x] = m1[x] > low ? SuppressPixel(m0, m1, m2, dx, dy, x, low, high) : 0;
+            }
+            for (int x = x0; x < x1; ++x)
+            {
+                if (out[x] == 2) band.stack.push_back(static_cast<uint32_t>(offset + x));
+            }
+        }
+    }
+
+    Grow(map, band.stack, width, static_cast<size_t>(band.y0) * width, static_cast<size_t>(band.y1) * width);
+}
+
+int64_t CannyDetector::Detect(const ImageView& src, const ImageView& dst, int lowThreshold, int highThreshold,
+                              GradientOperator op, GradientNorm norm)
+{
+    ProfileScope profile("canny", src.width, src.height);
+    if (!src.IsValid() || !dst.IsValid() || dst.width != src.width || dst.height != src.height) return -1;
+    // 확장 스택은 화소 번호를 32비트로 담는다
+    if (static_cast<uint64_t>(src.width) * static_cast<uint64_t>(src.height) > UINT32_MAX) return -1;
+    if (lowThreshold > highThreshold) std::swap(lowThreshold, highThreshold);
+
+    // 크기 임계값 → 세기 임계값. 최대 크기 이상은 어떤 화소도 넘지 못하므로 잘라도 결과가 같다
+    const int maxMagnitude = EdgeDetection::MaxMagnitude(op, norm);
+    int32_t low = std::min(std::max(lowThreshold, 0), maxMagnitude);
+    int32_t high = std::min(std::max(highThreshold, 0), maxMagnitude);
+    if (norm == GradientNorm::L2)
+    {
+        low *= low;
+        high *= high;
+    }
+
+    const int width = src.width;
+    const int height = src.height;
+    m_width = width;
+    m_height = height;
+    m_map.resize(static_cast<size_t>(width) * height);
+    unsigned char* map = m_map.data();
+
+    // 1) 밴드별 비최대 억제 + 밴드 안 확장 (병렬)
+    const int targetBands = std::max(1, ThreadPool::Shared().ThreadCount() * 4);
+    const int bandRows = std::max(kMinCannyBandRows, (height + targetBands - 1) / targetBands);
+    const int bandCount = (height + bandRows - 1) / bandRows;
+    if (static_cast<int>(m_bands.size()) < bandCount) m_bands.resize(bandCount);
+    for (int b = 0; b < bandCount; ++b)
+    {
+        m_bands[b].y0 = b * bandRows;
+        m_bands[b].y1 = std::min(height, (b + 1) * bandRows);
+    }
+
+    ThreadPool::Shared().ParallelFor(0, bandCount, 1, [&](int b0, int b1)
+        {
+            for (int b = b0; b < b1; ++b) SuppressBand(m_bands[b], src, op, norm, low, high, map);
+        });
+
+    // 2) 밴드 경계: 위 띠 마지막 행과 아래 띠 첫 행을 서로 이어 붙이고 새로 닿은 후보를 전체로 확장 (순차)
+    m_stack.clear();
+    for (int b = 1; b < bandCount; ++b)
+    {
+        const size_t offset = static_cast<size_t>(m_bands[b].y0) * width;
+        unsigned char* row = map + offset;
+        unsigned char* up = row - width;
+        LinkRows(up, row, width, offset, m_stack);
+        LinkRows(row, up, width, offset - width, m_stack);
+    }
+    Grow(map, m_stack, width, 0, m_map.size());
+
+    // 3) 엣지 맵 → dst (병렬). 맵 값 0/1/2 중 2만 255
+    ThreadPool::Shared().ParallelFor(0, bandCount, 1, [&](int b0, int b1)
+        {
+            for (int b = b0; b < b1; ++b)
+            {
+                Band& band = m_bands[b];
+                int64_t edges = 0;
+                for (int y = band.y0; y < band.y1; ++y)
+                {
+                    const unsigned char* m = map + static_cast<size_t>(y) * width;
+                    unsigned char* out = dst.Row(y);
+                    int count = 0;
+                    if (dst.bytesPerPixel == 1)
+                    {
+                        for (int x = 0; x < width; ++x)
+                        {
+                            const int edge = m[x] >> 1;
+                            out[x] = static_cast<unsigned char>(edge * 255);
+                            count += edge;
+                        }
+                    }
+                    else
+                    {
+                        for (int x = 0; x < width; ++x)
+                        {
+                            const int edge = m[x] >> 1;
+                            unsigned char* p = out + static_cast<size_t>(x) * 4;
+                            p[0] = p[1] = p[2] = static_cast<unsigned char>(edge * 255);
+                            count += edge;
+                        }
+                    }
+                    edges += count;
+                }
+                band.edges = edges;
+            }
+        });
+
+    int64_t total = 0;
+    for (int b = 0; b < bandCount; ++b) total += m_bands[b].edges;
+    return total;
+}
+
+void CannyDetector::Clear()
+{
+    m_width = m_height = 0;
+    m_map.clear();
+    m_map.shrink_to_fit();
+    m_bands.clear();
+    m_bands.shrink_to_fit();
+    m_stack.clear();
+    m_stack.shrink_to_fit();
+}
@@ -0,0 +1,91 @@
+﻿#pragma once
+
+#include "ImageView.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 3x3 미분 연산자: 분리형 평활 [1 2 1] (Sobel) / [3 10 3] (Scharr) x 미분 [-1 0 1]
+enum class GradientOperator
+{
+    Sobel,
+    Scharr,
+};
+
+// 그래디언트 크기: L1 = |gx| + |gy|, L2 = sqrt(gx² + gy²) 절삭
+enum class GradientNorm
+{
+    L1,
+    L2,
+};
+
+// =====================================================
+//  정수 분리형 그래디언트 (내부용)
+//  행마다 세로 평활/미분을 한 번 구해 두고 가로 미분/평활로 gx, gy를 만든다 (3x3 곱 없이 16비트 정수 덧셈).
+//  gx = 오른쪽 - 왼쪽, gy = 아래 - 위이며 영상 밖은 가장자리 화소를 반복한다.
+//  방향 코드는 atan2(gy, gx)를 45° 단위로 반올림한 0..7 (0 = +x, 2 = +y(아래), 4 = -x, 6 = -y).
+//  그래디언트가 0이면 0. 코드 & 3은 방향과 무관한 축(0 수평, 1 ↘, 2 수직, 3 ↙)이다.
+// =====================================================
+namespace EdgeDetection
+{
+    // 가장 큰 그래디언트 크기 (Sobel L1 1530, L2 1140 / Scharr L1 6630, L2 4811)
+    int MaxMagnitude(GradientOperator op, GradientNorm norm);
+
+    // 한 행의 gx, gy. up/mid/down은 위/현재/아래 행이며 화소 간격 bytesPerPixel로 첫 바이트(그레이 값)만 읽는다.
+    // work는 2 * (width + 2)개 이상
+    void GradientRow(const unsigned char* up, const unsigned char* mid, const unsigned char* down, int width,
+                     int bytesPerPixel, GradientOperator op, int16_t* gx, int16_t* gy, int16_t* work);
+
+    void MagnitudeRow(const int16_t* gx, const int16_t* gy, int width, GradientNorm norm, uint16_t* magnitude);
+
+    // 0..255로 포화한 L2 크기 (Sobel이면 정수 제곱근 절삭과 같다)
+    void MagnitudeRow8(const int16_t* gx, const int16_t* gy, int width, unsigned char* magnitude);
+
+    void OrientationRow(const int16_t* gx, const int16_t* gy, int width, unsigned char* orientation);
+
+    // src(그레이 또는 BGRA, BGRA는 그레이로 읽음)의 그래디언트 크기(width x height, 행 간격 magnitudeStride 원소)와
+    // 방향 코드(nullptr이면 구하지 않음). 행 밴드로 나눠 병렬 처리하며, BGRA는 밴드마다 그레이 세 행만 변환한다.
+    // 잘못된 입력이면 false
+    bool Gradient(const ImageView& src, GradientOperator op, GradientNorm norm, uint16_t* magnitude,
+                  size_t magnitudeStride, unsigned char* orientation = nullptr, size_t orientationStride = 0);
+}
+
+// =====================================================
+//  캐니 엣지 검출기
+//  1) 밴드별 (병렬): 그래디언트 세 행을 돌려 쓰며 비최대 억제 → 엣지 맵 (0 없음, 1 약한 후보, 2 엣지),
+//     밴드 안에서만 강한 엣지에서 약한 후보로 8-연결 확장 (재귀 없이 화소 위치 스택으로)
+//  2) 밴드 경계 행만 이어 붙이고 새로 닿은 후보를 영상 전체로 확장 (순차, 경계마다 O(width))
+//  3) 엣지 맵 → dst (병렬)
+//  크기 > high 면 강한 엣지, low < 크기 <= high 면 강한 엣지에 이어질 때만 엣지. 가장자리 1화소는 엣지가 아니다.
+//  결과는 밴드 나누기(스레드 수)와 무관하다. 작업 버퍼는 객체가 보관하며 스레드 안전하지 않다.
+// =====================================================
+class CannyDetector
+{
+public:
+    CannyDetector();
+    ~CannyDetector();
+
+    // src(그레이 또는 BGRA)의 엣지를 dst(같은 크기, 그레이 또는 BGRA)에 255/0으로 쓰고 엣지 화소 수를 돌려준다.
+    // dst가 BGRA면 B, G, R에 쓰고 alpha는 유지한다. src == dst (제자리)도 된다.
+    // 임계값은 GradientNorm 기준 크기이며 low > high면 바꿔 쓴다 (L2는 제곱끼리 비교하므로 절삭 오차가 없다).
+    // 잘못된 입력이면 -1
+    int64_t Detect(const ImageView& src, const ImageView& dst, int lowThreshold, int highThreshold,
+                   GradientOperator op = GradientOperator::Sobel, GradientNorm norm = GradientNorm::L2);
+
+    // 마지막 Detect의 엣지 맵 (Width() x Height(), 빈틈 없음). 2는 엣지, 나머지는 엣지가 아님
+    const unsigned char* EdgeMap() const { return m_map.data(); }
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+
+    void Clear();
+
+    // 밴드 하나의 상태 (내부용)
+    struct Band;
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<unsigned char> m_map;
+    std::vector<Band> m_bands;
+    std::vector<uint32_t> m_stack;      // 경계 병합 후 전체 확장용
+};
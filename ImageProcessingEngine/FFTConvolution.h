@@ -0,0 +1,17 @@
+﻿#pragma once
+
+// =====================================================
+//  FFT 기반 컨볼루션 (내부용)
+//  NativeKernels::ConvolveRows와 같은 규칙(kSize/2 가장자리는 원본 복사, 내부 alpha 255,
+//  0..255 클램프 후 절삭)을 따르며, 부동소수점 오차 때문에 결과는 ±1 LSB 이내로 같다.
+//  화소당 비용이 커널 크기와 무관하므로 큰 커널에서 공간 컨볼루션보다 빠르다.
+// =====================================================
+namespace FFTConvolution
+{
+    // 이 크기의 영상/커널에서 FFT 경로가 공간 컨볼루션보다 빠를 것으로 예상되는지
+    bool PreferFFT(int width, int height, int kSize, int bytesPerPixel);
+
+    // src → dst (bytesPerPixel: BGRA 4, 그레이 1). src와 dst는 겹치면 안 된다
+    void Convolve(const unsigned char* src, unsigned char* dst, int width, int height, int bytesPerPixel,
+                  const float* kernel, int kSize);
+}
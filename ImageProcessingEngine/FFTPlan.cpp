@@ -0,0 +1,436 @@
+﻿#include "pch.h"
+#include "FFTPlan.h"
+#include "ScratchArena.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846264338327950288
+#endif
+
+// ==================== 계획 캐시 ====================
+namespace
+{
+    std::mutex g_planMutex;
+    std::map<int, std::shared_ptr<const FFTPlan>> g_plans;
+
+    // 기수 R의 단위근 exp(-2πi m / R), R <= 7
+    struct SmallRoots
+    {
+        float re[8][8];
+        float im[8][8];
+
+        SmallRoots()
+        {
+            for (int r = 1; r < 8; ++r)
+            {
+                for (int m = 0; m < r; ++m)
+                {
+                    double angle = -2.0 * M_PI * m / r;
+                    re[r][m] = static_cast<float>(std::cos(angle));
+                    im[r][m] = static_cast<float>(std::sin(angle));
+                }
+            }
+        }
+    };
+
+    const SmallRoots& Roots()
+    {
+        static const SmallRoots roots;
+        return roots;
+    }
+
+    // 기수 R 버터플라이의 DFT 부분 (입력은 이미 트위들이 곱해진 상태)
+    template <int R>
+    inline void SmallDFT(float* xr, float* xi, bool inverse)
+    {
+        const SmallRoots& roots = Roots();
+        const float sign = inverse ? -1.f : 1.f;
+        float yr[R], yi[R];
+        for (int q = 0; q < R; ++q)
+        {
+            float sr = xr[0], si = xi[0];
+            for (int r = 1; r < R; ++r)
+            {
+                const int m = (q * r) % R;
+                const float wr = roots.re[R][m];
+                const float wi = roots.im[R][m] * sign;
+                sr += xr[r] * wr - xi[r] * wi;
+                si += xr[r] * wi + xi[r] * wr;
+            }
+            yr[q] = sr;
+            yi[q] = si;
+        }
+        for (int q = 0; q < R; ++q)
+        {
+            xr[q] = yr[q];
+            xi[q] = yi[q];
+        }
+    }
+
+    template <>
+    inline void SmallDFT<2>(float* xr, float* xi, bool)
+    {
+        const float ar = xr[0], ai = xi[0];
+        xr[0] = ar + xr[1]; xi[0] = ai + xi[1];
+        xr[1] = ar - xr[1]; xi[1] = ai - xi[1];
+    }
+
+    template <>
+    inline void SmallDFT<4>(float* xr, float* xi, bool inverse)
+    {
+        const float t0r = xr[0] + xr[2], t0i = xi[0] + xi[2];
+        const float t1r = xr[0] - xr[2], t1i = xi[0] - xi[2];
+        const float t2r = xr[1] + xr[3], t2i = xi[1] + xi[3];
+        // (a1 - a3)에 순방향은 -i, 역방향은 +i를 곱한다
+        float t3r = xi[1] - xi[3], t3i = xr[3] - xr[1];
+        if (inverse)
+        {
+            t3r = -t3r;
+            t3i = -t3i;
+        }
+        xr[0] = t0r + t2r; xi[0] = t0i + t2i;
+        xr[2] = t0r - t2r; xi[2] = t0i - t2i;
+        xr[1] = t1r + t3r; xi[1] = t1i + t3i;
+        xr[3] = t1r - t3r; xi[3] = t1i - t3i;
+    }
+
+    // Stockham 자동 정렬 단계 하나: 입력 j + r * stride 를 읽어 출력 out + r * span 에 기록
+    template <int R>
+    void StockhamStage(const float* srcRe, const float* srcIm, float* dstRe, float* dstIm,
+                       int n, int span, int lanes, const float* twRe, const float* twIm, bool inverse)
+    {
+        const int stride = n / R;
+        const float twSign = inverse ? -1.f : 1.f;
+        for (int j = 0; j < stride; ++j)
+        {
+            const int k = j % span;
+            const size_t out = static_cast<size_t>(j / span) * span * R + k;
+            const float* wr = twRe + static_cast<size_t>(k) * (R - 1);
+            const float* wi = twIm + static_cast<size_t>(k) * (R - 1);
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                float xr[R], xi[R];
+                for (int r = 0; r < R; ++r)
+                {
+                    const size_t index = static_cast<size_t>(j + r * stride) * lanes + lane;
+                    xr[r] = srcRe[index];
+                    xi[r] = srcIm[index];
+                }
+                for (int r = 1; r < R; ++r)
+                {
+                    const float cr = wr[r - 1], ci = wi[r - 1] * twSign;
+                    const float ar = xr[r], ai = xi[r];
+                    xr[r] = ar * cr - ai * ci;
+                    xi[r] = ar * ci + ai * cr;
+                }
+                SmallDFT<R>(xr, xi, inverse);
+                for (int r = 0; r < R; ++r)
+                {
+                    const size_t index = (out + static_cast<size_t>(r) * span) * lanes + lane;
+                    dstRe[index] = xr[r];
+                    dstIm[index] = xi[r];
+                }
+            }
+        }
+    }
+}
+
+std::shared_ptr<const FFTPlan> FFTPlan::Get(int n)
+{
+    if (!IsSupportedSize(n)) return nullptr;
+
+    std::lock_guard<std::mutex> lock(g_planMutex);
+    std::shared_ptr<const FFTPlan>& plan = g_plans[n];
+    if (!plan) plan = std::make_shared<const FFTPlan>(n);
+    return plan;
+}
+
+void FFTPlan::ClearCache()
+{
+    std::lock_guard<std::mutex> lock(g_planMutex);
+    g_plans.clear();
+}
+
+bool FFTPlan::IsSupportedSize(int n)
+{
+    if (n < 1) return false;
+    for (int p : { 2, 3, 5, 7 })
+    {
+        while (n % p == 0) n /= p;
+    }
+    return n == 1;
+}
+
+int FFTPlan::GoodSize(int n)
+{
+    if (n <= 1) return 1;
+    while (!IsSupportedSize(n)) ++n;
+    return n;
+}
+
+FFTPlan::FFTPlan(int n)
+    : m_size(n)
+{
+    // 기수 4를 우선 사용하고 나머지를 2, 3, 5, 7로 분해
+    std::vector<int> radices;
+    int rest = n;
+    while (rest % 4 == 0) { radices.push_back(4); rest /= 4; }
+    for (int p : { 2, 3, 5, 7 })
+    {
+        while (rest % p == 0) { radices.push_back(p); rest /= p; }
+    }
+
+    // 트위들은 점화식 없이 항목마다 배정밀도 cos/sin으로 계산
+    int span = 1;
+    for (int radix : radices)
+    {
+        m_stages.push_back({ radix, span, m_twiddleRe.size() });
+        for (int k = 0; k < span; ++k)
+        {
+            for (int r = 1; r < radix; ++r)
+            {
+                double angle = -2.0 * M_PI * static_cast<double>(k) * r / (static_cast<double>(span) * radix);
+                m_twiddleRe.push_back(static_cast<float>(std::cos(angle)));
+                m_twiddleIm.push_back(static_cast<float>(std::sin(angle)));
+            }
+        }
+        span *= radix;
+    }
+}
+
+void FFTPlan::Forward(float* re, float* im, int lanes, float* workRe, float* workIm) const
+{
+    Transform(re, im, lanes, workRe, workIm, false);
+}
+
+void FFTPlan::Inverse(float* re, float* im, int lanes, float* workRe, float* workIm) const
+{
+    Transform(re, im, lanes, workRe, workIm, true);
+}
+
+void FFTPlan::Transform(float* re, float* im, int lanes, float* workRe, float* workIm, bool inverse) const
+{
+    float* srcRe = re;
+    float* srcIm = im;
+    float* dstRe = workRe;
+    float* dstIm = workIm;
+
+    for (const Stage& stage : m_stages)
+    {
+        const float* twRe = m_twiddleRe.data() + stage.twiddle;
+        const float* twIm = m_twiddleIm.data() + stage.twiddle;
+        switch (stage.radix)
+        {
+        case 2: StockhamStage<2>(srcRe, srcIm, dstRe, dstIm, m_size, stage.span, lanes, twRe, twIm, inverse); break;
+        case 3: StockhamStage<3>(srcRe, srcIm, dstRe, dstIm, m_size, stage.span, lanes, twRe, twIm, inverse); break;
+        case 4: StockhamStage<4>(srcRe, srcIm, dstRe, dstIm, m_size, stage.span, lanes, twRe, twIm, inverse); break;
+        case 5: StockhamStage<5>(srcRe, srcIm, dstRe, dstIm, m_size, stage.span, lanes, twRe, twIm, inverse); break;
+        case 7: StockhamStage<7>(srcRe, srcIm, dstRe, dstIm, m_size, stage.span, lanes, twRe, twIm, inverse); break;
+        }
+        std::swap(srcRe, dstRe);
+        std::swap(srcIm, dstIm);
+    }
+
+    // 단계 수가 홀수면 결과가 작업 버퍼에 있다
+    if (srcRe != re)
+    {
+        const size_t bytes = static_cast<size_t>(m_size) * lanes * sizeof(float);
+        memcpy(re, srcRe, bytes);
+        memcpy(im, srcIm, bytes);
+    }
+}
+
+// ==================== 2D 실수 FFT ====================
+namespace
+{
+    // 열 블록 폭: 실수부/허수부 각각 한 캐시 라인(16 float)
+    const int kColumnBlock = 16;
+
+    // 행 FFT 병렬 조각의 최소 행 수 (조각마다 작업 버퍼를 빌린다)
+    int RowGrain(int width)
+    {
+        return std::max(1, (1 << 16) / std::max(1, width));
+    }
+}
+
+int FFT2D::ColumnBlocks() const
+{
+    return (SpectrumWidth() + kColumnBlock - 1) / kColumnBlock;
+}
+
+int FFT2D::PaddedWidth(int width)
+{
+    return 2 * FFTPlan::GoodSize((std::max(width, 1) + 1) / 2);
+}
+
+int FFT2D::PaddedHeight(int height)
+{
+    return FFTPlan::GoodSize(height);
+}
+
+FFT2D::FFT2D(int width, int height)
+    : m_width(width), m_height(height)
+{
+    if (width < 2 || width % 2 != 0 || height < 1) return;
+
+    const int half = width / 2;
+    m_rowPlan = FFTPlan::Get(half);
+    m_columnPlan = FFTPlan::Get(height);
+
+    m_realTwiddleRe.resize(half);
+    m_realTwiddleIm.resize(half);
+    for (int k = 0; k < half; ++k)
+    {
+        double angle = -2.0 * M_PI * k / width;
+        m_realTwiddleRe[k] = static_cast<float>(std::cos(angle));
+        m_realTwiddleIm[k] = static_cast<float>(std::sin(angle));
+    }
+}
+
+void FFT2D::Forward(const float* input, float* spectrumRe, float* spectrumIm) const
+{
+    if (!IsValid()) return;
+
+    const int half = m_width / 2;
+    const int spectrumWidth = SpectrumWidth();
+
+    // 행: 짝/홀 표본을 복소수 하나로 묶어 width/2점 FFT 후 두 스펙트럼을 분리
+    ThreadPool::Shared().ParallelFor(0, m_height, RowGrain(m_width), [&](int y0, int y1)
+        {
+            ScratchArena::Buffer buffer = ScratchArena::Shared().Acquire(static_cast<size_t>(half) * 4 * sizeof(float));
+            float* zr = buffer.As<float>();
+            float* zi = zr + half;
+            float* workRe = zi + half;
+            float* workIm = workRe + half;
+
+            for (int y = y0; y < y1; ++y)
+            {
+                const float* x = input + static_cast<size_t>(y) * m_width;
+                for (int n = 0; n < half; ++n)
+                {
+                    zr[n] = x[2 * n];
+                    zi[n] = x[2 * n + 1];
+                }
+                m_rowPlan->Forward(zr, zi, 1, workRe, workIm);
+
+                float* outRe = spectrumRe + static_cast<size_t>(y) * spectrumWidth;
+                float* outIm = spectrumIm + static_cast<size_t>(y) * spectrumWidth;
+                for (int k = 0; k <= half; ++k)
+                {
+                    const int a = k % half;
+                    const int b = (half - k) % half;
+                    // Fe = (Z[k] + conj(Z[M-k])) / 2, Fo = (Z[k] - conj(Z[M-k])) / 2i
+                    const float feR = 0.5f * (zr[a] + zr[b]);
+                    const float feI = 0.5f * (zi[a] - zi[b]);
+                    const float foR = 0.5f * (zi[a] + zi[b]);
+                    const float foI = -0.5f * (zr[a] - zr[b]);
+                    const float twR = (k < half) ? m_realTwiddleRe[k] : -1.f;
+                    const float twI = (k < half) ? m_realTwiddleIm[k] : 0.f;
+                    outRe[k] = feR + foR * twR - foI * twI;
+                    outIm[k] = feI + foR * twI + foI * twR;
+                }
+            }
+        });
+
+    ColumnPass(spectrumRe, spectrumIm, false);
+}
+
+void FFT2D::Inverse(const float* spectrumRe, const float* spectrumIm, float* output) const
+{
+    if (!IsValid()) return;
+
+    const int half = m_width / 2;
+    const int spectrumWidth = SpectrumWidth();
+    const size_t count = static_cast<size_t>(m_height) * spectrumWidth;
+
+    ScratchArena::Buffer spectrum = ScratchArena::Shared().Acquire(count * 2 * sizeof(float));
+    float* re = spectrum.As<float>();
+    float* im = re + count;
+    memcpy(re, spectrumRe, count * sizeof(float));
+    memcpy(im, spectrumIm, count * sizeof(float));
+    ColumnPass(re, im, true);
+
+    const float scale = 1.f / (static_cast<float>(half) * m_height);
+
+    ThreadPool::Shared().ParallelFor(0, m_height, RowGrain(m_width), [&](int y0, int y1)
+        {
+            ScratchArena::Buffer buffer = ScratchArena::Shared().Acquire(static_cast<size_t>(half) * 4 * sizeof(float));
+            float* zr = buffer.As<float>();
+            float* zi = zr + half;
+            float* workRe = zi + half;
+            float* workIm = workRe + half;
+
+            for (int y = y0; y < y1; ++y)
+            {
+                const float* xr = re + static_cast<size_t>(y) * spectrumWidth;
+                const float* xi = im + static_cast<size_t>(y) * spectrumWidth;
+                for (int k = 0; k < half; ++k)
+                {
+                    // E = (X[k] + conj(X[M-k])) / 2, O = (X[k] - conj(X[M-k])) / 2 * exp(+2πik/width)
+                    const float eR = 0.5f * (xr[k] + xr[half - k]);
+                    const float eI = 0.5f * (xi[k] - xi[half - k]);
+                    const float dR = 0.5f * (xr[k] - xr[half - k]);
+                    const float dI = 0.5f * (xi[k] + xi[half - k]);
+                    const float twR = m_realTwiddleRe[k], twI = -m_realTwiddleIm[k];
+                    const float oR = dR * twR - dI * twI;
+                    const float oI = dR * twI + dI * twR;
+                    // Z = E + i O
+                    zr[k] = eR - oI;
+                    zi[k] = eI + oR;
+                }
+                m_rowPlan->Inverse(zr, zi, 1, workRe, workIm);
+
+                float* x = output + static_cast<size_t>(y) * m_width;
+                for (int n = 0; n < half; ++n)
+                {
+                    x[2 * n] = zr[n] * scale;
+                    x[2 * n + 1] = zi[n] * scale;
+                }
+            }
+        });
+}
+
+void FFT2D::ColumnPass(float* re, float* im, bool inverse) const
+{
+    const int spectrumWidth = SpectrumWidth();
+    const size_t blockFloats = static_cast<size_t>(m_height) * kColumnBlock;
+
+    // 열 블록을 행 단위 연속 구간(캐시 라인)으로 읽어 lanes 묶음 FFT 후 되돌려 쓴다
+    ThreadPool::Shared().ParallelFor(0, ColumnBlocks(), 1, [&](int b0, int b1)
+        {
+            ScratchArena::Buffer buffer = ScratchArena::Shared().Acquire(blockFloats * 4 * sizeof(float));
+            float* blockRe = buffer.As<float>();
+            float* blockIm = blockRe + blockFloats;
+            float* workRe = blockIm + blockFloats;
+            float* workIm = workRe + blockFloats;
+
+            for (int c0 = b0 * kColumnBlock; c0 < std::min(spectrumWidth, b1 * kColumnBlock); c0 += kColumnBlock)
+            {
+                const int lanes = std::min(kColumnBlock, spectrumWidth - c0);
+                const size_t bytes = static_cast<size_t>(lanes) * sizeof(float);
+                for (int y = 0; y < m_height; ++y)
+                {
+                    const size_t offset = static_cast<size_t>(y) * spectrumWidth + c0;
+                    memcpy(blockRe + static_cast<size_t>(y) * lanes, re + offset, bytes);
+                    memcpy(blockIm + static_cast<size_t>(y) * lanes, im + offset, bytes);
+                }
+
+                if (inverse)
+                    m_columnPlan->Inverse(blockRe, blockIm, lanes, workRe, workIm);
+                else
+                    m_columnPlan->Forward(blockRe, blockIm, lanes, workRe, workIm);
+
+                for (int y = 0; y < m_height; ++y)
+                {
+                    const size_t offset = static_cast<size_t>(y) * spectrumWidth + c0;
+                    memcpy(re + offset, blockRe + static_cast<size_t>(y) * lanes, bytes);
+                    memcpy(im + offset, blockIm + static_cast<size_t>(y) * lanes, bytes);
+                }
+            }
+        });
+}
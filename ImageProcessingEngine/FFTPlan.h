@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <memory>
+#include <vector>
+
+// =====================================================
+//  혼합 기수(2/3/4/5/7) 1D 복소 FFT 계획
+//  트위들 계수는 크기별로 한 번만 배정밀도로 계산해 캐시에 보관한다.
+//  복소수는 분리 형식(실수부 배열, 허수부 배열)이며, lanes개의 독립 신호를
+//  원소마다 인접하게 배치해(x[i * lanes + lane]) 한 번에 변환할 수 있다.
+// =====================================================
+class FFTPlan
+{
+public:
+    // 크기 n의 계획 (캐시됨). n이 지원되지 않는 크기면 nullptr
+    static std::shared_ptr<const FFTPlan> Get(int n);
+
+    // 캐시에 보관된 계획을 모두 버린다 (이미 받은 shared_ptr는 계속 유효)
+    static void ClearCache();
+
+    // n 이상인 가장 작은 2^a 3^b 5^c 7^d
+    static int GoodSize(int n);
+    static bool IsSupportedSize(int n);
+
+    int Size() const { return m_size; }
+
+    // 제자리 변환. work는 각각 Size() * lanes 개 이상. 역변환은 정규화(1/n)하지 않는다
+    void Forward(float* re, float* im, int lanes, float* workRe, float* workIm) const;
+    void Inverse(float* re, float* im, int lanes, float* workRe, float* workIm) const;
+
+    explicit FFTPlan(int n);
+
+private:
+    struct Stage
+    {
+        int radix;
+        int span;           // 이 단계 이전까지 완성된 부분 변환 길이
+        size_t twiddle;     // m_twiddleRe/Im 내 시작 위치 (span * (radix - 1)개)
+    };
+
+    void Transform(float* re, float* im, int lanes, float* workRe, float* workIm, bool inverse) const;
+
+    int m_size;
+    std::vector<Stage> m_stages;
+    std::vector<float> m_twiddleRe;
+    std::vector<float> m_twiddleIm;
+};
+
+// =====================================================
+//  2D 실수 FFT (width x height 실수 ↔ height x (width/2 + 1) 복소 스펙트럼)
+//  행은 width/2점 복소 FFT로 실수 변환하고, 열은 여러 열을 묶은 블록 단위로 변환해
+//  한 번에 캐시 라인 전체를 읽고 쓴다.
+//  행과 열 블록은 공용 스레드 풀에서 병렬로 처리하며, 호출 스레드에 JobControl 작업이 걸려 있으면
+//  그 조각마다 진행률을 알리고 취소를 확인한다.
+// =====================================================
+class FFT2D
+{
+public:
+    // width는 짝수, width/2와 height는 FFTPlan 지원 크기여야 한다 (PaddedWidth/PaddedHeight 사용)
+    FFT2D(int width, int height);
+
+    // 실수 FFT에 쓸 수 있는 가장 작은 패딩 크기
+    static int PaddedWidth(int width);
+    static int PaddedHeight(int height);
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    int SpectrumWidth() const { return m_width / 2 + 1; }
+    bool IsValid() const { return m_rowPlan && m_columnPlan; }
+
+    // input: height x width 실수 (행 간격 width) → spectrum: height x SpectrumWidth() (분리 형식)
+    void Forward(const float* input, float* spectrumRe, float* spectrumIm) const;
+
+    // 스펙트럼 → height x width 실수. 1/(width * height)로 정규화한다
+    void Inverse(const float* spectrumRe, const float* spectrumIm, float* output) const;
+
+private:
+    void ColumnPass(float* re, float* im, bool inverse) const;
+    int ColumnBlocks() const;
+
+    int m_width;
+    int m_height;
+    std::shared_ptr<const FFTPlan> m_rowPlan;       // width/2점
+    std::shared_ptr<const FFTPlan> m_columnPlan;    // height점
+    std::vector<float> m_realTwiddleRe;             // exp(-2πik/width), k < width/2
+    std::vector<float> m_realTwiddleIm;
+};
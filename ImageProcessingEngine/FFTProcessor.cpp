@@ -0,0 +1,192 @@
+﻿#include "pch.h"
+#include "FFTProcessor.h"
+#include "FFTPlan.h"
+#include "FrequencyFilter.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include "JobControl.h"
+#include <cmath>
+#include <algorithm>
+
+static inline unsigned char clamp_u8_from_float(float v)
+{
+    // 0..255 범위로 클램프 + 반올림
+    v = (v < 0.f) ? 0.f : ((v > 255.f) ? 255.f : v);
+    return static_cast<unsigned char>(v + 0.5f);
+}
+
+FFTProcessor::FFTProcessor() = default;
+FFTProcessor::~FFTProcessor() = default;
+FFTProcessor::FFTProcessor(FFTProcessor&&) noexcept = default;
+FFTProcessor& FFTProcessor::operator=(FFTProcessor&&) noexcept = default;
+
+const FFT2D& FFTProcessor::PlanFor(int paddedWidth, int paddedHeight)
+{
+    if (!m_plan || m_plan->Width() != paddedWidth || m_plan->Height() != paddedHeight)
+    {
+        m_plan = std::make_unique<FFT2D>(paddedWidth, paddedHeight);
+    }
+    return *m_plan;
+}
+
+// 행 단위 병렬 루프의 최소 조각 (행 수)
+static int RowGrain(int width)
+{
+    return std::max(8, (1 << 16) / std::max(1, width));
+}
+
+// ==================== 2D FFT (실수 입력, 혼합 기수 패딩) ====================
+void FFTProcessor::ApplyFFT(unsigned char* pixels, int width, int height)
+{
+    ProfileScope profile("fft", width, height);
+    // 2의 제곱수 대신 2^a 3^b 5^c 7^d 크기로 패딩 (예: 4100x3000 → 4116x3000)
+    const int paddedWidth = FFT2D::PaddedWidth(width);
+    const int paddedHeight = FFT2D::PaddedHeight(height);
+    const FFT2D& fft = PlanFor(paddedWidth, paddedHeight);
+
+    m_width = paddedWidth;
+    m_height = paddedHeight;
+    const size_t spectrumSize = static_cast<size_t>(fft.SpectrumWidth()) * paddedHeight;
+    ThreadPool& pool = ThreadPool::Shared();
+
+    // 취소 등으로 중단되면 일부만 변환된 스펙트럼을 남기지 않는다
+    try
+    {
+        // 스펙트럼은 순변환이 전부 덮어쓰므로 0으로 채우지 않는다 (같은 크기 반복 시 재할당/초기화 없음)
+        m_real.resize(spectrumSize);
+        m_imag.resize(spectrumSize);
+        JobControl::ThrowIfCancelled();
+
+        // 그레이스케일 + 패딩 (패딩 영역만 0으로 채운다)
+        std::vector<float>& input = m_spatial;
+        input.resize(static_cast<size_t>(paddedWidth) * paddedHeight);
+        JobControl::ThrowIfCancelled();
+        const float wR = 0.299f, wG = 0.587f, wB = 0.114f;
+
+        pool.ParallelFor(0, paddedHeight, RowGrain(paddedWidth), [&](int y0, int y1)
+            {
+                for (int y = y0; y < y1; ++y)
+                {
+                    float* row = input.data() + static_cast<size_t>(y) * paddedWidth;
+                    const int valid = (y < height) ? width : 0;
+                    for (int x = 0; x < valid; ++x)
+                    {
+                        const unsigned char* p = pixels + (static_cast<size_t>(y) * width + x) * 4;
+                        row[x] = p[2] * wR + p[1] * wG + p[0] * wB;
+                    }
+                    std::fill(row + valid, row + paddedWidth, 0.f);
+                }
+            });
+
+        fft.Forward(input.data(), m_real.data(), m_imag.data());
+    }
+    catch (...)
+    {
+        Clear();
+        throw;
+    }
+
+    // Magnitude → log scale → 0..255 정규화
+    // 보관된 반쪽 스펙트럼 밖(x > W/2)은 켤레 대칭 X[y][x] = conj(X[H-y][W-x])로 읽는다
+    const int spectrumWidth = fft.SpectrumWidth();
+    std::vector<float> mag(static_cast<size_t>(width) * height, 0.f);
+    std::vector<float> rowMax(height, 0.f);
+
+    pool.ParallelFor(0, height, RowGrain(width), [&](int y0, int y1)
+        {
+            for (int y = y0; y < y1; ++y)
+            {
+                float maxMag = 0.f;
+                for (int x = 0; x < width; ++x)
+                {
+                    int sx = x, sy = y;
+                    if (sx >= spectrumWidth)
+                    {
+                        sx = paddedWidth - x;
+                        sy = (paddedHeight - y) % paddedHeight;
+                    }
+                    size_t o = static_cast<size_t>(y) * width + x;
+                    size_t p = static_cast<size_t>(sy) * spectrumWidth + sx;
+                    float re = m_real[p], im = m_imag[p];
+                    float m = std::sqrt(re * re + im * im);
+                    mag[o] = m;
+                    if (m > maxMag) maxMag = m;
+                }
+                rowMax[y] = maxMag;
+            }
+        });
+    const float maxMag = height > 0 ? *std::max_element(rowMax.begin(), rowMax.end()) : 0.f;
+
+    if (maxMag > 0.f)
+    {
+        float denom = std::log1p(maxMag); // log(1+max)
+
+        pool.ParallelFor(0, height, RowGrain(width), [&](int y0, int y1)
+            {
+                for (size_t i = static_cast<size_t>(y0) * width; i < static_cast<size_t>(y1) * width; ++i)
+                {
+                    float val = std::log1p(mag[i]) / denom * 255.f;
+                    unsigned char v = clamp_u8_from_float(val);
+                    unsigned char* p = pixels + i * 4;
+                    p[0] = v;
+                    p[1] = v;
+                    p[2] = v;
+                    p[3] = 255;
+                }
+            });
+    }
+}
+
+bool FFTProcessor::ApplyIFFT(unsigned char* pixels, int width, int height)
+{
+    ProfileScope profile("ifft", width, height);
+    if (m_real.empty() || m_imag.empty()) return false;
+
+    const FFT2D& fft = PlanFor(m_width, m_height);
+    std::vector<float>& r = m_spatial;
+    r.resize(static_cast<size_t>(m_width) * m_height);
+    fft.Inverse(m_real.data(), m_imag.data(), r.data());
+
+    // 원래 크기만 써서 복원 이미지 작성
+    int outW = std::min(width, m_width);
+    int outH = std::min(height, m_height);
+    ThreadPool::Shared().ParallelFor(0, outH, RowGrain(outW), [&](int y0, int y1)
+        {
+            for (int y = y0; y < y1; ++y)
+            {
+                for (int x = 0; x < outW; ++x)
+                {
+                    unsigned char* p = pixels + (static_cast<size_t>(y) * width + x) * 4;
+                    unsigned char v = clamp_u8_from_float(std::fabs(r[static_cast<size_t>(y) * m_width + x]));
+                    p[0] = v;
+                    p[1] = v;
+                    p[2] = v;
+                    p[3] = 255;
+                }
+            }
+        });
+    return true;
+}
+
+bool FFTProcessor::FilterSpectrum(const FrequencyFilter& filter)
+{
+    ProfileScope profile("fft-filter", m_width, m_height);
+    if (!HasData() || !filter.IsValid()) return false;
+    filter.Apply(m_real.data(), m_imag.data(), m_width, m_height);
+    return true;
+}
+
+bool FFTProcessor::HasData() const
+{
+    return !m_real.empty() && !m_imag.empty();
+}
+
+void FFTProcessor::Clear()
+{
+    m_real.clear();
+    m_imag.clear();
+    m_width = m_height = 0;
+    m_plan.reset();
+    m_spatial.clear();
+    m_spatial.shrink_to_fit();
+}
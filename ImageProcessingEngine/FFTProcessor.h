@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include <memory>
+#include <vector>
+
+class FFT2D;
+struct FrequencyFilter;
+
+// 2D FFT 처리기(컨텍스트): 스펙트럼, 변환 계획, 작업 버퍼를 객체가 소유한다.
+// 전역 상태가 없으므로 서로 다른 인스턴스는 여러 스레드에서 동시에 사용할 수 있다.
+// 한 인스턴스를 여러 스레드가 공유할 때는 호출하는 쪽에서 직렬화해야 한다.
+class FFTProcessor
+{
+public:
+    FFTProcessor();
+    ~FFTProcessor();
+    FFTProcessor(FFTProcessor&&) noexcept;
+    FFTProcessor& operator=(FFTProcessor&&) noexcept;
+
+    // 그레이스케일 + 혼합 기수(2/3/5/7) 크기 패딩 후 2D 실수 FFT, 로그 스케일 매그니튜드를 pixels에 기록.
+    // 작업(JobControl)이 취소되면 OperationCanceled를 던진다. 변환 도중이면 보관된 스펙트럼을 지우고,
+    // 매그니튜드 기록 중이면 pixels가 일부만 기록된 상태로 남는다
+    void ApplyFFT(unsigned char* pixels, int width, int height);
+
+    // 보관된 스펙트럼을 역변환하여 pixels(원본 크기)에 기록. 스펙트럼이 없으면 false
+    bool ApplyIFFT(unsigned char* pixels, int width, int height);
+
+    // 보관된 스펙트럼에 주파수 필터를 제자리로 곱한다 (순변환을 다시 하지 않음).
+    // 여러 번 호출하면 필터가 누적된다. 스펙트럼이 없거나 필터가 잘못되면 false
+    bool FilterSpectrum(const FrequencyFilter& filter);
+
+    bool HasData() const;
+    void Clear();
+
+private:
+    // 반쪽 스펙트럼 m_height x (m_width / 2 + 1)
+    std::vector<float> m_real;
+    std::vector<float> m_imag;
+    int m_width = 0;    // 패딩된 공간 영역 크기
+    int m_height = 0;
+
+    // 마지막으로 사용한 크기의 변환 계획과 공간 영역 작업 버퍼 (같은 크기 반복 시 재사용)
+    const FFT2D& PlanFor(int paddedWidth, int paddedHeight);
+    std::unique_ptr<FFT2D> m_plan;
+    std::vector<float> m_spatial;
+};
@@ -0,0 +1,494 @@
+﻿#include "pch.h"
+#include "FilterPipeline.h"
+#include "CpuFeatures.h"
+#include "NativeKernels.h"
+#include "GrayImage.h"
+#include "ThreadPool.h"
+#include "JobControl.h"
+#include "ScratchArena.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+using namespace NativeKernels;
+
+namespace
+{
+    // 커널 단위 실행 단계. Sobel/Laplacian은 그레이스케일 + 본 연산 두 단계로,
+    // 열림/닫힘은 최대/최소 필터 두 단계로 풀린다.
+    enum class StageKind
+    {
+        Grayscale,
+        Binarize,
+        Convolve,
+        Sobel,
+        Morphology,
+        MorphologyGradient,
+        MorphologyHat,
+        Median,
+    };
+
+    struct Stage
+    {
+        StageKind kind;
+        int param;
+        int halo;
+        const FixedKernel* kernel;
+        bool flag;      // Morphology: 팽창 여부, MorphologyHat: white(원본 - 열림) 여부
+    };
+
+    // 융합 파이프라인 단계별 계측 이름
+    const char* StageName(StageKind kind)
+    {
+        switch (kind)
+        {
+        case StageKind::Grayscale: return "pipeline/grayscale";
+        case StageKind::Binarize: return "pipeline/binarize";
+        case StageKind::Convolve: return "pipeline/convolve";
+        case StageKind::Sobel: return "pipeline/sobel";
+        case StageKind::Morphology: return "pipeline/morphology";
+        case StageKind::MorphologyGradient: return "pipeline/morph-gradient";
+        case StageKind::MorphologyHat: return "pipeline/morph-hat";
+        case StageKind::Median: return "pipeline/median";
+        }
+        return "pipeline/unknown";
+    }
+
+    // gray가 true면 그레이 평면용으로 전개한다 (그레이스케일 변환 단계 생략)
+    std::vector<Stage> ExpandSteps(const std::vector<FilterStep>& steps, bool gray)
+    {
+        std::vector<Stage> stages;
+        for (const FilterStep& step : steps)
+        {
+            switch (step.op)
+            {
+            case FilterOp::Grayscale:
+                if (!gray) stages.push_back({ StageKind::Grayscale, 0, 0, nullptr, false });
+                break;
+            case FilterOp::GaussianBlur:
+                stages.push_back({ StageKind::Convolve, 5, 2, &FixedGaussian5x5(), false });
+                break;
+            case FilterOp::Sobel:
+                if (!gray) stages.push_back({ StageKind::Grayscale, 0, 0, nullptr, false });
+                stages.push_back({ StageKind::Sobel, 0, 1, nullptr, false });
+                break;
+            case FilterOp::Laplacian:
+                if (!gray) stages.push_back({ StageKind::Grayscale, 0, 0, nullptr, false });
+                stages.push_back({ StageKind::Convolve, 3, 1, &FixedLaplacian3x3(), false });
+                break;
+            case FilterOp::Binarization:
+                stages.push_back({ StageKind::Binarize, step.param, 0, nullptr, false });
+                break;
+            case FilterOp::Dilation:
+            case FilterOp::Erosion:
+                // NativeProcessor와 동일하게 1 미만 크기는 아무것도 하지 않는다
+                if (step.param >= 1)
+                {
+                    stages.push_back({ StageKind::Morphology, step.param, step.param / 2, nullptr,
+                                       step.op == FilterOp::Dilation });
+                }
+                break;
+            case FilterOp::Opening:
+            case FilterOp::Closing:
+                if (step.param >= 1)
+                {
+                    const bool opening = step.op == FilterOp::Opening;
+                    stages.push_back({ StageKind::Morphology, step.param, step.param / 2, nullptr, !opening });
+                    stages.push_back({ StageKind::Morphology, step.param, step.param / 2, nullptr, opening });
+                }
+                break;
+            case FilterOp::MorphologyGradient:
+                if (step.param >= 1)
+                {
+                    stages.push_back({ StageKind::MorphologyGradient, step.param, step.param / 2, nullptr, false });
+                }
+                break;
+            case FilterOp::TopHat:
+            case FilterOp::BlackHat:
+                if (step.param >= 1)
+                {
+                    stages.push_back({ StageKind::MorphologyHat, step.param, 2 * (step.param / 2), nullptr,
+                                       step.op == FilterOp::TopHat });
+                }
+                break;
+            case FilterOp::MedianFilter:
+                if (step.param >= 1 && step.param % 2 == 1)
+                {
+                    stages.push_back({ StageKind::Median, step.param, step.param / 2, nullptr, false });
+                }
+                break;
+            }
+        }
+        return stages;
+    }
+
+    void RunStage(const Stage& stage, const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1)
+    {
+        switch (stage.kind)
+        {
+        case StageKind::Grayscale:
+            GrayscaleRows(src, dst, width, y0, y1);
+            break;
+        case StageKind::Binarize:
+            BinarizeRows(src, dst, width, y0, y1, stage.param);
+            break;
+        case StageKind::Convolve:
+            ConvolveRowsFixed(src, dst, width, height, y0, y1, *stage.kernel);
+            break;
+        case StageKind::Sobel:
+            SobelRows(src, dst, width, height, y0, y1);
+            break;
+        case StageKind::Morphology:
+            MorphologyRows(src, dst, width, height, y0, y1, stage.param, stage.flag);
+            break;
+        case StageKind::MorphologyGradient:
+            MorphologyGradientRows(src, dst, width, height, y0, y1, stage.param);
+            break;
+        case StageKind::MorphologyHat:
+            MorphologyHatRows(src, dst, width, height, y0, y1, stage.param, stage.flag);
+            break;
+        case StageKind::Median:
+            MedianRows(src, dst, width, height, y0, y1, stage.param);
+            break;
+        }
+    }
+
+    void RunStageGray(const Stage& stage, const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1)
+    {
+        switch (stage.kind)
+        {
+        case StageKind::Grayscale:
+            break;
+        case StageKind::Binarize:
+            ThresholdRowsGray(src, dst, width, y0, y1, stage.param);
+            break;
+        case StageKind::Convolve:
+            ConvolveRowsFixedGray(src, dst, width, height, y0, y1, *stage.kernel);
+            break;
+        case StageKind::Sobel:
+            SobelRowsGray(src, dst, width, height, y0, y1);
+            break;
+        case StageKind::Morphology:
+            MorphologyRowsGray(src, dst, width, height, y0, y1, stage.param, stage.flag);
+            break;
+        case StageKind::MorphologyGradient:
+            MorphologyGradientRowsGray(src, dst, width, height, y0, y1, stage.param);
+            break;
+        case StageKind::MorphologyHat:
+            MorphologyHatRowsGray(src, dst, width, height, y0, y1, stage.param, stage.flag);
+            break;
+        case StageKind::Median:
+            MedianRowsGray(src, dst, width, height, y0, y1, stage.param);
+            break;
+        }
+    }
+
+    int TotalHalo(const std::vector<Stage>& stages)
+    {
+        int halo = 0;
+        for (const Stage& stage : stages) halo += stage.halo;
+        return halo;
+    }
+}
+
+FilterPipeline& FilterPipeline::Add(FilterOp op, int param)
+{
+    m_steps.push_back({ op, param });
+    return *this;
+}
+
+void FilterPipeline::Clear()
+{
+    m_steps.clear();
+}
+
+// 커널 크기 파라미터를 가진 연산
+static bool IsKernelSizeOp(FilterOp op)
+{
+    switch (op)
+    {
+    case FilterOp::Dilation:
+    case FilterOp::Erosion:
+    case FilterOp::MedianFilter:
+    case FilterOp::Opening:
+    case FilterOp::Closing:
+    case FilterOp::MorphologyGradient:
+    case FilterOp::TopHat:
+    case FilterOp::BlackHat:
+        return true;
+    default:
+        return false;
+    }
+}
+
+FilterPipeline FilterPipeline::Scaled(int level) const
+{
+    FilterPipeline scaled;
+    scaled.m_cacheBudget = m_cacheBudget;
+    if (level <= 0)
+    {
+        scaled.m_steps = m_steps;
+        return scaled;
+    }
+
+    for (const FilterStep& step : m_steps)
+    {
+        if (step.op == FilterOp::GaussianBlur) continue;
+        // 짝수 크기 중앙값은 복사(아무것도 안 함)이므로 크기를 바꾸지 않는다
+        if (!IsKernelSizeOp(step.op) || step.param < 1 || (step.op == FilterOp::MedianFilter && step.param % 2 == 0))
+        {
+            scaled.m_steps.push_back(step);
+            continue;
+        }
+        const int radius = step.param / 2;
+        const int scaledRadius = level >= 30 ? 0 : (radius + ((1 << level) >> 1)) >> level;
+        scaled.m_steps.push_back({ step.op, 2 * scaledRadius + 1 });
+    }
+    return scaled;
+}
+
+int FilterPipeline::Halo() const
+{
+    return TotalHalo(ExpandSteps(m_steps, false));
+}
+
+int FilterPipeline::BandRows(int width, int height, int bytesPerPixel) const
+{
+    const int halo = Halo();
+    const size_t rowBytes = static_cast<size_t>(std::max(width, 1)) * bytesPerPixel;
+
+    // 입력 밴드 2개(이전 밴드 할로 보존용) + 단계 간 핑퐁 버퍼 2개
+    const size_t budgetRows = m_cacheBudget / (rowBytes * 4);
+    int rows = static_cast<int>(std::min<size_t>(budgetRows, static_cast<size_t>(height)));
+    rows -= 2 * halo;
+
+    // 밴드가 너무 얇으면 할로 재계산 비용이 커지므로 최소 높이를 보장
+    const int minRows = std::max(16, 2 * halo);
+    rows = std::max(rows, minRows);
+    return std::max(1, std::min(rows, height));
+}
+
+void FilterPipeline::RunBands(const ImageView& source, const ImageView& target) const
+{
+    const int width = source.width, height = source.height, bytesPerPixel = source.bytesPerPixel;
+    const bool gray = bytesPerPixel == 1;
+    const std::vector<Stage> stages = ExpandSteps(m_steps, gray);
+    if (width <= 0 || height <= 0) return;
+
+    // 할 일이 없는 파이프라인도 dst는 src와 같아야 한다 (다른 버퍼면 복사)
+    if (stages.empty())
+    {
+        if (source.data == target.data) return;
+        const size_t rowBytes = static_cast<size_t>(width) * bytesPerPixel;
+        for (int y = 0; y < height; ++y)
+        {
+            memcpy(target.Row(y), source.Row(y), rowBytes);
+        }
+        return;
+    }
+
+    const int halo = TotalHalo(stages);
+    const int bandRows = BandRows(width, height, bytesPerPixel);
+    const size_t rowBytes = static_cast<size_t>(width) * bytesPerPixel;
+    const size_t bufferRows = static_cast<size_t>(std::min(height, bandRows + 2 * halo));
+    const RowBuffer image{ source.data, 0, source.stride };
+    const RowBuffer output{ target.data, 0, target.stride };
+
+    // 밴드들을 연속 구간(segment)으로 묶어 구간마다 병렬로 처리한다.
+    // 제자리 처리면 한 구간의 결과가 이웃 구간이 읽을 원본 할로 행을 덮으므로,
+    // 구간 경계 위아래 할로 행을 시작 전에 따로 보관해 두고 경계 너머는 보관본에서 읽는다.
+    // 출력이 다른 버퍼면 원본이 바뀌지 않으므로 항상 원본에서 바로 읽는다.
+    const bool inPlace = source.data == target.data;
+    const int bandCount = (height + bandRows - 1) / bandRows;
+    const int segments = std::min(bandCount, ThreadPool::Shared().ThreadCount() * 4);
+
+    std::vector<int> boundary(segments + 1);
+    for (int k = 0; k <= segments; ++k)
+    {
+        boundary[k] = std::min(height, static_cast<int>(static_cast<long long>(bandCount) * k / segments) * bandRows);
+    }
+
+    // 밴드 버퍼와 경계 보관본은 공용 작업 버퍼 풀에서 빌린다 (같은 크기를 반복 처리하면 새 할당 없음)
+    ScratchArena& arena = ScratchArena::Shared();
+    const ScratchArena::Buffer edges = arena.Acquire(inPlace ? static_cast<size_t>(segments + 1) * 2 * halo * rowBytes : 0);
+    std::vector<RowBuffer> edgeRows(segments + 1, image);
+    for (int k = 0; k <= segments && inPlace; ++k)
+    {
+        const int lo = std::max(0, boundary[k] - halo);
+        const int hi = std::min(height, boundary[k] + halo);
+        edgeRows[k] = RowBuffer{ edges.Data() + static_cast<size_t>(k) * 2 * halo * rowBytes, lo, rowBytes };
+        for (int y = lo; y < hi; ++y)
+        {
+            memcpy(edgeRows[k].Row(y), image.Row(y), rowBytes);
+        }
+    }
+
+    // 계측 중이면 단계별로 모든 밴드의 실행 시간을 합산한다 (스레드 시간 합, 집계 전용)
+    Profiler& profiler = Profiler::Shared();
+    const bool profiling = profiler.IsActive();
+    const int64_t startNs = profiling ? profiler.Now() : 0;
+    std::vector<std::atomic<int64_t>> stageNs(profiling ? stages.size() : 0);
+
+    // 진행률은 구간이 아니라 밴드 단위로 센다
+    JobControl* progress = JobControl::ProgressTarget();
+    if (progress != nullptr) progress->AddWork(bandCount);
+    JobControl::ReportingScope reporting;
+
+    ThreadPool::Shared().ParallelFor(0, segments, 1, [&](int firstSegment, int lastSegment)
+        {
+            // 입력 밴드 2개 + 단계 간 핑퐁 버퍼 2개
+            const size_t bufferBytes = bufferRows * rowBytes;
+            const ScratchArena::Buffer buffers = arena.Acquire(4 * bufferBytes);
+            unsigned char* const input[2] = { buffers.Data(), buffers.Data() + bufferBytes };
+            unsigned char* const work[2] = { buffers.Data() + 2 * bufferBytes, buffers.Data() + 3 * bufferBytes };
+            std::vector<int> outLo(stages.size()), outHi(stages.size());
+
+            for (int segment = firstSegment; segment < lastSegment; ++segment)
+            {
+                const int segmentEnd = boundary[segment + 1];
+                const RowBuffer& below = edgeRows[segment + 1];
+                RowBuffer previousInput = edgeRows[segment];
+                int current = 0;
+
+                for (int b0 = boundary[segment]; b0 < segmentEnd; b0 += bandRows)
+                {
+                    // 구간은 영상의 1/(스레드 수 x 4)까지 커지므로 취소는 밴드마다 확인한다
+                    JobControl::ThrowIfCancelled();
+                    const int b1 = std::min(height, b0 + bandRows);
+
+                    // 뒤 단계부터 거슬러 올라가며 각 단계가 만들어야 할 행 범위를 계산
+                    int lo = b0, hi = b1;
+                    for (size_t s = stages.size(); s-- > 0;)
+                    {
+                        outLo[s] = lo;
+                        outHi[s] = hi;
+                        lo = std::max(0, lo - stages[s].halo);
+                        hi = std::min(height, hi + stages[s].halo);
+                    }
+
+                    // 원본 행 [lo, hi) 준비. b0 위쪽 행은 이미 결과로 덮였으므로 이전 밴드 입력(구간 첫 밴드는
+                    // 경계 보관본)에서, 구간 아래 행은 다른 스레드가 덮고 있을 수 있으므로 경계 보관본에서 가져온다
+                    RowBuffer in{ input[current], lo, rowBytes };
+                    for (int y = lo; y < hi; ++y)
+                    {
+                        const unsigned char* from = !inPlace ? image.Row(y)
+                                                  : (y < b0) ? previousInput.Row(y)
+                                                  : (y >= segmentEnd) ? below.Row(y) : image.Row(y);
+                        memcpy(in.Row(y), from, rowBytes);
+                    }
+
+                    RowBuffer src = in;
+                    for (size_t s = 0; s < stages.size(); ++s)
+                    {
+                        RowBuffer dst{ work[s % 2], outLo[s], rowBytes };
+                        const int64_t stageStart = profiling ? profiler.Now() : 0;
+                        if (gray)
+                            RunStageGray(stages[s], src, dst, width, height, outLo[s], outHi[s]);
+                        else
+                            RunStage(stages[s], src, dst, width, height, outLo[s], outHi[s]);
+                        if (profiling) stageNs[s].fetch_add(profiler.Now() - stageStart, std::memory_order_relaxed);
+                        src = dst;
+                    }
+
+                    for (int y = b0; y < b1; ++y)
+                    {
+                        memcpy(output.Row(y), src.Row(y), rowBytes);
+                    }
+
+                    previousInput = in;
+                    current ^= 1;
+                    if (progress != nullptr) progress->CompleteWork(1);
+                }
+            }
+        });
+
+    for (size_t s = 0; s < stageNs.size(); ++s)
+    {
+        ProfileRecord record;
+        record.name = StageName(stages[s].kind);
+        record.startNs = startNs;
+        record.durationNs = stageNs[s].load(std::memory_order_relaxed);
+        record.pixels = static_cast<int64_t>(width) * height;
+        record.simd = SimdLevelName(ActiveSimdLevel());
+        record.threads = ThreadPool::Shared().ThreadCount();
+        profiler.Record(record, false);
+    }
+}
+
+void FilterPipeline::Run(unsigned char* pixels, int width, int height) const
+{
+    ProfileScope profile("pipeline", width, height);
+    const ImageView image = ImageView::BGRA(pixels, width, height);
+    RunBands(image, image);
+}
+
+void FilterPipeline::Run(GrayImage& image) const
+{
+    ProfileScope profile("gray-pipeline", image.Width(), image.Height());
+    const ImageView plane = ImageView::Gray(image.Data(), image.Width(), image.Height(), image.Stride());
+    RunBands(plane, plane);
+}
+
+static bool SameLayout(const ImageView& src, const ImageView& dst)
+{
+    if (!src.IsValid() || !dst.IsValid()) return false;
+    if (src.width != dst.width || src.height != dst.height || src.bytesPerPixel != dst.bytesPerPixel) return false;
+
+    // 같은 시작 주소면 행 간격도 같아야 제자리 처리가 성립한다
+    return src.data != dst.data || src.stride == dst.stride;
+}
+
+bool FilterPipeline::Run(const ImageView& src, const ImageView& dst) const
+{
+    ProfileScope profile("pipeline", src.width, src.height);
+    if (!SameLayout(src, dst)) return false;
+
+    RunBands(src, dst);
+    return true;
+}
+
+bool FilterPipeline::Run(const ImageView& src, const ImageView& dst, const ImageRect& roi) const
+{
+    ProfileScope profile("pipeline-roi", roi.width, roi.height);
+    if (!SameLayout(src, dst)) return false;
+    if (roi.IsEmpty() || roi.x < 0 || roi.y < 0 || roi.x + roi.width > src.width || roi.y + roi.height > src.height)
+        return false;
+
+    if (roi.width == src.width && roi.height == src.height)
+    {
+        RunBands(src, dst);
+        return true;
+    }
+
+    // 할 일이 없으면 작업 버퍼를 거치지 않는다 (다른 버퍼면 roi만 복사)
+    const int bpp = src.bytesPerPixel;
+    const size_t roiBytes = static_cast<size_t>(roi.width) * bpp;
+    if (ExpandSteps(m_steps, bpp == 1).empty())
+    {
+        if (src.data == dst.data) return true;
+        for (int y = roi.y; y < roi.y + roi.height; ++y)
+        {
+            memcpy(dst.Row(y) + static_cast<size_t>(roi.x) * bpp, src.Row(y) + static_cast<size_t>(roi.x) * bpp, roiBytes);
+        }
+        return true;
+    }
+
+    // roi + 할로 영역을 별도 버퍼로 처리한다 (TiledProcessor의 타일과 같은 방식).
+    // 할로 영역 가장자리에서 생기는 차이는 단계별 할로 합 안쪽으로만 번지므로 roi에는 닿지 않는다
+    const int halo = Halo();
+    const int x0 = std::max(0, roi.x - halo), x1 = std::min(src.width, roi.x + roi.width + halo);
+    const int y0 = std::max(0, roi.y - halo), y1 = std::min(src.height, roi.y + roi.height + halo);
+    const size_t rowBytes = static_cast<size_t>(x1 - x0) * bpp;
+
+    ScratchArena::Buffer buffer = ScratchArena::Shared().Acquire(rowBytes * (y1 - y0));
+    const ImageView result{ buffer.Data(), x1 - x0, y1 - y0, rowBytes, bpp };
+    RunBands(src.Sub(x0, y0, x1 - x0, y1 - y0), result);
+
+    for (int y = roi.y; y < roi.y + roi.height; ++y)
+    {
+        memcpy(dst.Row(y) + static_cast<size_t>(roi.x) * bpp,
+               result.Row(y - y0) + static_cast<size_t>(roi.x - x0) * bpp, roiBytes);
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+﻿#pragma once
+
+#include "ImageView.h"
+#include <cstddef>
+#include <vector>
+
+class GrayImage;
+
+// 파이프라인 연산 종류 (NativeProcessor::Apply* 와 1:1 대응)
+enum class FilterOp
+{
+    Grayscale,
+    GaussianBlur,
+    Sobel,
+    Laplacian,
+    Binarization,   // param = threshold
+    Dilation,       // param = kernelSize
+    Erosion,        // param = kernelSize
+    MedianFilter,   // param = kernelSize
+    Opening,        // param = kernelSize
+    Closing,        // param = kernelSize
+    MorphologyGradient, // param = kernelSize
+    TopHat,         // param = kernelSize
+    BlackHat,       // param = kernelSize
+};
+
+struct FilterStep
+{
+    FilterOp op;
+    int param;
+};
+
+// 여러 연산을 L2 크기의 행 밴드 단위로 묶어 실행하는 융합 파이프라인.
+// 밴드마다 모든 단계를 캐시 안에서 처리하므로 원본은 한 번 읽고 결과는 한 번만 쓴다.
+// 밴드 구간들은 공용 스레드 풀(ThreadPool::Shared)에서 병렬로 처리된다.
+// 결과는 각 연산을 순서대로 하나씩 호출한 것과 비트 단위로 같다.
+class FilterPipeline
+{
+public:
+    FilterPipeline& Add(FilterOp op, int param = 0);
+    void Clear();
+
+    const std::vector<FilterStep>& Steps() const { return m_steps; }
+
+    // 2^level 배 축소한 영상(ImagePyramid 레벨)에 쓸 파이프라인. 커널 크기 파라미터는 반경을 2^level로
+    // 나눠 반올림한 홀수 크기로 바꾸고(짝수 중앙값처럼 크기가 의미를 가지는 경우는 그대로), 고정 5x5
+    // 가우시안은 축소 자체의 평균이 대신하므로 level >= 1에서 뺀다. 임계값 등 밝기 파라미터는 그대로다.
+    // 그래서 가우시안만 있던 파이프라인은 단계가 없어질 수 있다 (Run은 이때 src를 dst로 복사한다)
+    FilterPipeline Scaled(int level) const;
+
+    // 모든 단계의 커널 반경 합 (밴드 사이에 겹쳐 읽는 행 수)
+    int Halo() const;
+
+    // 스레드 하나의 밴드 작업 버퍼 전체가 차지할 목표 크기(바이트). 기본 1 MiB
+    void SetCacheBudget(size_t bytes) { m_cacheBudget = bytes; }
+    size_t CacheBudget() const { return m_cacheBudget; }
+
+    // 주어진 폭에서 한 밴드가 처리하는 출력 행 수 (bytesPerPixel: BGRA 4, 그레이 1)
+    int BandRows(int width, int height, int bytesPerPixel = 4) const;
+
+    // BGRA 영상에 모든 단계를 제자리(in-place)로 적용
+    void Run(unsigned char* pixels, int width, int height) const;
+
+    // 그레이 평면에 적용 (Grayscale 단계는 생략된다)
+    void Run(GrayImage& image) const;
+
+    // src를 읽어 dst에 기록. 두 뷰는 크기와 형식(bytesPerPixel)이 같아야 하며,
+    // 같은 버퍼를 가리키면 제자리 처리, 겹치지 않는 다른 버퍼면 src는 읽기만 한다.
+    // 일부만 겹치는 두 뷰는 지원하지 않는다. 잘못된 뷰면 false
+    bool Run(const ImageView& src, const ImageView& dst) const;
+
+    // roi 영역만 처리한다. src에서 roi와 그 주위 Halo() 화소(영상 안쪽만)만 읽고 dst에는 roi만 쓴다.
+    // roi 안의 결과는 영상 전체를 처리한 결과와 비트 단위로 같다 (가장자리 규칙은 원래 영상 경계 기준).
+    // src와 dst는 같은 크기/형식이어야 하며 같은 버퍼(제자리)여도 된다. roi가 영상 밖으로 벗어나면 false
+    bool Run(const ImageView& src, const ImageView& dst, const ImageRect& roi) const;
+
+private:
+    void RunBands(const ImageView& src, const ImageView& dst) const;
+
+    std::vector<FilterStep> m_steps;
+    size_t m_cacheBudget = 1u << 20;
+};
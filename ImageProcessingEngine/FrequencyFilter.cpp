@@ -0,0 +1,104 @@
+﻿#include "pch.h"
+#include "FrequencyFilter.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // 반경 d0 저역 통과 이득 (d는 중심까지 거리)
+    float LowPassGain(FrequencyFilterShape shape, float d, float d0, int order)
+    {
+        switch (shape)
+        {
+        case FrequencyFilterShape::Ideal:
+            return d <= d0 ? 1.f : 0.f;
+        case FrequencyFilterShape::Butterworth:
+            return 1.f / (1.f + std::pow(d / d0, 2.f * order));
+        case FrequencyFilterShape::Gaussian:
+        default:
+            return std::exp(-(d * d) / (2.f * d0 * d0));
+        }
+    }
+
+    // 중심 d0, 폭 w인 대역 통과 이득 (Gonzalez & Woods의 대역 제거 필터를 1에서 뺀 것)
+    float BandPassGain(FrequencyFilterShape shape, float d, float d0, float w, int order)
+    {
+        switch (shape)
+        {
+        case FrequencyFilterShape::Ideal:
+            return std::fabs(d - d0) <= w * 0.5f ? 1.f : 0.f;
+        case FrequencyFilterShape::Butterworth:
+        {
+            // 대역 제거 = 1 / (1 + (d w / (d² - d0²))^2n) → 통과 = 1 - 제거
+            const float num = d * w;
+            const float den = d * d - d0 * d0;
+            if (num == 0.f) return 0.f;
+            if (den == 0.f) return 1.f;
+            const float t = std::pow(den / num, 2.f * order);
+            return 1.f / (1.f + t);
+        }
+        case FrequencyFilterShape::Gaussian:
+        default:
+        {
+            if (d == 0.f) return d0 == 0.f ? 1.f : 0.f;
+            const float t = (d * d - d0 * d0) / (d * w);
+            return std::exp(-t * t);
+        }
+        }
+    }
+}
+
+bool FrequencyFilter::IsValid() const
+{
+    if (!(cutoff > 0.f)) return false;
+    if (type == FrequencyFilterType::BandPass && !(bandwidth > 0.f)) return false;
+    if (shape == FrequencyFilterShape::Butterworth && order < 1) return false;
+    return true;
+}
+
+float FrequencyFilter::Gain(float fx, float fy) const
+{
+    const float d = std::sqrt(fx * fx + fy * fy);
+    switch (type)
+    {
+    case FrequencyFilterType::LowPass:
+        return LowPassGain(shape, d, cutoff, order);
+    case FrequencyFilterType::HighPass:
+        return 1.f - LowPassGain(shape, d, cutoff, order);
+    case FrequencyFilterType::BandPass:
+        return BandPassGain(shape, d, cutoff, bandwidth, order);
+    case FrequencyFilterType::Notch:
+    default:
+    {
+        // 실수 영상의 주기 패턴은 ±(notchX, notchY) 두 곳에 나타나므로 둘 다 제거
+        const float d1 = std::hypot(fx - notchX, fy - notchY);
+        const float d2 = std::hypot(fx + notchX, fy + notchY);
+        return (1.f - LowPassGain(shape, d1, cutoff, order)) * (1.f - LowPassGain(shape, d2, cutoff, order));
+    }
+    }
+}
+
+void FrequencyFilter::Apply(float* spectrumRe, float* spectrumIm, int width, int height) const
+{
+    const int spectrumWidth = width / 2 + 1;
+
+    // 방사형이 아닌 Notch도 있으므로 행마다 이득을 직접 계산한다 (변환 비용에 비해 작다)
+    // 화소마다 exp/pow를 계산하므로 다른 행 루프보다 조각을 잘게 나눈다
+    const int grain = std::max(8, (1 << 14) / std::max(1, spectrumWidth));
+    ThreadPool::Shared().ParallelFor(0, height, grain, [&](int v0, int v1)
+        {
+            for (int v = v0; v < v1; ++v)
+            {
+                const float fy = static_cast<float>(v <= height / 2 ? v : v - height) / height;
+                float* re = spectrumRe + static_cast<size_t>(v) * spectrumWidth;
+                float* im = spectrumIm + static_cast<size_t>(v) * spectrumWidth;
+                for (int u = 0; u < spectrumWidth; ++u)
+                {
+                    const float g = Gain(static_cast<float>(u) / width, fy);
+                    re[u] *= g;
+                    im[u] *= g;
+                }
+            }
+        });
+}
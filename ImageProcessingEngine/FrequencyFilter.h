@@ -0,0 +1,40 @@
+﻿#pragma once
+
+// =====================================================
+//  주파수 영역 필터 (FFTProcessor가 보관한 반쪽 스펙트럼에 제자리 적용)
+//  주파수 단위는 cycles/pixel (0 ~ 0.5). 주기가 P 화소인 패턴은 1/P 이다.
+// =====================================================
+enum class FrequencyFilterType
+{
+    LowPass,
+    HighPass,
+    BandPass,   // cutoff: 통과 대역 중심, bandwidth: 대역 폭
+    Notch,      // (notchX, notchY)와 그 켤레 위치 주변 반경 cutoff를 제거
+};
+
+enum class FrequencyFilterShape
+{
+    Ideal,
+    Butterworth,    // order 차수
+    Gaussian,
+};
+
+struct FrequencyFilter
+{
+    FrequencyFilterType type = FrequencyFilterType::LowPass;
+    FrequencyFilterShape shape = FrequencyFilterShape::Gaussian;
+    float cutoff = 0.1f;
+    float bandwidth = 0.05f;
+    int order = 2;
+    float notchX = 0.f;     // 제거할 주파수 (가로/세로 성분, 부호 있음)
+    float notchY = 0.f;
+
+    // cutoff > 0, BandPass면 bandwidth > 0, Butterworth면 order >= 1
+    bool IsValid() const;
+
+    // 주파수 (fx, fy)에서의 이득 (0 ~ 1). 원점 대칭이므로 실수 영상은 실수로 유지된다
+    float Gain(float fx, float fy) const;
+
+    // width x height 실수 영상의 반쪽 스펙트럼 height x (width/2 + 1)에 이득을 곱한다
+    void Apply(float* spectrumRe, float* spectrumIm, int width, int height) const;
+};
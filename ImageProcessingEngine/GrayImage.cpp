@@ -0,0 +1,36 @@
+﻿#include "pch.h"
+#include "GrayImage.h"
+#include "NativeKernels.h"
+
+using namespace NativeKernels;
+
+GrayImage::GrayImage(int width, int height)
+{
+    Resize(width, height);
+}
+
+void GrayImage::Resize(int width, int height)
+{
+    m_width = (width > 0 && height > 0) ? width : 0;
+    m_height = (width > 0 && height > 0) ? height : 0;
+    m_data.resize(static_cast<size_t>(m_width) * m_height);
+}
+
+void GrayImage::FromBGRA(const unsigned char* pixels, int width, int height)
+{
+    Resize(width, height);
+    if (Empty()) return;
+
+    RowBuffer src = WholeImage(const_cast<unsigned char*>(pixels), width);
+    RowBuffer dst{ m_data.data(), 0, Stride() };
+    GrayFromBGRARows(src, dst, m_width, 0, m_height);
+}
+
+void GrayImage::ToBGRA(unsigned char* pixels, bool preserveAlpha) const
+{
+    if (Empty()) return;
+
+    RowBuffer src{ const_cast<unsigned char*>(m_data.data()), 0, Stride() };
+    RowBuffer dst = WholeImage(pixels, m_width);
+    BGRAFromGrayRows(src, dst, m_width, 0, m_height, preserveAlpha);
+}
@@ -0,0 +1,36 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// 단일 채널 8비트(1 byte/pixel) 평면 영상.
+// 그레이스케일/모폴로지 연산은 BGRA 대신 이 형식으로 처리하면 메모리 대역폭이 1/4로 줄어든다.
+class GrayImage
+{
+public:
+    GrayImage() = default;
+    GrayImage(int width, int height);
+
+    void Resize(int width, int height);
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    size_t Stride() const { return static_cast<size_t>(m_width); }
+    bool Empty() const { return m_data.empty(); }
+
+    unsigned char* Data() { return m_data.data(); }
+    const unsigned char* Data() const { return m_data.data(); }
+    unsigned char* Row(int y) { return m_data.data() + static_cast<size_t>(y) * Stride(); }
+    const unsigned char* Row(int y) const { return m_data.data() + static_cast<size_t>(y) * Stride(); }
+
+    // BGRA 버퍼에서 그레이 평면 생성 (NativeProcessor::ToGrayscale과 같은 값)
+    void FromBGRA(const unsigned char* pixels, int width, int height);
+
+    // 그레이 평면을 BGRA 버퍼(같은 크기)로 기록. preserveAlpha가 false면 alpha = 255
+    void ToBGRA(unsigned char* pixels, bool preserveAlpha = false) const;
+
+private:
+    std::vector<unsigned char> m_data;
+    int m_width = 0;
+    int m_height = 0;
+};
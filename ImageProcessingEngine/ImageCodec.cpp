@@ -0,0 +1,320 @@
+﻿#include "pch.h"
+#include "ImageCodec.h"
+#include "NativeKernels.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace
+{
+    // 이보다 큰 영상 헤더는 손상된 파일로 본다 (BGRA 버퍼 크기 오버플로 방지)
+    const long long kMaxPixels = 1LL << 30;
+
+    std::FILE* OpenFile(const std::string& path, const char* mode)
+    {
+#if defined(_WIN32)
+        auto widen = [](const char* text)
+            {
+                const int length = MultiByteToWideChar(CP_UTF8, 0, text, -1, nullptr, 0);
+                std::wstring wide(length > 0 ? length - 1 : 0, L'\0');
+                if (length > 1) MultiByteToWideChar(CP_UTF8, 0, text, -1, &wide[0], length);
+                return wide;
+            };
+        return _wfopen(widen(path.c_str()).c_str(), widen(mode).c_str());
+#else
+        return std::fopen(path.c_str(), mode);
+#endif
+    }
+
+    bool ReadAll(const std::string& path, std::vector<unsigned char>& data)
+    {
+        std::FILE* file = OpenFile(path, "rb");
+        if (file == nullptr) return false;
+
+        bool ok = std::fseek(file, 0, SEEK_END) == 0;
+        const long size = ok ? std::ftell(file) : -1;
+        ok = ok && size > 0 && std::fseek(file, 0, SEEK_SET) == 0;
+        if (ok)
+        {
+            data.resize(static_cast<size_t>(size));
+            ok = std::fread(data.data(), 1, data.size(), file) == data.size();
+        }
+        std::fclose(file);
+        return ok;
+    }
+
+    bool ValidSize(long long width, long long height)
+    {
+        return width > 0 && height > 0 && width * height <= kMaxPixels;
+    }
+
+    uint32_t ReadU32(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24); }
+    uint16_t ReadU16(const unsigned char* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+
+    void WriteU32(unsigned char* p, uint32_t v)
+    {
+        p[0] = static_cast<unsigned char>(v);
+        p[1] = static_cast<unsigned char>(v >> 8);
+        p[2] = static_cast<unsigned char>(v >> 16);
+        p[3] = static_cast<unsigned char>(v >> 24);
+    }
+
+    void WriteU16(unsigned char* p, uint16_t v)
+    {
+        p[0] = static_cast<unsigned char>(v);
+        p[1] = static_cast<unsigned char>(v >> 8);
+    }
+
+    // ==================== BMP ====================
+    bool DecodeBmp(const std::vector<unsigned char>& data, std::vector<unsigned char>& pixels, int& width, int& height)
+    {
+        if (data.size() < 54 || data[0] != 'B' || data[1] != 'M') return false;
+
+        const uint32_t offset = ReadU32(&data[10]);
+        const uint32_t headerSize = ReadU32(&data[14]);
+        if (headerSize < 40 || 14 + static_cast<size_t>(headerSize) > data.size()) return false;
+
+        const long long w = static_cast<int32_t>(ReadU32(&data[18]));
+        const long long h = static_cast<int32_t>(ReadU32(&data[22]));
+        const int bitCount = ReadU16(&data[28]);
+        const uint32_t compression = ReadU32(&data[30]);
+
+        // BI_RGB(0), 32비트는 BI_BITFIELDS(3)도 기본 BGRA 마스크로 간주
+        if (compression != 0 && !(compression == 3 && bitCount == 32)) return false;
+        if (bitCount != 8 && bitCount != 24 && bitCount != 32) return false;
+
+        const bool topDown = h < 0;
+        const long long absHeight = topDown ? -h : h;
+        if (!ValidSize(w, absHeight)) return false;
+
+        const size_t stride = ((static_cast<size_t>(w) * bitCount + 31) / 32) * 4;
+        if (offset > data.size() || stride * absHeight > data.size() - offset) return false;
+
+        // 8비트 팔레트 (BGRX 엔트리)
+        unsigned char palette[256][4] = {};
+        if (bitCount == 8)
+        {
+            uint32_t colors = ReadU32(&data[46]);
+            if (colors == 0 || colors > 256) colors = 256;
+            const size_t paletteOffset = 14 + headerSize;
+            if (paletteOffset + colors * 4 > offset) return false;
+            for (uint32_t i = 0; i < colors; ++i) memcpy(palette[i], &data[paletteOffset + i * 4], 4);
+        }
+
+        width = static_cast<int>(w);
+        height = static_cast<int>(absHeight);
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+
+        for (int y = 0; y < height; ++y)
+        {
+            const int sourceRow = topDown ? y : height - 1 - y;
+            const unsigned char* in = &data[offset + stride * sourceRow];
+            unsigned char* out = pixels.data() + static_cast<size_t>(y) * width * 4;
+
+            for (int x = 0; x < width; ++x, out += 4)
+            {
+                if (bitCount == 8)
+                {
+                    const unsigned char* entry = palette[in[x]];
+                    out[0] = entry[0]; out[1] = entry[1]; out[2] = entry[2];
+                }
+                else
+                {
+                    const unsigned char* p = in + x * (bitCount / 8);
+                    out[0] = p[0]; out[1] = p[1]; out[2] = p[2];
+                }
+                out[3] = 255;
+            }
+        }
+        return true;
+    }
+
+    bool EncodeBmp(std::FILE* file, const unsigned char* pixels, int width, int height)
+    {
+        const size_t stride = (static_cast<size_t>(width) * 3 + 3) & ~static_cast<size_t>(3);
+        const size_t imageSize = stride * height;
+
+        unsigned char header[54] = {};
+        header[0] = 'B';
+        header[1] = 'M';
+        WriteU32(&header[2], static_cast<uint32_t>(54 + imageSize));
+        WriteU32(&header[10], 54);
+        WriteU32(&header[14], 40);
+        WriteU32(&header[18], static_cast<uint32_t>(width));
+        WriteU32(&header[22], static_cast<uint32_t>(height));
+        WriteU16(&header[26], 1);
+        WriteU16(&header[28], 24);
+        WriteU32(&header[34], static_cast<uint32_t>(imageSize));
+        WriteU32(&header[38], 2835);   // 72 DPI
+        WriteU32(&header[42], 2835);
+        if (std::fwrite(header, 1, sizeof(header), file) != sizeof(header)) return false;
+
+        std::vector<unsigned char> row(stride, 0);
+        for (int y = height - 1; y >= 0; --y)
+        {
+            const unsigned char* in = pixels + static_cast<size_t>(y) * width * 4;
+            for (int x = 0; x < width; ++x)
+            {
+                row[x * 3 + 0] = in[x * 4 + 0];
+                row[x * 3 + 1] = in[x * 4 + 1];
+                row[x * 3 + 2] = in[x * 4 + 2];
+            }
+            if (std::fwrite(row.data(), 1, stride, file) != stride) return false;
+        }
+        return true;
+    }
+
+    // ==================== PGM / PPM ====================
+    // 공백과 '#' 주석을 건너뛰고 10진수 하나를 읽는다
+    bool ReadHeaderNumber(const std::vector<unsigned char>& data, size_t& pos, long long& value)
+    {
+        for (;;)
+        {
+            while (pos < data.size() && std::isspace(data[pos])) ++pos;
+            if (pos < data.size() && data[pos] == '#')
+            {
+                while (pos < data.size() && data[pos] != '\n') ++pos;
+                continue;
+            }
+            break;
+        }
+        if (pos >= data.size() || !std::isdigit(data[pos])) return false;
+
+        value = 0;
+        while (pos < data.size() && std::isdigit(data[pos]) && value < kMaxPixels)
+        {
+            value = value * 10 + (data[pos++] - '0');
+        }
+        return true;
+    }
+
+    bool DecodePnm(const std::vector<unsigned char>& data, std::vector<unsigned char>& pixels, int& width, int& height)
+    {
+        if (data.size() < 3 || data[0] != 'P' || (data[1] != '5' && data[1] != '6')) return false;
+        const int channels = (data[1] == '5') ? 1 : 3;
+
+        size_t pos = 2;
+        long long w = 0, h = 0, maxValue = 0;
+        if (!ReadHeaderNumber(data, pos, w) || !ReadHeaderNumber(data, pos, h) || !ReadHeaderNumber(data, pos, maxValue))
+            return false;
+        if (!ValidSize(w, h) || maxValue <= 0 || maxValue > 255) return false;
+
+        // 헤더 끝의 공백 한 글자 다음부터 화소
+        ++pos;
+        const size_t count = static_cast<size_t>(w) * h;
+        if (pos > data.size() || count * channels > data.size() - pos) return false;
+
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        pixels.resize(count * 4);
+
+        const unsigned char* in = &data[pos];
+        unsigned char* out = pixels.data();
+        for (size_t i = 0; i < count; ++i, out += 4)
+        {
+            // 최대값이 255가 아니면 0..255로 늘린다
+            auto scale = [maxValue](unsigned char v)
+                {
+                    return static_cast<unsigned char>(maxValue == 255 ? v : std::min<long long>(255, v * 255 / maxValue));
+                };
+            if (channels == 1)
+            {
+                out[0] = out[1] = out[2] = scale(in[i]);
+            }
+            else
+            {
+                out[0] = scale(in[i * 3 + 2]);
+                out[1] = scale(in[i * 3 + 1]);
+                out[2] = scale(in[i * 3 + 0]);
+            }
+            out[3] = 255;
+        }
+        return true;
+    }
+
+    bool EncodePnm(std::FILE* file, bool gray, const unsigned char* pixels, int width, int height)
+    {
+        if (std::fprintf(file, "%s\n%d %d\n255\n", gray ? "P5" : "P6", width, height) < 0) return false;
+
+        const int channels = gray ? 1 : 3;
+        std::vector<unsigned char> row(static_cast<size_t>(width) * channels);
+        for (int y = 0; y < height; ++y)
+        {
+            const unsigned char* in = pixels + static_cast<size_t>(y) * width * 4;
+            for (int x = 0; x < width; ++x)
+            {
+                const unsigned char* p = in + x * 4;
+                if (gray)
+                {
+                    row[x] = NativeKernels::GrayOf(p);
+                }
+                else
+                {
+                    row[x * 3 + 0] = p[2];
+                    row[x * 3 + 1] = p[1];
+                    row[x * 3 + 2] = p[0];
+                }
+            }
+            if (std::fwrite(row.data(), 1, row.size(), file) != row.size()) return false;
+        }
+        return true;
+    }
+}
+
+ImageCodec::Format ImageCodec::FormatFromPath(const std::string& path)
+{
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return Format::Unknown;
+
+    std::string extension = path.substr(dot + 1);
+    for (char& c : extension) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+    if (extension == "bmp") return Format::Bmp;
+    if (extension == "pgm") return Format::Pgm;
+    if (extension == "ppm") return Format::Ppm;
+    return Format::Unknown;
+}
+
+const char* ImageCodec::Extension(Format format)
+{
+    switch (format)
+    {
+    case Format::Bmp: return ".bmp";
+    case Format::Pgm: return ".pgm";
+    case Format::Ppm: return ".ppm";
+    default: return "";
+    }
+}
+
+bool ImageCodec::Read(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height)
+{
+    std::vector<unsigned char> data;
+    if (!ReadAll(path, data)) return false;
+
+    // 확장자보다 파일 시그니처를 믿는다
+    if (data.size() >= 2 && data[0] == 'B' && data[1] == 'M') return DecodeBmp(data, pixels, width, height);
+    if (data.size() >= 2 && data[0] == 'P') return DecodePnm(data, pixels, width, height);
+    return false;
+}
+
+bool ImageCodec::Write(const std::string& path, Format format, const unsigned char* pixels, int width, int height)
+{
+    if (pixels == nullptr || width <= 0 || height <= 0 || format == Format::Unknown) return false;
+
+    std::FILE* file = OpenFile(path, "wb");
+    if (file == nullptr) return false;
+
+    bool ok = (format == Format::Bmp) ? EncodeBmp(file, pixels, width, height)
+                                      : EncodePnm(file, format == Format::Pgm, pixels, width, height);
+    ok = (std::fclose(file) == 0) && ok;
+    return ok;
+}
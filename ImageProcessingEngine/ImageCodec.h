@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+
+// =====================================================
+//  영상 파일 입출력 (외부 라이브러리 없이 배치 처리 도구 등 네이티브 코드에서 사용)
+//  BMP: 8비트 팔레트 / 24 / 32비트 무압축 읽기, 24비트 쓰기
+//  PGM(P5) / PPM(P6): 최대값 255 이하 바이너리 형식
+//  메모리 안의 영상은 항상 BGRA (alpha 255)이며 경로는 UTF-8이다.
+// =====================================================
+namespace ImageCodec
+{
+    enum class Format
+    {
+        Unknown,
+        Bmp,
+        Pgm,
+        Ppm,
+    };
+
+    // 확장자(.bmp/.pgm/.ppm, 대소문자 무시)로 형식 판단
+    Format FormatFromPath(const std::string& path);
+    const char* Extension(Format format);
+
+    // 파일을 BGRA로 읽는다. 지원하지 않는 형식이거나 파일이 손상되었으면 false
+    bool Read(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height);
+
+    // BGRA를 format으로 저장. Pgm은 그레이스케일 규칙(NativeKernels::GrayOf)으로 변환한다
+    bool Write(const std::string& path, Format format, const unsigned char* pixels, int width, int height);
+}
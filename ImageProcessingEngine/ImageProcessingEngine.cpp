@@ -1,7 +1,24 @@
 ﻿#include "pch.h"
 #include "ImageProcessingEngine.h"
 #include "NativeProcessor.h"
+#include "FFTProcessor.h"
+#include "FrequencyFilter.h"
+#include "FilterPipeline.h"
+#include "GrayImage.h"
+#include "TemplateMatcher.h"
+#include "TiledProcessor.h"
+#include "ThreadPool.h"
+#include "ScratchArena.h"
+#include "Profiler.h"
+#include "TileHistory.h"
+#include "Thresholding.h"
+#include "ConnectedComponents.h"
+#include "EdgeDetection.h"
+#include "ProgressivePreview.h"
+#include "JobControl.h"
 #include <cmath>
+#include <string>
+#include <cstring>
 #include <vector>
 #include <algorithm>   // std::min/max
 #include <vcclr.h>
@@ -9,129 +26,93 @@
 using namespace System;
 using namespace ImageProcessingEngine;
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846264338327950288
-#endif
-
-// ---- 로컬 clamp 유틸 (std::clamp 없이도 동작) ----
-template <typename T>
-static inline T clamp_val(T v, T lo, T hi)
+ImageEngine::ImageEngine()
+    : m_fft(gcnew FFTContext())
 {
-    return (v < lo) ? lo : ((v > hi) ? hi : v);
 }
 
-static inline unsigned char clamp_u8_from_float(float v)
+void ImageEngine::SetThreadCount(int threads)
 {
-    // 0..255 범위로 클램프 + 반올림
-    v = (v < 0.f) ? 0.f : ((v > 255.f) ? 255.f : v);
-    return static_cast<unsigned char>(v + 0.5f);
+    ThreadPool::Shared().SetThreadCount(threads);
 }
 
-// =====================================================
-//              FFT 전역 데이터 (float 버전)
-// =====================================================
-static std::vector<float> g_fftRealData;
-static std::vector<float> g_fftImagData;
-static int g_fftWidth = 0;
-static int g_fftHeight = 0;
-
-// 2의 제곱수 찾기
-static inline int nextPowerOf2(int n)
+int ImageEngine::GetThreadCount()
 {
-    int power = 1;
-    while (power < n) power <<= 1;
-    return power;
+    return ThreadPool::Shared().ThreadCount();
 }
 
-// ==================== 1D FFT (Cooley–Tukey) ====================
-static void fft1d(std::vector<float>& real, std::vector<float>& imag, bool inverse)
+void ImageEngine::SetThreadAffinity(bool pinThreads)
 {
-    int n = static_cast<int>(real.size());
-    if (n <= 1) return;
-    // 2의 거듭제곱만 처리
-    if ((n & (n - 1)) != 0) return;
-
-    // Bit reversal
-    for (int i = 1, j = 0; i < n; ++i)
-    {
-        int bit = n >> 1;
-        for (; j & bit; bit >>= 1) j ^= bit;
-        j ^= bit;
-        if (i < j)
-        {
-            std::swap(real[i], real[j]);
-            std::swap(imag[i], imag[j]);
-        }
-    }
+    ThreadPool::Shared().SetAffinity(pinThreads);
+}
 
-    // 스테이지
-    for (int len = 2; len <= n; len <<= 1)
-    {
-        float ang = static_cast<float>(2.0 * M_PI) / len * (inverse ? 1.f : -1.f);
-        float wlenReal = std::cos(ang), wlenImag = std::sin(ang);
+ScratchMemoryStats ImageEngine::GetScratchStats()
+{
+    const ScratchArena::Stats native = ScratchArena::Shared().GetStats();
+    ScratchMemoryStats stats;
+    stats.InUseBytes = static_cast<Int64>(native.bytesInUse);
+    stats.PeakInUseBytes = static_cast<Int64>(native.peakBytesInUse);
+    stats.ReservedBytes = static_cast<Int64>(native.bytesReserved);
+    stats.PeakReservedBytes = static_cast<Int64>(native.peakBytesReserved);
+    stats.AcquireCount = static_cast<Int64>(native.acquireCount);
+    stats.SystemAllocations = static_cast<Int64>(native.systemAllocations);
+    return stats;
+}
 
-        for (int i = 0; i < n; i += len)
-        {
-            float wReal = 1.f, wImag = 0.f;
-            int half = len >> 1;
-            for (int j = 0; j < half; ++j)
-            {
-                float uReal = real[i + j], uImag = imag[i + j];
-                float tReal = real[i + j + half], tImag = imag[i + j + half];
+void ImageEngine::ResetScratchPeaks()
+{
+    ScratchArena::Shared().ResetPeaks();
+}
 
-                float vReal = tReal * wReal - tImag * wImag;
-                float vImag = tReal * wImag + tImag * wReal;
+void ImageEngine::TrimScratch()
+{
+    ScratchArena::Shared().Trim();
+}
 
-                real[i + j] = uReal + vReal;
-                imag[i + j] = uImag + vImag;
-                real[i + j + half] = uReal - vReal;
-                imag[i + j + half] = uImag - vImag;
+// ==================== Grayscale ====================
+// 파이프라인/히스토그램/캐니와 같은 정수 그레이 커널 (공용 스레드 풀, SIMD, 작업 취소)
+bool ImageEngine::ApplyGrayscale(array<unsigned char>^ pixelBuffer, int width, int height)
+{
+    if (pixelBuffer == nullptr || width <= 0 || height <= 0) return false;
+    if (pixelBuffer->Length < static_cast<long long>(width) * height * 4) return false;
 
-                float nextWReal = wReal * wlenReal - wImag * wlenImag;
-                float nextWImag = wReal * wlenImag + wImag * wlenReal;
-                wReal = nextWReal; wImag = nextWImag;
-            }
-        }
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ToGrayscale(nativePixels, width, height);
+        return true;
     }
-
-    if (inverse)
+    catch (...)
     {
-        float invN = 1.f / n;
-        for (int i = 0; i < n; ++i)
-        {
-            real[i] *= invN;
-            imag[i] *= invN;
-        }
+        return false;
     }
 }
 
-// ==================== Grayscale (빠르고 안전) ====================
-bool ImageEngine::ApplyGrayscale(array<unsigned char>^ pixelBuffer, int width, int height)
+// ==================== 2D FFT 컨텍스트 ====================
+FFTContext::FFTContext()
+    : m_processor(new FFTProcessor())
 {
-    try
-    {
-        // BGRA 순서
-        const float wR = 0.299f, wG = 0.587f, wB = 0.114f;
-        int total = width * height;
+}
 
-        // OpenMP 병렬화 (미사용 환경에서도 pragma는 무시됨)
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (int i = 0; i < total; ++i)
-        {
-            int idx = i * 4;
-            float b = pixelBuffer[idx + 0];
-            float g = pixelBuffer[idx + 1];
-            float r = pixelBuffer[idx + 2];
+FFTContext::~FFTContext()
+{
+    this->!FFTContext();
+}
 
-            unsigned char gray = clamp_u8_from_float(r * wR + g * wG + b * wB);
+FFTContext::!FFTContext()
+{
+    delete m_processor;
+    m_processor = nullptr;
+}
 
-            pixelBuffer[idx + 0] = gray;
-            pixelBuffer[idx + 1] = gray;
-            pixelBuffer[idx + 2] = gray;
-            // alpha는 보존
-        }
+bool FFTContext::ApplyFFT(array<unsigned char>^ pixelBuffer, int width, int height)
+{
+    if (m_processor == nullptr) return false;
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        m_processor->ApplyFFT(nativePixels, width, height);
         return true;
     }
     catch (...)
@@ -140,121 +121,67 @@ bool ImageEngine::ApplyGrayscale(array<unsigned char>^ pixelBuffer, int width, i
     }
 }
 
-// ==================== 2D FFT (행/열 분리 + 병렬) ====================
-bool ImageEngine::ApplyFFT(array<unsigned char>^ pixelBuffer, int width, int height)
+bool FFTContext::ApplyIFFT(array<unsigned char>^ pixelBuffer, int width, int height)
 {
+    if (m_processor == nullptr) return false;
     try
     {
-        int paddedWidth = nextPowerOf2(width);
-        int paddedHeight = nextPowerOf2(height);
-
-        g_fftWidth = paddedWidth;
-        g_fftHeight = paddedHeight;
-        g_fftRealData.assign(paddedWidth * paddedHeight, 0.f);
-        g_fftImagData.assign(paddedWidth * paddedHeight, 0.f);
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        return m_processor->ApplyIFFT(nativePixels, width, height);
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
 
-        // 그레이스케일 + 패딩
-        const float wR = 0.299f, wG = 0.587f, wB = 0.114f;
+bool FFTContext::HasData()
+{
+    return m_processor != nullptr && m_processor->HasData();
+}
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (int y = 0; y < paddedHeight; ++y)
-        {
-            for (int x = 0; x < paddedWidth; ++x)
-            {
-                int pIdx = y * paddedWidth + x;
-                if (x < width && y < height)
-                {
-                    int idx = (y * width + x) * 4;
-                    float gray = pixelBuffer[idx + 2] * wR + pixelBuffer[idx + 1] * wG + pixelBuffer[idx + 0] * wB;
-                    g_fftRealData[pIdx] = gray;
-                }
-                else
-                {
-                    g_fftRealData[pIdx] = 0.f;
-                }
-                g_fftImagData[pIdx] = 0.f;
-            }
-        }
+void FFTContext::Clear()
+{
+    if (m_processor != nullptr) m_processor->Clear();
+}
 
-        // 행별 FFT
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (int y = 0; y < paddedHeight; ++y)
-        {
-            std::vector<float> r(paddedWidth), im(paddedWidth);
-            for (int x = 0; x < paddedWidth; ++x)
-            {
-                r[x] = g_fftRealData[y * paddedWidth + x];
-                im[x] = g_fftImagData[y * paddedWidth + x];
-            }
-            fft1d(r, im, false);
-            for (int x = 0; x < paddedWidth; ++x)
-            {
-                g_fftRealData[y * paddedWidth + x] = r[x];
-                g_fftImagData[y * paddedWidth + x] = im[x];
-            }
-        }
+// ==================== 되돌리기 기록 ====================
+ImageHistory::ImageHistory(int tileSize)
+    : m_history(new TileHistory(tileSize))
+{
+}
 
-        // 열별 FFT
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (int x = 0; x < paddedWidth; ++x)
-        {
-            std::vector<float> r(paddedHeight), im(paddedHeight);
-            for (int y = 0; y < paddedHeight; ++y)
-            {
-                r[y] = g_fftRealData[y * paddedWidth + x];
-                im[y] = g_fftImagData[y * paddedWidth + x];
-            }
-            fft1d(r, im, false);
-            for (int y = 0; y < paddedHeight; ++y)
-            {
-                g_fftRealData[y * paddedWidth + x] = r[y];
-                g_fftImagData[y * paddedWidth + x] = im[y];
-            }
-        }
+ImageHistory::~ImageHistory()
+{
+    this->!ImageHistory();
+}
 
-        // Magnitude → log scale → 0..255 정규화
-        float maxMag = 0.f;
-        std::vector<float> mag(width * height, 0.f);
+ImageHistory::!ImageHistory()
+{
+    delete m_history;
+    m_history = nullptr;
+}
 
-        for (int y = 0; y < height; ++y)
-        {
-            for (int x = 0; x < width; ++x)
-            {
-                int o = y * width + x;
-                int p = y * paddedWidth + x;
-                float re = g_fftRealData[p], im = g_fftImagData[p];
-                float m = std::sqrt(re * re + im * im);
-                mag[o] = m;
-                if (m > maxMag) maxMag = m;
-            }
-        }
+void ImageHistory::SetMemoryBudget(Int64 bytes)
+{
+    if (m_history != nullptr) m_history->SetMemoryBudget(static_cast<size_t>(std::max<Int64>(0, bytes)));
+}
 
-        if (maxMag > 0.f)
-        {
-            float denom = std::log1p(maxMag); // log(1+max)
-            int total = width * height;
+void ImageHistory::SetCompression(bool enabled)
+{
+    if (m_history != nullptr) m_history->SetCompression(enabled);
+}
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-            for (int i = 0; i < total; ++i)
-            {
-                float val = std::log1p(mag[i]) / denom * 255.f;
-                unsigned char v = clamp_u8_from_float(val);
-                int idx = i * 4;
-                pixelBuffer[idx + 0] = v;
-                pixelBuffer[idx + 1] = v;
-                pixelBuffer[idx + 2] = v;
-                pixelBuffer[idx + 3] = 255;
-            }
-        }
-        return true;
+bool ImageHistory::Push(array<unsigned char>^ pixelBuffer, int width, int height)
+{
+    if (m_history == nullptr || pixelBuffer == nullptr || width <= 0 || height <= 0) return false;
+    if (pixelBuffer->Length < static_cast<long long>(width) * height * 4) return false;
+    try
+    {
+        // 기록은 호출 스레드에 걸린 작업(EngineJob)이 취소돼도 중간에 멈추지 않는다
+        JobControl::Scope detached(nullptr);
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        return m_history->Push(ImageView::BGRA(nativePixels, width, height));
     }
     catch (...)
     {
@@ -262,74 +189,83 @@ bool ImageEngine::ApplyFFT(array<unsigned char>^ pixelBuffer, int width, int hei
     }
 }
 
-bool ImageEngine::ApplyIFFT(array<unsigned char>^ pixelBuffer, int width, int height)
+bool ImageHistory::CanUndo()
+{
+    return m_history != nullptr && m_history->CanUndo();
+}
+
+bool ImageHistory::CanRedo()
 {
+    return m_history != nullptr && m_history->CanRedo();
+}
+
+bool ImageHistory::Undo()
+{
+    return m_history != nullptr && m_history->Undo();
+}
+
+bool ImageHistory::Redo()
+{
+    return m_history != nullptr && m_history->Redo();
+}
+
+Int64 ImageHistory::CurrentState()
+{
+    return m_history != nullptr ? static_cast<Int64>(m_history->CurrentState()) : 0;
+}
+
+int ImageHistory::Width()
+{
+    return m_history != nullptr ? m_history->Width() : 0;
+}
+
+int ImageHistory::Height()
+{
+    return m_history != nullptr ? m_history->Height() : 0;
+}
+
+bool ImageHistory::Restore(array<unsigned char>^ pixelBuffer, Int64 basisState)
+{
+    if (m_history == nullptr || pixelBuffer == nullptr || m_history->BytesPerPixel() != 4) return false;
+    const int width = m_history->Width(), height = m_history->Height();
+    if (pixelBuffer->Length < static_cast<long long>(width) * height * 4) return false;
     try
     {
-        if (g_fftRealData.empty() || g_fftImagData.empty()) return false;
+        JobControl::Scope detached(nullptr);
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        return m_history->Restore(ImageView::BGRA(nativePixels, width, height), static_cast<uint64_t>(basisState));
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
 
-        // 복사본으로 작업
-        std::vector<float> r = g_fftRealData;
-        std::vector<float> im = g_fftImagData;
+Int64 ImageHistory::StoredBytes()
+{
+    return m_history != nullptr ? static_cast<Int64>(m_history->GetStats().storedBytes) : 0;
+}
 
-        // 열별 IFFT
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (int x = 0; x < g_fftWidth; ++x)
-        {
-            std::vector<float> tr(g_fftHeight), ti(g_fftHeight);
-            for (int y = 0; y < g_fftHeight; ++y)
-            {
-                tr[y] = r[y * g_fftWidth + x];
-                ti[y] = im[y * g_fftWidth + x];
-            }
-            fft1d(tr, ti, true);
-            for (int y = 0; y < g_fftHeight; ++y)
-            {
-                r[y * g_fftWidth + x] = tr[y];
-                im[y * g_fftWidth + x] = ti[y];
-            }
-        }
+int ImageHistory::StateCount()
+{
+    return m_history != nullptr ? m_history->GetStats().states : 0;
+}
 
-        // 행별 IFFT
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (int y = 0; y < g_fftHeight; ++y)
-        {
-            std::vector<float> tr(g_fftWidth), ti(g_fftWidth);
-            for (int x = 0; x < g_fftWidth; ++x)
-            {
-                tr[x] = r[y * g_fftWidth + x];
-                ti[x] = im[y * g_fftWidth + x];
-            }
-            fft1d(tr, ti, true);
-            for (int x = 0; x < g_fftWidth; ++x)
-            {
-                r[y * g_fftWidth + x] = tr[x];
-                im[y * g_fftWidth + x] = ti[x];
-            }
-        }
+void ImageHistory::Clear()
+{
+    if (m_history != nullptr) m_history->Clear();
+}
 
-        // 원래 크기만 써서 복원 이미지 작성
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (int y = 0; y < height; ++y)
-        {
-            for (int x = 0; x < width; ++x)
-            {
-                int idx = (y * width + x) * 4;
-                int p = y * g_fftWidth + x;
-                unsigned char v = clamp_u8_from_float(std::fabs(r[p]));
-                pixelBuffer[idx + 0] = v;
-                pixelBuffer[idx + 1] = v;
-                pixelBuffer[idx + 2] = v;
-                pixelBuffer[idx + 3] = 255;
-            }
-        }
-        return true;
+// ==================== 주파수 영역 필터 ====================
+static bool FilterAndInvert(FFTProcessor* processor, array<unsigned char>^ pixelBuffer, int width, int height,
+                            const ::FrequencyFilter& filter)
+{
+    if (processor == nullptr) return false;
+    try
+    {
+        if (!processor->FilterSpectrum(filter)) return false;
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        return processor->ApplyIFFT(nativePixels, width, height);
     }
     catch (...)
     {
@@ -337,104 +273,125 @@ bool ImageEngine::ApplyIFFT(array<unsigned char>^ pixelBuffer, int width, int he
     }
 }
 
+static ::FrequencyFilter MakeFilter(FrequencyFilterType type, ImageProcessingEngine::FrequencyFilterShape shape,
+                                    float cutoff, int order)
+{
+    ::FrequencyFilter filter;
+    filter.type = type;
+    filter.shape = static_cast<::FrequencyFilterShape>(shape);
+    filter.cutoff = cutoff;
+    filter.order = order;
+    return filter;
+}
+
+bool FFTContext::ApplyLowPass(array<unsigned char>^ pixelBuffer, int width, int height,
+                              ImageProcessingEngine::FrequencyFilterShape shape, float cutoff, int order)
+{
+    return FilterAndInvert(m_processor, pixelBuffer, width, height,
+                           MakeFilter(FrequencyFilterType::LowPass, shape, cutoff, order));
+}
+
+bool FFTContext::ApplyHighPass(array<unsigned char>^ pixelBuffer, int width, int height,
+                               ImageProcessingEngine::FrequencyFilterShape shape, float cutoff, int order)
+{
+    return FilterAndInvert(m_processor, pixelBuffer, width, height,
+                           MakeFilter(FrequencyFilterType::HighPass, shape, cutoff, order));
+}
+
+bool FFTContext::ApplyBandPass(array<unsigned char>^ pixelBuffer, int width, int height,
+                               ImageProcessingEngine::FrequencyFilterShape shape, float center, float bandwidth, int order)
+{
+    ::FrequencyFilter filter = MakeFilter(FrequencyFilterType::BandPass, shape, center, order);
+    filter.bandwidth = bandwidth;
+    return FilterAndInvert(m_processor, pixelBuffer, width, height, filter);
+}
+
+bool FFTContext::ApplyNotch(array<unsigned char>^ pixelBuffer, int width, int height,
+                            ImageProcessingEngine::FrequencyFilterShape shape, float frequencyX, float frequencyY,
+                            float radius, int order)
+{
+    ::FrequencyFilter filter = MakeFilter(FrequencyFilterType::Notch, shape, radius, order);
+    filter.notchX = frequencyX;
+    filter.notchY = frequencyY;
+    return FilterAndInvert(m_processor, pixelBuffer, width, height, filter);
+}
+
+// ==================== 2D FFT ====================
+bool ImageEngine::ApplyFFT(array<unsigned char>^ pixelBuffer, int width, int height)
+{
+    return m_fft->ApplyFFT(pixelBuffer, width, height);
+}
+
+bool ImageEngine::ApplyIFFT(array<unsigned char>^ pixelBuffer, int width, int height)
+{
+    return m_fft->ApplyIFFT(pixelBuffer, width, height);
+}
+
 bool ImageEngine::HasFFTData()
 {
-    return !g_fftRealData.empty() && !g_fftImagData.empty();
+    return m_fft->HasData();
 }
 
 void ImageEngine::ClearFFTData()
 {
-    g_fftRealData.clear();
-    g_fftImagData.clear();
-    g_fftWidth = g_fftHeight = 0;
+    m_fft->Clear();
 }
 
-// ==================== Gaussian Blur (Separable + 정규화) ====================
-static std::vector<float> makeGaussian1D(int radius, float sigma)
+bool ImageEngine::ApplyLowPass(array<unsigned char>^ pixelBuffer, int width, int height,
+                               ImageProcessingEngine::FrequencyFilterShape shape, float cutoff, int order)
 {
-    int size = radius * 2 + 1;
-    std::vector<float> k(size);
-    float sum = 0.f;
-    float inv2s2 = 1.f / (2.f * sigma * sigma);
-    for (int i = -radius; i <= radius; ++i)
-    {
-        float v = std::exp(-(i * i) * inv2s2);
-        k[i + radius] = v;
-        sum += v;
-    }
-    // 정규화
-    float inv = 1.f / sum;
-    for (float& v : k) v *= inv;
-    return k;
+    return m_fft->ApplyLowPass(pixelBuffer, width, height, shape, cutoff, order);
+}
+
+bool ImageEngine::ApplyHighPass(array<unsigned char>^ pixelBuffer, int width, int height,
+                                ImageProcessingEngine::FrequencyFilterShape shape, float cutoff, int order)
+{
+    return m_fft->ApplyHighPass(pixelBuffer, width, height, shape, cutoff, order);
+}
+
+bool ImageEngine::ApplyBandPass(array<unsigned char>^ pixelBuffer, int width, int height,
+                                ImageProcessingEngine::FrequencyFilterShape shape, float center, float bandwidth, int order)
+{
+    return m_fft->ApplyBandPass(pixelBuffer, width, height, shape, center, bandwidth, order);
 }
 
-static inline int clamp_index(int v, int lo, int hi)
+bool ImageEngine::ApplyNotch(array<unsigned char>^ pixelBuffer, int width, int height,
+                             ImageProcessingEngine::FrequencyFilterShape shape, float frequencyX, float frequencyY,
+                             float radius, int order)
 {
-    return (v < lo) ? lo : ((v > hi) ? hi : v);
+    return m_fft->ApplyNotch(pixelBuffer, width, height, shape, frequencyX, frequencyY, radius, order);
 }
 
+// ==================== Gaussian Blur ====================
+// 파이프라인/미리보기와 같은 고정소수점 5x5 (/273) 커널
 bool ImageProcessingEngine::ImageEngine::ApplyGaussianBlur(array<unsigned char>^ pixelBuffer, int width, int height)
 {
+    if (pixelBuffer == nullptr || width <= 0 || height <= 0) return false;
+    if (pixelBuffer->Length < static_cast<long long>(width) * height * 4) return false;
+
     try
     {
-        // 기본 파라미터(필요시 변경 가능)
-        const int   radius = 2;          // 커널크기 5 (= 2*radius+1)
-        const float sigma = 1.0f;
-
-        // 임시 버퍼 (float로 누적 → 품질↑)
-        const int N = width * height;
-        std::vector<float> tmpB(N), tmpG(N), tmpR(N);
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyGaussianBlur(nativePixels, width, height);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
 
-        // 수평 패스
-        auto k = makeGaussian1D(radius, sigma);
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (int y = 0; y < height; ++y)
-        {
-            for (int x = 0; x < width; ++x)
-            {
-                float sb = 0.f, sg = 0.f, sr = 0.f;
-                for (int t = -radius; t <= radius; ++t)
-                {
-                    int xx = clamp_index(x + t, 0, width - 1);
-                    int idx = (y * width + xx) * 4;
-                    float w = k[t + radius];
-                    sb += pixelBuffer[idx + 0] * w;
-                    sg += pixelBuffer[idx + 1] * w;
-                    sr += pixelBuffer[idx + 2] * w;
-                }
-                int o = y * width + x;
-                tmpB[o] = sb; tmpG[o] = sg; tmpR[o] = sr;
-            }
-        }
+bool ImageProcessingEngine::ImageEngine::ApplyGaussianBlur(array<unsigned char>^ pixelBuffer, int width, int height, float sigma)
+{
+    if (pixelBuffer == nullptr || width <= 0 || height <= 0 || !(sigma > 0.f)) return false;
+    if (pixelBuffer->Length < static_cast<long long>(width) * height * 4) return false;
 
-        // 수직 패스 + 출력
-    #ifdef _OPENMP
-    #pragma omp parallel for
-    #endif
-        for (int y = 0; y < height; ++y)
-        {
-            for (int x = 0; x < width; ++x)
-            {
-                float sb = 0.f, sg = 0.f, sr = 0.f;
-                for (int t = -radius; t <= radius; ++t)
-                {
-                    int yy = clamp_index(y + t, 0, height - 1);
-                    int o = yy * width + x;
-                    float w = k[t + radius];
-                    sb += tmpB[o] * w;
-                    sg += tmpG[o] * w;
-                    sr += tmpR[o] * w;
-                }
-                int idx = (y * width + x) * 4;
-                pixelBuffer[idx + 0] = clamp_u8_from_float(sb);
-                pixelBuffer[idx + 1] = clamp_u8_from_float(sg);
-                pixelBuffer[idx + 2] = clamp_u8_from_float(sr);
-                // alpha는 그대로 두거나 255로 고정
-                // pixelBuffer[idx + 3] = 255;
-            }
-        }
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyGaussianBlur(nativePixels, width, height, sigma);
         return true;
     }
     catch (...)
@@ -446,49 +403,695 @@ bool ImageProcessingEngine::ImageEngine::ApplyGaussianBlur(array<unsigned char>^
 // Sobel
 bool ImageProcessingEngine::ImageEngine::ApplySobel(array<unsigned char>^ pixelBuffer, int width, int height)
 {
-    pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
-    NativeProcessor processor;
-    processor.ApplySobel(nativePixels, width, height);
-    return true;
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplySobel(nativePixels, width, height);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
 }
 
 bool ImageProcessingEngine::ImageEngine::ApplyLaplacian(array<unsigned char>^ pixelBuffer, int width, int height)
 {
-    pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
-    NativeProcessor processor;
-    processor.ApplyLaplacian(nativePixels, width, height);
-    return true;
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyLaplacian(nativePixels, width, height);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
 }
 
 bool ImageProcessingEngine::ImageEngine::ApplyBinarization(array<unsigned char>^ pixelBuffer, int width, int height, int threshold)
 {
-    pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
-    NativeProcessor processor;
-    processor.ApplyBinarization(nativePixels, width, height, threshold);
-    return true;
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyBinarization(nativePixels, width, height, threshold);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
 }
 
-bool ImageProcessingEngine::ImageEngine::ApplyDilation(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+bool ImageProcessingEngine::ImageEngine::ApplyOtsuBinarization(array<unsigned char>^ pixelBuffer, int width, int height,
+                                                               int% threshold)
 {
-    pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
-    NativeProcessor processor;
-    processor.ApplyDilation(nativePixels, width, height, kernelSize);
-    return true;
+    threshold = -1;
+    if (pixelBuffer == nullptr || width <= 0 || height <= 0) return false;
+    if (pixelBuffer->Length < static_cast<long long>(width) * height * 4) return false;
+
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        threshold = processor.ApplyOtsuBinarization(nativePixels, width, height);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
 }
 
-bool ImageProcessingEngine::ImageEngine::ApplyErosion(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+bool ImageProcessingEngine::ImageEngine::ApplyAdaptiveThreshold(array<unsigned char>^ pixelBuffer, int width, int height,
+                                                                AdaptiveThresholdMethod method, int windowSize)
 {
-    pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
-    NativeProcessor processor;
-    processor.ApplyErosion(nativePixels, width, height, kernelSize);
-    return true;
+    return ApplyAdaptiveThreshold(pixelBuffer, width, height, method, windowSize,
+                                  Thresholding::DefaultK(static_cast<AdaptiveMethod>(method)));
 }
 
-// 중앙값 필터 래퍼 함수 추가
-bool ImageProcessingEngine::ImageEngine::ApplyMedianFilter(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+bool ImageProcessingEngine::ImageEngine::ApplyAdaptiveThreshold(array<unsigned char>^ pixelBuffer, int width, int height,
+                                                                AdaptiveThresholdMethod method, int windowSize, float k)
 {
-    pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
-    NativeProcessor processor;
-    processor.ApplyMedianFilter(nativePixels, width, height, kernelSize);
-    return true;
+    if (pixelBuffer == nullptr || width <= 0 || height <= 0 || windowSize < 3) return false;
+    if (pixelBuffer->Length < static_cast<long long>(width) * height * 4) return false;
+    if (method < AdaptiveThresholdMethod::Mean || method > AdaptiveThresholdMethod::Sauvola) return false;
+
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyAdaptiveThreshold(nativePixels, width, height, static_cast<AdaptiveMethod>(method), windowSize, k);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyDilation(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+{
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyDilation(nativePixels, width, height, kernelSize);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyErosion(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+{
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyErosion(nativePixels, width, height, kernelSize);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// 중앙값 필터 래퍼 함수 추가
+bool ImageProcessingEngine::ImageEngine::ApplyMedianFilter(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+{
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyMedianFilter(nativePixels, width, height, kernelSize);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// 임의 커널 컨볼루션 (공간/FFT 자동 선택)
+bool ImageProcessingEngine::ImageEngine::ApplyConvolution(array<unsigned char>^ pixelBuffer, int width, int height, array<float>^ kernel, int kSize)
+{
+    if (kernel == nullptr || kSize < 1 || kSize % 2 == 0 || kernel->Length != kSize * kSize) return false;
+
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        pin_ptr<float> nativeKernel = &kernel[0];
+        NativeProcessor processor;
+        processor.ApplyConvolution(nativePixels, width, height, nativeKernel, kSize);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// 형태학 복합 연산 래퍼
+bool ImageProcessingEngine::ImageEngine::ApplyOpening(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+{
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyOpening(nativePixels, width, height, kernelSize);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyClosing(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+{
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyClosing(nativePixels, width, height, kernelSize);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyMorphologyGradient(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+{
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyMorphologyGradient(nativePixels, width, height, kernelSize);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyTopHat(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+{
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyTopHat(nativePixels, width, height, kernelSize);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyBlackHat(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize)
+{
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        NativeProcessor processor;
+        processor.ApplyBlackHat(nativePixels, width, height, kernelSize);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// ==================== 템플릿 매칭 ====================
+array<TemplateMatchResult>^ ImageProcessingEngine::ImageEngine::MatchTemplate(array<unsigned char>^ pixelBuffer, int width, int height,
+    array<unsigned char>^ templateBuffer, int templateWidth, int templateHeight, int maxMatches, float minScore)
+{
+    if (pixelBuffer == nullptr || templateBuffer == nullptr || width <= 0 || height <= 0 ||
+        templateWidth <= 0 || templateHeight <= 0 ||
+        pixelBuffer->Length < static_cast<long long>(width) * height * 4 ||
+        templateBuffer->Length < static_cast<long long>(templateWidth) * templateHeight * 4)
+    {
+        return gcnew array<TemplateMatchResult>(0);
+    }
+
+    try
+    {
+        GrayImage image, templ;
+        {
+            pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+            image.FromBGRA(nativePixels, width, height);
+        }
+        {
+            pin_ptr<unsigned char> nativeTemplate = &templateBuffer[0];
+            templ.FromBGRA(nativeTemplate, templateWidth, templateHeight);
+        }
+
+        TemplateMatcher matcher;
+        matcher.SetTemplate(templ);
+        TemplateMatchOptions options;
+        options.maxMatches = maxMatches;
+        options.minScore = minScore;
+        std::vector<TemplateMatch> matches = matcher.Match(image, options);
+
+        array<TemplateMatchResult>^ results = gcnew array<TemplateMatchResult>(static_cast<int>(matches.size()));
+        for (int i = 0; i < results->Length; ++i)
+        {
+            results[i].X = matches[i].x;
+            results[i].Y = matches[i].y;
+            results[i].Score = matches[i].score;
+        }
+        return results;
+    }
+    catch (...)
+    {
+        return gcnew array<TemplateMatchResult>(0);
+    }
+}
+
+array<BlobInfo>^ ImageProcessingEngine::ImageEngine::LabelComponents(array<unsigned char>^ maskBuffer,
+    array<unsigned char>^ intensityBuffer, int width, int height, bool eightConnected)
+{
+    if (maskBuffer == nullptr || width <= 0 || height <= 0 ||
+        maskBuffer->Length < static_cast<long long>(width) * height * 4 ||
+        (intensityBuffer != nullptr && intensityBuffer->Length < static_cast<long long>(width) * height * 4))
+    {
+        return gcnew array<BlobInfo>(0);
+    }
+
+    try
+    {
+        ConnectedComponents components;
+        {
+            pin_ptr<unsigned char> nativeMask = &maskBuffer[0];
+            ImageView intensity;
+            pin_ptr<unsigned char> nativeIntensity = nullptr;
+            if (intensityBuffer != nullptr)
+            {
+                nativeIntensity = &intensityBuffer[0];
+                intensity = ImageView::BGRA(nativeIntensity, width, height);
+            }
+            components.Label(ImageView::BGRA(nativeMask, width, height),
+                             eightConnected ? Connectivity::Eight : Connectivity::Four, intensity);
+        }
+
+        const std::vector<BlobStats>& blobs = components.Blobs();
+        array<BlobInfo>^ results = gcnew array<BlobInfo>(static_cast<int>(blobs.size()));
+        for (int i = 0; i < results->Length; ++i)
+        {
+            const BlobStats& blob = blobs[i];
+            results[i].Area = blob.area;
+            results[i].Left = blob.bounds.x;
+            results[i].Top = blob.bounds.y;
+            results[i].Width = blob.bounds.width;
+            results[i].Height = blob.bounds.height;
+            results[i].CentroidX = blob.centroidX;
+            results[i].CentroidY = blob.centroidY;
+            results[i].MeanIntensity = blob.meanIntensity;
+        }
+        return results;
+    }
+    catch (...)
+    {
+        return gcnew array<BlobInfo>(0);
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyCanny(array<unsigned char>^ pixelBuffer, int width, int height,
+                                                    int lowThreshold, int highThreshold)
+{
+    return ApplyCanny(pixelBuffer, width, height, lowThreshold, highThreshold, EdgeOperator::Sobel, true);
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyCanny(array<unsigned char>^ pixelBuffer, int width, int height,
+                                                    int lowThreshold, int highThreshold,
+                                                    EdgeOperator edgeOperator, bool l2Norm)
+{
+    if (pixelBuffer == nullptr || width <= 0 || height <= 0) return false;
+    if (pixelBuffer->Length < static_cast<long long>(width) * height * 4) return false;
+    if (edgeOperator < EdgeOperator::Sobel || edgeOperator > EdgeOperator::Scharr) return false;
+
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        const ImageView image = ImageView::BGRA(nativePixels, width, height);
+        CannyDetector detector;
+        return detector.Detect(image, image, lowThreshold, highThreshold, static_cast<GradientOperator>(edgeOperator),
+                               l2Norm ? GradientNorm::L2 : GradientNorm::L1) >= 0;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ComputeGradient(array<unsigned char>^ pixelBuffer, int width, int height,
+                                                         EdgeOperator edgeOperator, bool l2Norm,
+                                                         array<UInt16>^ magnitude, array<unsigned char>^ orientation)
+{
+    const long long pixelCount = static_cast<long long>(width) * height;
+    if (pixelBuffer == nullptr || magnitude == nullptr || width <= 0 || height <= 0) return false;
+    if (pixelBuffer->Length < pixelCount * 4 || magnitude->Length < pixelCount) return false;
+    if (orientation != nullptr && orientation->Length < pixelCount) return false;
+    if (edgeOperator < EdgeOperator::Sobel || edgeOperator > EdgeOperator::Scharr) return false;
+
+    try
+    {
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        pin_ptr<UInt16> nativeMagnitude = &magnitude[0];
+        pin_ptr<unsigned char> nativeOrientation = nullptr;
+        if (orientation != nullptr) nativeOrientation = &orientation[0];
+        return EdgeDetection::Gradient(ImageView::BGRA(nativePixels, width, height),
+                                       static_cast<GradientOperator>(edgeOperator),
+                                       l2Norm ? GradientNorm::L2 : GradientNorm::L1, nativeMagnitude, width,
+                                       nativeOrientation, width);
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+// 관리 문자열 → UTF-8 (네이티브 파일 API용)
+static std::string ToUtf8(String^ text)
+{
+    array<unsigned char>^ bytes = System::Text::Encoding::UTF8->GetBytes(text);
+    if (bytes->Length == 0) return std::string();
+    pin_ptr<unsigned char> data = &bytes[0];
+    return std::string(reinterpret_cast<const char*>(data), bytes->Length);
+}
+
+// ==================== 성능 계측 ====================
+void ImageEngine::SetProfiling(bool enabled)
+{
+    Profiler::Shared().SetEnabled(enabled);
+}
+
+void ImageEngine::SetTracing(bool enabled)
+{
+    Profiler::Shared().SetTracing(enabled);
+}
+
+array<OperationStats>^ ImageEngine::GetOperationStats()
+{
+    const std::vector<ProfileStats> native = Profiler::Shared().Stats();
+    array<OperationStats>^ results = gcnew array<OperationStats>(static_cast<int>(native.size()));
+    for (int i = 0; i < results->Length; ++i)
+    {
+        const ProfileStats& stats = native[i];
+        results[i].Name = gcnew String(stats.name.c_str());
+        results[i].Calls = static_cast<Int64>(stats.calls);
+        results[i].TotalMs = stats.totalMs;
+        results[i].MeanMs = stats.meanMs;
+        results[i].MinMs = stats.minMs;
+        results[i].MaxMs = stats.maxMs;
+        results[i].P50Ms = stats.p50Ms;
+        results[i].P95Ms = stats.p95Ms;
+        results[i].P99Ms = stats.p99Ms;
+        results[i].NsPerPixel = stats.nsPerPixel;
+        results[i].Pixels = stats.pixels;
+        results[i].ScratchBytes = stats.scratchBytes;
+        results[i].AllocatedBytes = stats.allocatedBytes;
+        results[i].Threads = stats.threads;
+        results[i].Backend = gcnew String(stats.backend.c_str());
+        results[i].Histogram = gcnew array<Int64>(ProfileStats::kHistogramBuckets);
+        for (int b = 0; b < ProfileStats::kHistogramBuckets; ++b) results[i].Histogram[b] = stats.histogram[b];
+    }
+    return results;
+}
+
+bool ImageEngine::WriteTrace(String^ path)
+{
+    if (String::IsNullOrEmpty(path)) return false;
+    try
+    {
+        return Profiler::Shared().WriteChromeTrace(ToUtf8(path));
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+void ImageEngine::ResetProfiling()
+{
+    Profiler::Shared().Reset();
+}
+
+// ops/parameters 배열을 FilterPipeline으로 변환. 길이가 다르거나 알 수 없는 연산이면 false
+static bool BuildPipeline(array<int>^ ops, array<int>^ parameters, FilterPipeline& pipeline)
+{
+    if (ops == nullptr || parameters == nullptr || ops->Length != parameters->Length) return false;
+
+    for (int i = 0; i < ops->Length; ++i)
+    {
+        if (ops[i] < static_cast<int>(FilterOp::Grayscale) || ops[i] > static_cast<int>(FilterOp::BlackHat)) return false;
+        // Dilation 이후 연산은 커널 크기 파라미터를 받는다. 1 미만은 아무것도 하지 않으므로 잘못된 입력으로 본다
+        if (ops[i] >= static_cast<int>(FilterOp::Dilation) && parameters[i] < 1) return false;
+        pipeline.Add(static_cast<FilterOp>(ops[i]), parameters[i]);
+    }
+    return true;
+}
+
+// ==================== 점진적 미리보기 ====================
+PreviewContext::PreviewContext()
+    : m_preview(new ProgressivePreview())
+{
+}
+
+PreviewContext::~PreviewContext()
+{
+    this->!PreviewContext();
+}
+
+PreviewContext::!PreviewContext()
+{
+    delete m_preview;
+    m_preview = nullptr;
+}
+
+PreviewFrame PreviewContext::Run(array<unsigned char>^ pixelBuffer, int width, int height, Int64 sourceId,
+                                 array<int>^ ops, array<int>^ parameters, double latencyBudgetMs)
+{
+    PreviewFrame frame;
+    frame.Level = -1;
+    if (m_preview == nullptr || pixelBuffer == nullptr || width <= 0 || height <= 0) return frame;
+    if (pixelBuffer->Length < static_cast<long long>(width) * height * 4) return frame;
+
+    try
+    {
+        FilterPipeline pipeline;
+        if (!BuildPipeline(ops, parameters, pipeline)) return frame;
+
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        const int level = m_preview->Run(pipeline, ImageView::BGRA(nativePixels, width, height),
+                                         static_cast<uint64_t>(sourceId), latencyBudgetMs);
+        if (level < 0) return frame;
+
+        const ImageView result = m_preview->Result();
+        array<unsigned char>^ pixels = gcnew array<unsigned char>(static_cast<int>(result.stride * result.height));
+        pin_ptr<unsigned char> nativeResult = &pixels[0];
+        memcpy(nativeResult, result.data, result.stride * result.height);
+
+        frame.Pixels = pixels;
+        frame.Width = result.width;
+        frame.Height = result.height;
+        frame.Level = level;
+        return frame;
+    }
+    catch (...)
+    {
+        frame.Pixels = nullptr;
+        frame.Level = -1;
+        return frame;
+    }
+}
+
+void PreviewContext::RecordFullRun(array<int>^ ops, array<int>^ parameters, int width, int height, double milliseconds)
+{
+    if (m_preview == nullptr || width <= 0 || height <= 0) return;
+
+    FilterPipeline pipeline;
+    if (!BuildPipeline(ops, parameters, pipeline)) return;
+    m_preview->RecordRun(pipeline, static_cast<double>(width) * height, milliseconds);
+}
+
+void PreviewContext::Clear()
+{
+    if (m_preview != nullptr) m_preview->Clear();
+}
+
+// ==================== 취소 가능한 작업 ====================
+namespace ImageProcessingEngine
+{
+    // EngineJob::Enter가 돌려주는 범위. 종료자가 없으므로 반드시 Dispose해야 한다
+    // (종료자 스레드에서 다른 스레드의 작업을 되돌릴 수 없음)
+    ref class EngineJobScope
+    {
+    public:
+        EngineJobScope(EngineJob^ job, JobControl* control)
+            : m_job(job), m_scope(new JobControl::Scope(control))
+        {
+        }
+
+        ~EngineJobScope()
+        {
+            delete m_scope;
+            m_scope = nullptr;
+        }
+
+    private:
+        EngineJob^ m_job;               // 범위가 끝날 때까지 작업을 살려 둔다
+        JobControl::Scope* m_scope;
+    };
+}
+
+EngineJob::EngineJob()
+    : m_control(new JobControl())
+{
+}
+
+EngineJob::~EngineJob()
+{
+    this->!EngineJob();
+}
+
+EngineJob::!EngineJob()
+{
+    delete m_control;
+    m_control = nullptr;
+}
+
+void EngineJob::Cancel()
+{
+    if (m_control != nullptr) m_control->Cancel();
+}
+
+bool EngineJob::IsCanceled::get()
+{
+    return m_control != nullptr && m_control->IsCancelled();
+}
+
+double EngineJob::Progress::get()
+{
+    return m_control != nullptr ? m_control->Progress() : 0.0;
+}
+
+IDisposable^ EngineJob::Enter()
+{
+    return gcnew EngineJobScope(this, m_control);
+}
+
+bool EngineJob::IsCurrentCanceled::get()
+{
+    JobControl* control = JobControl::Current();
+    return control != nullptr && control->IsCancelled();
+}
+
+// 융합 파이프라인 래퍼
+bool ImageProcessingEngine::ImageEngine::ApplyPipeline(array<unsigned char>^ pixelBuffer, int width, int height, array<int>^ ops, array<int>^ parameters)
+{
+    try
+    {
+        FilterPipeline pipeline;
+        if (!BuildPipeline(ops, parameters, pipeline)) return false;
+
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        pipeline.Run(nativePixels, width, height);
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyPipeline(array<unsigned char>^ pixelBuffer, int width, int height, array<int>^ ops, array<int>^ parameters,
+                                                       int roiX, int roiY, int roiWidth, int roiHeight)
+{
+    if (pixelBuffer == nullptr || width <= 0 || height <= 0) return false;
+    if (pixelBuffer->Length < static_cast<long long>(width) * height * 4) return false;
+
+    try
+    {
+        FilterPipeline pipeline;
+        if (!BuildPipeline(ops, parameters, pipeline)) return false;
+
+        pin_ptr<unsigned char> nativePixels = &pixelBuffer[0];
+        const ImageView image = ImageView::BGRA(nativePixels, width, height);
+        return pipeline.Run(image, image, ImageRect{ roiX, roiY, roiWidth, roiHeight });
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyPipeline(IntPtr source, int sourceStride, IntPtr destination, int destinationStride,
+                                                       int width, int height, int roiX, int roiY, int roiWidth, int roiHeight,
+                                                       int bytesPerPixel, array<int>^ ops, array<int>^ parameters)
+{
+    if (source == IntPtr::Zero || width <= 0 || height <= 0) return false;
+    if (bytesPerPixel != 1 && bytesPerPixel != 4) return false;
+    if (destination == IntPtr::Zero)
+    {
+        destination = source;
+        destinationStride = sourceStride;
+    }
+
+    // 버퍼 크기는 알 수 없으므로 영상 한 행이 행 간격 안에 들어가는지만 확인한다 (ROI 범위는 Run이 확인)
+    const long long rowBytes = static_cast<long long>(width) * bytesPerPixel;
+    if (sourceStride <= 0 || destinationStride <= 0 || rowBytes > sourceStride || rowBytes > destinationStride) return false;
+
+    try
+    {
+        FilterPipeline pipeline;
+        if (!BuildPipeline(ops, parameters, pipeline)) return false;
+
+        // 영상 전체 뷰에 ROI를 넘겨 ROI 주위 할로를 읽게 한다 (가장자리 규칙도 원래 영상 경계 기준)
+        const ImageView sourceImage = ImageView{ static_cast<unsigned char*>(source.ToPointer()), width, height,
+                                                 static_cast<size_t>(sourceStride), bytesPerPixel };
+        const ImageView destinationImage = ImageView{ static_cast<unsigned char*>(destination.ToPointer()), width, height,
+                                                      static_cast<size_t>(destinationStride), bytesPerPixel };
+        return pipeline.Run(sourceImage, destinationImage, ImageRect{ roiX, roiY, roiWidth, roiHeight });
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool ImageProcessingEngine::ImageEngine::ApplyPipelineTiled(String^ inputPath, String^ outputPath, int width, int height, int bytesPerPixel,
+                                                            array<int>^ ops, array<int>^ parameters, int tileSize, int threadCount)
+{
+    if (String::IsNullOrEmpty(inputPath) || String::IsNullOrEmpty(outputPath)) return false;
+
+    try
+    {
+        FilterPipeline pipeline;
+        if (!BuildPipeline(ops, parameters, pipeline)) return false;
+
+        TiledProcessor processor(pipeline);
+        if (tileSize > 0) processor.SetTileSize(tileSize, tileSize);
+        processor.SetThreadCount(threadCount);
+
+        std::string input = ToUtf8(inputPath);
+        std::string output = ToUtf8(outputPath);
+        return processor.Run(input.c_str(), output.c_str(), width, height, bytesPerPixel);
+    }
+    catch (...)
+    {
+        return false;
+    }
 }
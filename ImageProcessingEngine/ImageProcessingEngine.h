@@ -2,30 +2,360 @@
 
 using namespace System;
 
+class FFTProcessor;
+class TileHistory;
+class ProgressivePreview;
+class JobControl;
+
 namespace ImageProcessingEngine {
+    // 주파수 필터 모양 (네이티브 FrequencyFilterShape와 같은 값)
+    public enum class FrequencyFilterShape
+    {
+        Ideal,
+        Butterworth,    // order 차수
+        Gaussian,
+    };
+
+    // 파이프라인 연산 (네이티브 FilterOp과 같은 값, ApplyPipeline의 ops에 int로 넘긴다)
+    public enum class FilterOperation
+    {
+        Grayscale,
+        GaussianBlur,
+        Sobel,
+        Laplacian,
+        Binarization,
+        Dilation,
+        Erosion,
+        MedianFilter,
+        Opening,
+        Closing,
+        MorphologyGradient,
+        TopHat,
+        BlackHat,
+    };
+
+    // 적응형 이진화 방식 (네이티브 AdaptiveMethod와 같은 값). k의 의미와 기본값:
+    // Mean T = 평균 - k (5), Niblack T = 평균 + k·표준편차 (-0.2), Sauvola T = 평균·(1 + k(표준편차/128 - 1)) (0.34)
+    public enum class AdaptiveThresholdMethod
+    {
+        Mean,
+        Niblack,
+        Sauvola,
+    };
+
+    // 엣지/그래디언트 미분 연산자 (네이티브 GradientOperator와 같은 값)
+    public enum class EdgeOperator
+    {
+        Sobel,
+        Scharr,
+    };
+
+    // 템플릿 매칭 결과: (X, Y)는 템플릿 왼쪽 위 모서리(서브픽셀), Score는 NCC (-1 ~ 1)
+    public value struct TemplateMatchResult
+    {
+        float X;
+        float Y;
+        float Score;
+    };
+
+    // 연결 요소(블롭) 통계: 외접 사각형 (Left, Top, Width, Height), 무게 중심, 평균 밝기 (0 ~ 255)
+    public value struct BlobInfo
+    {
+        Int64 Area;
+        int Left;
+        int Top;
+        int Width;
+        int Height;
+        double CentroidX;
+        double CentroidY;
+        double MeanIntensity;
+    };
+
+    // 공용 작업 버퍼 풀 사용량 (바이트, 크기 등급 기준). Peak*는 마지막 ResetScratchPeaks 이후 최고치
+    public value struct ScratchMemoryStats
+    {
+        Int64 InUseBytes;
+        Int64 PeakInUseBytes;
+        Int64 ReservedBytes;
+        Int64 PeakReservedBytes;
+        Int64 AcquireCount;
+        Int64 SystemAllocations;    // 풀에 맞는 버퍼가 없어 새로 할당한 횟수 (정상 상태에서는 늘지 않음)
+    };
+
+    // 연산 이름별 계측 집계. Calls/TotalMs/MinMs/MaxMs/Pixels/*Bytes는 누적, 나머지는 최근 호출 창 기준.
+    // Histogram[i]는 [2^i, 2^(i+1)) µs 구간 호출 수, Backend는 마지막 호출의 "경로/SIMD" (예: "fft/avx2")
+    public value struct OperationStats
+    {
+        String^ Name;
+        Int64 Calls;
+        double TotalMs;
+        double MeanMs;
+        double MinMs;
+        double MaxMs;
+        double P50Ms;
+        double P95Ms;
+        double P99Ms;
+        double NsPerPixel;
+        Int64 Pixels;
+        Int64 ScratchBytes;
+        Int64 AllocatedBytes;
+        int Threads;
+        String^ Backend;
+        array<Int64>^ Histogram;
+    };
+
+    // FFT 컨텍스트: 스펙트럼/변환 계획/작업 버퍼를 인스턴스마다 따로 가진다.
+    // 검사 스테이션마다 하나씩 만들면 한 프로세스에서 동시에 변환할 수 있다.
+    public ref class FFTContext
+    {
+    public:
+        FFTContext();
+        ~FFTContext();
+        !FFTContext();
+
+        bool ApplyFFT(array<unsigned char>^ pixelBuffer, int width, int height);
+        bool ApplyIFFT(array<unsigned char>^ pixelBuffer, int width, int height);
+        bool HasData();
+        void Clear();
+
+        // 보관된 스펙트럼에 필터를 제자리로 곱한 뒤 역변환 결과를 pixelBuffer에 기록한다.
+        // 순변환은 다시 하지 않으며, 연달아 호출하면 필터가 누적된다.
+        // 주파수 단위는 cycles/pixel (주기 P 화소 패턴 = 1/P, 최대 0.5)
+        bool ApplyLowPass(array<unsigned char>^ pixelBuffer, int width, int height,
+                          FrequencyFilterShape shape, float cutoff, int order);
+        bool ApplyHighPass(array<unsigned char>^ pixelBuffer, int width, int height,
+                           FrequencyFilterShape shape, float cutoff, int order);
+        bool ApplyBandPass(array<unsigned char>^ pixelBuffer, int width, int height,
+                           FrequencyFilterShape shape, float center, float bandwidth, int order);
+        // (frequencyX, frequencyY)와 그 켤레 위치 주변 반경 radius를 제거 (주기 패턴 제거용)
+        bool ApplyNotch(array<unsigned char>^ pixelBuffer, int width, int height,
+                        FrequencyFilterShape shape, float frequencyX, float frequencyY, float radius, int order);
+
+    private:
+        FFTProcessor* m_processor;
+    };
+
+    // 되돌리기/다시 실행 기록 (BGRA 버퍼). 영상을 타일로 나눠 바뀐 타일만 보관하고(같은 타일은 한 벌),
+    // Restore는 basisState 상태와 다른 타일만 pixelBuffer에 다시 쓴다.
+    // 사용 예: basis = CurrentState(); Undo(); Restore(buffer, basis)  (buffer는 basis 상태 화소를 담고 있어야 함)
+    // EngineJob이 걸린 스레드에서 호출해도 작업 취소와 무관하게 끝까지 기록/복원한다
+    public ref class ImageHistory
+    {
+    public:
+        ImageHistory(int tileSize);
+        ~ImageHistory();
+        !ImageHistory();
+
+        // 보관 크기 상한(바이트). 넘으면 가장 오래된 상태부터 버린다. 0이면 무제한
+        void SetMemoryBudget(Int64 bytes);
+        // 새 타일 LZ4 압축 여부
+        void SetCompression(bool enabled);
+
+        bool Push(array<unsigned char>^ pixelBuffer, int width, int height);
+        bool CanUndo();
+        bool CanRedo();
+        bool Undo();
+        bool Redo();
+
+        // 현재 상태 식별자 (없으면 0)와 크기
+        Int64 CurrentState();
+        int Width();
+        int Height();
+
+        // 현재 상태를 pixelBuffer(Width() x Height() BGRA)에 기록. basisState 0이면 전체
+        bool Restore(array<unsigned char>^ pixelBuffer, Int64 basisState);
+
+        Int64 StoredBytes();
+        int StateCount();
+        void Clear();
+
+    private:
+        TileHistory* m_history;
+    };
+
+    // 점진적 미리보기 결과: 원본의 1/2^Level 크기 BGRA 화소 (Level 0이면 전체 해상도 최종 결과)
+    public value struct PreviewFrame
+    {
+        array<unsigned char>^ Pixels;
+        int Width;
+        int Height;
+        int Level;
+    };
+
+    // 점진적 미리보기 컨텍스트: 원본별 축소 피라미드와 파이프라인별 측정 속도를 보관한다.
+    // 파라미터를 바꿔 가며 같은 영상에 반복 호출하면 피라미드를 다시 만들지 않는다. 한 번에 한 스레드에서만 호출
+    public ref class PreviewContext
+    {
+    public:
+        PreviewContext();
+        ~PreviewContext();
+        !PreviewContext();
+
+        // pixelBuffer(BGRA)에 파이프라인을 축소 해상도로 적용한 미리보기를 latencyBudgetMs 안에 만든다 (원본은 그대로).
+        // sourceId는 원본 내용 식별자(같은 내용이면 같은 값, 0은 캐시 안 함). 실패 시 Pixels가 nullptr
+        PreviewFrame Run(array<unsigned char>^ pixelBuffer, int width, int height, Int64 sourceId,
+                         array<int>^ ops, array<int>^ parameters, double latencyBudgetMs);
+
+        // 전체 해상도 실행 시간(ms)을 알려 주면 다음 레벨 선택에 반영한다
+        void RecordFullRun(array<int>^ ops, array<int>^ parameters, int width, int height, double milliseconds);
+
+        void Clear();
+
+    private:
+        ProgressivePreview* m_preview;
+    };
+
+    // 취소 가능한 엔진 작업. Enter()로 호출 스레드에 걸어 두면 그 스레드에서 호출한 엔진 연산이
+    // 행 밴드마다 취소를 확인하고 진행률을 알린다. 취소된 연산은 false(또는 빈 결과)를 반환하고
+    // 버퍼는 일부만 처리된 상태로 남으므로 버린다. Cancel/IsCanceled/Progress는 아무 스레드에서나 호출할 수 있고,
+    // Dispose는 작업을 건 연산이 모두 끝난 뒤에 한다.
+    // 사용 예: Task.Run(() => { using (job.Enter()) engine.ApplyMedianFilter(...); }); ... job.Cancel();
+    public ref class EngineJob
+    {
+    public:
+        EngineJob();
+        ~EngineJob();
+        !EngineJob();
+
+        void Cancel();
+        property bool IsCanceled { bool get(); }
+
+        // 0 ~ 1. 여러 단계 연산은 다음 단계가 시작될 때 값이 되돌아갈 수 있다
+        property double Progress { double get(); }
+
+        // 호출 스레드에 이 작업을 건다. 반환값을 Dispose하면 이전 상태로 돌아간다 (같은 스레드에서 Dispose해야 함)
+        IDisposable^ Enter();
+
+        // 호출 스레드에 걸린 작업이 취소됐는지 (걸린 작업이 없으면 false)
+        static property bool IsCurrentCanceled { bool get(); }
+
+    private:
+        JobControl* m_control;
+    };
+
     public ref class ImageEngine
     {
     public:
+        ImageEngine();
+
+        // 네이티브 연산이 함께 쓰는 공용 스레드 풀 설정 (모든 ImageEngine 인스턴스 공통).
+        // threads 0은 하드웨어 스레드 수, pinThreads는 작업 스레드를 CPU 코어에 고정. 처리 중이 아닐 때 호출
+        static void SetThreadCount(int threads);
+        static int GetThreadCount();
+        static void SetThreadAffinity(bool pinThreads);
+
+        // 연산 사이에 재사용하는 임시 버퍼 풀 (모든 ImageEngine 인스턴스 공통).
+        // 대기 중인 버퍼는 max(64 MB, 마지막 TrimScratch 이후 사용 중 최고치)까지만 남는다.
+        // TrimScratch는 대기 중인 버퍼를 모두 해제한다 (다른 크기 영상으로 바꿀 때, 큰 영상 처리 후 메모리 반환용)
+        static ScratchMemoryStats GetScratchStats();
+        static void ResetScratchPeaks();
+        static void TrimScratch();
+
+        // 연산별 성능 계측 (모든 ImageEngine 인스턴스 공통). 꺼져 있으면 비용이 거의 없다.
+        // 추적은 호출 하나하나를 보관해 WriteTrace로 Chrome trace JSON(chrome://tracing, ui.perfetto.dev)을 쓴다
+        static void SetProfiling(bool enabled);
+        static void SetTracing(bool enabled);
+        static array<OperationStats>^ GetOperationStats();
+        static bool WriteTrace(String^ path);
+        static void ResetProfiling();
+
         bool ApplyGrayscale(array<unsigned char>^ pixelBuffer, int width, int height);
 
         // --- 새로 추가된 함수 ---
         bool ApplyGaussianBlur(array<unsigned char>^ pixelBuffer, int width, int height);
+
+        // 시그마 지정 가우시안 (0.5 ~ 50 이상). σ ≥ 2는 시그마와 무관한 비용의 재귀(IIR) 경로를 쓴다
+        bool ApplyGaussianBlur(array<unsigned char>^ pixelBuffer, int width, int height, float sigma);
         bool ApplySobel(array<unsigned char>^ pixelBuffer, int width, int height);
         bool ApplyLaplacian(array<unsigned char>^ pixelBuffer, int width, int height);
         bool ApplyErosion(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize);
         // 이진화: threshold 파라미터 추가
         bool ApplyBinarization(array<unsigned char>^ pixelBuffer, int width, int height, int threshold);
 
+        // 오츠 자동 이진화. threshold에 사용한 임계값(0..255)을 돌려준다
+        bool ApplyOtsuBinarization(array<unsigned char>^ pixelBuffer, int width, int height,
+                                   [Runtime::InteropServices::Out] int% threshold);
+
+        // 적응형(국소) 이진화. 화소당 비용이 창 크기와 무관하다 (windowSize >= 3, 최대 4095).
+        // k를 생략하면 방식별 기본값을 쓴다
+        bool ApplyAdaptiveThreshold(array<unsigned char>^ pixelBuffer, int width, int height,
+                                    AdaptiveThresholdMethod method, int windowSize);
+        bool ApplyAdaptiveThreshold(array<unsigned char>^ pixelBuffer, int width, int height,
+                                    AdaptiveThresholdMethod method, int windowSize, float k);
+
         // 팽창: kernelSize 파라미터 추가
         bool ApplyDilation(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize);
 
         // 중앙값 필터: kernelSize 파라미터 추가
         bool ApplyMedianFilter(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize);
 
-        // --- FFT 함수들 추가 ---
+        // 열림/닫힘/형태학적 그래디언트/탑햇/블랙햇: 커널 크기와 무관한 비용
+        bool ApplyOpening(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize);
+        bool ApplyClosing(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize);
+        bool ApplyMorphologyGradient(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize);
+        bool ApplyTopHat(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize);
+        bool ApplyBlackHat(array<unsigned char>^ pixelBuffer, int width, int height, int kernelSize);
+
+        // kSize x kSize 임의 커널 컨볼루션. 큰 커널은 자동으로 FFT 경로를 사용한다
+        bool ApplyConvolution(array<unsigned char>^ pixelBuffer, int width, int height, array<float>^ kernel, int kSize);
+
+        // 정규화 상호상관 템플릿 매칭 (피라미드 거친→세밀 탐색). 점수 내림차순, 실패 시 빈 배열
+        array<TemplateMatchResult>^ MatchTemplate(array<unsigned char>^ pixelBuffer, int width, int height,
+                                                  array<unsigned char>^ templateBuffer, int templateWidth, int templateHeight,
+                                                  int maxMatches, float minScore);
+
+        // 연결 요소 라벨링 (병렬 union-find). maskBuffer의 B/G/R 중 하나라도 0이 아닌 화소가 전경이며,
+        // intensityBuffer(같은 크기 BGRA, nullptr 가능)의 그레이 값으로 평균 밝기를 구한다.
+        // 블롭은 첫 화소의 래스터 순서. 실패 시 빈 배열
+        array<BlobInfo>^ LabelComponents(array<unsigned char>^ maskBuffer, array<unsigned char>^ intensityBuffer,
+                                         int width, int height, bool eightConnected);
+
+        // 캐니 엣지 검출 (제자리). 엣지 화소의 B/G/R은 255, 나머지는 0이며 alpha는 유지한다.
+        // 임계값은 그래디언트 크기 기준이다 (생략 시 Sobel, L2 = sqrt(gx² + gy²))
+        bool ApplyCanny(array<unsigned char>^ pixelBuffer, int width, int height, int lowThreshold, int highThreshold);
+        bool ApplyCanny(array<unsigned char>^ pixelBuffer, int width, int height, int lowThreshold, int highThreshold,
+                        EdgeOperator edgeOperator, bool l2Norm);
+
+        // 그래디언트 크기(L2면 sqrt 절삭, 아니면 |gx| + |gy|)와 방향 코드(0..7, 45° 단위, 0 = +x, 2 = 아래)를
+        // width x height 배열에 쓴다. orientation은 nullptr 가능
+        bool ComputeGradient(array<unsigned char>^ pixelBuffer, int width, int height, EdgeOperator edgeOperator,
+                             bool l2Norm, array<UInt16>^ magnitude, array<unsigned char>^ orientation);
+
+        // 융합 파이프라인: ops[i]는 FilterOp 값, parameters[i]는 해당 연산의 파라미터
+        bool ApplyPipeline(array<unsigned char>^ pixelBuffer, int width, int height, array<int>^ ops, array<int>^ parameters);
+
+        // 선택 영역(ROI)에만 적용: ROI와 커널 할로만 읽고 ROI만 쓴다. ROI 안의 결과는 영상 전체에 적용한 결과와 같다
+        bool ApplyPipeline(array<unsigned char>^ pixelBuffer, int width, int height, array<int>^ ops, array<int>^ parameters,
+                           int roiX, int roiY, int roiWidth, int roiHeight);
+
+        // 호출자 소유 버퍼(WriteableBitmap.BackBuffer, 프레임 그래버 버퍼 등)를 복사 없이 처리한다.
+        // source/destination은 width x height 영상의 시작 주소와 행 간격(바이트)이며 ROI와 그 할로만 읽고
+        // ROI만 쓴다 (ROI 안의 결과는 영상 전체에 적용한 결과와 같다).
+        // destination이 IntPtr::Zero면 source에 제자리로 기록. bytesPerPixel: BGRA 4, 그레이 1
+        bool ApplyPipeline(IntPtr source, int sourceStride, IntPtr destination, int destinationStride,
+                           int width, int height, int roiX, int roiY, int roiWidth, int roiHeight, int bytesPerPixel,
+                           array<int>^ ops, array<int>^ parameters);
+
+        // 같은 파이프라인을 원시 영상 파일(헤더 없음, BGRA 4 / 그레이 1바이트)에 타일 단위로 적용해 outputPath에 쓴다.
+        // 영상 전체를 메모리에 올리지 않으므로 기가픽셀 영상도 처리할 수 있다. threadCount 0은 하드웨어 스레드 수
+        bool ApplyPipelineTiled(String^ inputPath, String^ outputPath, int width, int height, int bytesPerPixel,
+                                array<int>^ ops, array<int>^ parameters, int tileSize, int threadCount);
+
+        // --- FFT 함수들 추가 (엔진 인스턴스마다 별도 컨텍스트) ---
         bool ApplyFFT(array<unsigned char>^ pixelBuffer, int width, int height);
         bool ApplyIFFT(array<unsigned char>^ pixelBuffer, int width, int height);
         bool HasFFTData();
         void ClearFFTData();
+
+        // 주파수 영역 필터 (FFT 컨텍스트의 스펙트럼에 적용 후 역변환)
+        bool ApplyLowPass(array<unsigned char>^ pixelBuffer, int width, int height, FrequencyFilterShape shape, float cutoff, int order);
+        bool ApplyHighPass(array<unsigned char>^ pixelBuffer, int width, int height, FrequencyFilterShape shape, float cutoff, int order);
+        bool ApplyBandPass(array<unsigned char>^ pixelBuffer, int width, int height, FrequencyFilterShape shape, float center, float bandwidth, int order);
+        bool ApplyNotch(array<unsigned char>^ pixelBuffer, int width, int height, FrequencyFilterShape shape, float frequencyX, float frequencyY, float radius, int order);
+
+        property FFTContext^ FFT { FFTContext^ get() { return m_fft; } }
+
+    private:
+        FFTContext^ m_fft;
     };
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+﻿#include "pch.h"
+#include "ImagePyramid.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+void ImagePyramid::SetSource(const ImageView& source, uint64_t sourceId)
+{
+    const bool sameSource = sourceId != 0 && sourceId == m_sourceId && source.width == m_source.width &&
+                            source.height == m_source.height && source.bytesPerPixel == m_source.bytesPerPixel;
+    if (!sameSource) m_levels.clear();
+    m_source = source.IsValid() ? source : ImageView{};
+    m_sourceId = sourceId;
+}
+
+int ImagePyramid::LevelCount() const
+{
+    if (m_source.data == nullptr) return 0;
+    int levels = 1;
+    while (levels < kMaxLevels && LevelWidth(m_source.width, levels) >= kMinSide &&
+           LevelHeight(m_source.height, levels) >= kMinSide)
+    {
+        ++levels;
+    }
+    return levels;
+}
+
+ImageView ImagePyramid::Level(int level)
+{
+    if (level < 0 || level >= LevelCount()) return ImageView{};
+    if (level == 0) return m_source;
+
+    const int bytesPerPixel = m_source.bytesPerPixel;
+    auto levelView = [&](int l)
+    {
+        if (l == 0) return m_source;
+        const int w = LevelWidth(m_source.width, l);
+        return ImageView{ m_levels[l - 1].data(), w, LevelHeight(m_source.height, l),
+                          static_cast<size_t>(w) * bytesPerPixel, bytesPerPixel };
+    };
+
+    while (static_cast<int>(m_levels.size()) < level)
+    {
+        const int l = static_cast<int>(m_levels.size()) + 1;
+        const int w = LevelWidth(m_source.width, l);
+        const int h = LevelHeight(m_source.height, l);
+        m_levels.emplace_back(static_cast<size_t>(w) * h * bytesPerPixel);
+        Downsample(levelView(l - 1), levelView(l));
+    }
+    return levelView(level);
+}
+
+template <int bpp>
+static void DownsampleRows(const ImageView& src, const ImageView& dst, int y0, int y1)
+{
+    const int lastX = src.width - 1;
+    for (int y = y0; y < y1; ++y)
+    {
+        const unsigned char* a = src.Row(2 * y);
+        const unsigned char* b = src.Row(std::min(2 * y + 1, src.height - 1));
+        unsigned char* d = dst.Row(y);
+        for (int x = 0; x < dst.width; ++x)
+        {
+            const int x0 = 2 * x * bpp;
+            const int x1 = std::min(2 * x + 1, lastX) * bpp;
+            for (int c = 0; c < bpp; ++c)
+            {
+                d[x * bpp + c] = static_cast<unsigned char>((a[x0 + c] + a[x1 + c] + b[x0 + c] + b[x1 + c] + 2) >> 2);
+            }
+        }
+    }
+}
+
+void ImagePyramid::Downsample(const ImageView& src, const ImageView& dst)
+{
+    if (!src.IsValid() || !dst.IsValid() || src.bytesPerPixel != dst.bytesPerPixel) return;
+    if (dst.width != LevelWidth(src.width, 1) || dst.height != LevelHeight(src.height, 1)) return;
+
+    const int grain = std::max(8, (1 << 16) / std::max(1, dst.width));
+    ThreadPool::Shared().ParallelFor(0, dst.height, grain, [&](int y0, int y1)
+        {
+            if (src.bytesPerPixel == 4)
+            {
+                DownsampleRows<4>(src, dst, y0, y1);
+            }
+            else
+            {
+                DownsampleRows<1>(src, dst, y0, y1);
+            }
+        });
+}
+
+void ImagePyramid::Clear()
+{
+    m_levels.clear();
+    m_levels.shrink_to_fit();
+    m_source = ImageView{};
+    m_sourceId = 0;
+}
@@ -0,0 +1,45 @@
+﻿#pragma once
+
+#include "ImageView.h"
+#include <cstdint>
+#include <vector>
+
+// =====================================================
+//  축소 피라미드 (BGRA 또는 그레이)
+//  레벨 l은 레벨 l-1을 2x2 상자 평균(반올림)으로 줄인 ceil(w / 2^l) x ceil(h / 2^l) 영상이다.
+//  홀수 크기의 마지막 행/열은 가장자리 화소를 반복해 평균하므로 버려지는 화소가 없다.
+//  레벨은 처음 요청될 때 만들어 보관하고, 같은 원본(sourceId)이면 다시 만들지 않는다.
+//  레벨 0은 원본 뷰 그대로이며 복사하지 않는다. 스레드 안전하지 않다 (호출자가 직렬화).
+// =====================================================
+class ImagePyramid
+{
+public:
+    static const int kMaxLevels = 10;
+    // 이 크기보다 작은 변을 가진 레벨은 만들지 않는다
+    static const int kMinSide = 16;
+
+    // 원본 지정. sourceId가 0이 아니고 직전과 같으며 크기/형식도 같으면 만들어 둔 레벨을 유지한다
+    // (원본 내용이 바뀌면 다른 id를 넘겨야 한다). 원본 버퍼는 다음 SetSource까지 유효해야 한다
+    void SetSource(const ImageView& source, uint64_t sourceId);
+
+    // 사용할 수 있는 레벨 수 (레벨 0 포함, 1 이상). 원본이 없으면 0
+    int LevelCount() const;
+
+    // 레벨 영상 (없으면 만든다). 범위 밖이면 빈 뷰
+    ImageView Level(int level);
+
+    // 레벨 level의 크기 (만들지 않고 계산만)
+    static int LevelWidth(int width, int level) { return ((width - 1) >> level) + 1; }
+    static int LevelHeight(int height, int level) { return ((height - 1) >> level) + 1; }
+
+    // src를 2x2 상자 평균으로 줄여 dst에 쓴다 (dst 크기는 LevelWidth/LevelHeight(…, 1), 같은 형식)
+    static void Downsample(const ImageView& src, const ImageView& dst);
+
+    // 보관한 레벨을 모두 버린다
+    void Clear();
+
+private:
+    ImageView m_source;
+    uint64_t m_sourceId = 0;
+    std::vector<std::vector<unsigned char>> m_levels;   // m_levels[l - 1] = 레벨 l
+};
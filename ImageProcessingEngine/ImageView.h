@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include <cstddef>
+
+// 영상 안의 사각 영역 (화소 단위)
+struct ImageRect
+{
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    bool IsEmpty() const { return width <= 0 || height <= 0; }
+};
+
+// =====================================================
+//  호출자 소유 영상 버퍼를 가리키는 뷰 (복사 없음)
+//  행 간격(stride)이 width * bytesPerPixel보다 클 수 있으므로 패딩된 버퍼
+//  (WriteableBitmap 백 버퍼, 프레임 그래버 버퍼)나 큰 영상 안의 ROI를 그대로 가리킬 수 있다.
+// =====================================================
+struct ImageView
+{
+    unsigned char* data = nullptr;  // (0, 0) 화소 주소
+    int width = 0;
+    int height = 0;
+    size_t stride = 0;              // 행 간격(바이트)
+    int bytesPerPixel = 4;          // BGRA 4, 그레이 1
+
+    // stride 0은 빈틈 없는 버퍼 (width * bytesPerPixel)
+    static ImageView BGRA(unsigned char* pixels, int width, int height, size_t stride = 0)
+    {
+        return ImageView{ pixels, width, height, stride ? stride : static_cast<size_t>(width) * 4, 4 };
+    }
+
+    static ImageView Gray(unsigned char* pixels, int width, int height, size_t stride = 0)
+    {
+        return ImageView{ pixels, width, height, stride ? stride : static_cast<size_t>(width), 1 };
+    }
+
+    bool IsValid() const
+    {
+        return data != nullptr && width > 0 && height > 0 && (bytesPerPixel == 1 || bytesPerPixel == 4) &&
+               stride >= static_cast<size_t>(width) * bytesPerPixel;
+    }
+
+    unsigned char* Row(int y) const { return data + static_cast<size_t>(y) * stride; }
+
+    // (x, y)에서 시작하는 w x h 영역. 영상 밖으로 벗어나면 빈 뷰
+    ImageView Sub(int x, int y, int w, int h) const
+    {
+        if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > width || y + h > height) return ImageView{};
+        return ImageView{ Row(y) + static_cast<size_t>(x) * bytesPerPixel, w, h, stride, bytesPerPixel };
+    }
+
+    ImageView Sub(const ImageRect& rect) const { return Sub(rect.x, rect.y, rect.width, rect.height); }
+};
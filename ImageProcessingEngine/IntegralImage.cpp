@@ -0,0 +1,93 @@
+﻿#include "pch.h"
+#include "IntegralImage.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+// 세로 누적 단계에서 한 조각이 맡는 열 수 (행 하나의 조각이 캐시 라인 여러 개를 채우도록)
+static const int kColumnBlock = 256;
+static const int kMinRowsPerTask = 16;
+
+void IntegralImage::Build(const unsigned char* plane, int width, int height, size_t stride, bool withSquares)
+{
+    if (plane == nullptr || width <= 0 || height <= 0)
+    {
+        Clear();
+        return;
+    }
+
+    m_width = width;
+    m_height = height;
+    const size_t tableSize = static_cast<size_t>(width + 1) * (height + 1);
+    if (m_sum.Size() != tableSize * sizeof(uint32_t))
+    {
+        m_sum = ScratchArena::Shared().Acquire(tableSize * sizeof(uint32_t));
+    }
+    if (!withSquares)
+    {
+        m_squares.Release();
+    }
+    else if (m_squares.Size() != tableSize * sizeof(uint64_t))
+    {
+        m_squares = ScratchArena::Shared().Acquire(tableSize * sizeof(uint64_t));
+    }
+
+    uint32_t* sumTable = m_sum.As<uint32_t>();
+    uint64_t* squareTable = m_squares.As<uint64_t>();
+    std::fill(sumTable, sumTable + width + 1, 0u);
+    if (withSquares) std::fill(squareTable, squareTable + width + 1, 0ull);
+
+    // 1단계: 행마다 가로 누적합 (행끼리 독립)
+    const int grain = std::max(kMinRowsPerTask, (1 << 16) / width);
+    ThreadPool::Shared().ParallelFor(0, height, grain, [&](int y0, int y1)
+        {
+            for (int y = y0; y < y1; ++y)
+            {
+                const unsigned char* s = plane + static_cast<size_t>(y) * stride;
+                uint32_t* sumRow = sumTable + Index(0, y + 1);
+                uint32_t sum = 0;
+                sumRow[0] = 0;
+                for (int x = 0; x < width; ++x)
+                {
+                    sum += s[x];
+                    sumRow[x + 1] = sum;
+                }
+                if (!withSquares) continue;
+
+                uint64_t* squareRow = squareTable + Index(0, y + 1);
+                uint64_t squares = 0;
+                squareRow[0] = 0;
+                for (int x = 0; x < width; ++x)
+                {
+                    squares += static_cast<uint32_t>(s[x]) * s[x];
+                    squareRow[x + 1] = squares;
+                }
+            }
+        });
+
+    // 2단계: 열 블록마다 위에서 아래로 누적 (블록끼리 독립, 블록 안은 행 순서대로 연속 접근)
+    const int columns = width + 1;
+    const int blocks = (columns + kColumnBlock - 1) / kColumnBlock;
+    ThreadPool::Shared().ParallelFor(0, blocks, 1, [&](int b0, int b1)
+        {
+            const int x0 = b0 * kColumnBlock;
+            const int x1 = std::min(columns, b1 * kColumnBlock);
+            for (int y = 2; y <= height; ++y)
+            {
+                const uint32_t* above = sumTable + Index(0, y - 1);
+                uint32_t* row = sumTable + Index(0, y);
+                for (int x = x0; x < x1; ++x) row[x] += above[x];
+                if (!withSquares) continue;
+
+                const uint64_t* squaresAbove = squareTable + Index(0, y - 1);
+                uint64_t* squareRow = squareTable + Index(0, y);
+                for (int x = x0; x < x1; ++x) squareRow[x] += squaresAbove[x];
+            }
+        });
+}
+
+void IntegralImage::Clear()
+{
+    m_width = m_height = 0;
+    m_sum.Release();
+    m_squares.Release();
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+
+#include "ScratchArena.h"
+#include <cstddef>
+#include <cstdint>
+
+// =====================================================
+//  적분 영상(summed-area table): 임의 사각형의 화소 합/제곱합을 네 번의 조회로 구한다.
+//  (width + 1) x (height + 1) 표이며 0번 행/열은 0이다. 합 표는 32비트로 2^32에서 순환하지만
+//  사각형 합은 모듈러 뺄셈으로 구하므로 사각형 안 실제 합이 2^32 미만(면적 16,843,009 화소 이하)이면
+//  정확하다. 제곱합 표는 64비트다.
+//  표는 공용 작업 버퍼 풀에서 빌리므로 연산마다 만들어도 같은 크기면 새 할당이 없다 (이동만 가능).
+//  구성은 공용 스레드 풀로 병렬 처리한다.
+// =====================================================
+class IntegralImage
+{
+public:
+    // 사각형 합이 정확한 최대 면적 (255 x 면적 < 2^32)
+    static const int64_t kMaxExactArea = 0xFFFFFFFFll / 255;
+
+    // plane: 1 byte/pixel 영상 (행 간격 stride 바이트). withSquares가 false면 제곱합 표를 만들지 않는다
+    void Build(const unsigned char* plane, int width, int height, size_t stride, bool withSquares = true);
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    bool HasSquares() const { return m_squares.Data() != nullptr; }
+
+    // [x0, x1) x [y0, y1) 사각형의 합 / 제곱합 (0 <= x0 <= x1 <= width, 0 <= y0 <= y1 <= height)
+    uint32_t Sum(int x0, int y0, int x1, int y1) const
+    {
+        const uint32_t* sum = m_sum.As<uint32_t>();
+        return sum[Index(x1, y1)] - sum[Index(x0, y1)] - sum[Index(x1, y0)] + sum[Index(x0, y0)];
+    }
+
+    uint64_t SquareSum(int x0, int y0, int x1, int y1) const
+    {
+        const uint64_t* squares = m_squares.As<uint64_t>();
+        return squares[Index(x1, y1)] - squares[Index(x0, y1)] - squares[Index(x1, y0)] + squares[Index(x0, y0)];
+    }
+
+    // 표 행 (y = 0 .. height, 원소 width + 1개). 연산자 내부 루프에서 직접 조회할 때 사용
+    const uint32_t* SumRow(int y) const { return m_sum.As<uint32_t>() + Index(0, y); }
+    const uint64_t* SquareRow(int y) const { return m_squares.As<uint64_t>() + Index(0, y); }
+
+    void Clear();
+
+private:
+    size_t Index(int x, int y) const { return static_cast<size_t>(y) * (m_width + 1) + x; }
+
+    int m_width = 0;
+    int m_height = 0;
+    ScratchArena::Buffer m_sum;         // uint32_t
+    ScratchArena::Buffer m_squares;     // uint64_t (withSquares일 때만)
+};
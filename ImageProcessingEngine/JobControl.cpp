@@ -0,0 +1,93 @@
+﻿#include "pch.h"
+#include "JobControl.h"
+#include <algorithm>
+#include <atomic>
+
+struct JobControl::Impl
+{
+    std::atomic<bool> cancelled{ false };
+    std::atomic<int64_t> total{ 0 };
+    std::atomic<int64_t> done{ 0 };
+};
+
+static thread_local JobControl* t_current = nullptr;
+static thread_local bool t_reporting = false;   // 바깥 연산이 진행률을 세는 중
+
+JobControl::JobControl()
+    : m_impl(std::make_unique<Impl>())
+{
+}
+
+JobControl::~JobControl() = default;
+
+void JobControl::Cancel()
+{
+    m_impl->cancelled.store(true, std::memory_order_release);
+}
+
+bool JobControl::IsCancelled() const
+{
+    return m_impl->cancelled.load(std::memory_order_acquire);
+}
+
+double JobControl::Progress() const
+{
+    const int64_t total = m_impl->total.load(std::memory_order_relaxed);
+    const int64_t done = m_impl->done.load(std::memory_order_relaxed);
+    if (total <= 0) return 0.0;
+    return std::min(1.0, static_cast<double>(done) / static_cast<double>(total));
+}
+
+void JobControl::AddWork(int64_t units)
+{
+    m_impl->total.fetch_add(units, std::memory_order_relaxed);
+}
+
+void JobControl::CompleteWork(int64_t units)
+{
+    m_impl->done.fetch_add(units, std::memory_order_relaxed);
+}
+
+void JobControl::Reset()
+{
+    m_impl->cancelled.store(false, std::memory_order_relaxed);
+    m_impl->total.store(0, std::memory_order_relaxed);
+    m_impl->done.store(0, std::memory_order_relaxed);
+}
+
+JobControl* JobControl::Current()
+{
+    return t_current;
+}
+
+void JobControl::ThrowIfCancelled()
+{
+    if (t_current != nullptr && t_current->IsCancelled()) throw OperationCanceled();
+}
+
+JobControl* JobControl::ProgressTarget()
+{
+    return t_reporting ? nullptr : t_current;
+}
+
+JobControl::Scope::Scope(JobControl* job)
+    : m_previous(t_current)
+{
+    t_current = job;
+}
+
+JobControl::Scope::~Scope()
+{
+    t_current = m_previous;
+}
+
+JobControl::ReportingScope::ReportingScope()
+    : m_previous(t_reporting)
+{
+    t_reporting = true;
+}
+
+JobControl::ReportingScope::~ReportingScope()
+{
+    t_reporting = m_previous;
+}
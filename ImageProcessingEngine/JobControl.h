@@ -0,0 +1,82 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+// 취소된 작업 안에서 연산이 중단될 때 던지는 예외 (ThreadPool::ParallelFor를 거쳐 호출 스레드로 전달된다)
+struct OperationCanceled : std::runtime_error
+{
+    OperationCanceled() : std::runtime_error("operation canceled") {}
+};
+
+// =====================================================
+//  취소 가능한 작업의 제어/진행률 핸들
+//  Scope로 호출 스레드에 작업을 걸어 두면 그 스레드의 ParallelFor가 조각(행 밴드)마다 취소를 확인하고,
+//  작업 스레드에도 같은 작업을 걸어 중첩 호출까지 멈춘다. 취소되면 OperationCanceled가 연산 밖으로 나오고
+//  연산이 쓰던 출력 버퍼는 일부만 처리된 상태로 남는다.
+//  진행률은 등록된 작업량(AddWork) 대비 완료량(CompleteWork)이다. 가장 바깥 ParallelFor와 밴드/타일을 직접 세는
+//  연산이 알리며, 여러 단계 연산은 다음 단계가 등록될 때 분모가 늘어나므로 값이 되돌아갈 수 있다.
+//  Cancel/IsCancelled/Progress는 아무 스레드에서나 호출해도 된다. 구현(원자 변수)은 .cpp에만 둔다 (C++/CLI 포함 가능).
+// =====================================================
+class JobControl
+{
+public:
+    JobControl();
+    ~JobControl();
+    JobControl(const JobControl&) = delete;
+    JobControl& operator=(const JobControl&) = delete;
+
+    void Cancel();
+    bool IsCancelled() const;
+
+    // 0 ~ 1 (등록된 작업이 없으면 0)
+    double Progress() const;
+
+    void AddWork(int64_t units);
+    void CompleteWork(int64_t units);
+
+    // 취소 상태와 진행률을 지워 다시 쓸 수 있게 한다 (실행 중이 아닐 때 호출)
+    void Reset();
+
+    // 호출 스레드에 걸린 작업 (없으면 nullptr)
+    static JobControl* Current();
+
+    // 호출 스레드의 작업이 취소됐으면 OperationCanceled를 던진다 (작업이 없으면 아무것도 하지 않음)
+    static void ThrowIfCancelled();
+
+    // 진행률을 알릴 작업. 호출 스레드에 걸린 작업이 없거나 바깥 연산이 이미 진행률을 세는 중(ReportingScope 안)이면 nullptr
+    static JobControl* ProgressTarget();
+
+    // 호출 스레드에 작업을 건다. 소멸 시 이전 작업으로 되돌린다 (같은 스레드에서 소멸해야 함)
+    class Scope
+    {
+    public:
+        explicit Scope(JobControl* job);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        JobControl* m_previous;
+    };
+
+    // 진행률을 직접 세는 구간. 안에서 호출한 연산(중첩 ParallelFor, 타일마다 실행하는 파이프라인 등)은
+    // ProgressTarget()이 nullptr이 되어 같은 일을 두 번 세지 않는다
+    class ReportingScope
+    {
+    public:
+        ReportingScope();
+        ~ReportingScope();
+        ReportingScope(const ReportingScope&) = delete;
+        ReportingScope& operator=(const ReportingScope&) = delete;
+
+    private:
+        bool m_previous;
+    };
+
+    struct Impl;
+
+private:
+    std::unique_ptr<Impl> m_impl;
+};
@@ -0,0 +1,229 @@
+﻿#include "pch.h"
+#include "Lz4Codec.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    const size_t kMinMatch = 4;
+    const size_t kLastLiterals = 5;     // 블록 끝 5바이트는 항상 리터럴
+    const size_t kMatchSearchLimit = 12; // 끝에서 12바이트 안쪽에서는 일치를 시작하지 않는다
+    const size_t kMaxOffset = 65535;
+    const int kHashBits = 12;
+
+    inline uint32_t Read32(const unsigned char* p)
+    {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline uint64_t Read64(const unsigned char* p)
+    {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    // 0이 아닌 값의 최하위 1비트 위치
+    inline int TrailingZeros(uint64_t v)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, v);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(v);
+#endif
+    }
+
+    // a와 b가 limit 앞까지 몇 바이트 같은지 (8바이트씩 비교)
+    inline size_t CommonLength(const unsigned char* a, const unsigned char* b, const unsigned char* limit)
+    {
+        const unsigned char* start = a;
+        while (limit - a >= 8)
+        {
+            const uint64_t diff = Read64(a) ^ Read64(b);
+            if (diff != 0) return static_cast<size_t>(a - start) + TrailingZeros(diff) / 8;
+            a += 8;
+            b += 8;
+        }
+        while (a < limit && *a == *b)
+        {
+            ++a;
+            ++b;
+        }
+        return static_cast<size_t>(a - start);
+    }
+
+    inline uint32_t HashOf(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - kHashBits);
+    }
+
+    // 15 이상 길이의 나머지를 255 단위로 기록
+    inline unsigned char* WriteLength(unsigned char* op, size_t length)
+    {
+        for (; length >= 255; length -= 255) *op++ = 255;
+        *op++ = static_cast<unsigned char>(length);
+        return op;
+    }
+
+    inline size_t LengthBytes(size_t length)
+    {
+        return length < 15 ? 0 : (length - 15) / 255 + 1;
+    }
+}
+
+namespace Lz4Codec
+{
+    size_t CompressBound(size_t size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    size_t Compress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity)
+    {
+        unsigned char* op = dst;
+        unsigned char* const end = dst + capacity;
+        size_t anchor = 0;
+
+        // 리터럴 [anchor, literalEnd)와 일치(offset, matchLength)를 시퀀스 하나로 기록
+        auto emit = [&](size_t literalEnd, size_t offset, size_t matchLength) -> bool
+        {
+            const size_t literals = literalEnd - anchor;
+            const size_t need = 1 + LengthBytes(literals) + literals +
+                                (matchLength ? 2 + LengthBytes(matchLength - kMinMatch) : 0);
+            if (need > static_cast<size_t>(end - op)) return false;
+
+            unsigned char* token = op++;
+            *token = static_cast<unsigned char>((literals < 15 ? literals : 15) << 4);
+            if (literals >= 15) op = WriteLength(op, literals - 15);
+            memcpy(op, src + anchor, literals);
+            op += literals;
+
+            if (matchLength)
+            {
+                *op++ = static_cast<unsigned char>(offset & 0xFF);
+                *op++ = static_cast<unsigned char>(offset >> 8);
+                const size_t code = matchLength - kMinMatch;
+                *token |= static_cast<unsigned char>(code < 15 ? code : 15);
+                if (code >= 15) op = WriteLength(op, code - 15);
+            }
+            return true;
+        };
+
+        if (size > kMatchSearchLimit)
+        {
+            int32_t table[1 << kHashBits];
+            for (int32_t& entry : table) entry = -1;
+
+            const size_t searchEnd = size - kMatchSearchLimit;
+            const size_t matchEnd = size - kLastLiterals;
+            size_t i = 0;
+            unsigned misses = 0;
+            while (i < searchEnd)
+            {
+                const uint32_t sequence = Read32(src + i);
+                const uint32_t h = HashOf(sequence);
+                const int32_t candidate = table[h];
+                table[h] = static_cast<int32_t>(i);
+
+                if (candidate < 0 || i - static_cast<size_t>(candidate) > kMaxOffset || Read32(src + candidate) != sequence)
+                {
+                    // 압축이 안 되는 구간은 점점 크게 건너뛴다
+                    i += 1 + (misses++ >> 6);
+                    continue;
+                }
+                misses = 0;
+
+                size_t ref = static_cast<size_t>(candidate);
+                while (i > anchor && ref > 0 && src[i - 1] == src[ref - 1])
+                {
+                    --i;
+                    --ref;
+                }
+                const size_t length = kMinMatch + CommonLength(src + i + kMinMatch, src + ref + kMinMatch, src + matchEnd);
+
+                if (!emit(i, i - ref, length)) return 0;
+                i += length;
+                anchor = i;
+            }
+        }
+
+        if (!emit(size, 0, 0)) return 0;
+        return static_cast<size_t>(op - dst);
+    }
+
+    bool Decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t dstSize)
+    {
+        const unsigned char* ip = src;
+        const unsigned char* const inEnd = src + size;
+        unsigned char* op = dst;
+        unsigned char* const outEnd = dst + dstSize;
+
+        auto readLength = [&](size_t& length) -> bool
+        {
+            if (length != 15) return true;
+            unsigned char b;
+            do
+            {
+                if (ip >= inEnd) return false;
+                b = *ip++;
+                length += b;
+            } while (b == 255);
+            return true;
+        };
+
+        while (ip < inEnd)
+        {
+            const unsigned char token = *ip++;
+
+            size_t literals = token >> 4;
+            if (!readLength(literals)) return false;
+            if (literals > static_cast<size_t>(inEnd - ip) || literals > static_cast<size_t>(outEnd - op)) return false;
+            // 짧은 리터럴은 여유가 있으면 16바이트 고정 복사 (넘친 부분은 뒤 시퀀스가 덮어쓴다)
+            if (literals <= 16 && inEnd - ip >= 16 && outEnd - op >= 16)
+                memcpy(op, ip, 16);
+            else
+                memcpy(op, ip, literals);
+            ip += literals;
+            op += literals;
+
+            if (ip == inEnd) break;     // 마지막 시퀀스는 리터럴만 있다
+
+            if (inEnd - ip < 2) return false;
+            const size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+
+            size_t length = token & 15;
+            if (!readLength(length)) return false;
+            length += kMinMatch;
+            if (length > static_cast<size_t>(outEnd - op)) return false;
+
+            // 겹치는 복사(offset < length)는 반복 패턴이다. [match, op)는 항상 주기 offset의 배수 길이이므로
+            // 이미 쓴 구간 전체를 통째로 이어 붙이면 한 번에 두 배씩 늘어난다
+            const unsigned char* match = op - offset;
+            if (offset >= 8 && static_cast<size_t>(outEnd - op) >= length + 8)
+            {
+                // 8바이트 조각의 원본은 항상 이미 쓴 구간이므로 겹쳐도 앞에서부터 8바이트씩 복사할 수 있다
+                for (size_t k = 0; k < length; k += 8) memcpy(op + k, match + k, 8);
+                op += length;
+                continue;
+            }
+            while (length > 0)
+            {
+                const size_t chunk = std::min(length, static_cast<size_t>(op - match));
+                memcpy(op, match, chunk);
+                op += chunk;
+                length -= chunk;
+            }
+        }
+        return op == outEnd;
+    }
+}
@@ -0,0 +1,20 @@
+﻿#pragma once
+
+#include <cstddef>
+
+// =====================================================
+//  LZ4 블록 형식 압축/복원 (프레임 헤더 없음, 외부 라이브러리 없음)
+//  출력은 표준 LZ4 블록 형식이므로 다른 LZ4 구현의 블록 복원 함수로도 읽을 수 있다.
+//  압축은 4바이트 해시 표 하나로 찾는 탐욕 방식이다 (되돌리기 기록의 타일 압축용).
+// =====================================================
+namespace Lz4Codec
+{
+    // size 바이트를 압축했을 때 나올 수 있는 최대 크기
+    size_t CompressBound(size_t size);
+
+    // src를 dst(용량 capacity)에 압축하고 압축 크기를 반환. capacity를 넘으면 0
+    size_t Compress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity);
+
+    // 압축 블록을 정확히 dstSize 바이트로 복원. 블록이 손상되었거나 크기가 다르면 false
+    bool Decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t dstSize);
+}
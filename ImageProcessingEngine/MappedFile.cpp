@@ -0,0 +1,212 @@
+﻿#include "pch.h"
+#include "MappedFile.h"
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <vector>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // 매핑 시작 오프셋이 맞춰야 하는 단위 (Windows 64 KiB, POSIX 페이지 크기)
+    uint64_t MapGranularity()
+    {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwAllocationGranularity;
+#else
+        return static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+#if defined(_WIN32)
+    std::vector<wchar_t> WidePath(const char* path)
+    {
+        const int length = MultiByteToWideChar(CP_UTF8, 0, path, -1, nullptr, 0);
+        std::vector<wchar_t> wide(length > 0 ? length : 1, L'\0');
+        if (length > 0) MultiByteToWideChar(CP_UTF8, 0, path, -1, wide.data(), length);
+        return wide;
+    }
+#endif
+}
+
+// ==================== View ====================
+MappedFile::View::~View()
+{
+    Release();
+}
+
+MappedFile::View::View(View&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile::View& MappedFile::View::operator=(View&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_base = other.m_base;
+        m_baseSize = other.m_baseSize;
+        m_data = other.m_data;
+        m_size = other.m_size;
+        other.m_base = nullptr;
+        other.m_baseSize = 0;
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+    return *this;
+}
+
+void MappedFile::View::Release()
+{
+    if (m_base == nullptr) return;
+#if defined(_WIN32)
+    UnmapViewOfFile(m_base);
+#else
+    munmap(m_base, m_baseSize);
+#endif
+    m_base = nullptr;
+    m_baseSize = 0;
+    m_data = nullptr;
+    m_size = 0;
+}
+
+// ==================== MappedFile ====================
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::IsOpen() const
+{
+#if defined(_WIN32)
+    return m_mapping != nullptr;
+#else
+    return m_fd >= 0;
+#endif
+}
+
+bool MappedFile::OpenRead(const char* path)
+{
+    Close();
+    if (path == nullptr) return false;
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(WidePath(path).data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+    m_fd = fd;
+    m_size = static_cast<uint64_t>(info.st_size);
+#endif
+    m_writable = false;
+    return true;
+}
+
+bool MappedFile::Create(const char* path, uint64_t size)
+{
+    Close();
+    if (path == nullptr || size == 0) return false;
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(WidePath(path).data(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    // 매핑 크기를 지정하면 파일이 그 크기로 늘어난다
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                       static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+#else
+    const int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    m_fd = fd;
+#endif
+    m_size = size;
+    m_writable = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+    if (m_mapping != nullptr) CloseHandle(m_mapping);
+    if (m_file != nullptr) CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if (m_fd >= 0) close(m_fd);
+    m_fd = -1;
+#endif
+    m_size = 0;
+    m_writable = false;
+}
+
+MappedFile::View MappedFile::Map(uint64_t offset, size_t length) const
+{
+    View view;
+    if (!IsOpen() || length == 0 || offset > m_size || length > m_size - offset) return view;
+
+    static const uint64_t granularity = MapGranularity();
+    const uint64_t alignedOffset = offset - offset % granularity;
+    const size_t delta = static_cast<size_t>(offset - alignedOffset);
+    const size_t mapLength = length + delta;
+
+#if defined(_WIN32)
+    void* base = MapViewOfFile(m_mapping, m_writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+                               static_cast<DWORD>(alignedOffset >> 32), static_cast<DWORD>(alignedOffset & 0xFFFFFFFFu),
+                               mapLength);
+    if (base == nullptr) return view;
+#else
+    void* base = mmap(nullptr, mapLength, m_writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, m_fd,
+                      static_cast<off_t>(alignedOffset));
+    if (base == MAP_FAILED) return view;
+#endif
+    view.m_base = base;
+    view.m_baseSize = mapLength;
+    view.m_data = static_cast<unsigned char*>(base) + delta;
+    view.m_size = length;
+    return view;
+}
@@ -0,0 +1,65 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// =====================================================
+//  메모리 매핑 파일 (Windows: CreateFileMapping, POSIX: mmap)
+//  파일 전체가 아니라 필요한 구간만 뷰로 매핑하므로 RAM보다 큰 파일도 다룰 수 있다.
+// =====================================================
+class MappedFile
+{
+public:
+    // 매핑된 구간. 소멸 시 해제된다 (이동만 가능)
+    class View
+    {
+    public:
+        View() = default;
+        ~View();
+        View(View&& other) noexcept;
+        View& operator=(View&& other) noexcept;
+        View(const View&) = delete;
+        View& operator=(const View&) = delete;
+
+        unsigned char* Data() const { return m_data; }
+        size_t Size() const { return m_size; }
+        bool IsValid() const { return m_data != nullptr; }
+
+    private:
+        friend class MappedFile;
+        void Release();
+
+        void* m_base = nullptr;         // 할당 단위로 정렬된 매핑 시작 주소
+        size_t m_baseSize = 0;
+        unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 기존 파일을 읽기 전용으로 연다. path는 UTF-8
+    bool OpenRead(const char* path);
+
+    // 파일을 size 바이트로 새로 만들어(기존 내용 삭제) 읽기/쓰기로 연다
+    bool Create(const char* path, uint64_t size);
+
+    void Close();
+    bool IsOpen() const;
+    uint64_t Size() const { return m_size; }
+
+    // [offset, offset + length) 구간을 매핑. 범위를 벗어나거나 실패하면 빈 뷰
+    View Map(uint64_t offset, size_t length) const;
+
+private:
+    bool m_writable = false;
+    uint64_t m_size = 0;
+#if defined(_WIN32)
+    void* m_file = nullptr;         // HANDLE
+    void* m_mapping = nullptr;      // HANDLE
+#else
+    int m_fd = -1;
+#endif
+};
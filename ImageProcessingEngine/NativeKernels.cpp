@@ -0,0 +1,752 @@
+﻿#include "pch.h"
+#include "NativeKernels.h"
+#include "SimdKernels.h"
+#include "ScratchArena.h"
+#include "EdgeDetection.h"
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+namespace NativeKernels
+{
+    // 5x5 가우시안 커널 (합 273으로 정규화)
+    const float kGaussian5x5[25] = {
+        1 / 273.0f, 4 / 273.0f, 7 / 273.0f, 4 / 273.0f, 1 / 273.0f,
+        4 / 273.0f, 16 / 273.0f, 26 / 273.0f, 16 / 273.0f, 4 / 273.0f,
+        7 / 273.0f, 26 / 273.0f, 41 / 273.0f, 26 / 273.0f, 7 / 273.0f,
+        4 / 273.0f, 16 / 273.0f, 26 / 273.0f, 16 / 273.0f, 4 / 273.0f,
+        1 / 273.0f, 4 / 273.0f, 7 / 273.0f, 4 / 273.0f, 1 / 273.0f
+    };
+
+    const float kLaplacian3x3[9] = {
+        0, -1, 0,
+       -1,  4, -1,
+        0, -1, 0
+    };
+
+    static_assert(FixedKernel::kMaxSize == SimdKernels::kMaxFixedKernelSize, "고정소수점 커널 최대 크기 불일치");
+
+    bool QuantizeKernel(const float* kernel, int kSize, FixedKernel& out)
+    {
+        if (kernel == nullptr || kSize < 1 || kSize > FixedKernel::kMaxSize || kSize % 2 == 0) return false;
+
+        const int count = kSize * kSize;
+        double maxAbs = 0.0, sum = 0.0;
+        int largest = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            if (!std::isfinite(kernel[i])) return false;
+            sum += kernel[i];
+            if (std::fabs(kernel[i]) > maxAbs)
+            {
+                maxAbs = std::fabs(kernel[i]);
+                largest = i;
+            }
+        }
+
+        int shift = SimdKernels::kMaxFixedShift;
+        while (shift > 0 && std::nearbyint(maxAbs * std::ldexp(1.0, shift)) > 32767.0) --shift;
+        const double scale = std::ldexp(1.0, shift);
+        if (std::nearbyint(maxAbs * scale) > 32767.0) return false;
+
+        int32_t total = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            out.coefficients[i] = static_cast<int16_t>(std::lround(kernel[i] * scale));
+            total += out.coefficients[i];
+        }
+        const int32_t corrected = out.coefficients[largest] + static_cast<int32_t>(std::lround(sum * scale)) - total;
+        if (corrected >= -32767 && corrected <= 32767)
+        {
+            out.coefficients[largest] = static_cast<int16_t>(corrected);
+        }
+        double error = 0.0;
+        for (int i = 0; i < count; ++i)
+        {
+            error += std::fabs(out.coefficients[i] / scale - kernel[i]);
+        }
+        out.errorBound = static_cast<float>(error * 255.0);
+        out.size = kSize;
+        out.shift = shift;
+        return true;
+    }
+
+    static FixedKernel Quantized(const float* kernel, int kSize)
+    {
+        FixedKernel fixed{};
+        QuantizeKernel(kernel, kSize, fixed);
+        return fixed;
+    }
+
+    const FixedKernel& FixedGaussian5x5()
+    {
+        static const FixedKernel kernel = Quantized(kGaussian5x5, 5);
+        return kernel;
+    }
+
+    const FixedKernel& FixedLaplacian3x3()
+    {
+        static const FixedKernel kernel = Quantized(kLaplacian3x3, 3);
+        return kernel;
+    }
+
+    // 가장자리 행/열 복사 헬퍼 (bpp = 화소당 바이트 수)
+    template <int bpp>
+    static inline void CopyRow(const RowBuffer& src, const RowBuffer& dst, int width, int y)
+    {
+        if (src.Row(y) != dst.Row(y))
+        {
+            memcpy(dst.Row(y), src.Row(y), static_cast<size_t>(width) * bpp);
+        }
+    }
+
+    template <int bpp>
+    static inline void CopyPixel(const unsigned char* s, unsigned char* d)
+    {
+        for (int c = 0; c < bpp; ++c) d[c] = s[c];
+    }
+
+    // 반경 안쪽이 아닌 행은 복사하고, 나머지 행의 좌우 가장자리 열도 복사한 뒤
+    // 내부 행 범위를 [iy0, iy1)로 돌려준다.
+    template <int bpp>
+    static void CopyBorders(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                            int kHalf, int& iy0, int& iy1)
+    {
+        iy0 = std::max(y0, kHalf);
+        iy1 = std::min(y1, height - kHalf);
+        bool hasInteriorColumns = width - kHalf > kHalf;
+        if (iy0 >= iy1 || !hasInteriorColumns)
+        {
+            for (int y = y0; y < y1; ++y) CopyRow<bpp>(src, dst, width, y);
+            iy0 = iy1 = y0;
+            return;
+        }
+        for (int y = y0; y < iy0; ++y) CopyRow<bpp>(src, dst, width, y);
+        for (int y = iy1; y < y1; ++y) CopyRow<bpp>(src, dst, width, y);
+        for (int y = iy0; y < iy1; ++y)
+        {
+            const unsigned char* s = src.Row(y);
+            unsigned char* d = dst.Row(y);
+            for (int x = 0; x < kHalf; ++x) CopyPixel<bpp>(s + x * bpp, d + x * bpp);
+            for (int x = width - kHalf; x < width; ++x) CopyPixel<bpp>(s + x * bpp, d + x * bpp);
+        }
+    }
+
+    // 소벨 크기의 내부 화소 (행 [iy0, iy1), 열 [1, width - 1)). 정수 분리형 그래디언트의 L2 크기를 절삭 후 255로 포화한다.
+    // src는 채널 0(그레이 값)만 읽고 dst의 색 채널에 쓴다. 둘 다 BGRA면 src의 alpha를 복사한다
+    template <int srcBpp, int dstBpp>
+    static void SobelInterior(const RowBuffer& src, const RowBuffer& dst, int width, int iy0, int iy1)
+    {
+        if (iy0 >= iy1) return;
+        const size_t n = static_cast<size_t>(width);
+        ScratchArena::Buffer buffer = ScratchArena::Shared().Acquire((4 * n + 4) * sizeof(int16_t) + n);
+        int16_t* gx = buffer.As<int16_t>();
+        int16_t* gy = gx + n;
+        int16_t* work = gy + n;
+        unsigned char* magnitude = reinterpret_cast<unsigned char*>(work + 2 * n + 4);
+
+        for (int y = iy0; y < iy1; ++y)
+        {
+            EdgeDetection::GradientRow(src.Row(y - 1), src.Row(y), src.Row(y + 1), width, srcBpp,
+                                       GradientOperator::Sobel, gx, gy, work);
+            EdgeDetection::MagnitudeRow8(gx, gy, width, magnitude);
+            const unsigned char* s = src.Row(y);
+            unsigned char* d = dst.Row(y);
+            if (dstBpp == 1)
+            {
+                memcpy(d + 1, magnitude + 1, static_cast<size_t>(width) - 2);
+                continue;
+            }
+            for (int x = 1; x < width - 1; ++x)
+            {
+                unsigned char* p = d + x * 4;
+                p[0] = p[1] = p[2] = magnitude[x];
+                if (srcBpp == 4) p[3] = s[x * 4 + 3];
+            }
+        }
+    }
+
+    // CopyBorders가 복사한 가장자리 화소의 색 채널을 0으로 만든다 (alpha 유지)
+    template <int bpp>
+    static void ClearBorders(const RowBuffer& dst, int width, int y0, int y1, int kHalf, int iy0, int iy1)
+    {
+        const int channels = (bpp == 4) ? 3 : bpp;
+        auto clear = [channels](unsigned char* d, int x0, int x1)
+        {
+            for (int x = x0; x < x1; ++x)
+                for (int c = 0; c < channels; ++c) d[x * bpp + c] = 0;
+        };
+        for (int y = y0; y < y1; ++y)
+        {
+            unsigned char* d = dst.Row(y);
+            if (y < iy0 || y >= iy1)
+            {
+                clear(d, 0, width);
+            }
+            else
+            {
+                clear(d, 0, kHalf);
+                clear(d, width - kHalf, width);
+            }
+        }
+    }
+
+    // =====================================================
+    //  van Herk / Gil-Werman 최대·최소 필터
+    //  창 크기(win) 단위 블록마다 앞→뒤 누적(prefix)과 뒤→앞 누적(suffix)을 만들어 두면
+    //  창 [s, s + win)의 결과는 max(suffix[s], prefix[s + win - 1]) 한 번으로 구해진다.
+    //  가로/세로로 분리해 적용하므로 화소당 비교 횟수(약 6회)가 커널 크기와 무관하다.
+    // =====================================================
+    template <bool Dilate>
+    static inline unsigned char Extreme(unsigned char a, unsigned char b)
+    {
+        return Dilate ? std::max(a, b) : std::min(a, b);
+    }
+
+    // 한 행(채널 0, 화소 간격 step)의 가로 창 결과. out[i] = 창 [i, i + win), i = 0 .. width - win
+    template <bool Dilate>
+    static void HorizontalExtreme(const unsigned char* s, int step, int width, int win,
+                                  unsigned char* prefix, unsigned char* suffix, unsigned char* out)
+    {
+        for (int b = 0; b < width; b += win)
+        {
+            const int e = std::min(b + win, width);
+            prefix[b] = s[b * step];
+            for (int x = b + 1; x < e; ++x) prefix[x] = Extreme<Dilate>(prefix[x - 1], s[x * step]);
+            suffix[e - 1] = s[(e - 1) * step];
+            for (int x = e - 2; x >= b; --x) suffix[x] = Extreme<Dilate>(suffix[x + 1], s[x * step]);
+        }
+        for (int i = 0; i + win <= width; ++i)
+        {
+            out[i] = Extreme<Dilate>(suffix[i], prefix[i + win - 1]);
+        }
+    }
+
+    // 내부 영역 [kHalf, width - kHalf) x [iy0, iy1)의 (2 kHalf + 1)² 정사각 창 최대/최소를
+    // 행마다 emit(y, values)로 넘긴다. values[i]는 x = kHalf + i 의 결과이며 src의 채널 0만 읽는다.
+    // 세로 방향은 가로 결과 행 블록 2개(현재/다음)만 유지하며 SIMD 행 단위 max/min으로 누적한다.
+    template <bool Dilate, int bpp, typename Emit>
+    static void SquareExtreme(const RowBuffer& src, int width, int iy0, int iy1, int kHalf, Emit emit)
+    {
+        const int win = 2 * kHalf + 1;
+        const int count = width - 2 * kHalf;
+        const int rowEnd = iy1 + kHalf;
+        const size_t blockBytes = static_cast<size_t>(win) * count;
+
+        ScratchArena::Buffer scratch = ScratchArena::Shared().Acquire(3 * blockBytes + 2 * static_cast<size_t>(width));
+        unsigned char* current = scratch.Data();
+        unsigned char* next = current + blockBytes;
+        unsigned char* prefixRows = next + blockBytes;
+        unsigned char* prefix = prefixRows + blockBytes;
+        unsigned char* suffix = prefix + width;
+
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        auto pick = Dilate ? simd.maxBytes : simd.minBytes;
+        auto loadBlock = [&](unsigned char* block, int first, int rows)
+        {
+            for (int r = 0; r < rows; ++r)
+            {
+                HorizontalExtreme<Dilate>(src.Row(first + r), bpp, width, win, prefix, suffix,
+                                          block + static_cast<size_t>(r) * count);
+            }
+        };
+
+        // 블록 경계는 iy0 - kHalf 기준. 창 시작 행 s가 속한 블록(current)의 suffix와
+        // 창 끝 행이 속한 다음 블록(next)의 prefix를 결합한다.
+        loadBlock(current, iy0 - kHalf, std::min(win, rowEnd - (iy0 - kHalf)));
+        for (int blockStart = iy0 - kHalf; blockStart < iy1 - kHalf; blockStart += win)
+        {
+            const int rows = std::min(win, rowEnd - blockStart);
+            for (int r = rows - 2; r >= 0; --r)
+            {
+                unsigned char* row = current + static_cast<size_t>(r) * count;
+                pick(row, row + count, row, count);
+            }
+
+            const int nextStart = blockStart + win;
+            const int nextRows = std::max(0, std::min(win, rowEnd - nextStart));
+            loadBlock(next, nextStart, nextRows);
+            if (nextRows > 0) memcpy(prefixRows, next, count);
+            for (int r = 1; r < nextRows; ++r)
+            {
+                unsigned char* row = prefixRows + static_cast<size_t>(r) * count;
+                pick(row - count, next + static_cast<size_t>(r) * count, row, count);
+            }
+
+            // 블록 첫 행에서 시작하는 창은 블록 전체이므로 suffix 첫 행이 곧 결과
+            const int sEnd = std::min(blockStart + win, iy1 - kHalf);
+            emit(blockStart + kHalf, current);
+            for (int s = blockStart + 1; s < sEnd; ++s)
+            {
+                unsigned char* out = prefixRows + static_cast<size_t>(s - blockStart - 1) * count;
+                pick(current + static_cast<size_t>(s - blockStart) * count, out, out, count);
+                emit(s + kHalf, out);
+            }
+            std::swap(current, next);
+        }
+    }
+
+    template <int bpp, typename Emit>
+    static void SquareExtreme(const RowBuffer& src, int width, int iy0, int iy1, int kHalf, bool dilate, Emit emit)
+    {
+        if (dilate)
+            SquareExtreme<true, bpp>(src, width, iy0, iy1, kHalf, emit);
+        else
+            SquareExtreme<false, bpp>(src, width, iy0, iy1, kHalf, emit);
+    }
+
+    template <int bpp>
+    static void MorphologyRowsT(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                                int kernelSize, bool dilate)
+    {
+        int kHalf = kernelSize / 2;
+        int iy0, iy1;
+        CopyBorders<bpp>(src, dst, width, height, y0, y1, kHalf, iy0, iy1);
+        if (iy0 >= iy1) return;
+
+        SquareExtreme<bpp>(src, width, iy0, iy1, kHalf, dilate, [&](int y, const unsigned char* values)
+        {
+            unsigned char* d = dst.Row(y) + kHalf * bpp;
+            if (bpp == 1)
+            {
+                memcpy(d, values, static_cast<size_t>(width - 2 * kHalf));
+                return;
+            }
+            const unsigned char* s = src.Row(y) + kHalf * bpp;
+            for (int i = 0; i < width - 2 * kHalf; ++i)
+            {
+                unsigned char* p = d + i * bpp;
+                p[0] = p[1] = p[2] = values[i];
+                p[3] = s[i * bpp + 3];
+            }
+        });
+    }
+
+    template <int bpp>
+    static void MorphologyGradientRowsT(const RowBuffer& src, const RowBuffer& dst, int width, int height,
+                                        int y0, int y1, int kernelSize)
+    {
+        int kHalf = kernelSize / 2;
+        int iy0, iy1;
+        CopyBorders<bpp>(src, dst, width, height, y0, y1, kHalf, iy0, iy1);
+        // 팽창 결과를 먼저 기록한 뒤 침식 결과를 빼 준다
+        if (iy0 < iy1) MorphologyRowsT<bpp>(src, dst, width, height, iy0, iy1, kernelSize, true);
+        // 가장자리는 팽창/침식 모두 원본 복사이므로 차이가 0
+        ClearBorders<bpp>(dst, width, y0, y1, kHalf, iy0, iy1);
+        if (iy0 >= iy1) return;
+
+        SquareExtreme<bpp>(src, width, iy0, iy1, kHalf, false, [&](int y, const unsigned char* values)
+        {
+            unsigned char* d = dst.Row(y) + kHalf * bpp;
+            for (int i = 0; i < width - 2 * kHalf; ++i)
+            {
+                unsigned char* p = d + i * bpp;
+                const unsigned char diff = static_cast<unsigned char>(p[0] - values[i]);
+                p[0] = diff;
+                if (bpp == 4) p[1] = p[2] = diff;
+            }
+        });
+    }
+
+    template <int bpp>
+    static void MorphologyHatRowsT(const RowBuffer& src, const RowBuffer& dst, int width, int height,
+                                   int y0, int y1, int kernelSize, bool white)
+    {
+        if (y0 >= y1) return;
+
+        // 열림(침식 → 팽창) 또는 닫힘(팽창 → 침식)을 중간 버퍼로 계산
+        const int kHalf = kernelSize / 2;
+        const int lo = std::max(0, y0 - kHalf);
+        const int hi = std::min(height, y1 + kHalf);
+        const size_t stride = static_cast<size_t>(width) * bpp;
+        ScratchArena::Buffer temp = ScratchArena::Shared().Acquire(static_cast<size_t>(hi - lo) * stride);
+        const RowBuffer mid{ temp.Data(), lo, stride };
+        MorphologyRowsT<bpp>(src, mid, width, height, lo, hi, kernelSize, !white);
+        MorphologyRowsT<bpp>(mid, dst, width, height, y0, y1, kernelSize, white);
+
+        // white: 원본 - 열림, black: 닫힘 - 원본 (색 채널만, 음수는 0)
+        const int channels = (bpp == 4) ? 3 : bpp;
+        for (int y = y0; y < y1; ++y)
+        {
+            const unsigned char* s = src.Row(y);
+            unsigned char* d = dst.Row(y);
+            for (int x = 0; x < width; ++x)
+            {
+                for (int c = 0; c < channels; ++c)
+                {
+                    const int a = s[x * bpp + c];
+                    const int b = d[x * bpp + c];
+                    d[x * bpp + c] = static_cast<unsigned char>(std::max(0, white ? a - b : b - a));
+                }
+            }
+        }
+    }
+
+    // =====================================================
+    //  Perreault–Hébert 상수 시간 중앙값 필터
+    //  열마다 창 높이만큼의 히스토그램을 유지하고, 커널 히스토그램은 오른쪽으로 이동할 때
+    //  들어오는 열을 더하고 나가는 열을 빼서 갱신한다. 256 bin은 16개의 굵은(coarse) bin과
+    //  그 안의 16개 세밀(fine) bin으로 나누며, 세밀 bin은 중앙값이 속한 굵은 bin만 늦게 갱신한다.
+    // =====================================================
+
+    // 열 히스토그램(열당 544 byte)이 L2에 머물도록 출력 열을 이 폭의 세로 띠로 나눠 처리한다
+    static const int kMedianStripWidth = 512;
+
+    // 띠 하나(최대 kMedianStripWidth + 2 kHalf 열)의 열 히스토그램. 밴드마다 한 번 빌려 채널/띠 사이에 재사용
+    struct MedianScratch
+    {
+        explicit MedianScratch(int kHalf)
+            : m_buffer(ScratchArena::Shared().Acquire(static_cast<size_t>(kMedianStripWidth + 2 * kHalf) *
+                                                      (256 + 16) * sizeof(uint16_t)))
+        {
+            fine = m_buffer.As<uint16_t>();
+            coarse = fine + static_cast<size_t>(kMedianStripWidth + 2 * kHalf) * 256;
+        }
+
+        uint16_t* fine = nullptr;       // 열별 256 bin
+        uint16_t* coarse = nullptr;     // 열별 16 bin
+
+    private:
+        ScratchArena::Buffer m_buffer;
+    };
+
+    // 채널 하나(화소 내 오프셋 channel, 화소 간격 bpp)의 중앙값을 내부 영역
+    // [kHalf, width - kHalf) x [iy0, iy1)에 기록한다. 결과는 정렬 후 가운데 값과 같다.
+    template <int bpp>
+    static void MedianPlane(const RowBuffer& src, const RowBuffer& dst, int width, int iy0, int iy1, int kHalf,
+                            int channel, MedianScratch& scratch)
+    {
+        const int win = 2 * kHalf + 1;
+        const uint32_t rank = static_cast<uint32_t>(win) * win / 2;
+        const int stale = -(win + 1);   // 세밀 bin이 아직 계산되지 않았음을 뜻하는 위치
+
+        for (int sx0 = kHalf; sx0 < width - kHalf; sx0 += kMedianStripWidth)
+        {
+            const int sx1 = std::min(width - kHalf, sx0 + kMedianStripWidth);
+            const int firstColumn = sx0 - kHalf;
+            const int columns = sx1 + kHalf - firstColumn;
+
+            uint16_t* fine = scratch.fine;
+            uint16_t* coarse = scratch.coarse;
+            memset(fine, 0, static_cast<size_t>(columns) * 256 * sizeof(uint16_t));
+            memset(coarse, 0, static_cast<size_t>(columns) * 16 * sizeof(uint16_t));
+
+            auto updateColumns = [&](int y, int delta)
+            {
+                const unsigned char* s = src.Row(y) + firstColumn * bpp + channel;
+                for (int i = 0; i < columns; ++i)
+                {
+                    const int v = s[i * bpp];
+                    fine[i * 256 + v] = static_cast<uint16_t>(fine[i * 256 + v] + delta);
+                    coarse[i * 16 + (v >> 4)] = static_cast<uint16_t>(coarse[i * 16 + (v >> 4)] + delta);
+                }
+            };
+            for (int y = iy0 - kHalf; y <= iy0 + kHalf; ++y) updateColumns(y, 1);
+
+            for (int y = iy0; y < iy1; ++y)
+            {
+                if (y > iy0)
+                {
+                    updateColumns(y - kHalf - 1, -1);
+                    updateColumns(y + kHalf, 1);
+                }
+
+                // 행 시작 위치(sx0)의 커널 히스토그램: 열 [0, win)
+                uint32_t kernelCoarse[16] = {};
+                uint32_t kernelFine[256];
+                int fineAt[16];
+                for (int i = 0; i < win; ++i)
+                    for (int b = 0; b < 16; ++b) kernelCoarse[b] += coarse[i * 16 + b];
+                for (int b = 0; b < 16; ++b) fineAt[b] = stale;
+
+                unsigned char* d = dst.Row(y) + channel;
+                for (int x = sx0; x < sx1; ++x)
+                {
+                    const int center = x - firstColumn;
+                    if (x > sx0)
+                    {
+                        const uint16_t* in = coarse + (center + kHalf) * 16;
+                        const uint16_t* out = coarse + (center - kHalf - 1) * 16;
+                        for (int b = 0; b < 16; ++b) kernelCoarse[b] += in[b] - out[b];
+                    }
+
+                    int bucket = 0;
+                    uint32_t below = 0;
+                    while (below + kernelCoarse[bucket] <= rank) below += kernelCoarse[bucket++];
+
+                    // 세밀 bin 갱신: 밀린 이동 횟수가 창 반경보다 많으면 새로 합산하는 편이 싸다
+                    uint32_t* bins = kernelFine + bucket * 16;
+                    if (x - fineAt[bucket] > kHalf)
+                    {
+                        for (int j = 0; j < 16; ++j) bins[j] = 0;
+                        for (int i = center - kHalf; i <= center + kHalf; ++i)
+                        {
+                            const uint16_t* col = fine + i * 256 + bucket * 16;
+                            for (int j = 0; j < 16; ++j) bins[j] += col[j];
+                        }
+                    }
+                    else
+                    {
+                        for (int c = fineAt[bucket] - firstColumn + 1; c <= center; ++c)
+                        {
+                            const uint16_t* in = fine + (c + kHalf) * 256 + bucket * 16;
+                            const uint16_t* out = fine + (c - kHalf - 1) * 256 + bucket * 16;
+                            for (int j = 0; j < 16; ++j) bins[j] += in[j] - out[j];
+                        }
+                    }
+                    fineAt[bucket] = x;
+
+                    int j = 0;
+                    while (below + bins[j] <= rank) below += bins[j++];
+                    d[x * bpp] = static_cast<unsigned char>(bucket * 16 + j);
+                }
+            }
+        }
+    }
+
+    void GrayscaleRows(const RowBuffer& src, const RowBuffer& dst, int width, int y0, int y1)
+    {
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        for (int y = y0; y < y1; ++y)
+        {
+            simd.grayscaleBGRA(src.Row(y), dst.Row(y), width);
+        }
+    }
+
+    void BinarizeRows(const RowBuffer& src, const RowBuffer& dst, int width, int y0, int y1, int threshold)
+    {
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        for (int y = y0; y < y1; ++y)
+        {
+            simd.binarizeBGRA(src.Row(y), dst.Row(y), width, threshold);
+        }
+    }
+
+    void ConvolveRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                      const float* kernel, int kSize)
+    {
+        int kHalf = kSize / 2;
+        int iy0, iy1;
+        CopyBorders<4>(src, dst, width, height, y0, y1, kHalf, iy0, iy1);
+
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        ScratchArena::Buffer rowTable = ScratchArena::Shared().Acquire(kSize * sizeof(const unsigned char*));
+        const unsigned char** rows = rowTable.As<const unsigned char*>();
+        for (int y = iy0; y < iy1; ++y) {
+            for (int ky = 0; ky < kSize; ++ky) rows[ky] = src.Row(y + ky - kHalf);
+            simd.convolveBGRA(rows, kernel, kSize, kHalf, width - kHalf, dst.Row(y));
+        }
+    }
+
+    void ConvolveRowsFixed(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                           const FixedKernel& kernel)
+    {
+        const int kSize = kernel.size;
+        int kHalf = kSize / 2;
+        int iy0, iy1;
+        CopyBorders<4>(src, dst, width, height, y0, y1, kHalf, iy0, iy1);
+
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        const unsigned char* rows[FixedKernel::kMaxSize];
+        for (int y = iy0; y < iy1; ++y) {
+            for (int ky = 0; ky < kSize; ++ky) rows[ky] = src.Row(y + ky - kHalf);
+            simd.convolveFixedBGRA(rows, kernel.coefficients, kSize, kernel.shift, kHalf, width - kHalf, dst.Row(y));
+        }
+    }
+
+    void SobelRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1)
+    {
+        int iy0, iy1;
+        CopyBorders<4>(src, dst, width, height, y0, y1, 1, iy0, iy1);
+        SobelInterior<4, 4>(src, dst, width, iy0, iy1);
+    }
+
+    void SobelRowsFromGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1)
+    {
+        // 가장자리 화소는 그레이 값 그대로 (BGRA 그레이 영상을 SobelRows에 넣었을 때와 같음)
+        const int iy0 = std::max(y0, 1);
+        const int iy1 = std::min(y1, height - 1);
+        const bool interior = iy0 < iy1 && width > 2;
+        for (int y = y0; y < y1; ++y)
+        {
+            const unsigned char* s = src.Row(y);
+            unsigned char* d = dst.Row(y);
+            auto copy = [&](int x) { d[x * 4] = d[x * 4 + 1] = d[x * 4 + 2] = s[x]; };
+            if (!interior || y < iy0 || y >= iy1)
+            {
+                for (int x = 0; x < width; ++x) copy(x);
+            }
+            else
+            {
+                copy(0);
+                copy(width - 1);
+            }
+        }
+        if (interior) SobelInterior<1, 4>(src, dst, width, iy0, iy1);
+    }
+
+    void MorphologyRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                        int kernelSize, bool dilate)
+    {
+        MorphologyRowsT<4>(src, dst, width, height, y0, y1, kernelSize, dilate);
+    }
+
+    void MorphologyGradientRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                                int kernelSize)
+    {
+        MorphologyGradientRowsT<4>(src, dst, width, height, y0, y1, kernelSize);
+    }
+
+    void MorphologyHatRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                           int kernelSize, bool white)
+    {
+        MorphologyHatRowsT<4>(src, dst, width, height, y0, y1, kernelSize, white);
+    }
+
+    void MedianRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                    int kernelSize)
+    {
+        if (kernelSize % 2 == 0)
+        {
+            for (int y = y0; y < y1; ++y) CopyRow<4>(src, dst, width, y);
+            return;
+        }
+
+        int kHalf = kernelSize / 2;
+        int iy0, iy1;
+        CopyBorders<4>(src, dst, width, height, y0, y1, kHalf, iy0, iy1);
+        if (iy0 >= iy1) return;
+
+        // B, G, R 채널별 중앙값. alpha는 원본 유지
+        MedianScratch scratch(kHalf);
+        for (int c = 0; c < 3; ++c)
+        {
+            MedianPlane<4>(src, dst, width, iy0, iy1, kHalf, c, scratch);
+        }
+        for (int y = iy0; y < iy1; ++y)
+        {
+            const unsigned char* s = src.Row(y);
+            unsigned char* d = dst.Row(y);
+            for (int x = kHalf; x < width - kHalf; ++x) d[x * 4 + 3] = s[x * 4 + 3];
+        }
+    }
+
+    // =====================================================
+    //  단일 채널 그레이 평면 커널
+    // =====================================================
+    void GrayFromBGRARows(const RowBuffer& src, const RowBuffer& dst, int width, int y0, int y1)
+    {
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        for (int y = y0; y < y1; ++y)
+        {
+            simd.grayFromBGRA(src.Row(y), dst.Row(y), width);
+        }
+    }
+
+    void BGRAFromGrayRows(const RowBuffer& src, const RowBuffer& dst, int width, int y0, int y1, bool preserveAlpha)
+    {
+        for (int y = y0; y < y1; ++y)
+        {
+            const unsigned char* s = src.Row(y);
+            unsigned char* d = dst.Row(y);
+            for (int x = 0; x < width; ++x)
+            {
+                d[x * 4 + 0] = d[x * 4 + 1] = d[x * 4 + 2] = s[x];
+                if (!preserveAlpha) d[x * 4 + 3] = 255;
+            }
+        }
+    }
+
+    void ThresholdRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int y0, int y1, int threshold)
+    {
+        // 범위를 벗어난 임계값은 결과가 상수이므로 SIMD 커널을 거치지 않는다
+        if (threshold < 0 || threshold >= 255)
+        {
+            const unsigned char value = (threshold < 0) ? 255 : 0;
+            for (int y = y0; y < y1; ++y) memset(dst.Row(y), value, static_cast<size_t>(width));
+            return;
+        }
+
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        for (int y = y0; y < y1; ++y)
+        {
+            simd.thresholdGray(src.Row(y), dst.Row(y), width, threshold);
+        }
+    }
+
+    void ConvolveRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                          const float* kernel, int kSize)
+    {
+        int kHalf = kSize / 2;
+        int iy0, iy1;
+        CopyBorders<1>(src, dst, width, height, y0, y1, kHalf, iy0, iy1);
+
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        ScratchArena::Buffer rowTable = ScratchArena::Shared().Acquire(kSize * sizeof(const unsigned char*));
+        const unsigned char** rows = rowTable.As<const unsigned char*>();
+        for (int y = iy0; y < iy1; ++y) {
+            for (int ky = 0; ky < kSize; ++ky) rows[ky] = src.Row(y + ky - kHalf);
+            simd.convolveGray(rows, kernel, kSize, kHalf, width - kHalf, dst.Row(y));
+        }
+    }
+
+    void ConvolveRowsFixedGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                               const FixedKernel& kernel)
+    {
+        const int kSize = kernel.size;
+        int kHalf = kSize / 2;
+        int iy0, iy1;
+        CopyBorders<1>(src, dst, width, height, y0, y1, kHalf, iy0, iy1);
+
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        const unsigned char* rows[FixedKernel::kMaxSize];
+        for (int y = iy0; y < iy1; ++y) {
+            for (int ky = 0; ky < kSize; ++ky) rows[ky] = src.Row(y + ky - kHalf);
+            simd.convolveFixedGray(rows, kernel.coefficients, kSize, kernel.shift, kHalf, width - kHalf, dst.Row(y));
+        }
+    }
+
+    void SobelRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1)
+    {
+        int iy0, iy1;
+        CopyBorders<1>(src, dst, width, height, y0, y1, 1, iy0, iy1);
+        SobelInterior<1, 1>(src, dst, width, iy0, iy1);
+    }
+
+    void MorphologyRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                            int kernelSize, bool dilate)
+    {
+        MorphologyRowsT<1>(src, dst, width, height, y0, y1, kernelSize, dilate);
+    }
+
+    void MorphologyGradientRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                                    int kernelSize)
+    {
+        MorphologyGradientRowsT<1>(src, dst, width, height, y0, y1, kernelSize);
+    }
+
+    void MorphologyHatRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                               int kernelSize, bool white)
+    {
+        MorphologyHatRowsT<1>(src, dst, width, height, y0, y1, kernelSize, white);
+    }
+
+    void MedianRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                        int kernelSize)
+    {
+        if (kernelSize % 2 == 0)
+        {
+            for (int y = y0; y < y1; ++y) CopyRow<1>(src, dst, width, y);
+            return;
+        }
+
+        int kHalf = kernelSize / 2;
+        int iy0, iy1;
+        CopyBorders<1>(src, dst, width, height, y0, y1, kHalf, iy0, iy1);
+        if (iy0 >= iy1) return;
+
+        MedianScratch scratch(kHalf);
+        MedianPlane<1>(src, dst, width, iy0, iy1, kHalf, 0, scratch);
+    }
+}
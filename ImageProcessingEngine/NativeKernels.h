@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// =====================================================
+//  행 범위 커널 (BGRA, 내부용)
+//  NativeProcessor와 FilterPipeline이 같은 커널을 공유하므로
+//  전체 영상 처리와 밴드 단위 처리 결과가 비트 단위로 같다.
+// =====================================================
+namespace NativeKernels
+{
+    // 절대 행 번호 y로 주소를 찾는 행 버퍼. data는 firstRow 행의 시작 주소
+    struct RowBuffer
+    {
+        unsigned char* data;
+        int firstRow;
+        size_t stride;
+
+        unsigned char* Row(int y) const { return data + static_cast<ptrdiff_t>(y - firstRow) * static_cast<ptrdiff_t>(stride); }
+    };
+
+    inline RowBuffer WholeImage(unsigned char* pixels, int width)
+    {
+        return RowBuffer{ pixels, 0, static_cast<size_t>(width) * 4 };
+    }
+
+    // 그레이스케일 규칙: 0.114 B + 0.587 G + 0.299 R 을 정수로 정확히 계산 후 절삭.
+    // SIMD 구현(SimdKernels)도 같은 식을 사용하므로 모든 CPU에서 결과가 같다.
+    inline unsigned char GrayOf(const unsigned char* p)
+    {
+        return static_cast<unsigned char>((p[0] * 114 + p[1] * 587 + p[2] * 299) / 1000);
+    }
+
+    // 아래 커널들은 출력 행 [y0, y1)만 기록하고 src의 [y0 - halo, y1 + halo) ∩ [0, height) 만 읽는다.
+    // 커널 반경 안쪽이 아닌 가장자리 화소는 src를 그대로 복사한다 (기존 동작 유지).
+
+    // 그레이스케일 (halo 0, src == dst 허용)
+    void GrayscaleRows(const RowBuffer& src, const RowBuffer& dst, int width, int y0, int y1);
+
+    // 그레이스케일 + 임계값 이진화 (halo 0, src == dst 허용)
+    void BinarizeRows(const RowBuffer& src, const RowBuffer& dst, int width, int y0, int y1, int threshold);
+
+    // kSize x kSize 컨볼루션 (halo kSize/2). 내부 화소의 alpha는 255
+    void ConvolveRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                      const float* kernel, int kSize);
+
+    // 고정소수점 커널: float 계수를 2^shift 배 한 16비트 정수. 크기는 홀수 1..kMaxSize
+    struct FixedKernel
+    {
+        static const int kMaxSize = 7;
+
+        int size;
+        int shift;
+        int16_t coefficients[kMaxSize * kMaxSize];
+        float errorBound;   // 255 · Σ|q/2^shift − k|: 계수 반올림으로 생길 수 있는 출력 오차 상한 (LSB)
+    };
+
+    // float 커널을 16비트 계수로 양자화한다. |계수| <= 32767 인 가장 큰 shift(<= 16)를 고르고,
+    // 계수 합이 round(Σk · 2^shift)와 같도록 가장 큰 계수에서 반올림 오차를 보정한다
+    // (평탄한 영역 값이 그대로 유지됨). 보정 후의 출력 오차 상한을 errorBound에 기록한다.
+    // 크기가 맞지 않거나 계수가 너무 크면 false
+    bool QuantizeKernel(const float* kernel, int kSize, FixedKernel& out);
+
+    // kernel.size x kernel.size 고정소수점 컨볼루션 (halo size/2). 32비트 정수 누적 후
+    // 반올림 시프트하므로 CPU/ISA/스레드 수와 무관하게 결과가 비트 단위로 같다. 내부 화소의 alpha는 255
+    void ConvolveRowsFixed(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                           const FixedKernel& kernel);
+
+    // 소벨 크기 (halo 1). src는 그레이스케일 영상이어야 한다 (채널 0만 읽음).
+    // 정수 분리형 그래디언트(EdgeDetection)의 L2 크기를 절삭 후 255로 포화한다
+    void SobelRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1);
+
+    // 최대/최소 필터 (halo kernelSize/2). 채널 0만 읽는다. 화소당 비용은 커널 크기와 무관 (van Herk/Gil-Werman)
+    void MorphologyRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                        int kernelSize, bool dilate);
+
+    // 형태학적 그래디언트 = 팽창 - 침식 (halo kernelSize/2). 가장자리 화소는 0 (alpha 유지)
+    void MorphologyGradientRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                                int kernelSize);
+
+    // 탑햇 (halo 2 * (kernelSize/2)). white: 원본 - 열림, black: 닫힘 - 원본. 색 채널별로 계산, alpha 유지
+    void MorphologyHatRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                           int kernelSize, bool white);
+
+    // 채널별 중앙값 필터 (halo kernelSize/2). 짝수 크기는 그대로 복사.
+    // 화소당 비용은 커널 크기와 무관 (Perreault–Hébert 히스토그램)
+    void MedianRows(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                    int kernelSize);
+
+    // ---- 단일 채널(1 byte/pixel) 그레이 평면 커널 ----
+    // BGRA 커널에 그레이 영상(B = G = R)을 넣었을 때와 같은 값을 만든다.
+
+    // BGRA → 그레이 평면 (GrayOf와 동일한 결과)
+    void GrayFromBGRARows(const RowBuffer& src, const RowBuffer& dst, int width, int y0, int y1);
+
+    // 그레이 평면 → BGRA. preserveAlpha가 false면 alpha를 255로 채운다
+    void BGRAFromGrayRows(const RowBuffer& src, const RowBuffer& dst, int width, int y0, int y1, bool preserveAlpha);
+
+    void ThresholdRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int y0, int y1, int threshold);
+    void ConvolveRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                          const float* kernel, int kSize);
+    void ConvolveRowsFixedGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                               const FixedKernel& kernel);
+    void SobelRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1);
+
+    // 그레이 평면 → BGRA 소벨 크기 (B, G, R에 쓰고 alpha 유지). 가장자리 화소는 그레이 값.
+    // BGRA 그레이 영상에 SobelRows를 적용한 것과 같은 결과를 1/4 대역폭으로 읽는다
+    void SobelRowsFromGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1);
+    void MorphologyRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                            int kernelSize, bool dilate);
+    void MorphologyGradientRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                                    int kernelSize);
+    void MorphologyHatRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                               int kernelSize, bool white);
+    void MedianRowsGray(const RowBuffer& src, const RowBuffer& dst, int width, int height, int y0, int y1,
+                        int kernelSize);
+
+    // 5x5 가우시안(합 273) / 4-이웃 라플라시안 커널 계수
+    extern const float kGaussian5x5[25];
+    extern const float kLaplacian3x3[9];
+
+    // 위 커널의 고정소수점 버전 (기본 가우시안/라플라시안 연산이 사용)
+    const FixedKernel& FixedGaussian5x5();
+    const FixedKernel& FixedLaplacian3x3();
+}
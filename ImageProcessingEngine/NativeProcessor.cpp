@@ -1,227 +1,680 @@
-#include "pch.h"
+﻿#include "pch.h"
 #include "NativeProcessor.h"
+#include "NativeKernels.h"
+#include "GrayImage.h"
+#include "FFTConvolution.h"
+#include "RecursiveGaussian.h"
+#include "IntegralImage.h"
+#include "Thresholding.h"
+#include "FilterPipeline.h"
+#include "ThreadPool.h"
+#include "ScratchArena.h"
+#include "Profiler.h"
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <cstring>
+#include <functional>
 
-//  ׷̽ Լ
+using namespace NativeKernels;
+
+// 밴드 하나가 처리할 최소 화소 수. 너무 잘게 나누면 큐 비용과 밴드마다 하는 준비
+// (중앙값 히스토그램 초기화, 형태학 밴드 가장자리) 비용이 커진다
+static const int kMinBandPixels = 1 << 16;
+static const int kMinBandRows = 8;
+
+// 행 [0, height)를 밴드로 나눠 공용 스레드 풀에서 실행한다.
+// 행 커널은 출력 행 [y0, y1)만 기록하고 별도 원본 버퍼만 읽으므로 밴드끼리 겹치지 않고,
+// 결과는 한 번에 전체를 처리한 것과 비트 단위로 같다.
+static void ForEachBand(int width, int height, const std::function<void(int, int)>& body)
+{
+    const int grain = std::max(kMinBandRows, kMinBandPixels / std::max(1, width));
+    ThreadPool::Shared().ParallelFor(0, height, grain, body);
+}
+
+// 기존 그레이스케일 함수
 void NativeProcessor::ToGrayscale(unsigned char* pixels, int width, int height)
 {
-    int stride = width * 4;
-    for (int y = 0; y < height; ++y)
-    {
-        for (int x = 0; x < width; ++x)
+    ProfileScope profile("grayscale", width, height);
+    RowBuffer image = WholeImage(pixels, width);
+    ForEachBand(width, height, [&](int y0, int y1) { GrayscaleRows(image, image, width, y0, y1); });
+}
+
+// 임시 영상 버퍼는 공용 작업 버퍼 풀에서 빌린다 (같은 크기를 반복 처리하면 새 할당 없음)
+static ScratchArena::Buffer TempImage(int width, int height, int bytesPerPixel)
+{
+    return ScratchArena::Shared().Acquire(static_cast<size_t>(width) * height * bytesPerPixel);
+}
+
+// 커널이 읽을 원본 복사본을 만드는 헬퍼
+static ScratchArena::Buffer CopyOf(const unsigned char* pixels, int width, int height)
+{
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    ScratchArena::Buffer temp = TempImage(width, height, 4);
+    ForEachBand(width, height, [&](int y0, int y1)
         {
-            unsigned char* p = pixels + y * stride + x * 4;
-            unsigned char gray = static_cast<unsigned char>(p[0] * 0.114 + p[1] * 0.587 + p[2] * 0.299);
-            p[0] = p[1] = p[2] = gray;
-        }
+            memcpy(temp.Data() + y0 * rowBytes, pixels + y0 * rowBytes, (y1 - y0) * rowBytes);
+        });
+    return temp;
+}
+
+static ScratchArena::Buffer CopyOf(const GrayImage& image)
+{
+    ScratchArena::Buffer temp = TempImage(image.Width(), image.Height(), 1);
+    const size_t rowBytes = image.Stride();
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            memcpy(temp.Data() + y0 * rowBytes, image.Row(y0), (y1 - y0) * rowBytes);
+        });
+    return temp;
+}
+
+// 가우시안 블러: Wafer 표면의 미세 노이즈를 제거
+void NativeProcessor::ApplyGaussianBlur(unsigned char* pixels, int width, int height)
+{
+    ProfileScope profile("gaussian", width, height);
+    profile.SetBackend("fixed");
+    ScratchArena::Buffer temp = CopyOf(pixels, width, height);
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            ConvolveRowsFixed(WholeImage(temp.Data(), width), WholeImage(pixels, width), width, height, y0, y1,
+                              FixedGaussian5x5());
+        });
+}
+
+// ==================== Gaussian Blur (Separable + 정규화) ====================
+static std::vector<float> makeGaussian1D(int radius, float sigma)
+{
+    int size = radius * 2 + 1;
+    std::vector<float> k(size);
+    float sum = 0.f;
+    float inv2s2 = 1.f / (2.f * sigma * sigma);
+    for (int i = -radius; i <= radius; ++i)
+    {
+        float v = std::exp(-(i * i) * inv2s2);
+        k[i + radius] = v;
+        sum += v;
     }
+    // 정규화
+    float inv = 1.f / sum;
+    for (float& v : k) v *= inv;
+    return k;
+}
+
+static inline int clamp_index(int v, int lo, int hi)
+{
+    return (v < lo) ? lo : ((v > hi) ? hi : v);
+}
+
+static inline unsigned char clamp_u8_from_float(float v)
+{
+    // 0..255 범위로 클램프 + 반올림
+    v = (v < 0.f) ? 0.f : ((v > 255.f) ? 255.f : v);
+    return static_cast<unsigned char>(v + 0.5f);
 }
 
-//   Լ
-void Convolve(const unsigned char* src, unsigned char* dst, int width, int height, const std::vector<float>& kernel, int kSize) {
-    int kHalf = kSize / 2;
-    int stride = width * 4;
-
-    for (int y = kHalf; y < height - kHalf; ++y) {
-        for (int x = kHalf; x < width - kHalf; ++x) {
-            float sum_b = 0, sum_g = 0, sum_r = 0;
-            for (int ky = -kHalf; ky <= kHalf; ++ky) {
-                for (int kx = -kHalf; kx <= kHalf; ++kx) {
-                    const unsigned char* p = src + (y + ky) * stride + (x + kx) * 4;
-                    float k_val = kernel[(ky + kHalf) * kSize + (kx + kHalf)];
-                    sum_b += p[0] * k_val;
-                    sum_g += p[1] * k_val;
-                    sum_r += p[2] * k_val;
+void NativeProcessor::ApplyGaussianBlur(unsigned char* pixels, int width, int height, int radius, float sigma)
+{
+    ProfileScope profile("gaussian", width, height);
+    profile.SetBackend("separable");
+    // 임시 버퍼 (float로 누적 → 품질↑)
+    const size_t N = static_cast<size_t>(width) * height;
+    ScratchArena::Buffer planes = ScratchArena::Shared().Acquire(N * 3 * sizeof(float));
+    float* tmpB = planes.As<float>();
+    float* tmpG = tmpB + N;
+    float* tmpR = tmpG + N;
+
+    // 수평 패스
+    auto k = makeGaussian1D(radius, sigma);
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            for (int y = y0; y < y1; ++y)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    float sb = 0.f, sg = 0.f, sr = 0.f;
+                    for (int t = -radius; t <= radius; ++t)
+                    {
+                        int xx = clamp_index(x + t, 0, width - 1);
+                        const unsigned char* p = pixels + (static_cast<size_t>(y) * width + xx) * 4;
+                        float w = k[t + radius];
+                        sb += p[0] * w;
+                        sg += p[1] * w;
+                        sr += p[2] * w;
+                    }
+                    size_t o = static_cast<size_t>(y) * width + x;
+                    tmpB[o] = sb; tmpG[o] = sg; tmpR[o] = sr;
                 }
             }
-            unsigned char* out_p = dst + y * stride + x * 4;
-            out_p[0] = static_cast<unsigned char>(std::max(0.0f, std::min(255.0f, sum_b)));
-            out_p[1] = static_cast<unsigned char>(std::max(0.0f, std::min(255.0f, sum_g)));
-            out_p[2] = static_cast<unsigned char>(std::max(0.0f, std::min(255.0f, sum_r)));
-            out_p[3] = 255; // Alpha
-        }
-    }
-}
+        });
 
+    // 수직 패스 + 출력
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            for (int y = y0; y < y1; ++y)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    float sb = 0.f, sg = 0.f, sr = 0.f;
+                    for (int t = -radius; t <= radius; ++t)
+                    {
+                        int yy = clamp_index(y + t, 0, height - 1);
+                        size_t o = static_cast<size_t>(yy) * width + x;
+                        float w = k[t + radius];
+                        sb += tmpB[o] * w;
+                        sg += tmpG[o] * w;
+                        sr += tmpR[o] * w;
+                    }
+                    unsigned char* p = pixels + (static_cast<size_t>(y) * width + x) * 4;
+                    p[0] = clamp_u8_from_float(sb);
+                    p[1] = clamp_u8_from_float(sg);
+                    p[2] = clamp_u8_from_float(sr);
+                    // alpha는 그대로 둔다
+                }
+            }
+        });
+}
 
-// þ : Wafer ǥ ̼  
-void NativeProcessor::ApplyGaussianBlur(unsigned char* pixels, int width, int height)
+void NativeProcessor::ApplyGaussianBlur(unsigned char* pixels, int width, int height, float sigma, GaussianMethod method)
 {
-    // 5x5 þ Ŀ
-    std::vector<float> kernel = {
-        1, 4, 7, 4, 1,
-        4, 16, 26, 16, 4,
-        7, 26, 41, 26, 7,
-        4, 16, 26, 16, 4,
-        1, 4, 7, 4, 1
-    };
-    float kernelSum = 273.0f;
-    for (float& val : kernel) {
-        val /= kernelSum;
+    ProfileScope profile("gaussian-sigma", width, height);
+    if (sigma <= 0.f) return;
+
+    if (method == GaussianMethod::Auto)
+    {
+        method = RecursiveGaussian::PreferRecursive(sigma) ? GaussianMethod::Recursive : GaussianMethod::Separable;
     }
 
-    std::vector<unsigned char> temp(width * height * 4);
-    memcpy(temp.data(), pixels, width * height * 4);
+    profile.SetBackend(method == GaussianMethod::Recursive ? "recursive" : "separable");
+    if (method == GaussianMethod::Recursive)
+    {
+        RecursiveGaussian::Blur(pixels, width, height, 4, sigma);
+        return;
+    }
 
-    Convolve(temp.data(), pixels, width, height, kernel, 5);
+    // ±3σ 밖의 가중치는 0.3% 미만이다
+    const int radius = std::max(1, static_cast<int>(std::ceil(3.f * sigma)));
+    ApplyGaussianBlur(pixels, width, height, radius, sigma);
 }
 
-// Һ  : ݵü ȸ  踦 Ȯϰ 
+// 소벨 엣지 검출: 반도체 회로 패턴의 경계를 명확하게 추출
 void NativeProcessor::ApplySobel(unsigned char* pixels, int width, int height)
 {
-    ToGrayscale(pixels, width, height); //  ׷̽Ϸ ȯ
+    ProfileScope profile("sobel", width, height);
+    // 그레이 평면(1 byte/pixel)에 변환해 두고 읽는다 (BGRA 그레이 복사본의 1/4 대역폭)
+    ScratchArena::Buffer temp = TempImage(width, height, 1);
+    const RowBuffer gray{ temp.Data(), 0, static_cast<size_t>(width) };
+    ForEachBand(width, height, [&](int y0, int y1) { GrayFromBGRARows(WholeImage(pixels, width), gray, width, y0, y1); });
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            SobelRowsFromGray(gray, WholeImage(pixels, width), width, height, y0, y1);
+        });
+}
+
+// 라플라시안 필터: Wafer의 미세한 스크래치나 크랙 같은 결함을 강조.
+void NativeProcessor::ApplyLaplacian(unsigned char* pixels, int width, int height)
+{
+    ProfileScope profile("laplacian", width, height);
+    profile.SetBackend("fixed");
+    ScratchArena::Buffer temp = TempImage(width, height, 4);
+    RowBuffer gray = WholeImage(temp.Data(), width);
+    ForEachBand(width, height, [&](int y0, int y1) { GrayscaleRows(WholeImage(pixels, width), gray, width, y0, y1); });
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            ConvolveRowsFixed(gray, WholeImage(pixels, width), width, height, y0, y1, FixedLaplacian3x3());
+        });
+}
 
-    int stride = width * 4;
-    std::vector<unsigned char> temp(width * height * 4);
-    memcpy(temp.data(), pixels, width * height * 4);
 
-    int Gx, Gy;
-    int G;
+// 이진화: 회로 패턴과 배경을 명확하게 분리하여 패턴의 폭이나 간격을 측정하는 데 사용
+void NativeProcessor::ApplyBinarization(unsigned char* pixels, int width, int height, int threshold)
+{
+    ProfileScope profile("binarization", width, height);
+    RowBuffer image = WholeImage(pixels, width);
+    ForEachBand(width, height, [&](int y0, int y1) { BinarizeRows(image, image, width, y0, y1, threshold); });
+}
 
-    int sobel_x[3][3] = { {-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1} };
-    int sobel_y[3][3] = { {1, 2, 1}, {0, 0, 0}, {-1, -2, -1} };
+// 오츠 이진화: 조명에 따라 달라지는 패턴/배경 밝기에 맞춰 임계값을 자동으로 고른다
+int NativeProcessor::ApplyOtsuBinarization(unsigned char* pixels, int width, int height)
+{
+    ProfileScope profile("otsu", width, height);
+    uint64_t histogram[Thresholding::kHistogramBins];
+    Thresholding::HistogramBGRA(pixels, width, height, static_cast<size_t>(width) * 4, histogram);
+    const int threshold = Thresholding::OtsuThreshold(histogram);
+    ApplyBinarization(pixels, width, height, threshold);
+    return threshold;
+}
 
-    for (int y = 1; y < height - 1; ++y) {
-        for (int x = 1; x < width - 1; ++x) {
-            Gx = 0; Gy = 0;
-            for (int i = -1; i <= 1; ++i) {
-                for (int j = -1; j <= 1; ++j) {
-                    int pixel_val = temp[(y + i) * stride + (x + j) * 4];
-                    Gx += pixel_val * sobel_x[i + 1][j + 1];
-                    Gy += pixel_val * sobel_y[i + 1][j + 1];
-                }
-            }
-            G = static_cast<int>(sqrt(Gx * Gx + Gy * Gy));
-            G = std::min(255, std::max(0, G));
+// 적응형 이진화: 웨이퍼 중심/가장자리 조명 차이가 있어도 국소 대비로 패턴을 분리
+void NativeProcessor::ApplyAdaptiveThreshold(unsigned char* pixels, int width, int height, AdaptiveMethod method,
+                                             int windowSize, float k)
+{
+    ProfileScope profile("adaptive-threshold", width, height);
+    if (windowSize < 3) return;
+
+    ScratchArena::Buffer gray = TempImage(width, height, 1);
+    const RowBuffer plane{ gray.Data(), 0, static_cast<size_t>(width) };
+    ForEachBand(width, height, [&](int y0, int y1) { GrayFromBGRARows(WholeImage(pixels, width), plane, width, y0, y1); });
+
+    IntegralImage integral;
+    integral.Build(gray.Data(), width, height, plane.stride, method != AdaptiveMethod::Mean);
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            Thresholding::AdaptiveRows(integral, gray.Data(), plane.stride, pixels, static_cast<size_t>(width) * 4, 4,
+                                       y0, y1, method, windowSize, k);
+        });
+}
+
+// 팽창(Dilation): 끊어진 회로 패턴을 연결하거나 작은 노이즈(먼지 등)를 제거하는 데 사용
+void NativeProcessor::ApplyDilation(unsigned char* pixels, int width, int height, int kernelSize)
+{
+    ProfileScope profile("dilation", width, height);
+    if (kernelSize < 1) return;
+
+    ScratchArena::Buffer temp = CopyOf(pixels, width, height);
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            MorphologyRows(WholeImage(temp.Data(), width), WholeImage(pixels, width), width, height, y0, y1,
+                           kernelSize, true);
+        });
+}
+
+
+// 침식(Erosion): 회로 패턴의 얇은 부분을 제거하거나 붙어있는 객체를 분리하는 데 사용
+void NativeProcessor::ApplyErosion(unsigned char* pixels, int width, int height, int kernelSize)
+{
+    ProfileScope profile("erosion", width, height);
+    if (kernelSize < 1) return;
+
+    ScratchArena::Buffer temp = CopyOf(pixels, width, height);
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            MorphologyRows(WholeImage(temp.Data(), width), WholeImage(pixels, width), width, height, y0, y1,
+                           kernelSize, false);
+        });
+}
 
-            unsigned char* p = pixels + y * stride + x * 4;
-            p[0] = p[1] = p[2] = G;
-        }
+// 열림/닫힘: 임시 버퍼 하나로 두 번 왕복 (image → temp → image)
+static void OpenClose(const RowBuffer& image, const RowBuffer& temp, int width, int height, int kernelSize,
+                      bool opening, bool gray)
+{
+    if (gray)
+    {
+        ForEachBand(width, height, [&](int y0, int y1)
+            {
+                MorphologyRowsGray(image, temp, width, height, y0, y1, kernelSize, !opening);
+            });
+        ForEachBand(width, height, [&](int y0, int y1)
+            {
+                MorphologyRowsGray(temp, image, width, height, y0, y1, kernelSize, opening);
+            });
+    }
+    else
+    {
+        ForEachBand(width, height, [&](int y0, int y1)
+            {
+                MorphologyRows(image, temp, width, height, y0, y1, kernelSize, !opening);
+            });
+        ForEachBand(width, height, [&](int y0, int y1)
+            {
+                MorphologyRows(temp, image, width, height, y0, y1, kernelSize, opening);
+            });
     }
 }
 
-// öþ : Wafer ̼ ũġ ũ   .
-void NativeProcessor::ApplyLaplacian(unsigned char* pixels, int width, int height)
+// 열림(Opening): 커널보다 작은 밝은 돌기/노이즈 제거
+void NativeProcessor::ApplyOpening(unsigned char* pixels, int width, int height, int kernelSize)
 {
-    ToGrayscale(pixels, width, height); //  ׷̽Ϸ ȯ
+    ProfileScope profile("opening", width, height);
+    if (kernelSize < 1) return;
 
-    std::vector<float> kernel = {
-        0, -1, 0,
-       -1,  4, -1,
-        0, -1, 0
-    };
+    ScratchArena::Buffer temp = TempImage(width, height, 4);
+    OpenClose(WholeImage(pixels, width), WholeImage(temp.Data(), width), width, height, kernelSize, true, false);
+}
 
-    std::vector<unsigned char> temp(width * height * 4);
-    memcpy(temp.data(), pixels, width * height * 4);
+// 닫힘(Closing): 회로 패턴의 끊어진 틈과 작은 구멍 메우기
+void NativeProcessor::ApplyClosing(unsigned char* pixels, int width, int height, int kernelSize)
+{
+    ProfileScope profile("closing", width, height);
+    if (kernelSize < 1) return;
 
-    Convolve(temp.data(), pixels, width, height, kernel, 3);
+    ScratchArena::Buffer temp = TempImage(width, height, 4);
+    OpenClose(WholeImage(pixels, width), WholeImage(temp.Data(), width), width, height, kernelSize, false, false);
 }
 
+// 형태학적 그래디언트: 패턴 윤곽 추출
+void NativeProcessor::ApplyMorphologyGradient(unsigned char* pixels, int width, int height, int kernelSize)
+{
+    ProfileScope profile("morph-gradient", width, height);
+    if (kernelSize < 1) return;
 
-// ȭ: ȸ ϰ  Ȯϰ иϿ  ̳  ϴ  
-void NativeProcessor::ApplyBinarization(unsigned char* pixels, int width, int height, int threshold)
+    ScratchArena::Buffer temp = CopyOf(pixels, width, height);
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            MorphologyGradientRows(WholeImage(temp.Data(), width), WholeImage(pixels, width), width, height, y0, y1,
+                                   kernelSize);
+        });
+}
+
+// 탑햇: 불균일한 배경 위의 작고 밝은 결함 강조
+void NativeProcessor::ApplyTopHat(unsigned char* pixels, int width, int height, int kernelSize)
 {
-    ToGrayscale(pixels, width, height); //  ׷̽Ϸ ȯ
-    int stride = width * 4;
-    for (int y = 0; y < height; ++y)
-    {
-        for (int x = 0; x < width; ++x)
+    ProfileScope profile("tophat", width, height);
+    if (kernelSize < 1) return;
+
+    ScratchArena::Buffer temp = CopyOf(pixels, width, height);
+    ForEachBand(width, height, [&](int y0, int y1)
         {
-            unsigned char* p = pixels + y * stride + x * 4;
-            unsigned char gray = p[0];
-            unsigned char binary = (gray > threshold) ? 255 : 0;
-            p[0] = p[1] = p[2] = binary;
-        }
-    }
+            MorphologyHatRows(WholeImage(temp.Data(), width), WholeImage(pixels, width), width, height, y0, y1,
+                              kernelSize, true);
+        });
 }
 
-// â(Dilation):  ȸ  ϰų  ( ) ϴ  
-void NativeProcessor::ApplyDilation(unsigned char* pixels, int width, int height, int kernelSize)
+// 블랙햇: 작고 어두운 결함(핀홀 등) 강조
+void NativeProcessor::ApplyBlackHat(unsigned char* pixels, int width, int height, int kernelSize)
 {
-    int stride = width * 4;
-    std::vector<unsigned char> temp(width * height * 4);
-    memcpy(temp.data(), pixels, width * height * 4);
+    ProfileScope profile("blackhat", width, height);
+    if (kernelSize < 1) return;
 
-    int kHalf = kernelSize / 2;
+    ScratchArena::Buffer temp = CopyOf(pixels, width, height);
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            MorphologyHatRows(WholeImage(temp.Data(), width), WholeImage(pixels, width), width, height, y0, y1,
+                              kernelSize, false);
+        });
+}
 
-    for (int y = kHalf; y < height - kHalf; ++y) {
-        for (int x = kHalf; x < width - kHalf; ++x) {
-            unsigned char maxVal = 0;
-            for (int ky = -kHalf; ky <= kHalf; ++ky) {
-                for (int kx = -kHalf; kx <= kHalf; ++kx) {
-                    maxVal = std::max(maxVal, temp[(y + ky) * stride + (x + kx) * 4]);
-                }
-            }
-            unsigned char* p = pixels + y * stride + x * 4;
-            p[0] = p[1] = p[2] = maxVal;
-        }
-    }
+// 중앙값 필터
+void NativeProcessor::ApplyMedianFilter(unsigned char* pixels, int width, int height, int kernelSize)
+{
+    ProfileScope profile("median", width, height);
+    if (kernelSize < 1 || kernelSize % 2 == 0) return; // 커널 크기는 홀수여야 함
+
+    ScratchArena::Buffer temp = CopyOf(pixels, width, height);
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            MedianRows(WholeImage(temp.Data(), width), WholeImage(pixels, width), width, height, y0, y1,
+                       kernelSize);
+        });
 }
 
+// ==================== 임의 커널 컨볼루션 (공간 / FFT / 고정소수점 자동 선택) ====================
+static bool UseFFT(ConvolutionMethod method, int width, int height, int kSize, int bytesPerPixel)
+{
+    if (method == ConvolutionMethod::Auto) return FFTConvolution::PreferFFT(width, height, kSize, bytesPerPixel);
+    return method == ConvolutionMethod::FFT;
+}
 
-// ħ(Erosion): ȸ   κ ϰų پִ ü иϴ  
-void NativeProcessor::ApplyErosion(unsigned char* pixels, int width, int height, int kernelSize)
+// 고정소수점 경로를 쓰면 fixed에 양자화된 커널을 채운다
+// Auto에서 고정소수점 경로를 허용하는 양자화 오차 상한 (LSB). 0.5 이하면 float 경로와 ±1 LSB 이내
+static const float kMaxAutoFixedError = 0.5f;
+
+// Auto는 계수 반올림 오차가 kMaxAutoFixedError를 넘으면 (작은 shift, 동적 범위가 큰 커널)
+// float 공간/FFT 경로로 되돌아간다. FixedPoint는 오차와 무관하게 양자화한다
+static bool UseFixedPoint(ConvolutionMethod method, const float* kernel, int kSize, FixedKernel& fixed)
 {
-    int stride = width * 4;
-    std::vector<unsigned char> temp(width * height * 4);
-    memcpy(temp.data(), pixels, width * height * 4);
+    if (method != ConvolutionMethod::Auto && method != ConvolutionMethod::FixedPoint) return false;
+    if (!QuantizeKernel(kernel, kSize, fixed)) return false;
+    return method == ConvolutionMethod::FixedPoint || fixed.errorBound <= kMaxAutoFixedError;
+}
 
-    int kHalf = kernelSize / 2;
+void NativeProcessor::ApplyConvolution(unsigned char* pixels, int width, int height, const float* kernel, int kSize,
+                                       ConvolutionMethod method)
+{
+    ProfileScope profile("convolution", width, height);
+    if (kernel == nullptr || kSize < 1 || kSize % 2 == 0) return; // 커널 크기는 홀수여야 함
 
-    for (int y = kHalf; y < height - kHalf; ++y) {
-        for (int x = kHalf; x < width - kHalf; ++x) {
-            unsigned char minVal = 255;
-            for (int ky = -kHalf; ky <= kHalf; ++ky) {
-                for (int kx = -kHalf; kx <= kHalf; ++kx) {
-                    minVal = std::min(minVal, temp[(y + ky) * stride + (x + kx) * 4]);
-                }
-            }
-            unsigned char* p = pixels + y * stride + x * 4;
-            p[0] = p[1] = p[2] = minVal;
-        }
+    ScratchArena::Buffer temp = CopyOf(pixels, width, height);
+    FixedKernel fixed;
+    if (UseFixedPoint(method, kernel, kSize, fixed))
+    {
+        profile.SetBackend("fixed");
+        ForEachBand(width, height, [&](int y0, int y1)
+            {
+                ConvolveRowsFixed(WholeImage(temp.Data(), width), WholeImage(pixels, width), width, height, y0, y1,
+                                  fixed);
+            });
+        return;
     }
+    if (UseFFT(method, width, height, kSize, 4))
+    {
+        profile.SetBackend("fft");
+        FFTConvolution::Convolve(temp.Data(), pixels, width, height, 4, kernel, kSize);
+        return;
+    }
+    profile.SetBackend("spatial");
+    ForEachBand(width, height, [&](int y0, int y1)
+        {
+            ConvolveRows(WholeImage(temp.Data(), width), WholeImage(pixels, width), width, height, y0, y1,
+                         kernel, kSize);
+        });
 }
 
-// ߾Ӱ 
-void NativeProcessor::ApplyMedianFilter(unsigned char* pixels, int width, int height, int kernelSize)
+// ==================== 그레이 평면 연산 ====================
+static RowBuffer PlaneOf(GrayImage& image)
+{
+    return RowBuffer{ image.Data(), 0, image.Stride() };
+}
+
+// image와 같은 크기의 임시 평면
+static RowBuffer PlaneOf(const ScratchArena::Buffer& temp, const GrayImage& image)
+{
+    return RowBuffer{ temp.Data(), 0, image.Stride() };
+}
+
+void NativeProcessor::ApplyGaussianBlur(GrayImage& image)
 {
-    if (kernelSize % 2 == 0) return; // Ŀ ũ Ȧ 
+    ProfileScope profile("gray-gaussian", image.Width(), image.Height());
+    profile.SetBackend("fixed");
+    ScratchArena::Buffer temp = CopyOf(image);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            ConvolveRowsFixedGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1,
+                                  FixedGaussian5x5());
+        });
+}
 
-    std::vector<unsigned char> temp(width * height * 4);
-    memcpy(temp.data(), pixels, width * height * 4);
+void NativeProcessor::ApplySobel(GrayImage& image)
+{
+    ProfileScope profile("gray-sobel", image.Width(), image.Height());
+    ScratchArena::Buffer temp = CopyOf(image);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            SobelRowsGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1);
+        });
+}
 
-    int kHalf = kernelSize / 2;
-    int stride = width * 4;
+void NativeProcessor::ApplyLaplacian(GrayImage& image)
+{
+    ProfileScope profile("gray-laplacian", image.Width(), image.Height());
+    profile.SetBackend("fixed");
+    ScratchArena::Buffer temp = CopyOf(image);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            ConvolveRowsFixedGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1,
+                                  FixedLaplacian3x3());
+        });
+}
 
-    for (int y = kHalf; y < height - kHalf; ++y) {
-        for (int x = kHalf; x < width - kHalf; ++x) {
-            std::vector<unsigned char> b_vals, g_vals, r_vals;
-            for (int ky = -kHalf; ky <= kHalf; ++ky) {
-                for (int kx = -kHalf; kx <= kHalf; ++kx) {
-                    const unsigned char* p = temp.data() + (y + ky) * stride + (x + kx) * 4;
-                    b_vals.push_back(p[0]);
-                    g_vals.push_back(p[1]);
-                    r_vals.push_back(p[2]);
-                }
-            }
+void NativeProcessor::ApplyBinarization(GrayImage& image, int threshold)
+{
+    ProfileScope profile("gray-binarization", image.Width(), image.Height());
+    RowBuffer plane = PlaneOf(image);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            ThresholdRowsGray(plane, plane, image.Width(), y0, y1, threshold);
+        });
+}
+
+int NativeProcessor::ApplyOtsuBinarization(GrayImage& image)
+{
+    ProfileScope profile("gray-otsu", image.Width(), image.Height());
+    uint64_t histogram[Thresholding::kHistogramBins];
+    Thresholding::Histogram(image.Data(), image.Width(), image.Height(), image.Stride(), histogram);
+    const int threshold = Thresholding::OtsuThreshold(histogram);
+    ApplyBinarization(image, threshold);
+    return threshold;
+}
+
+void NativeProcessor::ApplyAdaptiveThreshold(GrayImage& image, AdaptiveMethod method, int windowSize, float k)
+{
+    ProfileScope profile("gray-adaptive-threshold", image.Width(), image.Height());
+    if (windowSize < 3 || image.Empty()) return;
+
+    IntegralImage integral;
+    integral.Build(image.Data(), image.Width(), image.Height(), image.Stride(), method != AdaptiveMethod::Mean);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            Thresholding::AdaptiveRows(integral, image.Data(), image.Stride(), image.Data(), image.Stride(), 1,
+                                       y0, y1, method, windowSize, k);
+        });
+}
+
+void NativeProcessor::ApplyDilation(GrayImage& image, int kernelSize)
+{
+    ProfileScope profile("gray-dilation", image.Width(), image.Height());
+    if (kernelSize < 1) return;
 
-            std::sort(b_vals.begin(), b_vals.end());
-            std::sort(g_vals.begin(), g_vals.end());
-            std::sort(r_vals.begin(), r_vals.end());
+    ScratchArena::Buffer temp = CopyOf(image);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            MorphologyRowsGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1,
+                               kernelSize, true);
+        });
+}
+
+void NativeProcessor::ApplyErosion(GrayImage& image, int kernelSize)
+{
+    ProfileScope profile("gray-erosion", image.Width(), image.Height());
+    if (kernelSize < 1) return;
+
+    ScratchArena::Buffer temp = CopyOf(image);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            MorphologyRowsGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1,
+                               kernelSize, false);
+        });
+}
+
+void NativeProcessor::ApplyOpening(GrayImage& image, int kernelSize)
+{
+    ProfileScope profile("gray-opening", image.Width(), image.Height());
+    if (kernelSize < 1) return;
+
+    ScratchArena::Buffer temp = TempImage(image.Width(), image.Height(), 1);
+    OpenClose(PlaneOf(image), PlaneOf(temp, image), image.Width(), image.Height(), kernelSize, true, true);
+}
+
+void NativeProcessor::ApplyClosing(GrayImage& image, int kernelSize)
+{
+    ProfileScope profile("gray-closing", image.Width(), image.Height());
+    if (kernelSize < 1) return;
+
+    ScratchArena::Buffer temp = TempImage(image.Width(), image.Height(), 1);
+    OpenClose(PlaneOf(image), PlaneOf(temp, image), image.Width(), image.Height(), kernelSize, false, true);
+}
+
+void NativeProcessor::ApplyMorphologyGradient(GrayImage& image, int kernelSize)
+{
+    ProfileScope profile("gray-morph-gradient", image.Width(), image.Height());
+    if (kernelSize < 1) return;
+
+    ScratchArena::Buffer temp = CopyOf(image);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            MorphologyGradientRowsGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1,
+                                       kernelSize);
+        });
+}
+
+void NativeProcessor::ApplyTopHat(GrayImage& image, int kernelSize)
+{
+    ProfileScope profile("gray-tophat", image.Width(), image.Height());
+    if (kernelSize < 1) return;
+
+    ScratchArena::Buffer temp = CopyOf(image);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            MorphologyHatRowsGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1,
+                                  kernelSize, true);
+        });
+}
+
+void NativeProcessor::ApplyBlackHat(GrayImage& image, int kernelSize)
+{
+    ProfileScope profile("gray-blackhat", image.Width(), image.Height());
+    if (kernelSize < 1) return;
+
+    ScratchArena::Buffer temp = CopyOf(image);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            MorphologyHatRowsGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1,
+                                  kernelSize, false);
+        });
+}
 
-            int median_index = b_vals.size() / 2;
-            unsigned char median_b = b_vals[median_index];
-            unsigned char median_g = g_vals[median_index];
-            unsigned char median_r = r_vals[median_index];
+void NativeProcessor::ApplyMedianFilter(GrayImage& image, int kernelSize)
+{
+    ProfileScope profile("gray-median", image.Width(), image.Height());
+    if (kernelSize < 1 || kernelSize % 2 == 0) return;
+
+    ScratchArena::Buffer temp = CopyOf(image);
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            MedianRowsGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1,
+                           kernelSize);
+        });
+}
+
+void NativeProcessor::ApplyConvolution(GrayImage& image, const float* kernel, int kSize, ConvolutionMethod method)
+{
+    ProfileScope profile("gray-convolution", image.Width(), image.Height());
+    if (kernel == nullptr || kSize < 1 || kSize % 2 == 0) return;
 
-            unsigned char* p = pixels + y * stride + x * 4;
-            p[0] = median_b;
-            p[1] = median_g;
-            p[2] = median_r;
-        }
+    ScratchArena::Buffer temp = CopyOf(image);
+    FixedKernel fixed;
+    if (UseFixedPoint(method, kernel, kSize, fixed))
+    {
+        profile.SetBackend("fixed");
+        ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+            {
+                ConvolveRowsFixedGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1,
+                                      fixed);
+            });
+        return;
+    }
+    if (UseFFT(method, image.Width(), image.Height(), kSize, 1))
+    {
+        profile.SetBackend("fft");
+        FFTConvolution::Convolve(temp.Data(), image.Data(), image.Width(), image.Height(), 1, kernel, kSize);
+        return;
     }
+    profile.SetBackend("spatial");
+    ForEachBand(image.Width(), image.Height(), [&](int y0, int y1)
+        {
+            ConvolveRowsGray(PlaneOf(temp, image), PlaneOf(image), image.Width(), image.Height(), y0, y1,
+                             kernel, kSize);
+        });
+}
+
+// ==================== 호출자 버퍼 (stride / ROI) ====================
+// 밴드 파이프라인이 src 행을 캐시 크기 밴드로 읽어 dst에 바로 기록하므로 영상 전체 임시 복사가 없다
+bool NativeProcessor::Apply(FilterOp op, int param, const ImageView& src, const ImageView& dst)
+{
+    if (op < FilterOp::Grayscale || op > FilterOp::BlackHat) return false;
+
+    FilterPipeline pipeline;
+    pipeline.Add(op, param);
+    return pipeline.Run(src, dst);
+}
+
+bool NativeProcessor::Apply(FilterOp op, int param, const ImageView& src, const ImageView& dst, const ImageRect& roi)
+{
+    if (op < FilterOp::Grayscale || op > FilterOp::BlackHat) return false;
+
+    FilterPipeline pipeline;
+    pipeline.Add(op, param);
+    return pipeline.Run(src, dst, roi);
 }
 
 void NativeProcessor::Binarize(unsigned char* pixels, int width, int height, int threshold)
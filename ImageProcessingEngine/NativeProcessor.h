@@ -1,34 +1,121 @@
-#pragma once
+﻿#pragma once
+
+class GrayImage;
+struct ImageView;
+struct ImageRect;
+enum class FilterOp;
+enum class AdaptiveMethod;
+
+// 임의 커널 컨볼루션 경로. Auto는 7x7 이하 커널이면 고정소수점 경로를, 그보다 크면
+// 커널 크기 교차점에 따라 공간/FFT 경로를 고른다
+enum class ConvolutionMethod
+{
+    Auto,
+    Spatial,
+    FFT,
+    FixedPoint,     // 16비트 계수 + 32비트 정수 누적 + 반올림. CPU와 무관하게 비트 단위로 같은 결과
+};
+
+// 시그마 지정 가우시안 경로. Auto는 시그마 교차점에 따라 분리형/재귀(IIR) 경로를 고른다
+enum class GaussianMethod
+{
+    Auto,
+    Separable,
+    Recursive,
+};
 
 class NativeProcessor
 {
 public:
-    // ȼ ͸ ޾ ׷̽Ϸ ȯϴ Լ
+    // 픽셀 데이터를 받아 그레이스케일로 변환하는 함수
     void ToGrayscale(unsigned char* pixels, int width, int height);
 
-    // ---  ߰ Լ  ---
+    // --- 새로 추가된 함수 선언 ---
 
-    // þ  ( )
+    // 가우시안 블러 (노이즈 제거)
     void ApplyGaussianBlur(unsigned char* pixels, int width, int height);
 
-    // Һ  
+    // 가우시안 블러 (분리형 1D 커널, 가장자리 클램프)
+    void ApplyGaussianBlur(unsigned char* pixels, int width, int height, int radius, float sigma);
+
+    // 가우시안 블러 (시그마만 지정, 0.5 ~ 50 이상). 분리형은 반지름 ceil(3σ), 재귀 경로는 시그마와 무관한
+    // 화소당 비용으로 배경 추정 같은 큰 시그마에 쓴다. Auto는 σ ≥ 2에서 재귀 경로를 고른다
+    void ApplyGaussianBlur(unsigned char* pixels, int width, int height, float sigma,
+                           GaussianMethod method = GaussianMethod::Auto);
+
+    // 소벨 엣지 검출
     void ApplySobel(unsigned char* pixels, int width, int height);
 
-    // öþ  
+    // 라플라시안 엣지 검출
     void ApplyLaplacian(unsigned char* pixels, int width, int height);
 
-    // ȭ (Ӱ谪 ó)
+    // 이진화 (임계값 처리)
     void ApplyBinarization(unsigned char* pixels, int width, int height, int threshold);
 
-    // â  (Morphology)
+    // 오츠 자동 임계값 이진화. 그레이 히스토그램에서 임계값을 골라 ApplyBinarization과 같이 적용하고
+    // 사용한 임계값(0..255)을 돌려준다
+    int ApplyOtsuBinarization(unsigned char* pixels, int width, int height);
+
+    // 적응형(국소) 임계값 이진화: 화소마다 windowSize x windowSize 창의 평균/표준편차로 임계값을 정한다.
+    // 적분 영상을 쓰므로 화소당 비용이 창 크기와 무관하다. 조명이 고르지 않은 영상용 (방식과 k는 AdaptiveMethod 참고).
+    // windowSize < 3 이면 아무것도 하지 않는다. alpha 유지
+    void ApplyAdaptiveThreshold(unsigned char* pixels, int width, int height, AdaptiveMethod method, int windowSize,
+                                float k);
+
+    // 팽창 연산 (Morphology)
     void ApplyDilation(unsigned char* pixels, int width, int height, int kernelSize);
 
-    // ħ  (Morphology)
+    // 침식 연산 (Morphology)
     void ApplyErosion(unsigned char* pixels, int width, int height, int kernelSize);
 
-    // ߾Ӱ 
+    // 열림(침식 → 팽창) / 닫힘(팽창 → 침식)
+    void ApplyOpening(unsigned char* pixels, int width, int height, int kernelSize);
+    void ApplyClosing(unsigned char* pixels, int width, int height, int kernelSize);
+
+    // 형태학적 그래디언트 (팽창 - 침식)
+    void ApplyMorphologyGradient(unsigned char* pixels, int width, int height, int kernelSize);
+
+    // 탑햇 (원본 - 열림) / 블랙햇 (닫힘 - 원본)
+    void ApplyTopHat(unsigned char* pixels, int width, int height, int kernelSize);
+    void ApplyBlackHat(unsigned char* pixels, int width, int height, int kernelSize);
+
+    // 중앙값 필터
     void ApplyMedianFilter(unsigned char* pixels, int width, int height, int kernelSize);
 
+    // kSize x kSize 임의 커널 컨볼루션 (kernel[ky * kSize + kx], 상관 방식, 가장자리 kSize/2는 원본 유지).
+    // FFT/고정소수점 경로는 공간 경로와 ±1 LSB 이내로 같다. 고정소수점 경로는 7x7까지이며
+    // 커널을 양자화할 수 없으면 공간 경로로 대신한다. Auto는 양자화 오차 상한이 0.5 LSB를 넘는
+    // 커널도 공간/FFT 경로로 보낸다
+    void ApplyConvolution(unsigned char* pixels, int width, int height, const float* kernel, int kSize,
+                          ConvolutionMethod method = ConvolutionMethod::Auto);
+
+    // --- 단일 채널 그레이 평면(GrayImage) 연산: BGRA 버전과 같은 결과, 1/4 대역폭 ---
+    void ApplyGaussianBlur(GrayImage& image);
+    void ApplySobel(GrayImage& image);
+    void ApplyLaplacian(GrayImage& image);
+    void ApplyBinarization(GrayImage& image, int threshold);
+    int ApplyOtsuBinarization(GrayImage& image);
+    void ApplyAdaptiveThreshold(GrayImage& image, AdaptiveMethod method, int windowSize, float k);
+    void ApplyDilation(GrayImage& image, int kernelSize);
+    void ApplyErosion(GrayImage& image, int kernelSize);
+    void ApplyOpening(GrayImage& image, int kernelSize);
+    void ApplyClosing(GrayImage& image, int kernelSize);
+    void ApplyMorphologyGradient(GrayImage& image, int kernelSize);
+    void ApplyTopHat(GrayImage& image, int kernelSize);
+    void ApplyBlackHat(GrayImage& image, int kernelSize);
+    void ApplyMedianFilter(GrayImage& image, int kernelSize);
+    void ApplyConvolution(GrayImage& image, const float* kernel, int kSize,
+                          ConvolutionMethod method = ConvolutionMethod::Auto);
+
+    // --- 호출자 버퍼 직접 처리: 행 간격(stride)과 ROI를 뷰로 지정, 영상 전체 복사 없음 ---
+    // src를 읽어 dst에 기록한다 (같은 뷰면 제자리). BGRA/그레이 뷰 모두 가능하며 연산과 파라미터는
+    // FilterPipeline과 같다. 뷰 크기/형식이 맞지 않으면 false
+    bool Apply(FilterOp op, int param, const ImageView& src, const ImageView& dst);
+
+    // roi 영역에만 적용: roi와 커널 할로만 읽고 roi만 쓴다 (선택 영역 파라미터 조정용).
+    // roi 안의 결과는 영상 전체에 적용한 결과와 같다
+    bool Apply(FilterOp op, int param, const ImageView& src, const ImageView& dst, const ImageRect& roi);
+
     void Binarize(unsigned char* pixels, int width, int height, int threshold);
     void Dilate(unsigned char* pixels, int width, int height, int kernelSize);
 };
\ No newline at end of file
@@ -0,0 +1,318 @@
+﻿#include "pch.h"
+#include "Profiler.h"
+#include "CpuFeatures.h"
+#include "ScratchArena.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace
+{
+    // 이름 하나의 누적값과 최근 호출 창
+    struct OpEntry
+    {
+        uint64_t calls = 0;
+        int64_t totalNs = 0;
+        int64_t minNs = 0;
+        int64_t maxNs = 0;
+        int64_t pixels = 0;
+        int64_t scratchBytes = 0;
+        int64_t allocatedBytes = 0;
+        int threads = 0;
+        const char* backend = nullptr;
+        const char* simd = nullptr;
+        std::vector<int64_t> windowNs;      // 원형 버퍼 (최대 kWindowSize)
+        std::vector<int64_t> windowPixels;
+        size_t next = 0;
+    };
+
+    // 호출 스레드에 1부터 작은 번호를 매긴다 (추적 보기에서 스레드 줄 구분용)
+    uint32_t CurrentThreadId()
+    {
+        static std::atomic<uint32_t> nextId{ 1 };
+        thread_local const uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    int HistogramBucket(int64_t ns)
+    {
+        int64_t us = ns / 1000;
+        int bucket = 0;
+        while (us >= 2 && bucket < ProfileStats::kHistogramBuckets - 1)
+        {
+            us >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    // 정렬된 값의 p 백분위수 (최근접 순위)
+    double Percentile(const std::vector<int64_t>& sorted, double p)
+    {
+        if (sorted.empty()) return 0.0;
+        const size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+        return static_cast<double>(sorted[std::min(rank, sorted.size() - 1)]) / 1e6;
+    }
+
+    std::FILE* OpenForWrite(const std::string& path)
+    {
+#if defined(_WIN32)
+        const int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+        std::wstring wide(length > 0 ? length - 1 : 0, L'\0');
+        if (length > 1) MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], length);
+        return _wfopen(wide.c_str(), L"wb");
+#else
+        return std::fopen(path.c_str(), "wb");
+#endif
+    }
+
+    void AppendEscaped(std::string& out, const char* text)
+    {
+        for (const char* c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\') out += '\\';
+            if (static_cast<unsigned char>(*c) >= 0x20) out += *c;
+        }
+    }
+}
+
+struct Profiler::Impl
+{
+    std::atomic<bool> enabled{ false };
+    std::atomic<bool> tracing{ false };
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    mutable std::mutex mutex;
+    std::map<std::string, OpEntry, std::less<>> ops;
+    std::vector<ProfileRecord> events;      // 원형 버퍼 (최대 kMaxTraceEvents)
+    size_t nextEvent = 0;
+};
+
+Profiler& Profiler::Shared()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : m_impl(std::make_unique<Impl>())
+{
+}
+
+Profiler::~Profiler() = default;
+
+void Profiler::SetEnabled(bool enabled)
+{
+    m_impl->enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::SetTracing(bool tracing)
+{
+    m_impl->tracing.store(tracing, std::memory_order_relaxed);
+}
+
+bool Profiler::IsTracing() const
+{
+    return m_impl->tracing.load(std::memory_order_relaxed);
+}
+
+bool Profiler::IsActive() const
+{
+    return m_impl->enabled.load(std::memory_order_relaxed) || m_impl->tracing.load(std::memory_order_relaxed);
+}
+
+int64_t Profiler::Now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_impl->epoch).count();
+}
+
+void Profiler::Record(const ProfileRecord& record, bool traceEvent)
+{
+    if (record.name == nullptr) return;
+
+    const bool enabled = m_impl->enabled.load(std::memory_order_relaxed);
+    const bool tracing = traceEvent && m_impl->tracing.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+
+    if (enabled)
+    {
+        auto it = m_impl->ops.find(record.name);
+        if (it == m_impl->ops.end()) it = m_impl->ops.emplace(record.name, OpEntry()).first;
+        OpEntry& entry = it->second;
+
+        entry.minNs = entry.calls == 0 ? record.durationNs : std::min(entry.minNs, record.durationNs);
+        entry.maxNs = std::max(entry.maxNs, record.durationNs);
+        ++entry.calls;
+        entry.totalNs += record.durationNs;
+        entry.pixels += record.pixels;
+        entry.scratchBytes += record.scratchBytes;
+        entry.allocatedBytes += record.allocatedBytes;
+        entry.threads = record.threads;
+        entry.backend = record.backend;
+        entry.simd = record.simd;
+
+        if (entry.windowNs.size() < static_cast<size_t>(kWindowSize))
+        {
+            entry.windowNs.push_back(record.durationNs);
+            entry.windowPixels.push_back(record.pixels);
+        }
+        else
+        {
+            entry.windowNs[entry.next] = record.durationNs;
+            entry.windowPixels[entry.next] = record.pixels;
+        }
+        entry.next = (entry.next + 1) % kWindowSize;
+    }
+
+    if (tracing)
+    {
+        std::vector<ProfileRecord>& events = m_impl->events;
+        if (events.size() < static_cast<size_t>(kMaxTraceEvents)) events.push_back(record);
+        else events[m_impl->nextEvent] = record;
+        m_impl->nextEvent = (m_impl->nextEvent + 1) % kMaxTraceEvents;
+    }
+}
+
+std::vector<ProfileStats> Profiler::Stats() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+
+    std::vector<ProfileStats> result;
+    result.reserve(m_impl->ops.size());
+    std::vector<int64_t> sorted;
+    for (const auto& item : m_impl->ops)
+    {
+        const OpEntry& entry = item.second;
+        ProfileStats stats;
+        stats.name = item.first;
+        stats.calls = entry.calls;
+        stats.totalMs = static_cast<double>(entry.totalNs) / 1e6;
+        stats.minMs = static_cast<double>(entry.minNs) / 1e6;
+        stats.maxMs = static_cast<double>(entry.maxNs) / 1e6;
+        stats.pixels = entry.pixels;
+        stats.scratchBytes = entry.scratchBytes;
+        stats.allocatedBytes = entry.allocatedBytes;
+        stats.threads = entry.threads;
+        stats.backend = entry.simd ? entry.simd : "";
+        if (entry.backend) stats.backend = std::string(entry.backend) + "/" + stats.backend;
+
+        int64_t windowNs = 0, windowPixels = 0;
+        for (size_t i = 0; i < entry.windowNs.size(); ++i)
+        {
+            windowNs += entry.windowNs[i];
+            windowPixels += entry.windowPixels[i];
+            ++stats.histogram[HistogramBucket(entry.windowNs[i])];
+        }
+        if (!entry.windowNs.empty())
+        {
+            stats.meanMs = static_cast<double>(windowNs) / 1e6 / static_cast<double>(entry.windowNs.size());
+        }
+        if (windowPixels > 0) stats.nsPerPixel = static_cast<double>(windowNs) / static_cast<double>(windowPixels);
+
+        sorted = entry.windowNs;
+        std::sort(sorted.begin(), sorted.end());
+        stats.p50Ms = Percentile(sorted, 50.0);
+        stats.p95Ms = Percentile(sorted, 95.0);
+        stats.p99Ms = Percentile(sorted, 99.0);
+        result.push_back(std::move(stats));
+    }
+    return result;
+}
+
+std::string Profiler::ChromeTraceJson() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+
+    // 원형 버퍼를 오래된 순서로 ("X" 완료 이벤트, 시간 단위 µs)
+    const std::vector<ProfileRecord>& events = m_impl->events;
+    const size_t count = events.size();
+    const size_t first = count < static_cast<size_t>(kMaxTraceEvents) ? 0 : m_impl->nextEvent;
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    char number[512];
+    for (size_t i = 0; i < count; ++i)
+    {
+        const ProfileRecord& e = events[(first + i) % count];
+        json += i ? ",\n{\"name\":\"" : "\n{\"name\":\"";
+        AppendEscaped(json, e.name);
+        std::snprintf(number, sizeof(number),
+            "\",\"cat\":\"op\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+            "\"args\":{\"pixels\":%lld,\"scratchBytes\":%lld,\"allocatedBytes\":%lld,\"threads\":%d,\"simd\":\"",
+            e.threadId, static_cast<double>(e.startNs) / 1e3, static_cast<double>(e.durationNs) / 1e3,
+            static_cast<long long>(e.pixels), static_cast<long long>(e.scratchBytes),
+            static_cast<long long>(e.allocatedBytes), e.threads);
+        json += number;
+        AppendEscaped(json, e.simd ? e.simd : "");
+        json += "\",\"backend\":\"";
+        AppendEscaped(json, e.backend ? e.backend : "");
+        json += "\"}}";
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) const
+{
+    const std::string json = ChromeTraceJson();
+    std::FILE* file = OpenForWrite(path);
+    if (file == nullptr) return false;
+    const bool ok = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+void Profiler::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->ops.clear();
+    m_impl->events.clear();
+    m_impl->nextEvent = 0;
+}
+
+ProfileScope::ProfileScope(const char* name, int width, int height)
+    : m_name(nullptr)
+{
+    Profiler& profiler = Profiler::Shared();
+    if (!profiler.IsActive()) return;
+
+    m_name = name;
+    m_pixels = static_cast<int64_t>(width) * height;
+    const ScratchArena::Stats scratch = ScratchArena::Shared().GetStats();
+    m_startAcquired = scratch.bytesAcquired;
+    m_startAllocated = scratch.bytesAllocated;
+    m_uncaught = std::uncaught_exceptions();
+    m_startNs = profiler.Now();
+}
+
+ProfileScope::~ProfileScope()
+{
+    // 예외(취소 포함)로 중단된 호출은 시간 분포를 흐리므로 기록하지 않는다
+    if (m_name == nullptr || std::uncaught_exceptions() > m_uncaught) return;
+
+    Profiler& profiler = Profiler::Shared();
+    ProfileRecord record;
+    record.name = m_name;
+    record.backend = m_backend;
+    record.simd = SimdLevelName(ActiveSimdLevel());
+    record.startNs = m_startNs;
+    record.durationNs = profiler.Now() - m_startNs;
+    record.pixels = m_pixels;
+    const ScratchArena::Stats scratch = ScratchArena::Shared().GetStats();
+    record.scratchBytes = static_cast<int64_t>(scratch.bytesAcquired - m_startAcquired);
+    record.allocatedBytes = static_cast<int64_t>(scratch.bytesAllocated - m_startAllocated);
+    record.threads = ThreadPool::Shared().ThreadCount();
+    record.threadId = CurrentThreadId();
+    profiler.Record(record);
+}
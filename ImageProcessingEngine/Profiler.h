@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 연산 호출 한 번의 기록. 문자열은 정적 수명 리터럴이어야 한다
+struct ProfileRecord
+{
+    const char* name = nullptr;
+    const char* backend = nullptr;  // 연산이 고른 경로 (예: "fft", "fixed", "recursive"). 없으면 nullptr
+    const char* simd = nullptr;     // 호출 시점 SIMD 수준
+    int64_t startNs = 0;            // 프로파일러 기준 시각부터
+    int64_t durationNs = 0;
+    int64_t pixels = 0;
+    int64_t scratchBytes = 0;       // 이 호출 동안 공용 작업 버퍼 풀에서 빌린 바이트 (크기 등급 기준)
+    int64_t allocatedBytes = 0;     // 그중 풀이 새로 할당한 바이트
+    int threads = 0;                // 공용 스레드 풀 크기
+    uint32_t threadId = 0;          // 호출 스레드 (프로파일러가 매긴 작은 번호)
+};
+
+// 연산 이름별 집계. 백분위수/히스토그램은 최근 kWindowSize번 호출 기준(rolling)이다
+struct ProfileStats
+{
+    static const int kHistogramBuckets = 24;   // i번 칸: [2^i, 2^(i+1)) µs (0번은 2 µs 미만, 마지막은 그 이상 전부)
+
+    std::string name;
+    uint64_t calls = 0;             // 누적
+    double totalMs = 0.0;           // 누적
+    double minMs = 0.0;             // 누적
+    double maxMs = 0.0;             // 누적
+    double meanMs = 0.0;            // 최근 창
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double nsPerPixel = 0.0;        // 최근 창 (시간 합 / 화소 합)
+    int64_t pixels = 0;             // 누적
+    int64_t scratchBytes = 0;       // 누적
+    int64_t allocatedBytes = 0;     // 누적
+    int threads = 0;                // 마지막 호출
+    std::string backend;            // 마지막 호출의 경로 ("simd" 또는 "경로/simd")
+    uint32_t histogram[kHistogramBuckets] = {};
+};
+
+// =====================================================
+//  연산별 성능 계측 (프로세스 공용)
+//  ProfileScope가 연산 호출마다 벽시계 시간, 화소 수, 작업 버퍼 사용량, 스레드 수, 선택된 경로를 기록한다.
+//  - 집계(SetEnabled): 이름별 누적값 + 최근 호출 창의 백분위수/히스토그램
+//  - 추적(SetTracing): 호출 하나하나를 보관해 Chrome trace / Perfetto JSON으로 내보낸다 (최근 kMaxTraceEvents개)
+//  둘 다 꺼져 있으면 ProfileScope는 플래그 하나만 읽고 아무것도 하지 않는다.
+//  작업 버퍼 사용량은 공용 풀 전체의 증가분이므로 여러 스레드에서 동시에 연산하면 서로 섞인다.
+//  여러 스레드에서 동시에 써도 된다. 구현(뮤텍스)은 .cpp에만 둔다 (C++/CLI 포함 가능).
+// =====================================================
+class Profiler
+{
+public:
+    static const int kWindowSize = 1024;
+    static const int kMaxTraceEvents = 1 << 16;
+
+    static Profiler& Shared();
+
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    void SetEnabled(bool enabled);
+    void SetTracing(bool tracing);
+    bool IsTracing() const;
+
+    // 집계나 추적 중 하나라도 켜져 있으면 true
+    bool IsActive() const;
+
+    // 프로파일러 기준 시각부터 지난 시간 (ns)
+    int64_t Now() const;
+
+    // traceEvent가 false면 집계에만 넣는다 (여러 스레드 시간을 합친 값처럼 시간축에 놓을 수 없는 기록)
+    void Record(const ProfileRecord& record, bool traceEvent = true);
+
+    // 이름순 집계
+    std::vector<ProfileStats> Stats() const;
+
+    // 보관된 추적 이벤트를 Chrome trace 형식({"traceEvents": [...]})으로. chrome://tracing, ui.perfetto.dev에서 열 수 있다
+    std::string ChromeTraceJson() const;
+    bool WriteChromeTrace(const std::string& path) const;     // path는 UTF-8
+
+    // 집계와 추적 이벤트를 모두 지운다 (켜짐 상태는 유지)
+    void Reset();
+
+    struct Impl;
+
+private:
+    std::unique_ptr<Impl> m_impl;
+};
+
+// 연산 하나의 계측 범위. 소멸 시 Profiler::Shared()에 기록한다 (꺼져 있거나 예외로 빠져나가면 기록하지 않음)
+class ProfileScope
+{
+public:
+    ProfileScope(const char* name, int width, int height);
+    ~ProfileScope();
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    // 연산이 실제로 고른 경로 (정적 수명 문자열)
+    void SetBackend(const char* backend) { m_backend = backend; }
+
+private:
+    const char* m_name;             // 꺼져 있으면 nullptr
+    const char* m_backend = nullptr;
+    int64_t m_pixels = 0;
+    int64_t m_startNs = 0;
+    uint64_t m_startAcquired = 0;
+    uint64_t m_startAllocated = 0;
+    int m_uncaught = 0;
+};
@@ -0,0 +1,101 @@
+﻿#include "pch.h"
+#include "ProgressivePreview.h"
+#include "FilterPipeline.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+const double ProgressivePreview::kDefaultNsPerPixelPerStep = 20.0;
+
+// 측정값 갱신 비율 (새 측정값 가중치)
+static const double kRateSmoothing = 0.5;
+
+// 단계 목록(연산, 파라미터)을 측정값 키로 쓴다. 축소 레벨의 파라미터가 달라도 원래 파이프라인 기준으로 모은다
+static std::string KeyOf(const FilterPipeline& pipeline)
+{
+    std::string key;
+    for (const FilterStep& step : pipeline.Steps())
+    {
+        key += std::to_string(static_cast<int>(step.op));
+        key += ':';
+        key += std::to_string(step.param);
+        key += ';';
+    }
+    return key;
+}
+
+double ProgressivePreview::EstimateMs(const FilterPipeline& pipeline, double pixels) const
+{
+    auto it = m_nsPerPixel.find(KeyOf(pipeline));
+    const double nsPerPixel = (it != m_nsPerPixel.end())
+        ? it->second
+        : kDefaultNsPerPixelPerStep * std::max<size_t>(1, pipeline.Steps().size());
+    return nsPerPixel * pixels * 1e-6;
+}
+
+int ProgressivePreview::ChooseLevel(const FilterPipeline& pipeline, int width, int height, double latencyBudgetMs) const
+{
+    int level = 0;
+    while (level + 1 < ImagePyramid::kMaxLevels &&
+           ImagePyramid::LevelWidth(width, level + 1) >= ImagePyramid::kMinSide &&
+           ImagePyramid::LevelHeight(height, level + 1) >= ImagePyramid::kMinSide)
+    {
+        const double pixels = static_cast<double>(ImagePyramid::LevelWidth(width, level)) *
+                              ImagePyramid::LevelHeight(height, level);
+        if (EstimateMs(pipeline, pixels) <= latencyBudgetMs) break;
+        ++level;
+    }
+    return level;
+}
+
+void ProgressivePreview::RecordRun(const FilterPipeline& pipeline, double pixels, double milliseconds)
+{
+    if (pixels <= 0.0 || milliseconds < 0.0) return;
+    const double measured = milliseconds * 1e6 / pixels;
+    auto it = m_nsPerPixel.find(KeyOf(pipeline));
+    if (it == m_nsPerPixel.end())
+    {
+        m_nsPerPixel.emplace(KeyOf(pipeline), measured);
+    }
+    else
+    {
+        it->second += kRateSmoothing * (measured - it->second);
+    }
+}
+
+int ProgressivePreview::Run(const FilterPipeline& pipeline, const ImageView& source, uint64_t sourceId,
+                            double latencyBudgetMs)
+{
+    ProfileScope profile("preview", source.width, source.height);
+    if (!source.IsValid()) return -1;
+
+    m_pyramid.SetSource(source, sourceId);
+    const int level = std::min(ChooseLevel(pipeline, source.width, source.height, latencyBudgetMs),
+                               m_pyramid.LevelCount() - 1);
+    const ImageView input = m_pyramid.Level(level);
+    if (!input.IsValid()) return -1;
+
+    const size_t rowBytes = static_cast<size_t>(input.width) * input.bytesPerPixel;
+    m_result.resize(rowBytes * input.height);
+    m_resultView = ImageView{ m_result.data(), input.width, input.height, rowBytes, input.bytesPerPixel };
+
+    // 축소 파이프라인에 남은 단계가 없으면(가우시안만, 크기 0 형태학 등) Run이 레벨 영상을 그대로 복사한다
+    const auto start = std::chrono::steady_clock::now();
+    if (!pipeline.Scaled(level).Run(input, m_resultView))
+    {
+        m_resultView = ImageView{};
+        return -1;
+    }
+    const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    RecordRun(pipeline, static_cast<double>(input.width) * input.height, elapsedMs);
+    return level;
+}
+
+void ProgressivePreview::Clear()
+{
+    m_pyramid.Clear();
+    m_result.clear();
+    m_result.shrink_to_fit();
+    m_resultView = ImageView{};
+}
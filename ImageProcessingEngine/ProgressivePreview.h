@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include "ImagePyramid.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class FilterPipeline;
+
+// =====================================================
+//  점진적(progressive) 미리보기
+//  파라미터를 조정하는 동안 큰 영상(50 MP 등)의 결과를 먼저 축소 해상도로 보여 주고,
+//  전체 해상도 결과는 그 뒤에 따로 계산한다. 미리보기는 캐시된 ImagePyramid 레벨에서
+//  FilterPipeline::Scaled(level)로 커널 크기를 맞춘 파이프라인을 실행한다.
+//  레벨은 지연 예산(ms) 안에 끝나는 가장 세밀한 레벨이며, 처리 속도(ns/pixel)는 파이프라인마다
+//  지난 실행에서 측정해 갱신한다. 원본이 바뀐 뒤 처음 피라미드를 만드는 시간은 예산에 넣지 않는다.
+//  스레드 안전하지 않다 (호출자가 직렬화).
+// =====================================================
+class ProgressivePreview
+{
+public:
+    // 측정값이 없는 파이프라인의 단계당 추정 비용
+    static const double kDefaultNsPerPixelPerStep;
+
+    // source(BGRA 또는 그레이)에 pipeline을 축소 해상도로 적용한다. sourceId가 같으면 피라미드를 재사용한다
+    // (ImagePyramid::SetSource 참고). 결과는 Result()에 보관되며 사용한 레벨(0 = 원본 해상도)을 돌려준다.
+    // 레벨 0이면 Result()가 전체 해상도 결과이므로 다시 계산할 필요가 없다. 실패 시 -1
+    int Run(const FilterPipeline& pipeline, const ImageView& source, uint64_t sourceId, double latencyBudgetMs);
+
+    // 마지막 Run 결과 (빈틈 없는 버퍼, source와 같은 형식). 원본 크기의 1/2^level
+    ImageView Result() const { return m_resultView; }
+
+    // 예산 안에 끝날 것으로 예상되는 가장 세밀한 레벨 (모두 넘으면 가장 거친 레벨)
+    int ChooseLevel(const FilterPipeline& pipeline, int width, int height, double latencyBudgetMs) const;
+
+    // 화소 수 pixels에서 pipeline의 예상 처리 시간 (ms)
+    double EstimateMs(const FilterPipeline& pipeline, double pixels) const;
+
+    // 전체 해상도 실행 시간을 알려 주면 추정값에 반영한다 (선택)
+    void RecordRun(const FilterPipeline& pipeline, double pixels, double milliseconds);
+
+    // 피라미드와 결과 버퍼를 버린다 (측정값은 유지)
+    void Clear();
+
+private:
+    ImagePyramid m_pyramid;
+    std::vector<unsigned char> m_result;
+    ImageView m_resultView;
+    std::map<std::string, double> m_nsPerPixel;     // 파이프라인 단계 목록 → 측정 ns/pixel
+};
@@ -0,0 +1,21 @@
+﻿#pragma once
+
+// =====================================================
+//  재귀(IIR) 가우시안 블러 (내부용)
+//  van Vliet–Young–Verbeek 3차 재귀 필터를 정방향/역방향으로 한 번씩 적용해 가우시안을 근사한다.
+//  화소당 비용이 시그마와 무관하므로 큰 시그마(배경 추정 등)에서 분리형 커널보다 빠르다.
+//  가장자리는 분리형 경로와 같은 클램프(가장자리 화소 반복)이며, Triggs–Sdika 경계 조건으로
+//  영상 밖으로 무한히 이어진 것과 같은 결과를 낸다. σ ≥ 2에서 정확한 가우시안과 최대 ±3 LSB
+//  (강한 계단 경계나 영상 가장자리 근처) 차이가 난다.
+// =====================================================
+namespace RecursiveGaussian
+{
+    // 근사식이 유효한 최소 시그마
+    const float kMinSigma = 0.5f;
+
+    // 이 시그마에서 재귀 경로를 쓰는 것이 나은지 (분리형은 반지름 ceil(3σ), 비용이 시그마에 비례)
+    bool PreferRecursive(float sigma);
+
+    // 제자리 블러 (bytesPerPixel: BGRA 4 - alpha는 그대로, 그레이 1). sigma < kMinSigma면 kMinSigma로 처리
+    void Blur(unsigned char* pixels, int width, int height, int bytesPerPixel, float sigma);
+}
@@ -0,0 +1,215 @@
+﻿#include "pch.h"
+#include "ScratchArena.h"
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    const size_t kMinBucket = 256;
+    const size_t kAlignment = 64;
+
+    // bytes 이상인 가장 작은 크기 등급: 256, 그 위로는 2^e * (1.25, 1.5, 1.75, 2)
+    size_t BucketSize(size_t bytes)
+    {
+        if (bytes <= kMinBucket) return kMinBucket;
+
+        size_t base = kMinBucket;
+        while (base * 2 < bytes) base *= 2;
+        const size_t step = base / 4;
+        return base + (bytes - base + step - 1) / step * step;
+    }
+
+    unsigned char* Allocate(size_t bytes)
+    {
+        return static_cast<unsigned char*>(::operator new(bytes, std::align_val_t(kAlignment)));
+    }
+
+    void Free(unsigned char* data)
+    {
+        ::operator delete(data, std::align_val_t(kAlignment));
+    }
+}
+
+struct ScratchArena::Impl
+{
+    struct Bucket
+    {
+        std::vector<unsigned char*> buffers;    // 대기 중인 버퍼
+        uint64_t lastUse = 0;                   // 마지막으로 빌리거나 반납한 시각 (useClock)
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<size_t, Bucket> free;    // 크기 등급 → 대기 목록
+    Stats stats;
+    uint64_t useClock = 0;
+    size_t retainLimit = kDefaultRetainBytes;
+    size_t recentPeakInUse = 0;                 // 마지막 Trim 이후 bytesInUse 최고치
+};
+
+// ==================== Buffer ====================
+ScratchArena::Buffer::~Buffer()
+{
+    Release();
+}
+
+ScratchArena::Buffer::Buffer(Buffer&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+ScratchArena::Buffer& ScratchArena::Buffer::operator=(Buffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_arena = other.m_arena;
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+        other.m_arena = nullptr;
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_capacity = 0;
+    }
+    return *this;
+}
+
+void ScratchArena::Buffer::Release()
+{
+    if (m_data == nullptr) return;
+    m_arena->Return(m_data, m_capacity);
+    m_arena = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+    m_capacity = 0;
+}
+
+// ==================== ScratchArena ====================
+ScratchArena& ScratchArena::Shared()
+{
+    static ScratchArena arena;
+    return arena;
+}
+
+ScratchArena::ScratchArena()
+    : m_impl(std::make_unique<Impl>())
+{
+}
+
+ScratchArena::~ScratchArena()
+{
+    Trim();
+}
+
+ScratchArena::Buffer ScratchArena::Acquire(size_t bytes)
+{
+    Buffer buffer;
+    if (bytes == 0) return buffer;
+
+    const size_t capacity = BucketSize(bytes);
+    unsigned char* data = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        Stats& stats = m_impl->stats;
+        ++stats.acquireCount;
+        stats.bytesAcquired += capacity;
+
+        Impl::Bucket& bucket = m_impl->free[capacity];
+        bucket.lastUse = ++m_impl->useClock;
+        if (!bucket.buffers.empty())
+        {
+            data = bucket.buffers.back();
+            bucket.buffers.pop_back();
+        }
+        else
+        {
+            // 할당 실패(bad_alloc)는 호출자에게 그대로 전달
+            data = Allocate(capacity);
+            ++stats.systemAllocations;
+            stats.bytesAllocated += capacity;
+            stats.bytesReserved += capacity;
+            stats.peakBytesReserved = std::max(stats.peakBytesReserved, stats.bytesReserved);
+        }
+        stats.bytesInUse += capacity;
+        stats.peakBytesInUse = std::max(stats.peakBytesInUse, stats.bytesInUse);
+        m_impl->recentPeakInUse = std::max(m_impl->recentPeakInUse, stats.bytesInUse);
+    }
+
+    buffer.m_arena = this;
+    buffer.m_data = data;
+    buffer.m_size = bytes;
+    buffer.m_capacity = capacity;
+    return buffer;
+}
+
+void ScratchArena::Return(unsigned char* data, size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->stats.bytesInUse -= capacity;
+    Impl::Bucket& bucket = m_impl->free[capacity];
+    bucket.buffers.push_back(data);
+    bucket.lastUse = ++m_impl->useClock;
+    EvictIdleLocked();
+}
+
+// 대기 중인 바이트가 max(retainLimit, recentPeakInUse)를 넘으면 가장 오래 쓰지 않은 등급부터 해제한다
+void ScratchArena::EvictIdleLocked()
+{
+    Stats& stats = m_impl->stats;
+    const size_t limit = std::max(m_impl->retainLimit, m_impl->recentPeakInUse);
+    while (stats.bytesReserved - stats.bytesInUse > limit)
+    {
+        std::pair<const size_t, Impl::Bucket>* oldest = nullptr;
+        for (auto& entry : m_impl->free)
+        {
+            if (!entry.second.buffers.empty() && (oldest == nullptr || entry.second.lastUse < oldest->second.lastUse))
+            {
+                oldest = &entry;
+            }
+        }
+        if (oldest == nullptr) break;
+
+        Free(oldest->second.buffers.back());
+        oldest->second.buffers.pop_back();
+        stats.bytesReserved -= oldest->first;
+    }
+}
+
+ScratchArena::Stats ScratchArena::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->stats;
+}
+
+void ScratchArena::ResetPeaks()
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    Stats& stats = m_impl->stats;
+    stats.peakBytesInUse = stats.bytesInUse;
+    stats.peakBytesReserved = stats.bytesReserved;
+}
+
+void ScratchArena::Trim()
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    for (auto& entry : m_impl->free)
+    {
+        for (unsigned char* data : entry.second.buffers)
+        {
+            Free(data);
+            m_impl->stats.bytesReserved -= entry.first;
+        }
+    }
+    m_impl->free.clear();
+    m_impl->recentPeakInUse = m_impl->stats.bytesInUse;
+}
+
+void ScratchArena::SetRetainLimit(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->retainLimit = bytes;
+    EvictIdleLocked();
+}
@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// =====================================================
+//  연산 간에 재사용하는 작업(scratch) 버퍼 풀
+//  요청 크기를 크기 등급(2의 거듭제곱을 4등분한 단계, 낭비 최대 25%)으로 올려
+//  등급별 대기 목록에서 꺼내 주고, 반납하면 해제하지 않고 다시 목록에 넣는다.
+//  같은 크기 영상을 반복 처리하면 정상 상태에서 새 할당이 없다.
+//  대기 중인 버퍼는 max(보관 한도, 마지막 Trim 이후 사용 중 최고치)까지만 남기고,
+//  넘으면 가장 오래 쓰지 않은 크기 등급부터 해제한다 (크기가 계속 바뀌어도 풀이 끝없이 늘지 않음).
+//  여러 스레드에서 동시에 써도 된다. 구현(뮤텍스)은 .cpp에만 둔다 (C++/CLI 포함 가능).
+// =====================================================
+class ScratchArena
+{
+public:
+    // 빌린 버퍼. 소멸 시 풀에 반납된다 (이동만 가능). 내용은 초기화되지 않으며 64바이트 정렬
+    class Buffer
+    {
+    public:
+        Buffer() = default;
+        ~Buffer();
+        Buffer(Buffer&& other) noexcept;
+        Buffer& operator=(Buffer&& other) noexcept;
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        unsigned char* Data() const { return m_data; }
+        size_t Size() const { return m_size; }
+
+        template <typename T>
+        T* As() const { return reinterpret_cast<T*>(m_data); }
+
+        void Release();
+
+    private:
+        friend class ScratchArena;
+        ScratchArena* m_arena = nullptr;
+        unsigned char* m_data = nullptr;
+        size_t m_size = 0;          // 요청 크기
+        size_t m_capacity = 0;      // 크기 등급
+    };
+
+    struct Stats
+    {
+        size_t bytesInUse = 0;          // 지금 빌려 간 버퍼 (크기 등급 기준)
+        size_t peakBytesInUse = 0;      // bytesInUse 최고치 (high-water mark)
+        size_t bytesReserved = 0;       // 풀이 잡고 있는 전체 (빌려 간 것 + 대기 중)
+        size_t peakBytesReserved = 0;
+        uint64_t acquireCount = 0;
+        uint64_t systemAllocations = 0; // 대기 목록이 비어 새로 할당한 횟수
+        uint64_t bytesAcquired = 0;     // 지금까지 빌려 간 버퍼 누계 (크기 등급 기준)
+        uint64_t bytesAllocated = 0;    // 지금까지 새로 할당한 누계
+    };
+
+    // 엔진 공용 풀 (NativeProcessor, FilterPipeline, 행 커널이 사용)
+    static ScratchArena& Shared();
+
+    ScratchArena();
+    ~ScratchArena();
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // bytes 이상 크기의 버퍼를 빌린다 (0이면 빈 버퍼)
+    Buffer Acquire(size_t bytes);
+
+    Stats GetStats() const;
+
+    // 최고치(peak*)를 현재 값으로 되돌린다
+    void ResetPeaks();
+
+    // 대기 중인 버퍼를 모두 해제한다 (빌려 간 버퍼는 반납 시 다시 풀에 들어간다).
+    // 보관 한도 계산에 쓰는 사용 중 최고치도 지금 값으로 되돌린다 (다른 영상으로 바꿀 때 호출)
+    void Trim();
+
+    // 대기 중인 버퍼 보관 한도 (바이트). 기본 kDefaultRetainBytes
+    void SetRetainLimit(size_t bytes);
+
+    static const size_t kDefaultRetainBytes = 64u * 1024 * 1024;
+
+private:
+    void Return(unsigned char* data, size_t capacity);
+    void EvictIdleLocked();
+
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
@@ -0,0 +1,263 @@
+﻿#include "pch.h"
+#include "SimdKernels.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace SimdKernels
+{
+    // ==================== 스칼라 기준 구현 ====================
+    static void GrayscaleBGRAScalar(const unsigned char* src, unsigned char* dst, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const unsigned char* s = src + i * 4;
+            unsigned char* d = dst + i * 4;
+            unsigned char gray = static_cast<unsigned char>(GrayValue(s[0], s[1], s[2]));
+            d[3] = s[3];
+            d[0] = d[1] = d[2] = gray;
+        }
+    }
+
+    static void BinarizeBGRAScalar(const unsigned char* src, unsigned char* dst, int count, int threshold)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const unsigned char* s = src + i * 4;
+            unsigned char* d = dst + i * 4;
+            unsigned char binary = (GrayValue(s[0], s[1], s[2]) > threshold) ? 255 : 0;
+            d[3] = s[3];
+            d[0] = d[1] = d[2] = binary;
+        }
+    }
+
+    static void GrayFromBGRAScalar(const unsigned char* src, unsigned char* dst, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const unsigned char* s = src + i * 4;
+            dst[i] = static_cast<unsigned char>(GrayValue(s[0], s[1], s[2]));
+        }
+    }
+
+    static void ThresholdGrayScalar(const unsigned char* src, unsigned char* dst, int count, int threshold)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            dst[i] = (src[i] > threshold) ? 255 : 0;
+        }
+    }
+
+    static void MaxBytesScalar(const unsigned char* a, const unsigned char* b, unsigned char* dst, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            dst[i] = (a[i] > b[i]) ? a[i] : b[i];
+        }
+    }
+
+    static void MinBytesScalar(const unsigned char* a, const unsigned char* b, unsigned char* dst, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            dst[i] = (a[i] < b[i]) ? a[i] : b[i];
+        }
+    }
+
+    static void ScaleAddFloatScalar(const float* src, float c, float* acc, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            acc[i] += c * src[i];
+        }
+    }
+
+    static void CorrelateBytesScalar(const unsigned char* t, const unsigned char* x, int count, uint32_t out[3])
+    {
+        uint32_t dot = 0, sum = 0, sumSq = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            dot += static_cast<uint32_t>(t[i]) * x[i];
+            sum += x[i];
+            sumSq += static_cast<uint32_t>(x[i]) * x[i];
+        }
+        out[0] = dot;
+        out[1] = sum;
+        out[2] = sumSq;
+    }
+
+    static inline unsigned char ClampToByte(float sum)
+    {
+        // std::max(0, std::min(255, sum)) 후 절삭과 같음
+        sum = (sum < 255.0f) ? sum : 255.0f;
+        sum = (sum > 0.0f) ? sum : 0.0f;
+        return static_cast<unsigned char>(sum);
+    }
+
+    void ConvolveBGRAScalar(const unsigned char* const* rows, const float* kernel, int kSize,
+                            int x0, int x1, unsigned char* dst)
+    {
+        const int kHalf = kSize / 2;
+        for (int x = x0; x < x1; ++x)
+        {
+            float sum_b = 0, sum_g = 0, sum_r = 0;
+            for (int ky = 0; ky < kSize; ++ky)
+            {
+                const unsigned char* row = rows[ky] + (x - kHalf) * 4;
+                const float* k_row = kernel + ky * kSize;
+                for (int kx = 0; kx < kSize; ++kx)
+                {
+                    const unsigned char* p = row + kx * 4;
+                    float k_val = k_row[kx];
+                    sum_b += p[0] * k_val;
+                    sum_g += p[1] * k_val;
+                    sum_r += p[2] * k_val;
+                }
+            }
+            unsigned char* out_p = dst + x * 4;
+            out_p[0] = ClampToByte(sum_b);
+            out_p[1] = ClampToByte(sum_g);
+            out_p[2] = ClampToByte(sum_r);
+            out_p[3] = 255; // Alpha
+        }
+    }
+
+    void ConvolveGrayScalar(const unsigned char* const* rows, const float* kernel, int kSize,
+                            int x0, int x1, unsigned char* dst)
+    {
+        const int kHalf = kSize / 2;
+        for (int x = x0; x < x1; ++x)
+        {
+            float sum = 0;
+            for (int ky = 0; ky < kSize; ++ky)
+            {
+                const unsigned char* row = rows[ky] + x - kHalf;
+                const float* k_row = kernel + ky * kSize;
+                for (int kx = 0; kx < kSize; ++kx)
+                {
+                    sum += row[kx] * k_row[kx];
+                }
+            }
+            dst[x] = ClampToByte(sum);
+        }
+    }
+
+    void ConvolveFixedBGRAScalar(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                                 int x0, int x1, unsigned char* dst)
+    {
+        const int kHalf = kSize / 2;
+        for (int x = x0; x < x1; ++x)
+        {
+            int32_t sum_b = 0, sum_g = 0, sum_r = 0;
+            for (int ky = 0; ky < kSize; ++ky)
+            {
+                const unsigned char* row = rows[ky] + (x - kHalf) * 4;
+                const int16_t* k_row = kernel + ky * kSize;
+                for (int kx = 0; kx < kSize; ++kx)
+                {
+                    const unsigned char* p = row + kx * 4;
+                    const int32_t k_val = k_row[kx];
+                    sum_b += p[0] * k_val;
+                    sum_g += p[1] * k_val;
+                    sum_r += p[2] * k_val;
+                }
+            }
+            unsigned char* out_p = dst + x * 4;
+            out_p[0] = RoundShiftToByte(sum_b, shift);
+            out_p[1] = RoundShiftToByte(sum_g, shift);
+            out_p[2] = RoundShiftToByte(sum_r, shift);
+            out_p[3] = 255;
+        }
+    }
+
+    void ConvolveFixedGrayScalar(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                                 int x0, int x1, unsigned char* dst)
+    {
+        const int kHalf = kSize / 2;
+        for (int x = x0; x < x1; ++x)
+        {
+            int32_t sum = 0;
+            for (int ky = 0; ky < kSize; ++ky)
+            {
+                const unsigned char* row = rows[ky] + x - kHalf;
+                const int16_t* k_row = kernel + ky * kSize;
+                for (int kx = 0; kx < kSize; ++kx)
+                {
+                    sum += row[kx] * static_cast<int32_t>(k_row[kx]);
+                }
+            }
+            dst[x] = RoundShiftToByte(sum, shift);
+        }
+    }
+
+    const KernelTable* ScalarTable()
+    {
+        static const KernelTable table = {
+            SimdLevel::Scalar,
+            GrayscaleBGRAScalar,
+            BinarizeBGRAScalar,
+            GrayFromBGRAScalar,
+            ThresholdGrayScalar,
+            ConvolveBGRAScalar,
+            ConvolveGrayScalar,
+            ConvolveFixedBGRAScalar,
+            ConvolveFixedGrayScalar,
+            MaxBytesScalar,
+            MinBytesScalar,
+            ScaleAddFloatScalar,
+            CorrelateBytesScalar,
+        };
+        return &table;
+    }
+
+    // ==================== 디스패치 ====================
+    static const KernelTable* TableFor(SimdLevel level)
+    {
+        const KernelTable* table = nullptr;
+        switch (level)
+        {
+        case SimdLevel::AVX512: table = AVX512Table(); if (table) break; // fall through
+        case SimdLevel::AVX2:   table = AVX2Table();   if (table) break; // fall through
+        case SimdLevel::SSE41:  table = SSE41Table();  if (table) break; // fall through
+        default:                table = ScalarTable(); break;
+        }
+        return table;
+    }
+
+    static const KernelTable* InitialTable()
+    {
+        SimdLevel level = DetectSimdLevel();
+        SimdLevel requested;
+        if (ParseSimdLevel(std::getenv("IMAGEPROCESSING_SIMD"), requested) && requested < level)
+        {
+            level = requested;
+        }
+        return TableFor(level);
+    }
+
+    static std::atomic<const KernelTable*>& ActiveTable()
+    {
+        static std::atomic<const KernelTable*> active(InitialTable());
+        return active;
+    }
+
+    const KernelTable& Active()
+    {
+        return *ActiveTable().load(std::memory_order_acquire);
+    }
+}
+
+SimdLevel ActiveSimdLevel()
+{
+    return SimdKernels::Active().level;
+}
+
+SimdLevel SetSimdLevel(SimdLevel level)
+{
+    const SimdLevel detected = DetectSimdLevel();
+    if (level > detected) level = detected;
+
+    const SimdKernels::KernelTable* table = SimdKernels::TableFor(level);
+    SimdKernels::ActiveTable().store(table, std::memory_order_release);
+    return table->level;
+}
@@ -0,0 +1,136 @@
+﻿#pragma once
+
+#include "CpuFeatures.h"
+#include <cstdint>
+
+// =====================================================
+//  행 단위 SIMD 커널 디스패치 테이블 (내부용)
+//  모든 구현은 스칼라 버전과 비트 단위로 같은 결과를 낸다.
+//  - 그레이스케일: (114 B + 587 G + 299 R) / 1000 정수 연산 (절삭)
+//  - 컨볼루션: 채널별 float 누적, 스칼라와 같은 순서(ky → kx)의 곱/합, FMA 미사용
+//  - 고정소수점 컨볼루션: 16비트 계수 x 8비트 화소를 32비트 정수로 누적 (순서와 무관하게 정확),
+//    (합 + 2^(shift-1)) >> shift 후 0..255 포화. 컴파일러/ISA와 무관하게 같은 값
+// =====================================================
+namespace SimdKernels
+{
+    struct KernelTable
+    {
+        SimdLevel level;
+
+        // BGRA → BGRA 그레이 (alpha 유지)
+        void (*grayscaleBGRA)(const unsigned char* src, unsigned char* dst, int count);
+        // BGRA → BGRA 이진화 (gray > threshold ? 255 : 0, alpha 유지)
+        void (*binarizeBGRA)(const unsigned char* src, unsigned char* dst, int count, int threshold);
+        // BGRA → 1채널 그레이
+        void (*grayFromBGRA)(const unsigned char* src, unsigned char* dst, int count);
+        // 1채널 임계값 (threshold는 0..254 범위로 호출)
+        void (*thresholdGray)(const unsigned char* src, unsigned char* dst, int count, int threshold);
+
+        // 한 행의 출력 화소 [x0, x1) 컨볼루션. rows[ky]는 (y + ky - kSize/2) 행의 시작 주소
+        // BGRA 버전은 alpha를 255로 채운다.
+        void (*convolveBGRA)(const unsigned char* const* rows, const float* kernel, int kSize,
+                             int x0, int x1, unsigned char* dst);
+        void (*convolveGray)(const unsigned char* const* rows, const float* kernel, int kSize,
+                             int x0, int x1, unsigned char* dst);
+
+        // 고정소수점 컨볼루션 (kSize <= kMaxFixedKernelSize). kernel은 2^shift 배 한 16비트 계수
+        void (*convolveFixedBGRA)(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                                  int x0, int x1, unsigned char* dst);
+        void (*convolveFixedGray)(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                                  int x0, int x1, unsigned char* dst);
+
+        // 바이트 단위 최대/최소: dst[i] = max(a[i], b[i]) / min(a[i], b[i]). dst가 a 또는 b와 같아도 된다
+        void (*maxBytes)(const unsigned char* a, const unsigned char* b, unsigned char* dst, int count);
+        void (*minBytes)(const unsigned char* a, const unsigned char* b, unsigned char* dst, int count);
+
+        // float 누적: acc[i] += c * src[i] (곱 후 합, FMA 미사용)
+        void (*scaleAddFloat)(const float* src, float c, float* acc, int count);
+
+        // 바이트 상관 합: out = { Σ t[i] x[i], Σ x[i], Σ x[i]² } (정수 연산이라 순서와 무관하게 정확).
+        // 32비트 합이 넘치지 않도록 count는 kMaxCorrelateCount 이하로 호출한다
+        void (*correlateBytes)(const unsigned char* t, const unsigned char* x, int count, uint32_t out[3]);
+    };
+
+    const int kMaxCorrelateCount = 1 << 16;
+
+    // 고정소수점 커널 최대 크기. 8비트 x 16비트 곱 49개의 합은 32비트 안에 들어간다
+    const int kMaxFixedKernelSize = 7;
+    const int kMaxFixedShift = 16;
+
+    // 0이 아닌 계수의 탭 목록. SIMD 구현은 탭 두 개씩 묶어 곱-합(madd)하며, 개수가 홀수면
+    // 마지막 탭을 계수 0인 자기 자신과 짝짓는다 (영상 밖을 읽지 않음)
+    struct FixedTaps
+    {
+        int count;
+        int row[kMaxFixedKernelSize * kMaxFixedKernelSize + 1];
+        int offset[kMaxFixedKernelSize * kMaxFixedKernelSize + 1];     // 출력 화소 기준 바이트 오프셋
+        int16_t coefficient[kMaxFixedKernelSize * kMaxFixedKernelSize + 1];
+    };
+
+    inline void CollectFixedTaps(const int16_t* kernel, int kSize, int bytesPerPixel, FixedTaps& taps)
+    {
+        const int kHalf = kSize / 2;
+        int lastRow = 0, lastOffset = 0;
+        taps.count = 0;
+        for (int ky = 0; ky < kSize; ++ky)
+        {
+            for (int kx = 0; kx < kSize; ++kx)
+            {
+                const int16_t c = kernel[ky * kSize + kx];
+                if (c == 0) continue;
+                lastRow = ky;
+                lastOffset = (kx - kHalf) * bytesPerPixel;
+                taps.row[taps.count] = lastRow;
+                taps.offset[taps.count] = lastOffset;
+                taps.coefficient[taps.count] = c;
+                ++taps.count;
+            }
+        }
+        if (taps.count % 2 != 0)
+        {
+            taps.row[taps.count] = lastRow;
+            taps.offset[taps.count] = lastOffset;
+            taps.coefficient[taps.count] = 0;
+        }
+    }
+
+    // 짝지은 두 탭의 계수를 madd용 dword 하나로 (하위 16비트 = 첫 탭)
+    inline int32_t FixedPair(const FixedTaps& taps, int i)
+    {
+        return static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint16_t>(taps.coefficient[i + 1])) << 16) |
+                                    static_cast<uint16_t>(taps.coefficient[i]));
+    }
+
+    // (acc + 2^(shift-1)) >> shift 를 0..255로 포화 (음수 시프트 없이 계산)
+    inline unsigned char RoundShiftToByte(int32_t acc, int shift)
+    {
+        const int32_t v = acc + ((1 << shift) >> 1);
+        if (v <= 0) return 0;
+        const int32_t r = v >> shift;
+        return static_cast<unsigned char>(r < 255 ? r : 255);
+    }
+
+    // 현재 선택된 구현
+    const KernelTable& Active();
+
+    // 각 ISA 구현. 해당 ISA를 빌드하지 않은 플랫폼에서는 nullptr
+    const KernelTable* ScalarTable();
+    const KernelTable* SSE41Table();
+    const KernelTable* AVX2Table();
+    const KernelTable* AVX512Table();
+
+    inline int GrayValue(int b, int g, int r)
+    {
+        return (b * 114 + g * 587 + r * 299) / 1000;
+    }
+
+    // 스칼라 꼬리 처리용 (각 ISA 구현이 남은 화소에 사용)
+    void ConvolveBGRAScalar(const unsigned char* const* rows, const float* kernel, int kSize,
+                            int x0, int x1, unsigned char* dst);
+    void ConvolveGrayScalar(const unsigned char* const* rows, const float* kernel, int kSize,
+                            int x0, int x1, unsigned char* dst);
+    void ConvolveFixedBGRAScalar(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                                 int x0, int x1, unsigned char* dst);
+    void ConvolveFixedGrayScalar(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                                 int x0, int x1, unsigned char* dst);
+}
@@ -0,0 +1,332 @@
+﻿// AVX2 구현 (MSVC /arch:AVX2, GCC/Clang -mavx2 로 이 파일만 빌드. FMA는 사용하지 않는다)
+#include "pch.h"
+#include "SimdKernels.h"
+
+#if defined(IMAGEPROCESSING_X86)
+#include <immintrin.h>
+#include <cstring>
+
+namespace SimdKernels
+{
+    namespace
+    {
+        // BGRA 8화소 → 화소별 dword 그레이 값 (114 B + 587 G + 299 R) / 1000
+        inline __m256i GrayDwords(__m256i px)
+        {
+            const __m256i lowBytes = _mm256_set1_epi32(0x00FF00FF);
+            const __m256i br = _mm256_and_si256(px, lowBytes);
+            const __m256i ga = _mm256_and_si256(_mm256_srli_epi32(px, 8), lowBytes);
+            const __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(br, _mm256_set1_epi32((299 << 16) | 114)),
+                                                 _mm256_madd_epi16(ga, _mm256_set1_epi32(587)));
+            // S / 1000 == ((S >> 3) * 33555) >> 22  (0 <= S <= 255000 에서 정확)
+            return _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(sum, 3), _mm256_set1_epi32(33555)), 22);
+        }
+
+        inline __m256i ClampToInt(__m256 sum)
+        {
+            sum = _mm256_min_ps(sum, _mm256_set1_ps(255.0f));
+            sum = _mm256_max_ps(sum, _mm256_setzero_ps());
+            return _mm256_cvttps_epi32(sum);
+        }
+
+        // dword 8개(0..255) → 8바이트
+        inline __m128i PackDwordsToBytes(__m256i v)
+        {
+            __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            return _mm_packus_epi16(words, words);
+        }
+
+        void GrayscaleBGRA(const unsigned char* src, unsigned char* dst, int count)
+        {
+            const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+            const __m256i replicate = _mm256_set1_epi32(0x00010101);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+                __m256i bgr = _mm256_mullo_epi32(GrayDwords(px), replicate);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                                    _mm256_or_si256(bgr, _mm256_and_si256(px, alphaMask)));
+            }
+            ScalarTable()->grayscaleBGRA(src + i * 4, dst + i * 4, count - i);
+        }
+
+        void BinarizeBGRA(const unsigned char* src, unsigned char* dst, int count, int threshold)
+        {
+            const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+            const __m256i colorMask = _mm256_set1_epi32(0x00FFFFFF);
+            const __m256i t = _mm256_set1_epi32(threshold);
+            int i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+                __m256i on = _mm256_cmpgt_epi32(GrayDwords(px), t);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                                    _mm256_or_si256(_mm256_and_si256(on, colorMask), _mm256_and_si256(px, alphaMask)));
+            }
+            ScalarTable()->binarizeBGRA(src + i * 4, dst + i * 4, count - i, threshold);
+        }
+
+        void GrayFromBGRA(const unsigned char* src, unsigned char* dst, int count)
+        {
+            const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+            int i = 0;
+            for (; i + 32 <= count; i += 32)
+            {
+                const __m256i* s = reinterpret_cast<const __m256i*>(src + i * 4);
+                __m256i g0 = GrayDwords(_mm256_loadu_si256(s + 0));
+                __m256i g1 = GrayDwords(_mm256_loadu_si256(s + 1));
+                __m256i g2 = GrayDwords(_mm256_loadu_si256(s + 2));
+                __m256i g3 = GrayDwords(_mm256_loadu_si256(s + 3));
+                // 레인 단위 pack 후 dword 순서를 바로잡는다
+                __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(g0, g1), _mm256_packus_epi32(g2, g3));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permutevar8x32_epi32(packed, order));
+            }
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256i g = GrayDwords(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4)));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), PackDwordsToBytes(g));
+            }
+            ScalarTable()->grayFromBGRA(src + i * 4, dst + i, count - i);
+        }
+
+        void ThresholdGray(const unsigned char* src, unsigned char* dst, int count, int threshold)
+        {
+            // x > t  <=>  max(x, t + 1) == x   (부호 없는 비교)
+            const __m256i limit = _mm256_set1_epi8(static_cast<char>(threshold + 1));
+            int i = 0;
+            for (; i + 32 <= count; i += 32)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cmpeq_epi8(_mm256_max_epu8(x, limit), x));
+            }
+            ScalarTable()->thresholdGray(src + i, dst + i, count - i, threshold);
+        }
+
+        void ConvolveBGRA(const unsigned char* const* rows, const float* kernel, int kSize,
+                          int x0, int x1, unsigned char* dst)
+        {
+            const int kHalf = kSize / 2;
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            int x = x0;
+            for (; x + 4 <= x1; x += 4)
+            {
+                // 벡터 하나 = 화소 2개의 B, G, R, A
+                __m256 acc0 = _mm256_setzero_ps();
+                __m256 acc1 = _mm256_setzero_ps();
+                for (int ky = 0; ky < kSize; ++ky)
+                {
+                    const unsigned char* row = rows[ky] + (x - kHalf) * 4;
+                    const float* k_row = kernel + ky * kSize;
+                    for (int kx = 0; kx < kSize; ++kx)
+                    {
+                        const unsigned char* p = row + kx * 4;
+                        __m256 k = _mm256_set1_ps(k_row[kx]);
+                        __m256 v0 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+                        __m256 v1 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + 8))));
+                        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(v0, k));
+                        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(v1, k));
+                    }
+                }
+                __m256i c0 = ClampToInt(acc0);
+                __m256i c1 = ClampToInt(acc1);
+                __m128i w0 = _mm_packus_epi32(_mm256_castsi256_si128(c0), _mm256_extracti128_si256(c0, 1));
+                __m128i w1 = _mm_packus_epi32(_mm256_castsi256_si128(c1), _mm256_extracti128_si256(c1, 1));
+                __m128i bytes = _mm_or_si128(_mm_packus_epi16(w0, w1), alpha);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), bytes);
+            }
+            ConvolveBGRAScalar(rows, kernel, kSize, x, x1, dst);
+        }
+
+        void ConvolveGray(const unsigned char* const* rows, const float* kernel, int kSize,
+                          int x0, int x1, unsigned char* dst)
+        {
+            const int kHalf = kSize / 2;
+            int x = x0;
+            for (; x + 16 <= x1; x += 16)
+            {
+                __m256 acc0 = _mm256_setzero_ps();
+                __m256 acc1 = _mm256_setzero_ps();
+                for (int ky = 0; ky < kSize; ++ky)
+                {
+                    const unsigned char* row = rows[ky] + x - kHalf;
+                    const float* k_row = kernel + ky * kSize;
+                    for (int kx = 0; kx < kSize; ++kx)
+                    {
+                        __m256 k = _mm256_set1_ps(k_row[kx]);
+                        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + kx));
+                        __m256 v0 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+                        __m256 v1 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+                        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(v0, k));
+                        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(v1, k));
+                    }
+                }
+                __m128i lo = PackDwordsToBytes(ClampToInt(acc0));
+                __m128i hi = PackDwordsToBytes(ClampToInt(acc1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_unpacklo_epi64(lo, hi));
+            }
+            ConvolveGrayScalar(rows, kernel, kSize, x, x1, dst);
+        }
+
+        // 고정소수점: 탭 두 개의 16비트 화소를 교대로 놓고 madd로 곱-합 → dword 누적.
+        // unpack/pack이 128비트 레인 안에서만 섞으므로 packs 후 레인 안 순서가 원래대로 돌아온다
+        inline __m256i RoundShift(__m256i acc, __m256i half, int shift)
+        {
+            return _mm256_sra_epi32(_mm256_add_epi32(acc, half), _mm_cvtsi32_si128(shift));
+        }
+
+        // 16비트 16개(0..255 포화) → 16바이트 (레인 순서 유지)
+        inline __m128i PackWordsToBytes(__m256i words)
+        {
+            return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), 0x88));
+        }
+
+        void ConvolveFixedBGRA(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                               int x0, int x1, unsigned char* dst)
+        {
+            FixedTaps taps;
+            CollectFixedTaps(kernel, kSize, 4, taps);
+            const __m256i half = _mm256_set1_epi32((1 << shift) >> 1);
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            int x = x0;
+            for (; x + 4 <= x1; x += 4)
+            {
+                // 16비트 16개 = 화소 4개의 B, G, R, A
+                __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+                for (int i = 0; i < taps.count; i += 2)
+                {
+                    const __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(rows[taps.row[i]] + x * 4 + taps.offset[i])));
+                    const __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(rows[taps.row[i + 1]] + x * 4 + taps.offset[i + 1])));
+                    const __m256i k = _mm256_set1_epi32(FixedPair(taps, i));
+                    lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), k));
+                    hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), k));
+                }
+                const __m256i words = _mm256_packs_epi32(RoundShift(lo, half, shift), RoundShift(hi, half, shift));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_or_si128(PackWordsToBytes(words), alpha));
+            }
+            ConvolveFixedBGRAScalar(rows, kernel, kSize, shift, x, x1, dst);
+        }
+
+        void ConvolveFixedGray(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                               int x0, int x1, unsigned char* dst)
+        {
+            FixedTaps taps;
+            CollectFixedTaps(kernel, kSize, 1, taps);
+            const __m256i half = _mm256_set1_epi32((1 << shift) >> 1);
+            int x = x0;
+            for (; x + 16 <= x1; x += 16)
+            {
+                __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+                for (int i = 0; i < taps.count; i += 2)
+                {
+                    const __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(rows[taps.row[i]] + x + taps.offset[i])));
+                    const __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(rows[taps.row[i + 1]] + x + taps.offset[i + 1])));
+                    const __m256i k = _mm256_set1_epi32(FixedPair(taps, i));
+                    lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), k));
+                    hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), k));
+                }
+                const __m256i words = _mm256_packs_epi32(RoundShift(lo, half, shift), RoundShift(hi, half, shift));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), PackWordsToBytes(words));
+            }
+            ConvolveFixedGrayScalar(rows, kernel, kSize, shift, x, x1, dst);
+        }
+
+        void MaxBytes(const unsigned char* a, const unsigned char* b, unsigned char* dst, int count)
+        {
+            int i = 0;
+            for (; i + 32 <= count; i += 32)
+            {
+                __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_max_epu8(va, vb));
+            }
+            ScalarTable()->maxBytes(a + i, b + i, dst + i, count - i);
+        }
+
+        void MinBytes(const unsigned char* a, const unsigned char* b, unsigned char* dst, int count)
+        {
+            int i = 0;
+            for (; i + 32 <= count; i += 32)
+            {
+                __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_min_epu8(va, vb));
+            }
+            ScalarTable()->minBytes(a + i, b + i, dst + i, count - i);
+        }
+
+        void ScaleAddFloat(const float* src, float c, float* acc, int count)
+        {
+            int i = 0;
+            const __m256 vc = _mm256_set1_ps(c);
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 v = _mm256_mul_ps(vc, _mm256_loadu_ps(src + i));
+                _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), v));
+            }
+            ScalarTable()->scaleAddFloat(src + i, c, acc + i, count - i);
+        }
+
+        void CorrelateBytes(const unsigned char* t, const unsigned char* x, int count, uint32_t out[3])
+        {
+            int i = 0;
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i dot = zero, sumSq = zero, sum = zero;
+            for (; i + 32 <= count; i += 32)
+            {
+                __m256i vt = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t + i));
+                __m256i vx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+                __m256i tLo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(vt));
+                __m256i tHi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(vt, 1));
+                __m256i xLo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(vx));
+                __m256i xHi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(vx, 1));
+                dot = _mm256_add_epi32(dot, _mm256_add_epi32(_mm256_madd_epi16(tLo, xLo), _mm256_madd_epi16(tHi, xHi)));
+                sumSq = _mm256_add_epi32(sumSq, _mm256_add_epi32(_mm256_madd_epi16(xLo, xLo), _mm256_madd_epi16(xHi, xHi)));
+                sum = _mm256_add_epi64(sum, _mm256_sad_epu8(vx, zero));
+            }
+            uint32_t lanes[8];
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), dot);
+            uint32_t vDot = 0;
+            for (uint32_t v : lanes) vDot += v;
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sumSq);
+            uint32_t vSumSq = 0;
+            for (uint32_t v : lanes) vSumSq += v;
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+            const uint32_t vSum = lanes[0] + lanes[2] + lanes[4] + lanes[6];
+            ScalarTable()->correlateBytes(t + i, x + i, count - i, out);
+            out[0] += vDot;
+            out[1] += vSum;
+            out[2] += vSumSq;
+        }
+    }
+
+    const KernelTable* AVX2Table()
+    {
+        static const KernelTable table = {
+            SimdLevel::AVX2,
+            GrayscaleBGRA,
+            BinarizeBGRA,
+            GrayFromBGRA,
+            ThresholdGray,
+            ConvolveBGRA,
+            ConvolveGray,
+            ConvolveFixedBGRA,
+            ConvolveFixedGray,
+            MaxBytes,
+            MinBytes,
+            ScaleAddFloat,
+            CorrelateBytes,
+        };
+        return &table;
+    }
+}
+#else
+namespace SimdKernels
+{
+    const KernelTable* AVX2Table() { return nullptr; }
+}
+#endif
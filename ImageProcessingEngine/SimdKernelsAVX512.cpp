@@ -0,0 +1,309 @@
+﻿// AVX-512 F/BW 구현 (MSVC /arch:AVX512, GCC/Clang -mavx512f -mavx512bw 로 이 파일만 빌드)
+#include "pch.h"
+#include "SimdKernels.h"
+
+#if defined(IMAGEPROCESSING_X86)
+#include <immintrin.h>
+
+namespace SimdKernels
+{
+    namespace
+    {
+        // BGRA 16화소 → 화소별 dword 그레이 값 (114 B + 587 G + 299 R) / 1000
+        inline __m512i GrayDwords(__m512i px)
+        {
+            const __m512i lowBytes = _mm512_set1_epi32(0x00FF00FF);
+            const __m512i br = _mm512_and_si512(px, lowBytes);
+            const __m512i ga = _mm512_and_si512(_mm512_srli_epi32(px, 8), lowBytes);
+            const __m512i sum = _mm512_add_epi32(_mm512_madd_epi16(br, _mm512_set1_epi32((299 << 16) | 114)),
+                                                 _mm512_madd_epi16(ga, _mm512_set1_epi32(587)));
+            // S / 1000 == ((S >> 3) * 33555) >> 22  (0 <= S <= 255000 에서 정확)
+            return _mm512_srli_epi32(_mm512_mullo_epi32(_mm512_srli_epi32(sum, 3), _mm512_set1_epi32(33555)), 22);
+        }
+
+        inline __m512i ClampToInt(__m512 sum)
+        {
+            sum = _mm512_min_ps(sum, _mm512_set1_ps(255.0f));
+            sum = _mm512_max_ps(sum, _mm512_setzero_ps());
+            return _mm512_cvttps_epi32(sum);
+        }
+
+        void GrayscaleBGRA(const unsigned char* src, unsigned char* dst, int count)
+        {
+            const __m512i alphaMask = _mm512_set1_epi32(static_cast<int>(0xFF000000u));
+            const __m512i replicate = _mm512_set1_epi32(0x00010101);
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m512i px = _mm512_loadu_si512(src + i * 4);
+                __m512i bgr = _mm512_mullo_epi32(GrayDwords(px), replicate);
+                _mm512_storeu_si512(dst + i * 4, _mm512_or_si512(bgr, _mm512_and_si512(px, alphaMask)));
+            }
+            ScalarTable()->grayscaleBGRA(src + i * 4, dst + i * 4, count - i);
+        }
+
+        void BinarizeBGRA(const unsigned char* src, unsigned char* dst, int count, int threshold)
+        {
+            const __m512i alphaMask = _mm512_set1_epi32(static_cast<int>(0xFF000000u));
+            const __m512i colorBits = _mm512_set1_epi32(0x00FFFFFF);
+            const __m512i t = _mm512_set1_epi32(threshold);
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m512i px = _mm512_loadu_si512(src + i * 4);
+                __mmask16 on = _mm512_cmpgt_epi32_mask(GrayDwords(px), t);
+                __m512i alpha = _mm512_and_si512(px, alphaMask);
+                _mm512_storeu_si512(dst + i * 4, _mm512_mask_or_epi32(alpha, on, alpha, colorBits));
+            }
+            ScalarTable()->binarizeBGRA(src + i * 4, dst + i * 4, count - i, threshold);
+        }
+
+        void GrayFromBGRA(const unsigned char* src, unsigned char* dst, int count)
+        {
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m512i gray = GrayDwords(_mm512_loadu_si512(src + i * 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm512_cvtepi32_epi8(gray));
+            }
+            ScalarTable()->grayFromBGRA(src + i * 4, dst + i, count - i);
+        }
+
+        void ThresholdGray(const unsigned char* src, unsigned char* dst, int count, int threshold)
+        {
+            const __m512i t = _mm512_set1_epi8(static_cast<char>(threshold));
+            int i = 0;
+            for (; i + 64 <= count; i += 64)
+            {
+                __m512i x = _mm512_loadu_si512(src + i);
+                _mm512_storeu_si512(dst + i, _mm512_movm_epi8(_mm512_cmpgt_epu8_mask(x, t)));
+            }
+            ScalarTable()->thresholdGray(src + i, dst + i, count - i, threshold);
+        }
+
+        void ConvolveBGRA(const unsigned char* const* rows, const float* kernel, int kSize,
+                          int x0, int x1, unsigned char* dst)
+        {
+            const int kHalf = kSize / 2;
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            int x = x0;
+            for (; x + 8 <= x1; x += 8)
+            {
+                // 벡터 하나 = 화소 4개의 B, G, R, A
+                __m512 acc0 = _mm512_setzero_ps();
+                __m512 acc1 = _mm512_setzero_ps();
+                for (int ky = 0; ky < kSize; ++ky)
+                {
+                    const unsigned char* row = rows[ky] + (x - kHalf) * 4;
+                    const float* k_row = kernel + ky * kSize;
+                    for (int kx = 0; kx < kSize; ++kx)
+                    {
+                        const unsigned char* p = row + kx * 4;
+                        __m512 k = _mm512_set1_ps(k_row[kx]);
+                        __m512 v0 = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+                        __m512 v1 = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16))));
+                        acc0 = _mm512_add_ps(acc0, _mm512_mul_ps(v0, k));
+                        acc1 = _mm512_add_ps(acc1, _mm512_mul_ps(v1, k));
+                    }
+                }
+                __m128i b0 = _mm_or_si128(_mm512_cvtepi32_epi8(ClampToInt(acc0)), alpha);
+                __m128i b1 = _mm_or_si128(_mm512_cvtepi32_epi8(ClampToInt(acc1)), alpha);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), b0);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4 + 16), b1);
+            }
+            ConvolveBGRAScalar(rows, kernel, kSize, x, x1, dst);
+        }
+
+        void ConvolveGray(const unsigned char* const* rows, const float* kernel, int kSize,
+                          int x0, int x1, unsigned char* dst)
+        {
+            const int kHalf = kSize / 2;
+            int x = x0;
+            for (; x + 32 <= x1; x += 32)
+            {
+                __m512 acc0 = _mm512_setzero_ps();
+                __m512 acc1 = _mm512_setzero_ps();
+                for (int ky = 0; ky < kSize; ++ky)
+                {
+                    const unsigned char* row = rows[ky] + x - kHalf;
+                    const float* k_row = kernel + ky * kSize;
+                    for (int kx = 0; kx < kSize; ++kx)
+                    {
+                        __m512 k = _mm512_set1_ps(k_row[kx]);
+                        __m512 v0 = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + kx))));
+                        __m512 v1 = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + kx + 16))));
+                        acc0 = _mm512_add_ps(acc0, _mm512_mul_ps(v0, k));
+                        acc1 = _mm512_add_ps(acc1, _mm512_mul_ps(v1, k));
+                    }
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm512_cvtepi32_epi8(ClampToInt(acc0)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 16), _mm512_cvtepi32_epi8(ClampToInt(acc1)));
+            }
+            ConvolveGrayScalar(rows, kernel, kSize, x, x1, dst);
+        }
+
+        // 고정소수점: 탭 두 개의 16비트 화소를 교대로 놓고 madd로 곱-합 → dword 누적.
+        // packs 후 16비트를 0..255로 자른 뒤 cvtepi16_epi8로 순서대로 좁힌다
+        inline __m512i RoundShift(__m512i acc, __m512i half, int shift)
+        {
+            return _mm512_sra_epi32(_mm512_add_epi32(acc, half), _mm_cvtsi32_si128(shift));
+        }
+
+        inline __m256i WordsToBytes(__m512i words)
+        {
+            words = _mm512_min_epi16(_mm512_max_epi16(words, _mm512_setzero_si512()), _mm512_set1_epi16(255));
+            return _mm512_cvtepi16_epi8(words);
+        }
+
+        void ConvolveFixedBGRA(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                               int x0, int x1, unsigned char* dst)
+        {
+            FixedTaps taps;
+            CollectFixedTaps(kernel, kSize, 4, taps);
+            const __m512i half = _mm512_set1_epi32((1 << shift) >> 1);
+            const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+            int x = x0;
+            for (; x + 8 <= x1; x += 8)
+            {
+                // 16비트 32개 = 화소 8개의 B, G, R, A
+                __m512i lo = _mm512_setzero_si512(), hi = _mm512_setzero_si512();
+                for (int i = 0; i < taps.count; i += 2)
+                {
+                    const __m512i a = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(rows[taps.row[i]] + x * 4 + taps.offset[i])));
+                    const __m512i b = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(rows[taps.row[i + 1]] + x * 4 + taps.offset[i + 1])));
+                    const __m512i k = _mm512_set1_epi32(FixedPair(taps, i));
+                    lo = _mm512_add_epi32(lo, _mm512_madd_epi16(_mm512_unpacklo_epi16(a, b), k));
+                    hi = _mm512_add_epi32(hi, _mm512_madd_epi16(_mm512_unpackhi_epi16(a, b), k));
+                }
+                const __m512i words = _mm512_packs_epi32(RoundShift(lo, half, shift), RoundShift(hi, half, shift));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), _mm256_or_si256(WordsToBytes(words), alpha));
+            }
+            ConvolveFixedBGRAScalar(rows, kernel, kSize, shift, x, x1, dst);
+        }
+
+        void ConvolveFixedGray(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                               int x0, int x1, unsigned char* dst)
+        {
+            FixedTaps taps;
+            CollectFixedTaps(kernel, kSize, 1, taps);
+            const __m512i half = _mm512_set1_epi32((1 << shift) >> 1);
+            int x = x0;
+            for (; x + 32 <= x1; x += 32)
+            {
+                __m512i lo = _mm512_setzero_si512(), hi = _mm512_setzero_si512();
+                for (int i = 0; i < taps.count; i += 2)
+                {
+                    const __m512i a = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(rows[taps.row[i]] + x + taps.offset[i])));
+                    const __m512i b = _mm512_cvtepu8_epi16(_mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(rows[taps.row[i + 1]] + x + taps.offset[i + 1])));
+                    const __m512i k = _mm512_set1_epi32(FixedPair(taps, i));
+                    lo = _mm512_add_epi32(lo, _mm512_madd_epi16(_mm512_unpacklo_epi16(a, b), k));
+                    hi = _mm512_add_epi32(hi, _mm512_madd_epi16(_mm512_unpackhi_epi16(a, b), k));
+                }
+                const __m512i words = _mm512_packs_epi32(RoundShift(lo, half, shift), RoundShift(hi, half, shift));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), WordsToBytes(words));
+            }
+            ConvolveFixedGrayScalar(rows, kernel, kSize, shift, x, x1, dst);
+        }
+
+        void MaxBytes(const unsigned char* a, const unsigned char* b, unsigned char* dst, int count)
+        {
+            int i = 0;
+            for (; i + 64 <= count; i += 64)
+            {
+                __m512i va = _mm512_loadu_si512(a + i);
+                __m512i vb = _mm512_loadu_si512(b + i);
+                _mm512_storeu_si512(dst + i, _mm512_max_epu8(va, vb));
+            }
+            ScalarTable()->maxBytes(a + i, b + i, dst + i, count - i);
+        }
+
+        void MinBytes(const unsigned char* a, const unsigned char* b, unsigned char* dst, int count)
+        {
+            int i = 0;
+            for (; i + 64 <= count; i += 64)
+            {
+                __m512i va = _mm512_loadu_si512(a + i);
+                __m512i vb = _mm512_loadu_si512(b + i);
+                _mm512_storeu_si512(dst + i, _mm512_min_epu8(va, vb));
+            }
+            ScalarTable()->minBytes(a + i, b + i, dst + i, count - i);
+        }
+
+        void ScaleAddFloat(const float* src, float c, float* acc, int count)
+        {
+            int i = 0;
+            const __m512 vc = _mm512_set1_ps(c);
+            for (; i + 16 <= count; i += 16)
+            {
+                __m512 v = _mm512_mul_ps(vc, _mm512_loadu_ps(src + i));
+                _mm512_storeu_ps(acc + i, _mm512_add_ps(_mm512_loadu_ps(acc + i), v));
+            }
+            ScalarTable()->scaleAddFloat(src + i, c, acc + i, count - i);
+        }
+
+        void CorrelateBytes(const unsigned char* t, const unsigned char* x, int count, uint32_t out[3])
+        {
+            int i = 0;
+            const __m512i zero = _mm512_setzero_si512();
+            __m512i dot = zero, sumSq = zero, sum = zero;
+            for (; i + 64 <= count; i += 64)
+            {
+                __m512i vt = _mm512_loadu_si512(t + i);
+                __m512i vx = _mm512_loadu_si512(x + i);
+                // 상위 절반은 따로 읽는다 (GCC 12의 _mm512_extracti64x4_epi64는 _mm256_undefined_si256 때문에 -Wuninitialized 오탐)
+                __m512i tLo = _mm512_cvtepu8_epi16(_mm512_castsi512_si256(vt));
+                __m512i tHi = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(t + i + 32)));
+                __m512i xLo = _mm512_cvtepu8_epi16(_mm512_castsi512_si256(vx));
+                __m512i xHi = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i + 32)));
+                dot = _mm512_add_epi32(dot, _mm512_add_epi32(_mm512_madd_epi16(tLo, xLo), _mm512_madd_epi16(tHi, xHi)));
+                sumSq = _mm512_add_epi32(sumSq, _mm512_add_epi32(_mm512_madd_epi16(xLo, xLo), _mm512_madd_epi16(xHi, xHi)));
+                sum = _mm512_add_epi64(sum, _mm512_sad_epu8(vx, zero));
+            }
+            // _mm512_reduce_add_*도 내부에서 extracti64x4를 쓰므로 메모리에 풀어 더한다
+            uint32_t lanes[16];
+            _mm512_storeu_si512(lanes, dot);
+            uint32_t vDot = 0;
+            for (uint32_t v : lanes) vDot += v;
+            _mm512_storeu_si512(lanes, sumSq);
+            uint32_t vSumSq = 0;
+            for (uint32_t v : lanes) vSumSq += v;
+            _mm512_storeu_si512(lanes, sum);
+            uint32_t vSum = 0;
+            for (int k = 0; k < 16; k += 2) vSum += lanes[k];
+            ScalarTable()->correlateBytes(t + i, x + i, count - i, out);
+            out[0] += vDot;
+            out[1] += vSum;
+            out[2] += vSumSq;
+        }
+    }
+
+    const KernelTable* AVX512Table()
+    {
+        static const KernelTable table = {
+            SimdLevel::AVX512,
+            GrayscaleBGRA,
+            BinarizeBGRA,
+            GrayFromBGRA,
+            ThresholdGray,
+            ConvolveBGRA,
+            ConvolveGray,
+            ConvolveFixedBGRA,
+            ConvolveFixedGray,
+            MaxBytes,
+            MinBytes,
+            ScaleAddFloat,
+            CorrelateBytes,
+        };
+        return &table;
+    }
+}
+#else
+namespace SimdKernels
+{
+    const KernelTable* AVX512Table() { return nullptr; }
+}
+#endif
@@ -0,0 +1,303 @@
+﻿// SSE4.1 구현 (MSVC x64는 별도 옵션 불필요, GCC/Clang은 -msse4.1로 이 파일만 빌드)
+#include "pch.h"
+#include "SimdKernels.h"
+
+#if defined(IMAGEPROCESSING_X86)
+#include <smmintrin.h>
+#include <cstring>
+
+namespace SimdKernels
+{
+    namespace
+    {
+        inline __m128i LoadU32(const unsigned char* p)
+        {
+            int v;
+            memcpy(&v, p, sizeof(v));
+            return _mm_cvtsi32_si128(v);
+        }
+
+        // BGRA 4화소 → 화소별 dword 그레이 값 (114 B + 587 G + 299 R) / 1000
+        inline __m128i GrayDwords(__m128i px)
+        {
+            const __m128i lowBytes = _mm_set1_epi32(0x00FF00FF);
+            const __m128i br = _mm_and_si128(px, lowBytes);
+            const __m128i ga = _mm_and_si128(_mm_srli_epi32(px, 8), lowBytes);
+            const __m128i sum = _mm_add_epi32(_mm_madd_epi16(br, _mm_set1_epi32((299 << 16) | 114)),
+                                              _mm_madd_epi16(ga, _mm_set1_epi32(587)));
+            // S / 1000 == ((S >> 3) * 33555) >> 22  (0 <= S <= 255000 에서 정확)
+            return _mm_srli_epi32(_mm_mullo_epi32(_mm_srli_epi32(sum, 3), _mm_set1_epi32(33555)), 22);
+        }
+
+        inline __m128i ClampToInt(__m128 sum)
+        {
+            sum = _mm_min_ps(sum, _mm_set1_ps(255.0f));
+            sum = _mm_max_ps(sum, _mm_setzero_ps());
+            return _mm_cvttps_epi32(sum);
+        }
+
+        void GrayscaleBGRA(const unsigned char* src, unsigned char* dst, int count)
+        {
+            const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+                __m128i gray = GrayDwords(px);
+                __m128i bgr = _mm_or_si128(gray, _mm_or_si128(_mm_slli_epi32(gray, 8), _mm_slli_epi32(gray, 16)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(bgr, _mm_and_si128(px, alphaMask)));
+            }
+            ScalarTable()->grayscaleBGRA(src + i * 4, dst + i * 4, count - i);
+        }
+
+        void BinarizeBGRA(const unsigned char* src, unsigned char* dst, int count, int threshold)
+        {
+            const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+            const __m128i t = _mm_set1_epi32(threshold);
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+                __m128i on = _mm_cmpgt_epi32(GrayDwords(px), t);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                                 _mm_or_si128(_mm_and_si128(on, colorMask), _mm_and_si128(px, alphaMask)));
+            }
+            ScalarTable()->binarizeBGRA(src + i * 4, dst + i * 4, count - i, threshold);
+        }
+
+        void GrayFromBGRA(const unsigned char* src, unsigned char* dst, int count)
+        {
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m128i* s = reinterpret_cast<const __m128i*>(src + i * 4);
+                __m128i g0 = GrayDwords(_mm_loadu_si128(s + 0));
+                __m128i g1 = GrayDwords(_mm_loadu_si128(s + 1));
+                __m128i g2 = GrayDwords(_mm_loadu_si128(s + 2));
+                __m128i g3 = GrayDwords(_mm_loadu_si128(s + 3));
+                __m128i packed = _mm_packus_epi16(_mm_packus_epi32(g0, g1), _mm_packus_epi32(g2, g3));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+            }
+            ScalarTable()->grayFromBGRA(src + i * 4, dst + i, count - i);
+        }
+
+        void ThresholdGray(const unsigned char* src, unsigned char* dst, int count, int threshold)
+        {
+            // x > t  <=>  max(x, t + 1) == x   (부호 없는 비교)
+            const __m128i limit = _mm_set1_epi8(static_cast<char>(threshold + 1));
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cmpeq_epi8(_mm_max_epu8(x, limit), x));
+            }
+            ScalarTable()->thresholdGray(src + i, dst + i, count - i, threshold);
+        }
+
+        void ConvolveBGRA(const unsigned char* const* rows, const float* kernel, int kSize,
+                          int x0, int x1, unsigned char* dst)
+        {
+            const int kHalf = kSize / 2;
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            int x = x0;
+            for (; x + 2 <= x1; x += 2)
+            {
+                // 레인 = 화소 1개의 B, G, R, A
+                __m128 acc0 = _mm_setzero_ps();
+                __m128 acc1 = _mm_setzero_ps();
+                for (int ky = 0; ky < kSize; ++ky)
+                {
+                    const unsigned char* row = rows[ky] + (x - kHalf) * 4;
+                    const float* k_row = kernel + ky * kSize;
+                    for (int kx = 0; kx < kSize; ++kx)
+                    {
+                        __m128i two = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + kx * 4));
+                        __m128 k = _mm_set1_ps(k_row[kx]);
+                        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(two)), k));
+                        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(two, 4))), k));
+                    }
+                }
+                __m128i packed = _mm_packus_epi32(ClampToInt(acc0), ClampToInt(acc1));
+                packed = _mm_or_si128(_mm_packus_epi16(packed, packed), alpha);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), packed);
+            }
+            ConvolveBGRAScalar(rows, kernel, kSize, x, x1, dst);
+        }
+
+        void ConvolveGray(const unsigned char* const* rows, const float* kernel, int kSize,
+                          int x0, int x1, unsigned char* dst)
+        {
+            const int kHalf = kSize / 2;
+            int x = x0;
+            for (; x + 4 <= x1; x += 4)
+            {
+                __m128 acc = _mm_setzero_ps();
+                for (int ky = 0; ky < kSize; ++ky)
+                {
+                    const unsigned char* row = rows[ky] + x - kHalf;
+                    const float* k_row = kernel + ky * kSize;
+                    for (int kx = 0; kx < kSize; ++kx)
+                    {
+                        __m128 v = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(LoadU32(row + kx)));
+                        acc = _mm_add_ps(acc, _mm_mul_ps(v, _mm_set1_ps(k_row[kx])));
+                    }
+                }
+                __m128i packed = _mm_packus_epi32(ClampToInt(acc), _mm_setzero_si128());
+                packed = _mm_packus_epi16(packed, packed);
+                int out = _mm_cvtsi128_si32(packed);
+                memcpy(dst + x, &out, sizeof(out));
+            }
+            ConvolveGrayScalar(rows, kernel, kSize, x, x1, dst);
+        }
+
+        // 고정소수점: 탭 두 개의 16비트 화소를 교대로 놓고 madd로 곱-합 → dword 누적
+        inline __m128i RoundShift(__m128i acc, __m128i half, int shift)
+        {
+            return _mm_sra_epi32(_mm_add_epi32(acc, half), _mm_cvtsi32_si128(shift));
+        }
+
+        void ConvolveFixedBGRA(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                               int x0, int x1, unsigned char* dst)
+        {
+            FixedTaps taps;
+            CollectFixedTaps(kernel, kSize, 4, taps);
+            const __m128i half = _mm_set1_epi32((1 << shift) >> 1);
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            int x = x0;
+            for (; x + 2 <= x1; x += 2)
+            {
+                // 16비트 8개 = 화소 2개의 B, G, R, A
+                __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+                for (int i = 0; i < taps.count; i += 2)
+                {
+                    const __m128i a = _mm_cvtepu8_epi16(_mm_loadl_epi64(
+                        reinterpret_cast<const __m128i*>(rows[taps.row[i]] + x * 4 + taps.offset[i])));
+                    const __m128i b = _mm_cvtepu8_epi16(_mm_loadl_epi64(
+                        reinterpret_cast<const __m128i*>(rows[taps.row[i + 1]] + x * 4 + taps.offset[i + 1])));
+                    const __m128i k = _mm_set1_epi32(FixedPair(taps, i));
+                    lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), k));
+                    hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), k));
+                }
+                const __m128i words = _mm_packs_epi32(RoundShift(lo, half, shift), RoundShift(hi, half, shift));
+                const __m128i bytes = _mm_or_si128(_mm_packus_epi16(words, words), alpha);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), bytes);
+            }
+            ConvolveFixedBGRAScalar(rows, kernel, kSize, shift, x, x1, dst);
+        }
+
+        void ConvolveFixedGray(const unsigned char* const* rows, const int16_t* kernel, int kSize, int shift,
+                               int x0, int x1, unsigned char* dst)
+        {
+            FixedTaps taps;
+            CollectFixedTaps(kernel, kSize, 1, taps);
+            const __m128i half = _mm_set1_epi32((1 << shift) >> 1);
+            int x = x0;
+            for (; x + 8 <= x1; x += 8)
+            {
+                __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+                for (int i = 0; i < taps.count; i += 2)
+                {
+                    const __m128i a = _mm_cvtepu8_epi16(_mm_loadl_epi64(
+                        reinterpret_cast<const __m128i*>(rows[taps.row[i]] + x + taps.offset[i])));
+                    const __m128i b = _mm_cvtepu8_epi16(_mm_loadl_epi64(
+                        reinterpret_cast<const __m128i*>(rows[taps.row[i + 1]] + x + taps.offset[i + 1])));
+                    const __m128i k = _mm_set1_epi32(FixedPair(taps, i));
+                    lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), k));
+                    hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), k));
+                }
+                const __m128i words = _mm_packs_epi32(RoundShift(lo, half, shift), RoundShift(hi, half, shift));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(words, words));
+            }
+            ConvolveFixedGrayScalar(rows, kernel, kSize, shift, x, x1, dst);
+        }
+
+        void MaxBytes(const unsigned char* a, const unsigned char* b, unsigned char* dst, int count)
+        {
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_max_epu8(va, vb));
+            }
+            ScalarTable()->maxBytes(a + i, b + i, dst + i, count - i);
+        }
+
+        void MinBytes(const unsigned char* a, const unsigned char* b, unsigned char* dst, int count)
+        {
+            int i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_min_epu8(va, vb));
+            }
+            ScalarTable()->minBytes(a + i, b + i, dst + i, count - i);
+        }
+
+        void ScaleAddFloat(const float* src, float c, float* acc, int count)
+        {
+            int i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 v = _mm_mul_ps(_mm_set1_ps(c), _mm_loadu_ps(src + i));
+                _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), v));
+            }
+            ScalarTable()->scaleAddFloat(src + i, c, acc + i, count - i);
+        }
+
+        void CorrelateBytes(const unsigned char* t, const unsigned char* x, int count, uint32_t out[3])
+        {
+            int i = 0;
+            const __m128i zero = _mm_setzero_si128();
+            __m128i dot = zero, sumSq = zero, sum = zero;
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i vt = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + i));
+                __m128i vx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+                __m128i tLo = _mm_cvtepu8_epi16(vt), tHi = _mm_cvtepu8_epi16(_mm_srli_si128(vt, 8));
+                __m128i xLo = _mm_cvtepu8_epi16(vx), xHi = _mm_cvtepu8_epi16(_mm_srli_si128(vx, 8));
+                dot = _mm_add_epi32(dot, _mm_add_epi32(_mm_madd_epi16(tLo, xLo), _mm_madd_epi16(tHi, xHi)));
+                sumSq = _mm_add_epi32(sumSq, _mm_add_epi32(_mm_madd_epi16(xLo, xLo), _mm_madd_epi16(xHi, xHi)));
+                sum = _mm_add_epi64(sum, _mm_sad_epu8(vx, zero));
+            }
+            uint32_t lanes[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), dot);
+            const uint32_t vDot = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sumSq);
+            const uint32_t vSumSq = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            const uint32_t vSum = static_cast<uint32_t>(_mm_cvtsi128_si32(sum) + _mm_extract_epi32(sum, 2));
+            ScalarTable()->correlateBytes(t + i, x + i, count - i, out);
+            out[0] += vDot;
+            out[1] += vSum;
+            out[2] += vSumSq;
+        }
+    }
+
+    const KernelTable* SSE41Table()
+    {
+        static const KernelTable table = {
+            SimdLevel::SSE41,
+            GrayscaleBGRA,
+            BinarizeBGRA,
+            GrayFromBGRA,
+            ThresholdGray,
+            ConvolveBGRA,
+            ConvolveGray,
+            ConvolveFixedBGRA,
+            ConvolveFixedGray,
+            MaxBytes,
+            MinBytes,
+            ScaleAddFloat,
+            CorrelateBytes,
+        };
+        return &table;
+    }
+}
+#else
+namespace SimdKernels
+{
+    const KernelTable* SSE41Table() { return nullptr; }
+}
+#endif
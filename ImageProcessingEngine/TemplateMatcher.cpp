@@ -0,0 +1,427 @@
+﻿#include "pch.h"
+#include "TemplateMatcher.h"
+#include "FFTPlan.h"
+#include "SimdKernels.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+    // 최상위 레벨 템플릿의 짧은 변이 이보다 작아지도록 축소하지 않는다 (너무 작으면 변별력이 없다)
+    const int kMinTopTemplateSide = 16;
+    const int kMaxPyramidLevels = 6;
+
+    // 분자 계산 경로 교차점: 템플릿 화소 수가 이보다 크면 FFT 상관이 직접 상관보다 빠르다 (AVX2/AVX-512 실측)
+    const int kFFTTemplateArea = 1024;
+
+    // 거친 레벨에서 남길 최소 후보 수 (반복 패턴에서 진짜 위치가 밀려나지 않도록 넉넉히).
+    // 결이 고운 템플릿은 홀수 위치에서 2x2 축소로 상관이 크게 떨어지므로 거친 레벨에서는 점수로 거르지 않고
+    // 상위 후보를 이만큼 남긴 뒤 minScore는 레벨 0에서만 적용한다
+    const int kMinCoarseCandidates = 32;
+
+    // 세밀 레벨에서 다시 찾는 반경 (상위 레벨 위치 x2 주변)
+    const int kRefineRadius = 2;
+
+    // 창 안 분산이 이보다 작으면(거의 평탄한 영역) 점수를 0으로 둔다
+    const double kMinVariancePerPixel = 0.25;
+
+    // 2x2 평균 축소 (홀수 크기의 마지막 행/열은 버린다)
+    GrayImage Downsample(const GrayImage& src)
+    {
+        GrayImage dst(src.Width() / 2, src.Height() / 2);
+        for (int y = 0; y < dst.Height(); ++y)
+        {
+            const unsigned char* a = src.Row(2 * y);
+            const unsigned char* b = src.Row(2 * y + 1);
+            unsigned char* d = dst.Row(y);
+            for (int x = 0; x < dst.Width(); ++x)
+            {
+                d[x] = static_cast<unsigned char>((a[2 * x] + a[2 * x + 1] + b[2 * x] + b[2 * x + 1] + 2) >> 2);
+            }
+        }
+        return dst;
+    }
+
+    float Ncc(double numerator, double sum, double sumSq, double n, double templateNorm)
+    {
+        const double variance = sumSq - sum * sum / n;
+        if (variance < kMinVariancePerPixel * n || templateNorm <= 0.0) return 0.f;
+        return static_cast<float>(numerator / (templateNorm * std::sqrt(variance)));
+    }
+
+    // 위치 (x, y) 하나의 NCC를 직접 계산 (세밀 레벨 탐색용).
+    // Σ T' I = Σ T I - mean(T) Σ I 이므로 8비트 정수 내적으로 정확히 구한다
+    float ScoreAt(const GrayImage& image, const TemplateMatcher::Level& t, int x, int y)
+    {
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        const int tw = t.image.Width(), th = t.image.Height();
+        uint64_t dot = 0, sum = 0, sumSq = 0;
+        for (int i = 0; i < th; ++i)
+        {
+            const unsigned char* row = image.Row(y + i) + x;
+            const unsigned char* trow = t.image.Row(i);
+            for (int j = 0; j < tw; j += SimdKernels::kMaxCorrelateCount)
+            {
+                uint32_t partial[3];
+                simd.correlateBytes(trow + j, row + j, std::min(tw - j, SimdKernels::kMaxCorrelateCount), partial);
+                dot += partial[0];
+                sum += partial[1];
+                sumSq += partial[2];
+            }
+        }
+        const double numerator = static_cast<double>(dot) - t.mean * static_cast<double>(sum);
+        return Ncc(numerator, static_cast<double>(sum), static_cast<double>(sumSq),
+                   static_cast<double>(tw) * th, t.norm);
+    }
+
+    // 모든 위치의 분자 Σ T'(i, j) I(y + i, x + j). out은 ow x oh
+    void CorrelateDirect(const GrayImage& image, const TemplateMatcher::Level& t, std::vector<float>& out, int ow, int oh)
+    {
+        const int width = image.Width();
+        const int tw = t.image.Width(), th = t.image.Height();
+
+        std::vector<float> plane(static_cast<size_t>(width) * image.Height());
+        for (size_t i = 0; i < plane.size(); ++i) plane[i] = image.Data()[i];
+
+        // 템플릿 계수 하나를 출력 행 전체에 곱해 더한다 (x 방향 SIMD)
+        const SimdKernels::KernelTable& simd = SimdKernels::Active();
+        ThreadPool::Shared().ParallelFor(0, oh, 1, [&](int y0, int y1)
+            {
+                for (int y = y0; y < y1; ++y)
+                {
+                    float* acc = out.data() + static_cast<size_t>(y) * ow;
+                    std::fill(acc, acc + ow, 0.f);
+                    for (int i = 0; i < th; ++i)
+                    {
+                        const float* row = plane.data() + static_cast<size_t>(y + i) * width;
+                        const float* trow = t.zeroMean.data() + static_cast<size_t>(i) * tw;
+                        for (int j = 0; j < tw; ++j)
+                        {
+                            simd.scaleAddFloat(row + j, trow[j], acc, ow);
+                        }
+                    }
+                }
+            });
+    }
+
+    // FFT 상관. 영상 평균을 빼서 변환하면(템플릿 합이 0이라 분자는 같다) 부동소수점 오차가 줄어든다.
+    // 출력 위치는 영상 안쪽만 읽으므로 순환 상관의 되감김이 섞이지 않는다
+    void CorrelateFFT(const GrayImage& image, const TemplateMatcher::Level& t, std::vector<float>& out, int ow, int oh)
+    {
+        const int width = image.Width(), height = image.Height();
+        const int tw = t.image.Width(), th = t.image.Height();
+        const int paddedWidth = FFT2D::PaddedWidth(width);
+        const int paddedHeight = FFT2D::PaddedHeight(height);
+        const FFT2D fft(paddedWidth, paddedHeight);
+        const size_t spectrumSize = static_cast<size_t>(fft.SpectrumWidth()) * paddedHeight;
+
+        double mean = 0.0;
+        for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) mean += image.Data()[i];
+        mean /= static_cast<double>(width) * height;
+
+        std::vector<float> plane(static_cast<size_t>(paddedWidth) * paddedHeight, 0.f);
+        for (int y = 0; y < height; ++y)
+        {
+            const unsigned char* s = image.Row(y);
+            float* p = plane.data() + static_cast<size_t>(y) * paddedWidth;
+            for (int x = 0; x < width; ++x) p[x] = static_cast<float>(s[x] - mean);
+        }
+        std::vector<float> re(spectrumSize), im(spectrumSize);
+        fft.Forward(plane.data(), re.data(), im.data());
+
+        // 상관 필터 g(-i, -j) = T'(i, j)
+        std::fill(plane.begin(), plane.end(), 0.f);
+        for (int i = 0; i < th; ++i)
+        {
+            const int gy = (paddedHeight - i) % paddedHeight;
+            for (int j = 0; j < tw; ++j)
+            {
+                const int gx = (paddedWidth - j) % paddedWidth;
+                plane[static_cast<size_t>(gy) * paddedWidth + gx] = t.zeroMean[static_cast<size_t>(i) * tw + j];
+            }
+        }
+        std::vector<float> kernelRe(spectrumSize), kernelIm(spectrumSize);
+        fft.Forward(plane.data(), kernelRe.data(), kernelIm.data());
+
+        for (size_t i = 0; i < spectrumSize; ++i)
+        {
+            const float a = re[i], b = im[i];
+            re[i] = a * kernelRe[i] - b * kernelIm[i];
+            im[i] = a * kernelIm[i] + b * kernelRe[i];
+        }
+        fft.Inverse(re.data(), im.data(), plane.data());
+
+        for (int y = 0; y < oh; ++y)
+        {
+            std::copy(plane.data() + static_cast<size_t>(y) * paddedWidth,
+                      plane.data() + static_cast<size_t>(y) * paddedWidth + ow,
+                      out.data() + static_cast<size_t>(y) * ow);
+        }
+    }
+
+    // 최상위 레벨 전체 탐색: 분자(직접/FFT) + 합/제곱합 적분 영상으로 정규화한 점수 지도
+    std::vector<float> ScoreMap(const GrayImage& image, const TemplateMatcher::Level& t, int ow, int oh)
+    {
+        const int width = image.Width(), height = image.Height();
+        const int tw = t.image.Width(), th = t.image.Height();
+
+        std::vector<float> scores(static_cast<size_t>(ow) * oh);
+        if (tw * th > kFFTTemplateArea)
+            CorrelateFFT(image, t, scores, ow, oh);
+        else
+            CorrelateDirect(image, t, scores, ow, oh);
+
+        // (width + 1) x (height + 1) 적분 영상. 20 MP 이상에서도 넘치지 않도록 64비트
+        const size_t stride = static_cast<size_t>(width) + 1;
+        std::vector<int64_t> sum(stride * (height + 1), 0), sumSq(stride * (height + 1), 0);
+        for (int y = 0; y < height; ++y)
+        {
+            const unsigned char* s = image.Row(y);
+            int64_t rowSum = 0, rowSumSq = 0;
+            for (int x = 0; x < width; ++x)
+            {
+                rowSum += s[x];
+                rowSumSq += s[x] * s[x];
+                sum[(y + 1) * stride + x + 1] = sum[y * stride + x + 1] + rowSum;
+                sumSq[(y + 1) * stride + x + 1] = sumSq[y * stride + x + 1] + rowSumSq;
+            }
+        }
+
+        const double n = static_cast<double>(tw) * th;
+        const int grain = std::max(8, (1 << 16) / std::max(1, ow));
+        ThreadPool::Shared().ParallelFor(0, oh, grain, [&](int y0, int y1)
+            {
+                for (int y = y0; y < y1; ++y)
+                {
+                    const int64_t* s0 = sum.data() + y * stride;
+                    const int64_t* s1 = sum.data() + (y + th) * stride;
+                    const int64_t* q0 = sumSq.data() + y * stride;
+                    const int64_t* q1 = sumSq.data() + (y + th) * stride;
+                    float* row = scores.data() + static_cast<size_t>(y) * ow;
+                    for (int x = 0; x < ow; ++x)
+                    {
+                        const int64_t s = s1[x + tw] - s1[x] - s0[x + tw] + s0[x];
+                        const int64_t q = q1[x + tw] - q1[x] - q0[x + tw] + q0[x];
+                        row[x] = Ncc(row[x], static_cast<double>(s), static_cast<double>(q), n, t.norm);
+                    }
+                }
+            });
+        return scores;
+    }
+
+    struct Candidate
+    {
+        int x;
+        int y;
+        float score;
+    };
+
+    // 점수 내림차순으로 정렬한 뒤 서로 minDistance 안에 있는 약한 후보를 제거
+    std::vector<Candidate> SuppressNonMaxima(std::vector<Candidate> candidates, int minDistance, size_t maxCount)
+    {
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+        std::vector<Candidate> kept;
+        for (const Candidate& c : candidates)
+        {
+            if (kept.size() >= maxCount) break;
+            bool isolated = true;
+            for (const Candidate& k : kept)
+            {
+                if (std::abs(c.x - k.x) < minDistance && std::abs(c.y - k.y) < minDistance)
+                {
+                    isolated = false;
+                    break;
+                }
+            }
+            if (isolated) kept.push_back(c);
+        }
+        return kept;
+    }
+
+    // 세 점 (-1, 0, +1)에 맞춘 포물선의 꼭짓점 오프셋 (-0.5 ~ 0.5)
+    float ParabolicOffset(float left, float center, float right)
+    {
+        const float denominator = left - 2.f * center + right;
+        if (denominator >= 0.f) return 0.f;     // 극대가 아님
+        const float offset = 0.5f * (left - right) / denominator;
+        return std::max(-0.5f, std::min(0.5f, offset));
+    }
+}
+
+bool TemplateMatcher::SetTemplate(const GrayImage& templ)
+{
+    m_levels.clear();
+    if (templ.Empty()) return false;
+
+    GrayImage current = templ;
+    for (int level = 0; level <= kMaxPyramidLevels; ++level)
+    {
+        Level entry;
+        const int tw = current.Width(), th = current.Height();
+        const size_t n = static_cast<size_t>(tw) * th;
+
+        double mean = 0.0;
+        for (size_t i = 0; i < n; ++i) mean += current.Data()[i];
+        mean /= static_cast<double>(n);
+
+        entry.zeroMean.resize(n);
+        double energy = 0.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double v = current.Data()[i] - mean;
+            entry.zeroMean[i] = static_cast<float>(v);
+            energy += v * v;
+        }
+        entry.mean = mean;
+        entry.norm = std::sqrt(energy);
+        entry.image = current;
+        m_levels.push_back(std::move(entry));
+
+        if (std::min(tw, th) / 2 < kMinTopTemplateSide) break;
+        current = Downsample(current);
+    }
+    return true;
+}
+
+int TemplateMatcher::AutoPyramidLevels(int imageWidth, int imageHeight) const
+{
+    if (m_levels.empty()) return 0;
+
+    // 템플릿 피라미드는 짧은 변이 kMinTopTemplateSide 이상인 레벨까지만 만들어져 있다.
+    // 영상도 최상위 레벨에서 템플릿의 두 배 이상 남아야 전체 탐색이 의미 있다
+    int levels = static_cast<int>(m_levels.size()) - 1;
+    while (levels > 0)
+    {
+        const Level& top = m_levels[levels];
+        if ((imageWidth >> levels) >= 2 * top.image.Width() && (imageHeight >> levels) >= 2 * top.image.Height()) break;
+        --levels;
+    }
+    return levels;
+}
+
+std::vector<TemplateMatch> TemplateMatcher::Match(const GrayImage& image, const TemplateMatchOptions& options) const
+{
+    ProfileScope profile("template-match", image.Width(), image.Height());
+    std::vector<TemplateMatch> matches;
+    if (m_levels.empty() || image.Empty() || options.maxMatches < 1) return matches;
+
+    const GrayImage& templ = m_levels[0].image;
+    if (templ.Width() > image.Width() || templ.Height() > image.Height()) return matches;
+    if (m_levels[0].norm <= 0.0) return matches;    // 평탄한 템플릿은 상관이 정의되지 않는다
+
+    int levels = options.pyramidLevels < 0 ? AutoPyramidLevels(image.Width(), image.Height())
+                                           : std::min(options.pyramidLevels, static_cast<int>(m_levels.size()) - 1);
+    // 축소된 영상이 축소된 템플릿보다 작아지면 한 단계씩 줄인다
+    while (levels > 0 && ((image.Width() >> levels) < m_levels[levels].image.Width() ||
+                          (image.Height() >> levels) < m_levels[levels].image.Height()))
+    {
+        --levels;
+    }
+
+    // 영상 피라미드 (레벨 0은 입력을 그대로 참조)
+    std::vector<GrayImage> pyramid(levels);
+    for (int l = 0; l < levels; ++l)
+    {
+        pyramid[l] = Downsample(l == 0 ? image : pyramid[l - 1]);
+    }
+    auto imageAt = [&](int l) -> const GrayImage& { return l == 0 ? image : pyramid[l - 1]; };
+
+    const int minDistance = options.minDistance > 0 ? options.minDistance
+                                                    : std::max(1, std::min(templ.Width(), templ.Height()) / 2);
+    const size_t candidateCount = static_cast<size_t>(std::max(4 * options.maxMatches, kMinCoarseCandidates));
+
+    // 1) 최상위 레벨 전체 탐색 → 3x3 극대점 후보
+    const GrayImage& top = imageAt(levels);
+    const Level& topTemplate = m_levels[levels];
+    const int ow = top.Width() - topTemplate.image.Width() + 1;
+    const int oh = top.Height() - topTemplate.image.Height() + 1;
+    const std::vector<float> scores = ScoreMap(top, topTemplate, ow, oh);
+
+    const float threshold = levels > 0 ? -2.f : options.minScore;
+    std::vector<Candidate> candidates;
+    for (int y = 0; y < oh; ++y)
+    {
+        for (int x = 0; x < ow; ++x)
+        {
+            const float s = scores[static_cast<size_t>(y) * ow + x];
+            if (s < threshold) continue;
+            bool isMax = true;
+            for (int dy = -1; dy <= 1 && isMax; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    const int nx = x + dx, ny = y + dy;
+                    if ((dx || dy) && nx >= 0 && ny >= 0 && nx < ow && ny < oh &&
+                        scores[static_cast<size_t>(ny) * ow + nx] > s)
+                    {
+                        isMax = false;
+                        break;
+                    }
+                }
+            }
+            if (isMax) candidates.push_back({ x, y, s });
+        }
+    }
+    candidates = SuppressNonMaxima(std::move(candidates), std::max(1, minDistance >> levels), candidateCount);
+
+    // 2) 한 레벨씩 내려가며 상위 위치 x2 주변 ±kRefineRadius 재탐색
+    for (int l = levels - 1; l >= 0; --l)
+    {
+        const GrayImage& level = imageAt(l);
+        const Level& t = m_levels[l];
+        const int maxX = level.Width() - t.image.Width();
+        const int maxY = level.Height() - t.image.Height();
+
+        ThreadPool::Shared().ParallelFor(0, static_cast<int>(candidates.size()), 1, [&](int c0, int c1)
+            {
+                for (int c = c0; c < c1; ++c)
+                {
+                    Candidate& candidate = candidates[c];
+                    const int cx = 2 * candidate.x, cy = 2 * candidate.y;
+                    Candidate best{ std::min(cx, maxX), std::min(cy, maxY), -2.f };
+                    for (int y = std::max(0, cy - kRefineRadius); y <= std::min(maxY, cy + kRefineRadius); ++y)
+                    {
+                        for (int x = std::max(0, cx - kRefineRadius); x <= std::min(maxX, cx + kRefineRadius); ++x)
+                        {
+                            const float s = ScoreAt(level, t, x, y);
+                            if (s > best.score) best = { x, y, s };
+                        }
+                    }
+                    candidate = best;
+                }
+            });
+
+    }
+
+    // minScore는 원본 해상도 점수에만 적용한다
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [&](const Candidate& c) { return c.score < options.minScore; }),
+                     candidates.end());
+
+    const std::vector<Candidate> kept =
+        SuppressNonMaxima(std::move(candidates), minDistance, static_cast<size_t>(options.maxMatches));
+
+    // 3) 서브픽셀: 가로/세로 각각 이웃 점수에 포물선을 맞춘다
+    const Level& t0 = m_levels[0];
+    const int maxX = image.Width() - templ.Width();
+    const int maxY = image.Height() - templ.Height();
+    for (const Candidate& c : kept)
+    {
+        TemplateMatch match{ static_cast<float>(c.x), static_cast<float>(c.y), c.score };
+        if (c.x > 0 && c.x < maxX)
+        {
+            match.x += ParabolicOffset(ScoreAt(image, t0, c.x - 1, c.y), c.score, ScoreAt(image, t0, c.x + 1, c.y));
+        }
+        if (c.y > 0 && c.y < maxY)
+        {
+            match.y += ParabolicOffset(ScoreAt(image, t0, c.x, c.y - 1), c.score, ScoreAt(image, t0, c.x, c.y + 1));
+        }
+        matches.push_back(match);
+    }
+    return matches;
+}
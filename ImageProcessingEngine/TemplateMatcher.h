@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include "GrayImage.h"
+#include <vector>
+
+// 템플릿 매칭 결과. (x, y)는 레벨 0 영상에서 템플릿 왼쪽 위 모서리 위치(서브픽셀)
+struct TemplateMatch
+{
+    float x;
+    float y;
+    float score;    // 정규화 상호상관(NCC), -1 ~ 1
+};
+
+struct TemplateMatchOptions
+{
+    int maxMatches = 1;         // 반환할 최대 개수 (점수 내림차순)
+    float minScore = 0.7f;      // 이보다 낮은 점수는 버린다
+    int pyramidLevels = -1;     // 축소 단계 수. -1이면 템플릿/영상 크기로 자동 결정
+    int minDistance = 0;        // 결과 사이 최소 거리(화소). 0이면 템플릿 짧은 변의 절반
+};
+
+// =====================================================
+//  정규화 상호상관(NCC) 템플릿 매처
+//  1) 영상/템플릿을 2x2 평균으로 축소한 피라미드의 최상위 레벨에서 전체 탐색
+//     (분자는 템플릿이 크면 FFT, 작으면 직접 상관, 분모는 합/제곱합 적분 영상)
+//  2) 후보마다 한 레벨씩 내려가며 ±2 화소 주변만 다시 계산
+//  3) 레벨 0 최고점 주변 3x3 점수에 포물선을 맞춰 서브픽셀 위치를 구한다
+//  템플릿 피라미드는 SetTemplate에서 한 번만 만들어 여러 영상에 재사용한다.
+// =====================================================
+class TemplateMatcher
+{
+public:
+    // 템플릿 설정. 비어 있으면 false
+    bool SetTemplate(const GrayImage& templ);
+    bool HasTemplate() const { return !m_levels.empty(); }
+
+    // 템플릿이 없거나 영상보다 크면 빈 결과
+    std::vector<TemplateMatch> Match(const GrayImage& image, const TemplateMatchOptions& options = TemplateMatchOptions()) const;
+
+    // 주어진 크기에서 자동으로 고르는 피라미드 단계 수
+    int AutoPyramidLevels(int imageWidth, int imageHeight) const;
+
+    struct Level
+    {
+        GrayImage image;
+        std::vector<float> zeroMean;    // 평균을 뺀 템플릿 (행 간격 width)
+        double mean = 0.0;
+        double norm = 0.0;              // sqrt(Σ zeroMean²)
+    };
+
+private:
+    std::vector<Level> m_levels;
+};
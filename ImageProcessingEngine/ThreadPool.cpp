@@ -0,0 +1,344 @@
+﻿#include "pch.h"
+#include "ThreadPool.h"
+#include "JobControl.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    // ParallelFor 한 번에 해당하는 작업. 호출 스레드의 스택에 있다
+    struct Job
+    {
+        const std::function<void(int, int)>* body = nullptr;
+        JobControl* control = nullptr;  // ParallelFor 호출 스레드에 걸린 작업 (조각을 실행하는 스레드에도 건다)
+        int remaining = 0;              // mutex로 보호 (완료 통지 직후 Job이 사라지므로)
+        std::atomic<bool> failed{ false };
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    struct Task
+    {
+        Job* job;
+        int begin;
+        int end;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    int HardwareThreads()
+    {
+        return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    void PinThread(std::thread& thread, int cpu)
+    {
+#if defined(_WIN32)
+        if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8))
+            SetThreadAffinityMask(thread.native_handle(), static_cast<DWORD_PTR>(1) << cpu);
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+        (void)thread;
+        (void)cpu;
+#endif
+    }
+}
+
+struct ThreadPool::Impl
+{
+    int threads = 1;
+    bool pin = false;
+
+    // 작업 스레드 i의 큐는 queues[i]. 작업 스레드 수 = threads - 1 (호출 스레드가 나머지 하나)
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> pending{ 0 };      // 큐에 들어 있는 조각 수
+    bool stop = false;
+
+    std::atomic<unsigned> nextQueue{ 0 };
+
+    void Start();
+    void Stop();
+    void Push(int self, Job& job, int begin, int end, int chunks);
+    bool Pop(int self, Task& task);
+    void Execute(const Task& task);
+    void WorkerLoop(int index);
+    void For(int begin, int end, int grain, const std::function<void(int, int)>& body);
+};
+
+// 현재 스레드가 어느 풀의 몇 번 작업 스레드인지 (작업 스레드가 아니면 -1)
+static thread_local const ThreadPool::Impl* t_pool = nullptr;
+static thread_local int t_index = -1;
+
+void ThreadPool::Impl::Start()
+{
+    const int count = threads - 1;
+    stop = false;
+    queues.clear();
+    for (int i = 0; i < count; ++i) queues.push_back(std::make_unique<WorkQueue>());
+
+    const int cpus = HardwareThreads();
+    for (int i = 0; i < count; ++i)
+    {
+        workers.emplace_back([this, i] { WorkerLoop(i); });
+        if (pin) PinThread(workers.back(), (i + 1) % cpus);
+    }
+}
+
+void ThreadPool::Impl::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+    workers.clear();
+    queues.clear();
+}
+
+void ThreadPool::Impl::Push(int self, Job& job, int begin, int end, int chunks)
+{
+    // 작업 스레드가 호출하면 자기 큐에 넣고(다른 스레드가 훔쳐 감), 외부 스레드는 큐마다 고르게 나눠 넣는다
+    const int queueCount = static_cast<int>(queues.size());
+    const unsigned start = (self >= 0) ? static_cast<unsigned>(self) : nextQueue.fetch_add(static_cast<unsigned>(chunks));
+    const int length = end - begin;
+
+    for (int c = 0; c < chunks; ++c)
+    {
+        const int b = begin + static_cast<int>(static_cast<long long>(length) * c / chunks);
+        const int e = begin + static_cast<int>(static_cast<long long>(length) * (c + 1) / chunks);
+        WorkQueue& queue = *queues[(self >= 0) ? self : (start + c) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{ &job, b, e });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pending += chunks;
+    }
+    wake.notify_all();
+}
+
+bool ThreadPool::Impl::Pop(int self, Task& task)
+{
+    const int queueCount = static_cast<int>(queues.size());
+
+    // 자기 큐는 뒤에서(가장 최근에 넣은 조각, 캐시에 남아 있을 가능성이 큼)
+    if (self >= 0)
+    {
+        WorkQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            --pending;
+            return true;
+        }
+    }
+
+    // 다른 큐는 앞에서 훔친다
+    const int first = (self >= 0) ? self + 1 : 0;
+    for (int i = 0; i < queueCount; ++i)
+    {
+        WorkQueue& victim = *queues[(first + i) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            --pending;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Impl::Execute(const Task& task)
+{
+    Job& job = *task.job;
+    if (!job.failed)
+    {
+        JobControl::Scope scope(job.control);
+        try
+        {
+            (*job.body)(task.begin, task.end);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            if (!job.error) job.error = std::current_exception();
+            job.failed = true;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(job.mutex);
+    if (--job.remaining == 0) job.done.notify_all();
+}
+
+void ThreadPool::Impl::WorkerLoop(int index)
+{
+    t_pool = this;
+    t_index = index;
+
+    for (;;)
+    {
+        Task task;
+        if (Pop(index, task))
+        {
+            Execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stop || pending > 0; });
+        if (stop) return;
+    }
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool(int threads)
+    : m_impl(std::make_unique<Impl>())
+{
+    m_impl->threads = (threads > 0) ? threads : HardwareThreads();
+    m_impl->Start();
+}
+
+ThreadPool::~ThreadPool()
+{
+    m_impl->Stop();
+}
+
+void ThreadPool::SetThreadCount(int threads)
+{
+    const int count = (threads > 0) ? threads : HardwareThreads();
+    if (count == m_impl->threads) return;
+
+    m_impl->Stop();
+    m_impl->threads = count;
+    m_impl->Start();
+}
+
+int ThreadPool::ThreadCount() const
+{
+    return m_impl->threads;
+}
+
+void ThreadPool::SetAffinity(bool pinThreads)
+{
+    if (pinThreads == m_impl->pin) return;
+
+    // 고정 해제도 스레드를 다시 만들어 적용한다
+    m_impl->Stop();
+    m_impl->pin = pinThreads;
+    m_impl->Start();
+}
+
+bool ThreadPool::Affinity() const
+{
+    return m_impl->pin;
+}
+
+void ThreadPool::ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body)
+{
+    if (end <= begin) return;
+
+    JobControl* control = JobControl::Current();
+    if (control == nullptr)
+    {
+        m_impl->For(begin, end, grain, body);
+        return;
+    }
+
+    // 작업이 걸려 있으면 조각을 grain 크기로 더 나눠 그 사이마다 취소를 확인한다 (취소 지연 = grain 하나).
+    // 진행률은 가장 바깥 호출만 센다 (조각 안의 중첩 호출은 세지 않음)
+    JobControl* progress = JobControl::ProgressTarget();
+    const int step = std::max(1, grain);
+    if (progress != nullptr) progress->AddWork(end - begin);
+
+    m_impl->For(begin, end, grain, [&](int b, int e)
+        {
+            JobControl::ReportingScope reporting;
+            for (int s = b; s < e; s += step)
+            {
+                if (control->IsCancelled()) throw OperationCanceled();
+                const int t = std::min(e, s + step);
+                body(s, t);
+                if (progress != nullptr) progress->CompleteWork(t - s);
+            }
+        });
+}
+
+void ThreadPool::Impl::For(int begin, int end, int grain, const std::function<void(int, int)>& body)
+{
+    // 스레드당 4조각: 작업량이 고르지 않아도 훔쳐 가며 균형을 맞출 수 있을 만큼만 나눈다
+    const int length = end - begin;
+    const int maxChunks = threads * 4;
+    const int chunks = std::min(maxChunks, (length + std::max(1, grain) - 1) / std::max(1, grain));
+    if (queues.empty() || chunks <= 1)
+    {
+        body(begin, end);
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    job.control = JobControl::Current();
+    job.remaining = chunks;
+
+    const int self = (t_pool == this) ? t_index : -1;
+    Push(self, job, begin, end, chunks);
+
+    // 기다리는 동안 이 작업(또는 다른 작업)의 조각을 함께 처리
+    Task task;
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            if (job.remaining == 0) break;
+        }
+        if (!Pop(self, task)) break;
+        Execute(task);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(job.mutex);
+        job.done.wait(lock, [&job] { return job.remaining == 0; });
+    }
+
+    if (job.error) std::rethrow_exception(job.error);
+}
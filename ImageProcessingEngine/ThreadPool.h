@@ -0,0 +1,42 @@
+﻿#pragma once
+
+#include <functional>
+#include <memory>
+
+// =====================================================
+//  작업 훔치기(work-stealing) 스레드 풀
+//  작업 스레드마다 자기 큐를 가지고, 자기 큐가 비면 다른 스레드 큐의 앞쪽에서 조각을 가져온다.
+//  ParallelFor를 호출한 스레드도 끝날 때까지 조각을 함께 처리하므로 중첩 호출해도 교착되지 않는다.
+//  구현(스레드/뮤텍스)은 .cpp에만 두어 C++/CLI 코드에서도 이 헤더를 포함할 수 있다.
+// =====================================================
+class ThreadPool
+{
+public:
+    // 프로세스 공용 풀. 여러 영상을 동시에 처리해도 작업 스레드 수가 이 풀의 크기를 넘지 않는다
+    static ThreadPool& Shared();
+
+    // threads: 동시에 실행할 스레드 수 (호출 스레드 포함). 0이면 하드웨어 스레드 수
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 스레드 수 변경 (작업 스레드를 다시 만든다). 실행 중인 ParallelFor가 없을 때 호출해야 한다
+    void SetThreadCount(int threads);
+    int ThreadCount() const;
+
+    // true면 작업 스레드 i를 논리 CPU (i + 1) % N 에 고정한다 (0번은 주로 호출 스레드 몫)
+    void SetAffinity(bool pinThreads);
+    bool Affinity() const;
+
+    // [begin, end)를 grain 이상 크기의 조각으로 나눠 body(조각 시작, 조각 끝)를 병렬 실행하고 모두 끝나면 반환.
+    // 조각에서 예외가 나면 남은 조각은 건너뛰고 첫 예외를 호출 스레드에서 다시 던진다.
+    // 호출 스레드에 JobControl 작업이 걸려 있으면 grain마다 취소를 확인하고 취소되면 OperationCanceled를 던진다
+    void ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+
+    struct Impl;
+
+private:
+    std::unique_ptr<Impl> m_impl;
+};
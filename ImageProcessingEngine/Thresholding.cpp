@@ -0,0 +1,231 @@
+﻿#include "pch.h"
+#include "Thresholding.h"
+#include "IntegralImage.h"
+#include "NativeKernels.h"
+#include "ThreadPool.h"
+#include "ScratchArena.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Thresholding
+{
+    static const int kMinHistogramPixels = 1 << 16;
+
+    // 행 묶음마다 부분 히스토그램을 만든다. 같은 값이 이어질 때 저장→읽기 의존이 생기지 않도록
+    // 화소를 네 개의 보조 히스토그램에 번갈아 세고 묶음 끝에서 합친다
+    template <int bpp>
+    static void HistogramT(const unsigned char* pixels, int width, int height, size_t stride,
+                           uint64_t histogram[kHistogramBins])
+    {
+        std::fill(histogram, histogram + kHistogramBins, 0ull);
+        if (pixels == nullptr || width <= 0 || height <= 0) return;
+
+        const int rowsPerChunk = std::max(1, kMinHistogramPixels / width);
+        const int chunks = (height + rowsPerChunk - 1) / rowsPerChunk;
+        ScratchArena::Buffer partialBuffer =
+            ScratchArena::Shared().Acquire(static_cast<size_t>(chunks) * kHistogramBins * sizeof(uint64_t));
+        uint64_t* partials = partialBuffer.As<uint64_t>();
+
+        ThreadPool::Shared().ParallelFor(0, chunks, 1, [&](int c0, int c1)
+            {
+                for (int c = c0; c < c1; ++c)
+                {
+                    uint32_t counts[4][kHistogramBins] = {};
+                    const int y0 = c * rowsPerChunk;
+                    const int y1 = std::min(height, y0 + rowsPerChunk);
+                    for (int y = y0; y < y1; ++y)
+                    {
+                        const unsigned char* s = pixels + static_cast<size_t>(y) * stride;
+                        int x = 0;
+                        for (; x + 4 <= width; x += 4)
+                        {
+                            if (bpp == 1)
+                            {
+                                ++counts[0][s[x]];
+                                ++counts[1][s[x + 1]];
+                                ++counts[2][s[x + 2]];
+                                ++counts[3][s[x + 3]];
+                            }
+                            else
+                            {
+                                ++counts[0][NativeKernels::GrayOf(s + x * 4)];
+                                ++counts[1][NativeKernels::GrayOf(s + x * 4 + 4)];
+                                ++counts[2][NativeKernels::GrayOf(s + x * 4 + 8)];
+                                ++counts[3][NativeKernels::GrayOf(s + x * 4 + 12)];
+                            }
+                        }
+                        for (; x < width; ++x)
+                        {
+                            ++counts[0][bpp == 1 ? s[x] : NativeKernels::GrayOf(s + x * 4)];
+                        }
+                    }
+                    uint64_t* partial = partials + static_cast<size_t>(c) * kHistogramBins;
+                    for (int i = 0; i < kHistogramBins; ++i)
+                    {
+                        partial[i] = static_cast<uint64_t>(counts[0][i]) + counts[1][i] + counts[2][i] + counts[3][i];
+                    }
+                }
+            });
+
+        for (int c = 0; c < chunks; ++c)
+        {
+            const uint64_t* partial = partials + static_cast<size_t>(c) * kHistogramBins;
+            for (int i = 0; i < kHistogramBins; ++i) histogram[i] += partial[i];
+        }
+    }
+
+    void Histogram(const unsigned char* plane, int width, int height, size_t stride, uint64_t histogram[kHistogramBins])
+    {
+        HistogramT<1>(plane, width, height, stride, histogram);
+    }
+
+    void HistogramBGRA(const unsigned char* pixels, int width, int height, size_t stride,
+                       uint64_t histogram[kHistogramBins])
+    {
+        HistogramT<4>(pixels, width, height, stride, histogram);
+    }
+
+    int OtsuThreshold(const uint64_t histogram[kHistogramBins])
+    {
+        uint64_t total = 0;
+        double sumAll = 0.0;
+        int first = -1;
+        for (int i = 0; i < kHistogramBins; ++i)
+        {
+            total += histogram[i];
+            sumAll += static_cast<double>(i) * histogram[i];
+            if (first < 0 && histogram[i] != 0) first = i;
+        }
+        if (first < 0) return 0;
+
+        // σ_B²(t) ∝ w0 w1 (μ0 - μ1)². 같은 최댓값이면 가장 작은 t
+        uint64_t background = 0;
+        double backgroundSum = 0.0;
+        double best = -1.0;
+        int threshold = first;
+        for (int t = 0; t < kHistogramBins; ++t)
+        {
+            background += histogram[t];
+            if (background == 0) continue;
+            const uint64_t foreground = total - background;
+            if (foreground == 0) break;
+
+            backgroundSum += static_cast<double>(t) * histogram[t];
+            const double meanBackground = backgroundSum / static_cast<double>(background);
+            const double meanForeground = (sumAll - backgroundSum) / static_cast<double>(foreground);
+            const double diff = meanBackground - meanForeground;
+            const double between = static_cast<double>(background) * static_cast<double>(foreground) * diff * diff;
+            if (between > best)
+            {
+                best = between;
+                threshold = t;
+            }
+        }
+        return threshold;
+    }
+
+    float DefaultK(AdaptiveMethod method)
+    {
+        switch (method)
+        {
+        case AdaptiveMethod::Mean:    return 5.0f;
+        case AdaptiveMethod::Niblack: return -0.2f;
+        case AdaptiveMethod::Sauvola: return 0.34f;
+        }
+        return 0.0f;
+    }
+
+    // Sauvola의 표준편차 동적 범위 R (8비트 영상)
+    static const double kSauvolaRange = 128.0;
+
+    template <int bpp, AdaptiveMethod Method>
+    static void AdaptiveRowsT(const IntegralImage& integral, const unsigned char* plane, size_t planeStride,
+                              unsigned char* dst, size_t dstStride, int y0, int y1, int radius, double k)
+    {
+        const int width = integral.Width();
+        const int height = integral.Height();
+        for (int y = y0; y < y1; ++y)
+        {
+            const int top = std::max(0, y - radius);
+            const int bottom = std::min(height, y + radius + 1);
+            const uint32_t* sumTop = integral.SumRow(top);
+            const uint32_t* sumBottom = integral.SumRow(bottom);
+            const uint64_t* squareTop = (Method == AdaptiveMethod::Mean) ? nullptr : integral.SquareRow(top);
+            const uint64_t* squareBottom = (Method == AdaptiveMethod::Mean) ? nullptr : integral.SquareRow(bottom);
+            const unsigned char* s = plane + static_cast<size_t>(y) * planeStride;
+            unsigned char* d = dst + static_cast<size_t>(y) * dstStride;
+
+            for (int x = 0; x < width; ++x)
+            {
+                const int left = std::max(0, x - radius);
+                const int right = std::min(width, x + radius + 1);
+                // 평균이 정수일 때 정확히 그 값이 되도록 역수 곱 대신 나눗셈 (임계값 경계 판정 일관성)
+                const double area = static_cast<double>(right - left) * (bottom - top);
+                const uint32_t sum = sumBottom[right] - sumBottom[left] - sumTop[right] + sumTop[left];
+                const double mean = sum / area;
+
+                double threshold;
+                if (Method == AdaptiveMethod::Mean)
+                {
+                    threshold = mean - k;
+                }
+                else
+                {
+                    const uint64_t squares = squareBottom[right] - squareBottom[left] - squareTop[right] + squareTop[left];
+                    const double variance = std::max(0.0, squares / area - mean * mean);
+                    const double deviation = std::sqrt(variance);
+                    threshold = (Method == AdaptiveMethod::Niblack)
+                        ? mean + k * deviation
+                        : mean * (1.0 + k * (deviation / kSauvolaRange - 1.0));
+                }
+
+                const unsigned char binary = (s[x] > threshold) ? 255 : 0;
+                if (bpp == 1)
+                {
+                    d[x] = binary;
+                }
+                else
+                {
+                    d[x * 4 + 0] = d[x * 4 + 1] = d[x * 4 + 2] = binary;
+                }
+            }
+        }
+    }
+
+    template <int bpp>
+    static void AdaptiveRowsDispatch(const IntegralImage& integral, const unsigned char* plane, size_t planeStride,
+                                     unsigned char* dst, size_t dstStride, int y0, int y1,
+                                     AdaptiveMethod method, int radius, double k)
+    {
+        switch (method)
+        {
+        case AdaptiveMethod::Mean:
+            AdaptiveRowsT<bpp, AdaptiveMethod::Mean>(integral, plane, planeStride, dst, dstStride, y0, y1, radius, k);
+            break;
+        case AdaptiveMethod::Niblack:
+            AdaptiveRowsT<bpp, AdaptiveMethod::Niblack>(integral, plane, planeStride, dst, dstStride, y0, y1, radius, k);
+            break;
+        case AdaptiveMethod::Sauvola:
+            AdaptiveRowsT<bpp, AdaptiveMethod::Sauvola>(integral, plane, planeStride, dst, dstStride, y0, y1, radius, k);
+            break;
+        }
+    }
+
+    void AdaptiveRows(const IntegralImage& integral, const unsigned char* plane, size_t planeStride,
+                      unsigned char* dst, size_t dstStride, int bytesPerPixel, int y0, int y1,
+                      AdaptiveMethod method, int windowSize, float k)
+    {
+        if (method != AdaptiveMethod::Mean && !integral.HasSquares()) return;
+
+        const int radius = std::min(windowSize, kMaxWindowSize) / 2;
+        if (bytesPerPixel == 4)
+        {
+            AdaptiveRowsDispatch<4>(integral, plane, planeStride, dst, dstStride, y0, y1, method, radius, k);
+        }
+        else
+        {
+            AdaptiveRowsDispatch<1>(integral, plane, planeStride, dst, dstStride, y0, y1, method, radius, k);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class IntegralImage;
+
+// 국소(적응형) 임계값 방식. 창 안 평균 m, 표준편차 s, 파라미터 k로
+//   Mean:    T = m - k            (k: 평균에서 뺄 밝기, 기본 5)
+//   Niblack: T = m + k s          (기본 k = -0.2)
+//   Sauvola: T = m (1 + k (s / 128 - 1))   (기본 k = 0.34)
+// 밝기 > T 인 화소가 255, 나머지는 0 (전역 이진화와 같은 방향)
+enum class AdaptiveMethod
+{
+    Mean,
+    Niblack,
+    Sauvola,
+};
+
+// =====================================================
+//  히스토그램 / 자동(오츠) 임계값 / 적분 영상 기반 적응형 임계값 (내부용)
+//  히스토그램은 행 묶음마다 부분 히스토그램을 병렬로 만든 뒤 순서대로 합치므로 스레드 수와 무관하게 같다.
+//  적응형 임계값은 창의 합/제곱합을 적분 영상에서 네 번 조회로 구하므로 화소당 비용이 창 크기와 무관하다.
+// =====================================================
+namespace Thresholding
+{
+    const int kHistogramBins = 256;
+
+    // 1 byte/pixel 평면의 밝기 히스토그램
+    void Histogram(const unsigned char* plane, int width, int height, size_t stride, uint64_t histogram[kHistogramBins]);
+
+    // BGRA 영상의 그레이(NativeKernels::GrayOf) 히스토그램. 그레이 평면을 따로 만들지 않는다
+    void HistogramBGRA(const unsigned char* pixels, int width, int height, size_t stride,
+                       uint64_t histogram[kHistogramBins]);
+
+    // 클래스 간 분산을 최대화하는 임계값 t (밝기 <= t 와 > t 로 나눔).
+    // 값이 한 가지뿐이면 그 값을 돌려준다 (모두 0으로 이진화)
+    int OtsuThreshold(const uint64_t histogram[kHistogramBins]);
+
+    float DefaultK(AdaptiveMethod method);
+
+    // 창 한 변의 최대 크기 (창 합이 IntegralImage에서 정확한 범위)
+    const int kMaxWindowSize = 4095;
+
+    // 출력 행 [y0, y1)을 적응형 임계값으로 이진화한다. integral은 plane으로 만든 적분 영상이며
+    // Niblack/Sauvola는 제곱합 표가 필요하다. 창은 windowSize/2 반경의 정사각형(짝수는 한 칸 큰 홀수)으로
+    // 영상 밖은 잘라낸다. dst가 BGRA(bytesPerPixel 4)면 B, G, R에 쓰고 alpha는 그대로 둔다.
+    // 각 화소는 plane의 자기 위치만 읽으므로 plane == dst (그레이 제자리)도 된다
+    void AdaptiveRows(const IntegralImage& integral, const unsigned char* plane, size_t planeStride,
+                      unsigned char* dst, size_t dstStride, int bytesPerPixel, int y0, int y1,
+                      AdaptiveMethod method, int windowSize, float k);
+}
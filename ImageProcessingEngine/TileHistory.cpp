@@ -0,0 +1,508 @@
+﻿#include "pch.h"
+#include "TileHistory.h"
+#include "Lz4Codec.h"
+#include "ScratchArena.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    // 타일 하나 (여러 상태가 공유). 내용은 tileWidth x tileHeight 화소를 빈틈 없이 이어 붙인 것
+    struct Tile
+    {
+        uint64_t hash = 0;
+        int width = 0;
+        int height = 0;
+        int bytesPerPixel = 0;
+        bool compressed = false;
+        int refs = 0;                       // 이 타일을 가리키는 상태 수
+        std::vector<unsigned char> data;
+
+        size_t RawSize() const { return static_cast<size_t>(width) * height * bytesPerPixel; }
+        size_t StoredSize() const { return data.size() + sizeof(Tile); }
+    };
+
+    struct State
+    {
+        uint64_t id = 0;
+        int width = 0;
+        int height = 0;
+        int bytesPerPixel = 0;
+        int tilesX = 0;
+        int tilesY = 0;
+        std::vector<Tile*> tiles;           // 행 우선
+
+        bool SameGeometry(const State& other) const
+        {
+            return width == other.width && height == other.height && bytesPerPixel == other.bytesPerPixel;
+        }
+    };
+
+    // 타일 작업 단위. 128 x 128 BGRA 타일 4개 = 256 KB
+    const int kTileGrain = 4;
+    const size_t kDefaultBudget = static_cast<size_t>(512) << 20;
+
+    // ==================== 64비트 해시 (xxHash64 방식) ====================
+    const uint64_t kPrime1 = 11400714785074694791ull;
+    const uint64_t kPrime2 = 14029467366897019727ull;
+    const uint64_t kPrime3 = 1609587929392839161ull;
+    const uint64_t kPrime4 = 9650029242287828579ull;
+    const uint64_t kPrime5 = 2870177450012600261ull;
+
+    inline uint64_t Rotl(uint64_t v, int r) { return (v << r) | (v >> (64 - r)); }
+
+    inline uint64_t Read64(const unsigned char* p)
+    {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline uint64_t Round(uint64_t acc, uint64_t input)
+    {
+        acc += input * kPrime2;
+        return Rotl(acc, 31) * kPrime1;
+    }
+
+    inline uint64_t Merge(uint64_t acc, uint64_t lane)
+    {
+        acc ^= Round(0, lane);
+        return acc * kPrime1 + kPrime4;
+    }
+
+    uint64_t Hash64(const unsigned char* p, size_t size, uint64_t seed)
+    {
+        const unsigned char* const end = p + size;
+        uint64_t h;
+        if (size >= 32)
+        {
+            // 독립 누산기 4개로 32바이트씩 처리 (의존 사슬을 끊어 메모리 대역폭 근처까지)
+            uint64_t v1 = seed + kPrime1 + kPrime2, v2 = seed + kPrime2, v3 = seed, v4 = seed - kPrime1;
+            for (; end - p >= 32; p += 32)
+            {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+            }
+            h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+            h = Merge(Merge(Merge(Merge(h, v1), v2), v3), v4);
+        }
+        else
+        {
+            h = seed + kPrime5;
+        }
+        h += size;
+
+        for (; end - p >= 8; p += 8) h = Rotl(h ^ Round(0, Read64(p)), 27) * kPrime1 + kPrime4;
+        for (; p < end; ++p) h = Rotl(h ^ (*p * kPrime5), 11) * kPrime1;
+
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    // ==================== 타일 배치 ====================
+    struct TileRect
+    {
+        int x, y, width, height;
+    };
+
+    TileRect RectOf(const State& state, int tileSize, int index)
+    {
+        const int x = (index % state.tilesX) * tileSize;
+        const int y = (index / state.tilesX) * tileSize;
+        return { x, y, std::min(tileSize, state.width - x), std::min(tileSize, state.height - y) };
+    }
+
+    // image의 타일 영역을 raw에 빈틈 없이 모은다. 반환값은 바이트 수
+    size_t Gather(const ImageView& image, const TileRect& rect, unsigned char* raw)
+    {
+        const size_t rowBytes = static_cast<size_t>(rect.width) * image.bytesPerPixel;
+        for (int y = 0; y < rect.height; ++y)
+        {
+            memcpy(raw + y * rowBytes, image.Row(rect.y + y) + static_cast<size_t>(rect.x) * image.bytesPerPixel,
+                   rowBytes);
+        }
+        return rowBytes * rect.height;
+    }
+
+    uint64_t TileHash(const unsigned char* raw, const TileRect& rect, int bytesPerPixel)
+    {
+        // 모양이 다르면 바이트가 같아도 다른 타일이다
+        const uint64_t seed = (static_cast<uint64_t>(rect.width) << 40) ^ (static_cast<uint64_t>(rect.height) << 16) ^
+                              static_cast<uint64_t>(bytesPerPixel);
+        return Hash64(raw, static_cast<size_t>(rect.width) * rect.height * bytesPerPixel, seed);
+    }
+
+    // 압축을 풀어 scratch에 두거나 원본 데이터를 그대로 가리킨다. 손상된 블록이면 nullptr
+    const unsigned char* Expand(const Tile& tile, unsigned char* scratch)
+    {
+        if (!tile.compressed) return tile.data.data();
+        return Lz4Codec::Decompress(tile.data.data(), tile.data.size(), scratch, tile.RawSize()) ? scratch : nullptr;
+    }
+
+    bool SameContent(const Tile& tile, uint64_t hash, const TileRect& rect, int bytesPerPixel,
+                     const unsigned char* raw, unsigned char* scratch)
+    {
+        if (tile.hash != hash || tile.width != rect.width || tile.height != rect.height ||
+            tile.bytesPerPixel != bytesPerPixel)
+        {
+            return false;
+        }
+        const unsigned char* stored = Expand(tile, scratch);
+        return stored != nullptr && memcmp(stored, raw, tile.RawSize()) == 0;
+    }
+
+    std::unique_ptr<Tile> MakeTile(uint64_t hash, const TileRect& rect, int bytesPerPixel, const unsigned char* raw,
+                                   bool compress, unsigned char* scratch)
+    {
+        std::unique_ptr<Tile> tile(new Tile);
+        tile->hash = hash;
+        tile->width = rect.width;
+        tile->height = rect.height;
+        tile->bytesPerPixel = bytesPerPixel;
+
+        const size_t size = tile->RawSize();
+        if (compress)
+        {
+            // 10% 이상 줄지 않으면 Compress가 0을 반환한다
+            const size_t packed = Lz4Codec::Compress(raw, size, scratch, size - size / 10);
+            if (packed > 0)
+            {
+                tile->compressed = true;
+                tile->data.assign(scratch, scratch + packed);
+                return tile;
+            }
+        }
+        tile->data.assign(raw, raw + size);
+        return tile;
+    }
+}
+
+struct TileHistory::Impl
+{
+    int tileSize = 128;
+    size_t budget = kDefaultBudget;
+    bool compression = false;
+
+    std::deque<State> states;
+    int current = -1;
+    uint64_t nextId = 1;
+
+    // 해시 → 내용이 다른 타일들 (대부분 1개)
+    std::unordered_map<uint64_t, std::vector<std::unique_ptr<Tile>>> tiles;
+    Stats stats;
+
+    const State* Find(uint64_t id) const
+    {
+        for (const State& state : states)
+        {
+            if (state.id == id) return &state;
+        }
+        return nullptr;
+    }
+
+    void Release(Tile* tile)
+    {
+        if (--tile->refs > 0) return;
+
+        stats.storedBytes -= tile->StoredSize();
+        stats.rawBytes -= tile->RawSize();
+        --stats.tileCount;
+
+        auto bucket = tiles.find(tile->hash);
+        std::vector<std::unique_ptr<Tile>>& list = bucket->second;
+        list.erase(std::find_if(list.begin(), list.end(),
+                                [tile](const std::unique_ptr<Tile>& entry) { return entry.get() == tile; }));
+        if (list.empty()) tiles.erase(bucket);
+    }
+
+    void Drop(State& state)
+    {
+        for (Tile* tile : state.tiles) Release(tile);
+        state.tiles.clear();
+    }
+
+    void EnforceBudget()
+    {
+        while (budget > 0 && stats.storedBytes > budget && current > 0)
+        {
+            Drop(states.front());
+            states.pop_front();
+            --current;
+        }
+        stats.states = static_cast<int>(states.size());
+    }
+};
+
+TileHistory::TileHistory(int tileSize)
+    : m_impl(std::make_unique<Impl>())
+{
+    m_impl->tileSize = std::max(16, tileSize);
+}
+
+TileHistory::~TileHistory() = default;
+
+void TileHistory::SetMemoryBudget(size_t bytes)
+{
+    m_impl->budget = bytes;
+    m_impl->EnforceBudget();
+}
+
+size_t TileHistory::MemoryBudget() const
+{
+    return m_impl->budget;
+}
+
+void TileHistory::SetCompression(bool enabled)
+{
+    m_impl->compression = enabled;
+}
+
+bool TileHistory::Compression() const
+{
+    return m_impl->compression;
+}
+
+bool TileHistory::Push(const ImageView& image)
+{
+    if (!image.IsValid()) return false;
+
+    Impl& impl = *m_impl;
+    const int tileSize = impl.tileSize;
+    const int bpp = image.bytesPerPixel;
+
+    State state;
+    state.id = impl.nextId;
+    state.width = image.width;
+    state.height = image.height;
+    state.bytesPerPixel = bpp;
+    state.tilesX = (image.width + tileSize - 1) / tileSize;
+    state.tilesY = (image.height + tileSize - 1) / tileSize;
+    const int count = state.tilesX * state.tilesY;
+    state.tiles.assign(count, nullptr);
+
+    const State* previous = impl.current >= 0 ? &impl.states[impl.current] : nullptr;
+    if (previous != nullptr && !previous->SameGeometry(state)) previous = nullptr;
+
+    const size_t tileBytes = static_cast<size_t>(tileSize) * tileSize * bpp;
+    std::vector<uint64_t> hashes(count);
+    ThreadPool& pool = ThreadPool::Shared();
+    ScratchArena& arena = ScratchArena::Shared();
+
+    // 1) 타일 해시. 같은 위치의 현재 상태 타일과 내용이 같으면 그대로 공유 (대부분의 타일이 여기서 끝난다)
+    pool.ParallelFor(0, count, kTileGrain, [&](int t0, int t1)
+        {
+            ScratchArena::Buffer raw = arena.Acquire(tileBytes), scratch = arena.Acquire(tileBytes);
+            for (int t = t0; t < t1; ++t)
+            {
+                const TileRect rect = RectOf(state, tileSize, t);
+                Gather(image, rect, raw.Data());
+                hashes[t] = TileHash(raw.Data(), rect, bpp);
+                Tile* old = previous != nullptr ? previous->tiles[t] : nullptr;
+                if (old != nullptr && SameContent(*old, hashes[t], rect, bpp, raw.Data(), scratch.Data()))
+                {
+                    state.tiles[t] = old;
+                }
+            }
+        });
+
+    // 2) 남은 타일은 보관 중인 타일에서 같은 해시를 찾고, 없으면 이번 상태 안에서 같은 해시의
+    //    첫 타일(leader)을 기준으로 삼는다 (배경처럼 반복되는 타일은 한 벌만 만든다)
+    std::vector<const std::vector<std::unique_ptr<Tile>>*> candidates(count, nullptr);
+    std::vector<int> leader(count, -1);
+    {
+        std::unordered_map<uint64_t, int> leaders;
+        for (int t = 0; t < count; ++t)
+        {
+            if (state.tiles[t] != nullptr) continue;
+            auto bucket = impl.tiles.find(hashes[t]);
+            if (bucket != impl.tiles.end())
+            {
+                candidates[t] = &bucket->second;
+                continue;
+            }
+            auto inserted = leaders.emplace(hashes[t], t);
+            if (!inserted.second) leader[t] = inserted.first->second;
+        }
+    }
+
+    // 3) 후보와 비교해 공유하거나 새 타일을 만든다 (leader 먼저, 그다음 leader와 같은지 확인)
+    std::vector<std::unique_ptr<Tile>> created(count);
+    auto resolve = [&](bool followers)
+    {
+        pool.ParallelFor(0, count, kTileGrain, [&](int t0, int t1)
+            {
+                ScratchArena::Buffer raw = arena.Acquire(tileBytes);
+                ScratchArena::Buffer scratch = arena.Acquire(tileBytes);
+                for (int t = t0; t < t1; ++t)
+                {
+                    if (state.tiles[t] != nullptr || (leader[t] >= 0) != followers) continue;
+
+                    const TileRect rect = RectOf(state, tileSize, t);
+                    Gather(image, rect, raw.Data());
+                    if (candidates[t] != nullptr)
+                    {
+                        for (const std::unique_ptr<Tile>& tile : *candidates[t])
+                        {
+                            if (SameContent(*tile, hashes[t], rect, bpp, raw.Data(), scratch.Data()))
+                            {
+                                state.tiles[t] = tile.get();
+                                break;
+                            }
+                        }
+                    }
+                    else if (followers)
+                    {
+                        Tile* first = state.tiles[leader[t]];
+                        if (SameContent(*first, hashes[t], rect, bpp, raw.Data(), scratch.Data())) state.tiles[t] = first;
+                    }
+                    if (state.tiles[t] == nullptr)
+                    {
+                        created[t] = MakeTile(hashes[t], rect, bpp, raw.Data(), impl.compression, scratch.Data());
+                        state.tiles[t] = created[t].get();
+                    }
+                }
+            });
+    };
+    resolve(false);
+    resolve(true);
+
+    // 4) 새 타일 등록, 참조 수 증가 후 다시 실행 기록을 버린다
+    //    (버릴 상태에만 있던 타일을 새 상태가 공유할 수 있으므로 참조를 먼저 늘린다)
+    for (int t = 0; t < count; ++t)
+    {
+        if (created[t])
+        {
+            Tile* tile = created[t].get();
+            impl.stats.storedBytes += tile->StoredSize();
+            impl.stats.rawBytes += tile->RawSize();
+            ++impl.stats.tileCount;
+            impl.tiles[tile->hash].push_back(std::move(created[t]));
+        }
+        ++state.tiles[t]->refs;
+    }
+    while (static_cast<int>(impl.states.size()) > impl.current + 1)
+    {
+        impl.Drop(impl.states.back());
+        impl.states.pop_back();
+    }
+
+    impl.states.push_back(std::move(state));
+    impl.current = static_cast<int>(impl.states.size()) - 1;
+    ++impl.nextId;
+    impl.EnforceBudget();
+    return true;
+}
+
+bool TileHistory::CanUndo() const
+{
+    return m_impl->current > 0;
+}
+
+bool TileHistory::CanRedo() const
+{
+    return m_impl->current + 1 < static_cast<int>(m_impl->states.size());
+}
+
+bool TileHistory::Undo()
+{
+    if (!CanUndo()) return false;
+    --m_impl->current;
+    return true;
+}
+
+bool TileHistory::Redo()
+{
+    if (!CanRedo()) return false;
+    ++m_impl->current;
+    return true;
+}
+
+uint64_t TileHistory::CurrentState() const
+{
+    return m_impl->current >= 0 ? m_impl->states[m_impl->current].id : 0;
+}
+
+int TileHistory::Width() const
+{
+    return m_impl->current >= 0 ? m_impl->states[m_impl->current].width : 0;
+}
+
+int TileHistory::Height() const
+{
+    return m_impl->current >= 0 ? m_impl->states[m_impl->current].height : 0;
+}
+
+int TileHistory::BytesPerPixel() const
+{
+    return m_impl->current >= 0 ? m_impl->states[m_impl->current].bytesPerPixel : 0;
+}
+
+bool TileHistory::Restore(const ImageView& dst, uint64_t basis) const
+{
+    const Impl& impl = *m_impl;
+    if (impl.current < 0 || !dst.IsValid()) return false;
+
+    const State& state = impl.states[impl.current];
+    if (dst.width != state.width || dst.height != state.height || dst.bytesPerPixel != state.bytesPerPixel)
+        return false;
+
+    const State* from = basis != 0 ? impl.Find(basis) : nullptr;
+    if (from != nullptr && !from->SameGeometry(state)) from = nullptr;
+
+    const int tileSize = impl.tileSize;
+    const int count = static_cast<int>(state.tiles.size());
+    const size_t tileBytes = static_cast<size_t>(tileSize) * tileSize * state.bytesPerPixel;
+    std::atomic<bool> corrupt(false);
+
+    ThreadPool::Shared().ParallelFor(0, count, kTileGrain, [&](int t0, int t1)
+        {
+            ScratchArena::Buffer scratch = ScratchArena::Shared().Acquire(tileBytes);
+            for (int t = t0; t < t1; ++t)
+            {
+                const Tile* tile = state.tiles[t];
+                if (from != nullptr && from->tiles[t] == tile) continue;
+
+                const unsigned char* pixels = Expand(*tile, scratch.Data());
+                if (pixels == nullptr)
+                {
+                    corrupt = true;
+                    continue;
+                }
+                const TileRect rect = RectOf(state, tileSize, t);
+                const size_t rowBytes = static_cast<size_t>(rect.width) * state.bytesPerPixel;
+                for (int y = 0; y < rect.height; ++y)
+                {
+                    memcpy(dst.Row(rect.y + y) + static_cast<size_t>(rect.x) * state.bytesPerPixel,
+                           pixels + y * rowBytes, rowBytes);
+                }
+            }
+        });
+    return !corrupt;
+}
+
+TileHistory::Stats TileHistory::GetStats() const
+{
+    Stats stats = m_impl->stats;
+    stats.states = static_cast<int>(m_impl->states.size());
+    return stats;
+}
+
+void TileHistory::Clear()
+{
+    Impl& impl = *m_impl;
+    impl.states.clear();
+    impl.tiles.clear();
+    impl.current = -1;
+    impl.stats = Stats();
+}
@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include "ImageView.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// =====================================================
+//  타일 델타 되돌리기/다시 실행 기록
+//  영상을 고정 크기 타일로 나눠 상태마다 타일 목록만 보관한다. 내용이 같은 타일은 해시로 찾아
+//  한 벌만 두므로, 일부만 바뀐 상태는 바뀐 타일 크기만큼만 메모리가 늘어난다 (선택적으로 LZ4 압축).
+//  보관 크기가 예산을 넘으면 가장 오래된 상태부터 버린다.
+//  Restore는 직전 상태와 다른 타일만 다시 쓰므로 되돌리기 한 단계는 바뀐 영역 복사 정도의 시간이 든다.
+//  한 인스턴스를 여러 스레드가 공유할 때는 호출하는 쪽에서 직렬화해야 한다 (내부 타일 작업은 공용 스레드 풀 사용).
+// =====================================================
+class TileHistory
+{
+public:
+    struct Stats
+    {
+        size_t storedBytes = 0;     // 보관 중인 타일 데이터 (압축 후, 타일 관리 구조 포함)
+        size_t rawBytes = 0;        // 보관 중인 타일의 압축 전 크기
+        size_t tileCount = 0;       // 서로 다른 타일 수
+        int states = 0;
+    };
+
+    // tileSize: 타일 한 변 화소 수 (16 이상)
+    explicit TileHistory(int tileSize = 128);
+    ~TileHistory();
+    TileHistory(const TileHistory&) = delete;
+    TileHistory& operator=(const TileHistory&) = delete;
+
+    // 보관 크기 상한(바이트, Stats::storedBytes 기준). 넘으면 가장 오래된 상태부터 버리되
+    // 현재 상태는 항상 남긴다. 0이면 무제한 (기본 512 MB)
+    void SetMemoryBudget(size_t bytes);
+    size_t MemoryBudget() const;
+
+    // true면 새 타일을 LZ4 블록으로 압축해 보관한다 (10% 이상 줄지 않는 타일은 그대로). 기본 false
+    void SetCompression(bool enabled);
+    bool Compression() const;
+
+    // image(BGRA 또는 그레이)를 새 상태로 추가해 현재 상태로 삼는다. 현재 상태 뒤의 다시 실행 기록은 버린다
+    bool Push(const ImageView& image);
+
+    bool CanUndo() const;
+    bool CanRedo() const;
+
+    // 현재 상태를 한 단계 앞/뒤로 옮긴다. 화소는 Restore로 받는다
+    bool Undo();
+    bool Redo();
+
+    // 현재 상태 식별자 (상태마다 고유하며 재사용하지 않음). 상태가 없으면 0
+    uint64_t CurrentState() const;
+
+    // 현재 상태의 크기/형식 (상태가 없으면 0)
+    int Width() const;
+    int Height() const;
+    int BytesPerPixel() const;
+
+    // 현재 상태를 dst(현재 상태와 같은 크기/형식)에 기록한다.
+    // dst가 basis 상태의 화소를 담고 있고 basis가 아직 기록에 있으면 basis와 다른 타일만 쓴다 (0이면 전체)
+    bool Restore(const ImageView& dst, uint64_t basis = 0) const;
+
+    Stats GetStats() const;
+    void Clear();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
@@ -0,0 +1,133 @@
+﻿#include "pch.h"
+#include "TiledProcessor.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "JobControl.h"
+#include "ScratchArena.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+TiledProcessor::TiledProcessor(const FilterPipeline& pipeline)
+    : m_pipeline(pipeline)
+{
+}
+
+void TiledProcessor::SetTileSize(int tileWidth, int tileHeight)
+{
+    m_tileWidth = std::max(1, tileWidth);
+    m_tileHeight = std::max(1, tileHeight);
+}
+
+int TiledProcessor::ThreadCount() const
+{
+    const int poolThreads = ThreadPool::Shared().ThreadCount();
+    return (m_threads > 0) ? std::min(m_threads, poolThreads) : poolThreads;
+}
+
+size_t TiledProcessor::WorkingSetPerThread(int bytesPerPixel) const
+{
+    const int halo = m_pipeline.Halo();
+    const int bufferWidth = m_tileWidth + 2 * halo;
+    const int bufferHeight = m_tileHeight + 2 * halo;
+    const size_t tileBytes = static_cast<size_t>(bufferWidth) * bufferHeight * bytesPerPixel;
+
+    // FilterPipeline::RunBands: 입력 밴드 2개 + 핑퐁 버퍼 2개
+    const int bandRows = m_pipeline.BandRows(bufferWidth, bufferHeight, bytesPerPixel);
+    const size_t bandBytes = static_cast<size_t>(std::min(bufferHeight, bandRows + 2 * halo)) * bufferWidth * bytesPerPixel;
+    return tileBytes + 4 * bandBytes;
+}
+
+bool TiledProcessor::Run(const char* inputPath, const char* outputPath, int width, int height, int bytesPerPixel) const
+{
+    ProfileScope profile("pipeline-tiled", width, height);
+    if (width <= 0 || height <= 0 || (bytesPerPixel != 1 && bytesPerPixel != 4)) return false;
+
+    const uint64_t rowBytes = static_cast<uint64_t>(width) * bytesPerPixel;
+    const uint64_t imageBytes = rowBytes * static_cast<uint64_t>(height);
+
+    MappedFile input;
+    if (!input.OpenRead(inputPath) || input.Size() < imageBytes) return false;
+    MappedFile output;
+    if (!output.Create(outputPath, imageBytes)) return false;
+
+    const int halo = m_pipeline.Halo();
+    const int tilesX = (width + m_tileWidth - 1) / m_tileWidth;
+    const int tilesY = (height + m_tileHeight - 1) / m_tileHeight;
+    const int tileCount = tilesX * tilesY;
+    const int threads = std::min(ThreadCount(), tileCount);
+
+    // 타일은 행 우선 순서로 나눠 가져간다 (동시에 처리되는 타일이 같은 입력 행을 공유하도록)
+    std::atomic<int> nextTile(0);
+    std::atomic<bool> failed(false);
+    JobControl* progress = JobControl::ProgressTarget();
+
+    auto worker = [&]()
+    {
+        // 할로 포함 최대 타일 크기로 한 번만 빌려 타일 사이에 재사용
+        const size_t maxWidth = static_cast<size_t>(std::min(width, m_tileWidth + 2 * halo));
+        const size_t maxHeight = static_cast<size_t>(std::min(height, m_tileHeight + 2 * halo));
+        ScratchArena::Buffer buffer = ScratchArena::Shared().Acquire(maxWidth * maxHeight * bytesPerPixel);
+
+        for (int tile = nextTile++; tile < tileCount && !failed; tile = nextTile++)
+        {
+            const int tx0 = (tile % tilesX) * m_tileWidth;
+            const int ty0 = (tile / tilesX) * m_tileHeight;
+            const int tx1 = std::min(width, tx0 + m_tileWidth);
+            const int ty1 = std::min(height, ty0 + m_tileHeight);
+
+            // 할로 포함 원본 영역. 영상 가장자리에서는 잘라내므로 가장자리 규칙도 전체 실행과 같다
+            const int sx0 = std::max(0, tx0 - halo), sx1 = std::min(width, tx1 + halo);
+            const int sy0 = std::max(0, ty0 - halo), sy1 = std::min(height, ty1 + halo);
+            const int bufferWidth = sx1 - sx0, bufferHeight = sy1 - sy0;
+            const size_t bufferRowBytes = static_cast<size_t>(bufferWidth) * bytesPerPixel;
+
+            unsigned char* pixels = buffer.Data();
+
+            // 필요한 행만 매핑하고 타일 열 구간을 매핑된 파일에서 바로 읽어 타일 버퍼에 결과를 쓴다
+            // (실제로 읽히는 페이지는 타일 크기 정도)
+            {
+                MappedFile::View source = input.Map(static_cast<uint64_t>(sy0) * rowBytes,
+                                                    static_cast<size_t>((sy1 - sy0) * rowBytes));
+                if (!source.IsValid())
+                {
+                    failed = true;
+                    break;
+                }
+                const ImageView region{ source.Data() + static_cast<size_t>(sx0) * bytesPerPixel,
+                                        bufferWidth, bufferHeight, static_cast<size_t>(rowBytes), bytesPerPixel };
+                const ImageView tileBuffer{ pixels, bufferWidth, bufferHeight, bufferRowBytes, bytesPerPixel };
+                m_pipeline.Run(region, tileBuffer);
+            }
+
+            // 할로를 뺀 타일 안쪽만 결과 파일에 기록
+            MappedFile::View target = output.Map(static_cast<uint64_t>(ty0) * rowBytes,
+                                                 static_cast<size_t>((ty1 - ty0) * rowBytes));
+            if (!target.IsValid())
+            {
+                failed = true;
+                break;
+            }
+            const size_t tileRowBytes = static_cast<size_t>(tx1 - tx0) * bytesPerPixel;
+            for (int y = ty0; y < ty1; ++y)
+            {
+                memcpy(target.Data() + (y - ty0) * rowBytes + static_cast<size_t>(tx0) * bytesPerPixel,
+                       pixels + (y - sy0) * bufferRowBytes + static_cast<size_t>(tx0 - sx0) * bytesPerPixel,
+                       tileRowBytes);
+            }
+            if (progress != nullptr) progress->CompleteWork(1);
+        }
+    };
+
+    // 공용 풀에서 작업자 threads개를 돌린다 (다른 영상 처리와 함께 돌아도 풀 크기를 넘지 않음).
+    // 작업이 걸려 있으면 타일 파이프라인이 밴드마다 취소를 확인하고, 진행률은 타일 단위로 센다
+    if (progress != nullptr) progress->AddWork(tileCount);
+    JobControl::ReportingScope reporting;
+    ThreadPool::Shared().ParallelFor(0, threads, 1, [&](int first, int last)
+        {
+            for (int t = first; t < last; ++t) worker();
+        });
+
+    return !failed;
+}
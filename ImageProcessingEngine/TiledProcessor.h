@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include "FilterPipeline.h"
+#include <cstddef>
+
+// =====================================================
+//  타일 단위 out-of-core 실행
+//  원시(raw) 영상 파일(헤더 없음, 행 우선, 행 간격 width * bytesPerPixel)을 메모리 매핑으로
+//  타일씩 읽어 FilterPipeline을 적용하고 결과 파일에 기록한다.
+//  타일마다 파이프라인 할로만큼 겹쳐 읽으므로 결과는 전체 영상에 Run 한 것과 비트 단위로 같다.
+//  스레드마다 (타일 + 할로) 결과 버퍼 하나와 파이프라인 밴드 버퍼만 쓰므로
+//  최대 메모리는 영상 크기와 무관하게 타일 크기 x 스레드 수에 비례한다.
+// =====================================================
+class TiledProcessor
+{
+public:
+    explicit TiledProcessor(const FilterPipeline& pipeline);
+
+    // 타일 크기 (기본 1024 x 1024)
+    void SetTileSize(int tileWidth, int tileHeight);
+    int TileWidth() const { return m_tileWidth; }
+    int TileHeight() const { return m_tileHeight; }
+
+    // 동시에 처리할 타일 수. 0이면 공용 스레드 풀 크기 (기본). 풀 크기를 넘지 않는다
+    void SetThreadCount(int threads) { m_threads = threads; }
+    int ThreadCount() const;
+
+    // 스레드 하나가 쓰는 작업 메모리(바이트) 추정치: 할로 포함 타일 버퍼 + 파이프라인 밴드 버퍼
+    size_t WorkingSetPerThread(int bytesPerPixel) const;
+
+    // inputPath의 width x height 영상(bytesPerPixel: BGRA 4, 그레이 1)을 처리해 outputPath에 같은 형식으로 쓴다.
+    // 경로는 UTF-8. 파일 크기가 맞지 않거나 입출력에 실패하면 false
+    bool Run(const char* inputPath, const char* outputPath, int width, int height, int bytesPerPixel) const;
+
+private:
+    FilterPipeline m_pipeline;
+    int m_tileWidth = 1024;
+    int m_tileHeight = 1024;
+    int m_threads = 0;
+};
@@ -51,7 +51,22 @@ namespace ImageProcessing.Services
             return null;
         }
 
-        public async Task SaveImage(BitmapImage image, string filePath)
+        public string SaveTraceFileDialog()
+        {
+            var dialog = new SaveFileDialog
+            {
+                Filter = "Chrome Trace|*.json",
+                FileName = "trace.json"
+            };
+
+            if (dialog.ShowDialog() == true)
+            {
+                return dialog.FileName;
+            }
+            return null;
+        }
+
+        public async Task SaveImage(BitmapSource image, string filePath)
         {
             await Task.Run(() =>
             {
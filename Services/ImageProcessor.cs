@@ -1,7 +1,8 @@
 ﻿using ImageProcessingEngine;
 using System;
-using System.Collections.Generic;
-using System.IO;
+using System.Diagnostics;
+using System.Threading;
+using System.Threading.Tasks;
 using System.Windows;
 using System.Windows.Media;
 using System.Windows.Media.Imaging;
@@ -10,25 +11,90 @@ namespace ImageProcessing.Services
 {
     public class ImageProcessor
     {
+        // 되돌리기 기록 보관 상한 (바뀐 타일만 LZ4 압축해 보관하므로 보통 수십 단계가 들어간다)
+        private const long HistoryBudgetBytes = 512L * 1024 * 1024;
+        private const int HistoryTileSize = 128;
+
+        // 점진적 미리보기 지연 예산 (파라미터 조정 중 화면 반응 목표)
+        private const double PreviewBudgetMs = 60;
+
+        // 백그라운드 처리 진행률 알림 간격
+        private const int ProgressIntervalMs = 100;
+
+        // 선택 영역 캐니의 할로 (그래디언트/비최대 억제 창보다 넓고, 약한 엣지 추적도 이만큼 영역 밖으로 따라간다)
+        private const int CannyRegionHalo = 32;
+
         private readonly ImageEngine _engine = new ImageEngine();
-        private readonly Stack<BitmapImage> _undoStack = new Stack<BitmapImage>();
-        private readonly Stack<BitmapImage> _redoStack = new Stack<BitmapImage>();
-        private BitmapImage _currentImage;
+        private readonly ImageHistory _history = new ImageHistory(HistoryTileSize);
+        private readonly PreviewContext _preview = new PreviewContext();
+        private BitmapSource _currentImage;
+
+        // _currentImage의 BGRA 화소와 그 기록 상태 (되돌리기 때 바뀐 타일만 덮어쓴다)
+        private byte[] _statePixels;
+        private int _stateWidth;
+        private int _stateHeight;
+        private long _stateId;
+
+        public ImageProcessor()
+        {
+            _history.SetMemoryBudget(HistoryBudgetBytes);
+            _history.SetCompression(true);
+
+            // 연산별 계측 집계는 항상 켜 둔다 (호출당 비용이 처리 시간에 비해 무시할 수준)
+            ImageEngine.SetProfiling(true);
+        }
+
+        // ------------------ 성능 계측 ------------------
+        public OperationStats[] GetOperationStats() => ImageEngine.GetOperationStats();
+
+        public void SetTracing(bool enabled) => ImageEngine.SetTracing(enabled);
+
+        // Chrome trace JSON (ui.perfetto.dev 또는 chrome://tracing에서 열기)
+        public bool SaveTrace(string path) => ImageEngine.WriteTrace(path);
+
+        public void ResetProfiling() => ImageEngine.ResetProfiling();
+
+        public ScratchMemoryStats GetScratchStats() => ImageEngine.GetScratchStats();
 
         // 되돌리기/다시 실행 가능 여부를 외부에 노출하는 속성
-        public bool CanUndo => _undoStack.Count > 0;
-        public bool CanRedo => _redoStack.Count > 0;
+        public bool CanUndo => _history.CanUndo();
+        public bool CanRedo => _history.CanRedo();
 
         // FFT 상태 확인
         public bool HasFFTData => _engine.HasFFTData();
 
-        // Helper method to convert BitmapImage to byte array and back
-        private BitmapImage ProcessImage(BitmapImage source, Action<byte[], int, int> processAction)
+        // ------------------ 백그라운드 처리 ------------------
+        // operation을 작업 스레드에서 실행한다. cancellationToken이 취소되면 엔진 연산이 행 밴드 단위로 멈추고
+        // OperationCanceledException이 나며 결과와 되돌리기 기록은 남지 않는다. progress에는 진행률(0 ~ 1)을 주기적으로 알린다.
+        // 한 번에 하나만 실행해야 한다 (이전 처리를 취소했으면 끝나기를 기다린 뒤 호출)
+        public async Task<BitmapSource> RunAsync(Func<ImageProcessor, BitmapSource> operation, CancellationToken cancellationToken,
+                                                IProgress<double> progress = null)
         {
-            if (source == null) return null;
+            cancellationToken.ThrowIfCancellationRequested();
+
+            using (var job = new EngineJob())
+            using (cancellationToken.Register(job.Cancel))
+            {
+                var task = Task.Run(() =>
+                {
+                    using (job.Enter())
+                    {
+                        return operation(this);
+                    }
+                });
 
-            _undoStack.Push(source);
-            _redoStack.Clear();
+                while (await Task.WhenAny(task, Task.Delay(ProgressIntervalMs)) != task)
+                {
+                    progress?.Report(job.Progress);
+                }
+                return await task;
+            }
+        }
+
+        // Helper method to convert BitmapSource to byte array and back
+        private BitmapSource ProcessImage(BitmapSource source, Action<byte[], int, int> processAction)
+        {
+            if (source == null) return null;
 
             var bitmap = new FormatConvertedBitmap(source, PixelFormats.Bgra32, null, 0);
             int width = bitmap.PixelWidth;
@@ -37,27 +103,35 @@ namespace ImageProcessing.Services
             byte[] pixels = new byte[height * stride];
             bitmap.CopyPixels(pixels, stride, 0);
 
+            // 직전 결과가 아닌 영상(새로 불러오거나 붙여넣은 영상)이면 처리 전 상태를 먼저 기록
+            if (!ReferenceEquals(source, _currentImage) || _history.CurrentState() == 0)
+            {
+                // 크기가 다른 영상이면 이전 크기용 작업 버퍼는 다시 쓰이지 않으므로 풀에서 해제
+                if (width != _stateWidth || height != _stateHeight) ImageEngine.TrimScratch();
+                _history.Push(pixels, width, height);
+            }
+
             processAction(pixels, width, height);
 
-            var processedBitmap = BitmapSource.Create(width, height, 96, 96,
-                PixelFormats.Bgra32, null, pixels, stride);
+            // RunAsync에서 취소된 처리는 버퍼가 일부만 처리된 상태이므로 기록하지 않는다
+            if (EngineJob.IsCurrentCanceled) throw new OperationCanceledException();
 
-            var encoder = new PngBitmapEncoder();
-            encoder.Frames.Add(BitmapFrame.Create(processedBitmap));
-            using (var stream = new MemoryStream())
-            {
-                encoder.Save(stream);
-                stream.Seek(0, SeekOrigin.Begin);
+            _history.Push(pixels, width, height);
+            _statePixels = pixels;
+            _stateWidth = width;
+            _stateHeight = height;
+            _stateId = _history.CurrentState();
+            _currentImage = CreateBitmap(pixels, width, height);
+            return _currentImage;
+        }
 
-                var result = new BitmapImage();
-                result.BeginInit();
-                result.CacheOption = BitmapCacheOption.OnLoad;
-                result.StreamSource = stream;
-                result.EndInit();
-                result.Freeze();
-                _currentImage = result;
-                return _currentImage;
-            }
+        // BGRA 화소로 고정(Freeze)된 비트맵을 만든다 (인코딩 없이 한 번 복사하므로 이후 pixels를 고쳐도 영향 없음).
+        // dpi를 낮추면 적은 화소의 영상도 원본과 같은 크기로 표시된다 (축소 미리보기용)
+        private static BitmapSource CreateBitmap(byte[] pixels, int width, int height, double dpi = 96)
+        {
+            var bitmap = BitmapSource.Create(width, height, dpi, dpi, PixelFormats.Bgra32, null, pixels, width * 4);
+            bitmap.Freeze();
+            return bitmap;
         }
         public BitmapSource Crop(BitmapSource source, Rect rect)
         {
@@ -163,53 +237,277 @@ namespace ImageProcessing.Services
 
 
         // ------------------ 기존 필터 ------------------
-        public BitmapImage ApplyGrayscale(BitmapImage source)
+        // roi가 비어 있으면 영상 전체, 아니면 선택 영역(영상 좌표)에만 적용한다. 두 경우 모두(미리보기도)
+        // 같은 파이프라인 커널을 쓰므로 선택 영역 결과는 영상 전체에 적용한 결과와 같고 영역 밖은 그대로 남는다
+        private BitmapSource ApplyOperation(BitmapSource source, FilterOperation op, int param, Int32Rect roi)
+        {
+            var ops = new[] { (int)op };
+            var parameters = new[] { param };
+            if (roi.Width <= 0 || roi.Height <= 0)
+            {
+                // 전체 해상도 처리 시간을 미리보기 레벨 선택에 반영
+                return ProcessImage(source, (pixels, width, height) =>
+                {
+                    var stopwatch = Stopwatch.StartNew();
+                    _engine.ApplyPipeline(pixels, width, height, ops, parameters);
+                    if (!EngineJob.IsCurrentCanceled)
+                    {
+                        _preview.RecordFullRun(ops, parameters, width, height, stopwatch.Elapsed.TotalMilliseconds);
+                    }
+                });
+            }
+
+            return ProcessImage(source, (pixels, width, height) =>
+                _engine.ApplyPipeline(pixels, width, height, ops, parameters, roi.X, roi.Y, roi.Width, roi.Height));
+        }
+
+        // 파이프라인에 없는 연산을 선택 영역에 적용한다. 영역을 halo만큼 넓혀 잘라 낸 버퍼에서 처리하고
+        // 영역 안만 되돌려 쓴다 (halo가 연산의 창보다 넓으면 영역 안 결과는 영상 전체에 적용한 결과와 같다).
+        // roi가 비어 있으면 영상 전체
+        private BitmapSource ApplyRegion(BitmapSource source, Int32Rect roi, int halo, Action<byte[], int, int> operation)
+        {
+            if (roi.Width <= 0 || roi.Height <= 0) return ProcessImage(source, operation);
+
+            return ProcessImage(source, (pixels, width, height) =>
+            {
+                int left = Math.Max(0, roi.X), top = Math.Max(0, roi.Y);
+                int right = Math.Min(width, roi.X + roi.Width), bottom = Math.Min(height, roi.Y + roi.Height);
+                if (left >= right || top >= bottom) return;
+
+                int x0 = Math.Max(0, left - halo), y0 = Math.Max(0, top - halo);
+                int regionWidth = Math.Min(width, right + halo) - x0;
+                int regionHeight = Math.Min(height, bottom + halo) - y0;
+                var region = new byte[regionWidth * regionHeight * 4];
+                for (int y = 0; y < regionHeight; ++y)
+                {
+                    Buffer.BlockCopy(pixels, ((y0 + y) * width + x0) * 4, region, y * regionWidth * 4, regionWidth * 4);
+                }
+
+                operation(region, regionWidth, regionHeight);
+                if (EngineJob.IsCurrentCanceled) return;
+
+                for (int y = top; y < bottom; ++y)
+                {
+                    Buffer.BlockCopy(region, ((y - y0) * regionWidth + left - x0) * 4, pixels, (y * width + left) * 4,
+                                     (right - left) * 4);
+                }
+            });
+        }
+
+        // 축소 해상도 미리보기 (기록에 남기지 않고 원본도 바꾸지 않는다). 같은 영상에 파라미터만 바꿔
+        // 반복 호출하면 축소 피라미드를 재사용한다. 전체 해상도도 예산 안에 끝나면(레벨 0) 미리보기가
+        // 필요 없으므로 null
+        public BitmapSource PreviewOperation(BitmapSource source, FilterOperation op, int param)
+        {
+            if (source == null) return null;
+
+            byte[] pixels;
+            int width, height;
+            long sourceId = 0;
+            if (ReferenceEquals(source, _currentImage) && _statePixels != null)
+            {
+                pixels = _statePixels;
+                width = _stateWidth;
+                height = _stateHeight;
+                sourceId = _stateId;
+            }
+            else
+            {
+                var bitmap = new FormatConvertedBitmap(source, PixelFormats.Bgra32, null, 0);
+                width = bitmap.PixelWidth;
+                height = bitmap.PixelHeight;
+                pixels = new byte[height * width * 4];
+                bitmap.CopyPixels(pixels, width * 4, 0);
+            }
+
+            var frame = _preview.Run(pixels, width, height, sourceId, new[] { (int)op }, new[] { param }, PreviewBudgetMs);
+            if (frame.Pixels == null || frame.Level <= 0) return null;
+            return CreateBitmap(frame.Pixels, frame.Width, frame.Height, 96.0 / (1 << frame.Level));
+        }
+
+        public BitmapSource ApplyGrayscale(BitmapSource source, Int32Rect roi = default)
+        {
+            return ApplyOperation(source, FilterOperation.Grayscale, 0, roi);
+        }
+
+        // 파이프라인의 5x5 고정소수점 가우시안 커널(합 273)
+        public BitmapSource ApplyGaussianBlur(BitmapSource source, Int32Rect roi = default)
+        {
+            return ApplyOperation(source, FilterOperation.GaussianBlur, 0, roi);
+        }
+
+        // 시그마 지정 가우시안 (배경 추정 등 큰 시그마도 시그마와 무관한 비용으로 처리).
+        // 선택 영역은 4σ 할로로 처리한다 (그 밖의 가중치 합은 0.02 LSB 미만)
+        public BitmapSource ApplyGaussianBlur(BitmapSource source, float sigma, Int32Rect roi = default)
         {
-            return ProcessImage(source, (pixels, width, height) => _engine.ApplyGrayscale(pixels, width, height));
+            return ApplyRegion(source, roi, (int)Math.Ceiling(4 * sigma),
+                               (pixels, width, height) => _engine.ApplyGaussianBlur(pixels, width, height, sigma));
         }
 
-        public BitmapImage ApplyGaussianBlur(BitmapImage source)
+        public BitmapSource ApplySobel(BitmapSource source, Int32Rect roi = default)
         {
-            return ProcessImage(source, (pixels, width, height) => _engine.ApplyGaussianBlur(pixels, width, height));
+            return ApplyOperation(source, FilterOperation.Sobel, 0, roi);
         }
 
-        public BitmapImage ApplySobel(BitmapImage source)
+        // 캐니 엣지: 그래디언트 크기가 high를 넘는 엣지와, 그에 이어진 low 초과 화소만 남긴다 (흰색 엣지, 검은 배경).
+        // 선택 영역은 CannyRegionHalo 할로로 처리하므로, 선택 영역 밖으로 그보다 멀리 돌아 강한 엣지에 이어지는
+        // 약한 엣지는 영상 전체에 적용할 때와 달리 빠질 수 있다
+        public BitmapSource ApplyCanny(BitmapSource source, int lowThreshold = 50, int highThreshold = 150, Int32Rect roi = default)
         {
-            return ProcessImage(source, (pixels, width, height) => _engine.ApplySobel(pixels, width, height));
+            return ApplyRegion(source, roi, CannyRegionHalo,
+                               (pixels, width, height) => _engine.ApplyCanny(pixels, width, height, lowThreshold, highThreshold));
         }
 
-        public BitmapImage ApplyLaplacian(BitmapImage source)
+        public BitmapSource ApplyLaplacian(BitmapSource source, Int32Rect roi = default)
         {
-            return ProcessImage(source, (pixels, width, height) => _engine.ApplyLaplacian(pixels, width, height));
+            return ApplyOperation(source, FilterOperation.Laplacian, 0, roi);
         }
 
-        public BitmapImage ApplyBinarization(BitmapImage source, int param=128)
+        public BitmapSource ApplyBinarization(BitmapSource source, int param = 128, Int32Rect roi = default)
         {
-            return ProcessImage(source, (pixels, width, height) => _engine.ApplyBinarization(pixels, width, height, param));
+            return ApplyOperation(source, FilterOperation.Binarization, param, roi);
         }
 
-        public BitmapImage ApplyDilation(BitmapImage source, int param = 3)
+        // 오츠 자동 임계값 이진화 (처리 영역 히스토그램 기준: 선택 영역이 있으면 그 영역만으로 임계값을 정한다)
+        public BitmapSource ApplyOtsuBinarization(BitmapSource source, Int32Rect roi = default)
         {
-            return ProcessImage(source, (pixels, width, height) => _engine.ApplyDilation(pixels, width, height, param));
+            return ApplyRegion(source, roi, 0, (pixels, width, height) => _engine.ApplyOtsuBinarization(pixels, width, height, out _));
         }
 
-        public BitmapImage ApplyErosion(BitmapImage source, int param = 3)
+        // 적응형 이진화: 조명이 고르지 않아도 창 안의 국소 평균/표준편차로 임계값을 정한다
+        public BitmapSource ApplyAdaptiveThreshold(BitmapSource source, AdaptiveThresholdMethod method, int windowSize = 31,
+                                                  Int32Rect roi = default)
         {
-            return ProcessImage(source, (pixels, width, height) => _engine.ApplyErosion(pixels, width, height, param));
+            return ApplyRegion(source, roi, windowSize / 2,
+                               (pixels, width, height) => _engine.ApplyAdaptiveThreshold(pixels, width, height, method, windowSize));
         }
 
-        public BitmapImage ApplyMedianFilter(BitmapImage source, int param = 3)
+        public BitmapSource ApplyDilation(BitmapSource source, int param = 3, Int32Rect roi = default)
         {
-            return ProcessImage(source, (pixels, width, height) => _engine.ApplyMedianFilter(pixels, width, height, param));
+            return ApplyOperation(source, FilterOperation.Dilation, param, roi);
+        }
+
+        public BitmapSource ApplyErosion(BitmapSource source, int param = 3, Int32Rect roi = default)
+        {
+            return ApplyOperation(source, FilterOperation.Erosion, param, roi);
+        }
+
+        public BitmapSource ApplyOpening(BitmapSource source, int param = 3, Int32Rect roi = default)
+        {
+            return ApplyOperation(source, FilterOperation.Opening, param, roi);
+        }
+
+        public BitmapSource ApplyClosing(BitmapSource source, int param = 3, Int32Rect roi = default)
+        {
+            return ApplyOperation(source, FilterOperation.Closing, param, roi);
+        }
+
+        public BitmapSource ApplyMorphologyGradient(BitmapSource source, int param = 3, Int32Rect roi = default)
+        {
+            return ApplyOperation(source, FilterOperation.MorphologyGradient, param, roi);
+        }
+
+        public BitmapSource ApplyTopHat(BitmapSource source, int param = 3, Int32Rect roi = default)
+        {
+            return ApplyOperation(source, FilterOperation.TopHat, param, roi);
+        }
+
+        public BitmapSource ApplyBlackHat(BitmapSource source, int param = 3, Int32Rect roi = default)
+        {
+            return ApplyOperation(source, FilterOperation.BlackHat, param, roi);
+        }
+
+        public BitmapSource ApplyMedianFilter(BitmapSource source, int param = 3, Int32Rect roi = default)
+        {
+            return ApplyOperation(source, FilterOperation.MedianFilter, param, roi);
+        }
+
+        // ------------------ 템플릿 매칭 ------------------
+        // 찾은 위치마다 빨간 사각형을 그린 영상을 반환한다. matches는 점수 내림차순
+        public BitmapSource ApplyTemplateMatch(BitmapSource source, BitmapSource template, int maxMatches, float minScore,
+                                              out TemplateMatchResult[] matches)
+        {
+            matches = Array.Empty<TemplateMatchResult>();
+            if (source == null || template == null) return null;
+
+            var templateBitmap = new FormatConvertedBitmap(template, PixelFormats.Bgra32, null, 0);
+            int templateWidth = templateBitmap.PixelWidth;
+            int templateHeight = templateBitmap.PixelHeight;
+            byte[] templatePixels = new byte[templateWidth * templateHeight * 4];
+            templateBitmap.CopyPixels(templatePixels, templateWidth * 4, 0);
+
+            TemplateMatchResult[] found = null;
+            var result = ProcessImage(source, (pixels, width, height) =>
+            {
+                found = _engine.MatchTemplate(pixels, width, height, templatePixels, templateWidth, templateHeight, maxMatches, minScore);
+                foreach (var match in found)
+                {
+                    DrawRectangle(pixels, width, height, (int)Math.Round(match.X), (int)Math.Round(match.Y), templateWidth, templateHeight);
+                }
+            });
+            matches = found ?? Array.Empty<TemplateMatchResult>();
+            return result;
+        }
+
+        // ------------------ 블롭 분석 ------------------
+        // 이진 영상(전경 = 0이 아닌 화소)의 연결 요소마다 외접 사각형을 그린 영상을 반환한다.
+        // intensitySource가 같은 크기면 그 영상으로 블롭별 평균 밝기를 구한다 (보통 이진화 전 원본)
+        public BitmapSource ApplyBlobAnalysis(BitmapSource source, BitmapSource intensitySource, bool eightConnected,
+                                             out BlobInfo[] blobs)
+        {
+            blobs = Array.Empty<BlobInfo>();
+            if (source == null) return null;
+
+            byte[] intensityPixels = null;
+            if (intensitySource != null && intensitySource.PixelWidth == source.PixelWidth &&
+                intensitySource.PixelHeight == source.PixelHeight)
+            {
+                var intensityBitmap = new FormatConvertedBitmap(intensitySource, PixelFormats.Bgra32, null, 0);
+                intensityPixels = new byte[intensityBitmap.PixelWidth * intensityBitmap.PixelHeight * 4];
+                intensityBitmap.CopyPixels(intensityPixels, intensityBitmap.PixelWidth * 4, 0);
+            }
+
+            BlobInfo[] found = null;
+            var result = ProcessImage(source, (pixels, width, height) =>
+            {
+                found = _engine.LabelComponents(pixels, intensityPixels, width, height, eightConnected);
+                foreach (var blob in found)
+                {
+                    DrawRectangle(pixels, width, height, blob.Left, blob.Top, blob.Width, blob.Height);
+                }
+            });
+            blobs = found ?? Array.Empty<BlobInfo>();
+            return result;
+        }
+
+        // BGRA 버퍼에 2px 두께 빨간 테두리
+        private static void DrawRectangle(byte[] pixels, int width, int height, int left, int top, int rectWidth, int rectHeight)
+        {
+            const int thickness = 2;
+            for (int y = Math.Max(0, top); y < Math.Min(height, top + rectHeight); ++y)
+            {
+                for (int x = Math.Max(0, left); x < Math.Min(width, left + rectWidth); ++x)
+                {
+                    bool border = x - left < thickness || left + rectWidth - 1 - x < thickness ||
+                                  y - top < thickness || top + rectHeight - 1 - y < thickness;
+                    if (!border) continue;
+
+                    int o = (y * width + x) * 4;
+                    pixels[o + 0] = 0;
+                    pixels[o + 1] = 0;
+                    pixels[o + 2] = 255;
+                    pixels[o + 3] = 255;
+                }
+            }
         }
 
         // ------------------ FFT 관련 ------------------
-        public BitmapImage ApplyFFT(BitmapImage source)
+        public BitmapSource ApplyFFT(BitmapSource source)
         {
             return ProcessImage(source, (pixels, width, height) => _engine.ApplyFFT(pixels, width, height));
         }
 
-        public BitmapImage ApplyIFFT(BitmapImage source)
+        public BitmapSource ApplyIFFT(BitmapSource source)
         {
             if (!HasFFTData)
                 throw new InvalidOperationException("FFT 데이터가 없습니다. 먼저 푸리에 변환을 수행해주세요.");
@@ -222,24 +520,55 @@ namespace ImageProcessing.Services
             _engine.ClearFFTData();
         }
 
+        // 주파수 영역 필터: 보관된 스펙트럼을 제자리에서 걸러 역변환한다 (스펙트럼은 유지되어 누적 적용 가능).
+        // period는 차단 주기(화소). 이보다 짧은 주기(고주파)를 저역 통과는 제거하고 고역 통과는 남긴다
+        public BitmapSource ApplyLowPass(BitmapSource source, int period, FrequencyFilterShape shape = FrequencyFilterShape.Gaussian)
+        {
+            if (!HasFFTData)
+                throw new InvalidOperationException("FFT 데이터가 없습니다. 먼저 푸리에 변환을 수행해주세요.");
+
+            float cutoff = 1.0f / Math.Max(2, period);
+            return ProcessImage(source, (pixels, width, height) => _engine.ApplyLowPass(pixels, width, height, shape, cutoff, 2));
+        }
+
+        public BitmapSource ApplyHighPass(BitmapSource source, int period, FrequencyFilterShape shape = FrequencyFilterShape.Gaussian)
+        {
+            if (!HasFFTData)
+                throw new InvalidOperationException("FFT 데이터가 없습니다. 먼저 푸리에 변환을 수행해주세요.");
+
+            float cutoff = 1.0f / Math.Max(2, period);
+            return ProcessImage(source, (pixels, width, height) => _engine.ApplyHighPass(pixels, width, height, shape, cutoff, 2));
+        }
+
         // ------------------ Undo / Redo ------------------
-        public BitmapImage Undo()
+        public BitmapSource Undo()
         {
-            if (_undoStack.Count > 0)
-            {
-                _redoStack.Push(_currentImage);
-                _currentImage = _undoStack.Pop();
-            }
-            return _currentImage;
+            return _history.Undo() ? RestoreCurrentState() : _currentImage;
+        }
+
+        public BitmapSource Redo()
+        {
+            return _history.Redo() ? RestoreCurrentState() : _currentImage;
         }
 
-        public BitmapImage Redo()
+        // 기록의 현재 상태를 _statePixels에 복원한다. 크기가 같으면 직전 상태와 다른 타일만 덮어쓴다
+        private BitmapSource RestoreCurrentState()
         {
-            if (_redoStack.Count > 0)
+            int width = _history.Width();
+            int height = _history.Height();
+            long basis = _stateId;
+            if (_statePixels == null || _stateWidth != width || _stateHeight != height)
             {
-                _undoStack.Push(_currentImage);
-                _currentImage = _redoStack.Pop();
+                _statePixels = new byte[width * height * 4];
+                basis = 0;
             }
+
+            if (!_history.Restore(_statePixels, basis)) return _currentImage;
+
+            _stateWidth = width;
+            _stateHeight = height;
+            _stateId = _history.CurrentState();
+            _currentImage = CreateBitmap(_statePixels, width, height);
             return _currentImage;
         }
     }
@@ -1,12 +1,15 @@
 ﻿using ImageProcessing.Services;
+using ImageProcessingEngine;
 using ImageProcessing.ViewModels;
 using System;
 using System.IO;
+using System.Threading;
 using System.Threading.Tasks;
 using System.Windows;
 using System.Windows.Input;
 using System.Windows.Media.Imaging;
 using System.Diagnostics;
+using System.Globalization;
 using ImageProcessing.Models;
 using ImageProcessing.Views;
 using System.Windows.Media;
@@ -32,9 +35,9 @@ namespace ImageProcessing.ViewModel
         private readonly ClipboardService clipboardService;
 
         // 이미지 관련 필드
-        private BitmapImage currentBitmapImage;
-        private BitmapImage originalImage;
-        private BitmapImage loadedImage;
+        private BitmapSource currentBitmapImage;
+        private BitmapSource originalImage;
+        private BitmapSource loadedImage;
 
         // 선택 영역 및 좌표 관련 필드
         private Visibility selectionVisibility;
@@ -46,6 +49,10 @@ namespace ImageProcessing.ViewModel
         // UI 및 상태 관련 필드
         private Size imageControlSize;
         private double zoomLevel = 1.0;
+        private bool isProcessing;      // 백그라운드 처리(미리보기/전체 해상도) 진행 중
+        private CancellationTokenSource processingCancellation;
+        private Task processingTask = Task.CompletedTask;
+        private bool isTracing;
 
         // 기타
         private string lastImagePath;
@@ -58,7 +65,7 @@ namespace ImageProcessing.ViewModel
 
         #region Properties
         // 이미지 관련 속성
-        public BitmapImage CurrentBitmapImage
+        public BitmapSource CurrentBitmapImage
         {
             get => currentBitmapImage;
             set
@@ -71,7 +78,7 @@ namespace ImageProcessing.ViewModel
             }
         }
 
-        public BitmapImage LoadedImage
+        public BitmapSource LoadedImage
         {
             get => loadedImage;
             set => SetProperty(ref loadedImage, value);
@@ -126,6 +133,19 @@ namespace ImageProcessing.ViewModel
         public string ZoomPercentage => $"{ZoomLevel * 100:0}%";
 
         // Undo/Redo 상태
+        // 연산 호출마다 추적 이벤트를 남긴다 (SaveTraceCommand로 저장)
+        public bool IsTracing
+        {
+            get => isTracing;
+            set
+            {
+                if (SetProperty(ref isTracing, value))
+                {
+                    imageProcessor.SetTracing(value);
+                }
+            }
+        }
+
         public bool CanUndo => imageProcessor.CanUndo;
         public bool CanRedo => imageProcessor.CanRedo;
 
@@ -138,23 +158,39 @@ namespace ImageProcessing.ViewModel
         public ICommand ExitCommand { get; private set; }
         public ICommand UndoCommand { get; private set; }
         public ICommand RedoCommand { get; private set; }
+        public ICommand CancelProcessingCommand { get; private set; }
         public ICommand CutSelectionCommand { get; private set; }
         public ICommand CopySelectionCommand { get; private set; }
         public ICommand PasteCommand { get; private set; }
         public ICommand DeleteSelectionCommand { get; private set; }
         public ICommand ApplyGrayscaleCommand { get; private set; }
         public ICommand ApplyGaussianBlurCommand { get; private set; }
+        public ICommand ApplyGaussianSigmaCommand { get; private set; }
         public ICommand ApplyMedianFilterCommand { get; private set; }
         public ICommand ApplyLaplacianCommand { get; private set; }
         public ICommand ApplySobelCommand { get; private set; }
+        public ICommand ApplyCannyCommand { get; private set; }
         public ICommand ApplyBinarizationCommand { get; private set; }
+        public ICommand ApplyOtsuBinarizationCommand { get; private set; }
+        public ICommand ApplyAdaptiveThresholdCommand { get; private set; }
         public ICommand ApplyDilationCommand { get; private set; }
         public ICommand ApplyErosionCommand { get; private set; }
+        public ICommand ApplyOpeningCommand { get; private set; }
+        public ICommand ApplyClosingCommand { get; private set; }
+        public ICommand ApplyMorphologyGradientCommand { get; private set; }
+        public ICommand ApplyTopHatCommand { get; private set; }
+        public ICommand ApplyBlackHatCommand { get; private set; }
         public ICommand FFTCommand { get; private set; }
         public ICommand IFFTCommand { get; private set; }
+        public ICommand LowPassCommand { get; private set; }
+        public ICommand HighPassCommand { get; private set; }
         public ICommand TemplateMatchCommand { get; private set; }
+        public ICommand BlobAnalysisCommand { get; private set; }
         public ICommand OpenSettingsCommand { get; private set; }
         public ICommand ShowLogWindowCommand { get; private set; }
+        public ICommand ShowPerformanceStatsCommand { get; private set; }
+        public ICommand SaveTraceCommand { get; private set; }
+        public ICommand ResetPerformanceStatsCommand { get; private set; }
         public ICommand ZoomInCommand { get; private set; }
         public ICommand ZoomOutCommand { get; private set; }
         #endregion
@@ -231,30 +267,48 @@ namespace ImageProcessing.ViewModel
             LoadImageCommand = new RelayCommand(async _ => await LoadImageAsync());
             SaveImageCommand = new RelayCommand(async _ => await SaveImageAsync(), _ => CurrentBitmapImage != null);
 
-            ApplyGrayscaleCommand = new RelayCommand(_ => ApplyFilter(() => imageProcessor.ApplyGrayscale(CurrentBitmapImage), "Grayscale"));
-            ApplySobelCommand = new RelayCommand(_ => ApplyFilter(() => imageProcessor.ApplySobel(CurrentBitmapImage), "Sobel"));
-            ApplyLaplacianCommand = new RelayCommand(_ => ApplyFilter(() => imageProcessor.ApplyLaplacian(CurrentBitmapImage), "Laplacian"));
-            ApplyGaussianBlurCommand = new RelayCommand(_ => ApplyFilter(() => imageProcessor.ApplyGaussianBlur(CurrentBitmapImage), "Gaussian Blur"));
-            ApplyBinarizationCommand = new RelayCommand(_ => ExecuteWithParameter("Binarization", (processor, value) => processor.ApplyBinarization(CurrentBitmapImage, value), "128"));
-            ApplyDilationCommand = new RelayCommand(_ => ExecuteWithParameter("Dilation", (processor, value) => processor.ApplyDilation(CurrentBitmapImage, value), "3"));
-            ApplyErosionCommand = new RelayCommand(_ => ExecuteWithParameter("Erosion", (processor, value) => processor.ApplyErosion(CurrentBitmapImage, value), "3"));
-            ApplyMedianFilterCommand = new RelayCommand(_ => ExecuteWithParameter("Median Filter", (processor, value) => processor.ApplyMedianFilter(CurrentBitmapImage, value), "3"));
-            FFTCommand = new RelayCommand(_ => ApplyFilter(() => imageProcessor.ApplyFFT(CurrentBitmapImage), "FFT"), _ => CurrentBitmapImage != null);
-            IFFTCommand = new RelayCommand(_ => ApplyIFFT(), _ => CurrentBitmapImage != null && imageProcessor.HasFFTData);
-
-            UndoCommand = new RelayCommand(_ => ExecuteUndo(), _ => CanUndo);
-            RedoCommand = new RelayCommand(_ => ExecuteRedo(), _ => CanRedo);
+            ApplyGrayscaleCommand = new RelayCommand(_ => ApplyFilter(() => imageProcessor.ApplyGrayscale(CurrentBitmapImage, SelectionRoi()), "Grayscale"));
+            ApplySobelCommand = new RelayCommand(_ => ApplyFilter(() => imageProcessor.ApplySobel(CurrentBitmapImage, SelectionRoi()), "Sobel"));
+            ApplyCannyCommand = new RelayCommand(_ => ApplyCanny());
+            ApplyLaplacianCommand = new RelayCommand(_ => ApplyFilter(() => imageProcessor.ApplyLaplacian(CurrentBitmapImage, SelectionRoi()), "Laplacian"));
+            ApplyGaussianBlurCommand = new RelayCommand(_ => ApplyFilter(() => imageProcessor.ApplyGaussianBlur(CurrentBitmapImage, SelectionRoi()), "Gaussian Blur"));
+            ApplyGaussianSigmaCommand = new RelayCommand(_ => ApplyGaussianSigma());
+            ApplyBinarizationCommand = new RelayCommand(_ => ExecuteWithParameter("Binarization", (processor, value) => processor.ApplyBinarization(CurrentBitmapImage, value, SelectionRoi()), "128", FilterOperation.Binarization));
+            ApplyOtsuBinarizationCommand = new RelayCommand(_ => ApplyFilter(() => imageProcessor.ApplyOtsuBinarization(CurrentBitmapImage, SelectionRoi()), "Otsu Binarization"));
+            ApplyAdaptiveThresholdCommand = new RelayCommand(parameter => ApplyAdaptiveThreshold(parameter as string));
+            ApplyDilationCommand = new RelayCommand(_ => ExecuteWithParameter("Dilation", (processor, value) => processor.ApplyDilation(CurrentBitmapImage, value, SelectionRoi()), "3", FilterOperation.Dilation));
+            ApplyErosionCommand = new RelayCommand(_ => ExecuteWithParameter("Erosion", (processor, value) => processor.ApplyErosion(CurrentBitmapImage, value, SelectionRoi()), "3", FilterOperation.Erosion));
+            ApplyOpeningCommand = new RelayCommand(_ => ExecuteWithParameter("Opening", (processor, value) => processor.ApplyOpening(CurrentBitmapImage, value, SelectionRoi()), "3", FilterOperation.Opening));
+            ApplyClosingCommand = new RelayCommand(_ => ExecuteWithParameter("Closing", (processor, value) => processor.ApplyClosing(CurrentBitmapImage, value, SelectionRoi()), "3", FilterOperation.Closing));
+            ApplyMorphologyGradientCommand = new RelayCommand(_ => ExecuteWithParameter("Morphology Gradient", (processor, value) => processor.ApplyMorphologyGradient(CurrentBitmapImage, value, SelectionRoi()), "3", FilterOperation.MorphologyGradient));
+            ApplyTopHatCommand = new RelayCommand(_ => ExecuteWithParameter("Top-Hat", (processor, value) => processor.ApplyTopHat(CurrentBitmapImage, value, SelectionRoi()), "3", FilterOperation.TopHat));
+            ApplyBlackHatCommand = new RelayCommand(_ => ExecuteWithParameter("Black-Hat", (processor, value) => processor.ApplyBlackHat(CurrentBitmapImage, value, SelectionRoi()), "3", FilterOperation.BlackHat));
+            ApplyMedianFilterCommand = new RelayCommand(_ => ExecuteWithParameter("Median Filter", (processor, value) => processor.ApplyMedianFilter(CurrentBitmapImage, value, SelectionRoi()), "3", FilterOperation.MedianFilter));
+            FFTCommand = new RelayCommand(async _ => await ApplyFilterAsync(() => imageProcessor.ApplyFFT(CurrentBitmapImage), "FFT"), _ => CurrentBitmapImage != null);
+            IFFTCommand = new RelayCommand(_ => ApplyIFFT(), _ => CurrentBitmapImage != null && !isProcessing && imageProcessor.HasFFTData);
+            LowPassCommand = new RelayCommand(_ => ExecuteWithParameter("Low-Pass", (processor, value) => processor.ApplyLowPass(CurrentBitmapImage, value), "8"),
+                _ => CurrentBitmapImage != null && !isProcessing && imageProcessor.HasFFTData);
+            HighPassCommand = new RelayCommand(_ => ExecuteWithParameter("High-Pass", (processor, value) => processor.ApplyHighPass(CurrentBitmapImage, value), "8"),
+                _ => CurrentBitmapImage != null && !isProcessing && imageProcessor.HasFFTData);
+
+            UndoCommand = new RelayCommand(_ => ExecuteUndo(), _ => CanUndo && !isProcessing);
+            RedoCommand = new RelayCommand(_ => ExecuteRedo(), _ => CanRedo && !isProcessing);
+            CancelProcessingCommand = new RelayCommand(_ => processingCancellation?.Cancel(), _ => isProcessing);
             ShowOriginalImageCommand = new RelayCommand(_ => ShowOriginalImage(), _ => originalImage != null);
             DeleteImageCommand = new RelayCommand(_ => DeleteImage(), _ => CurrentBitmapImage != null);
             ReloadImageCommand = new RelayCommand(async _ => await ReloadImageAsync(), _ => originalImage != null || !string.IsNullOrEmpty(lastImagePath));
             ExitCommand = new RelayCommand(_ => Application.Current.Shutdown());
             ShowLogWindowCommand = new RelayCommand(_ => ShowLogWindow());
+            ShowPerformanceStatsCommand = new RelayCommand(_ => ShowPerformanceStats());
+            SaveTraceCommand = new RelayCommand(_ => SaveTrace());
+            ResetPerformanceStatsCommand = new RelayCommand(_ => imageProcessor.ResetProfiling());
 
             CutSelectionCommand = new RelayCommand(_ => CutSelection(), _ => HasValidSelection());
             CopySelectionCommand = new RelayCommand(_ => CopySelection(), _ => HasValidSelection());
             DeleteSelectionCommand = new RelayCommand(_ => DeleteSelection(), _ => HasValidSelection());
             PasteCommand = new RelayCommand(_ => ExecutePaste(), _ => CurrentBitmapImage != null && clipboardService.GetImage() != null);
-            TemplateMatchCommand = new RelayCommand(_ => { /* 기능 구현 필요 */ });
+            TemplateMatchCommand = new RelayCommand(async _ => await ExecuteTemplateMatchAsync(), _ => CurrentBitmapImage != null && !isProcessing);
+            BlobAnalysisCommand = new RelayCommand(async _ => await ExecuteBlobAnalysisAsync(), _ => CurrentBitmapImage != null && !isProcessing);
             OpenSettingsCommand = new RelayCommand(_ => { /* 기능 구현 필요 */ });
 
             ZoomInCommand = new RelayCommand(_ => ZoomLevel += ZOOM_STEP);
@@ -269,6 +323,22 @@ namespace ImageProcessing.ViewModel
                    SelectionRect.Height > MIN_SELECTION_SIZE;
         }
 
+        // 필터를 적용할 영역 (영상 좌표). 선택 영역이 없으면 비어 있어 영상 전체에 적용된다
+        private Int32Rect SelectionRoi()
+        {
+            if (!HasValidSelection()) return Int32Rect.Empty;
+
+            var imageRect = ConvertUiRectToImageRect(SelectionRect, ImageControlSize, CurrentBitmapImage);
+            imageRect.Intersect(new Rect(0, 0, CurrentBitmapImage.PixelWidth, CurrentBitmapImage.PixelHeight));
+            if (imageRect.IsEmpty) return Int32Rect.Empty;
+
+            int x = (int)imageRect.X, y = (int)imageRect.Y;
+            int width = (int)Math.Ceiling(imageRect.Right) - x;
+            int height = (int)Math.Ceiling(imageRect.Bottom) - y;
+            if (width <= 0 || height <= 0) return Int32Rect.Empty;
+            return new Int32Rect(x, y, width, height);
+        }
+
         private async Task LoadImageAsync()
         {
             var filePath = fileService.OpenImageFileDialog();
@@ -342,7 +412,7 @@ namespace ImageProcessing.ViewModel
                 clipboardService.SetImage(croppedImage);
 
                 var clearedImage = imageProcessor.ClearSelection(CurrentBitmapImage, imageSelectionRect);
-                CurrentBitmapImage = BitmapSourceToBitmapImage(clearedImage);
+                CurrentBitmapImage = Frozen(clearedImage);
                 LoadedImage = CurrentBitmapImage;
                 ResetSelection();
                 logService.AddLog("Cut Selection", 0);
@@ -377,7 +447,7 @@ namespace ImageProcessing.ViewModel
             var pastedImageSource = imageProcessor.Paste(CurrentBitmapImage, clipboardImage, pasteLocation);
             stopwatch.Stop();
 
-            CurrentBitmapImage = BitmapSourceToBitmapImage(pastedImageSource);
+            CurrentBitmapImage = Frozen(pastedImageSource);
             LoadedImage = CurrentBitmapImage;
 
             var pastedImageRect = new Rect(pasteLocation.X, pasteLocation.Y, clipboardImage.PixelWidth, clipboardImage.PixelHeight);
@@ -396,7 +466,7 @@ namespace ImageProcessing.ViewModel
             if (imageSelectionRect.IsEmpty) return;
 
             var clearedImage = imageProcessor.ClearSelection(CurrentBitmapImage, imageSelectionRect);
-            CurrentBitmapImage = BitmapSourceToBitmapImage(clearedImage);
+            CurrentBitmapImage = Frozen(clearedImage);
             LoadedImage = CurrentBitmapImage;
             ResetSelection();
             logService.AddLog("Delete Selection", 0);
@@ -468,7 +538,10 @@ namespace ImageProcessing.ViewModel
             SelectionRect = new Rect(0, 0, 0, 0);
         }
 
-        private void ExecuteWithParameter(string operationName, Func<ImageProcessor, int, BitmapImage> filterAction, string defaultValue = "3")
+        // previewOperation을 주면 백그라운드에서 취소 가능하게 처리하고, 선택 영역이 없을 때는 축소 해상도 미리보기를
+        // 먼저 보여 준 뒤 전체 해상도 결과로 바꾼다
+        private void ExecuteWithParameter(string operationName, Func<ImageProcessor, int, BitmapSource> filterAction, string defaultValue = "3",
+                                          FilterOperation? previewOperation = null)
         {
             if (CurrentBitmapImage == null) return;
 
@@ -481,7 +554,15 @@ namespace ImageProcessing.ViewModel
             {
                 if (int.TryParse(dialog.InputValue, out int parameter))
                 {
-                    ApplyFilter(() => filterAction(imageProcessor, parameter), operationName);
+                    if (previewOperation.HasValue)
+                    {
+                        _ = ApplyFilterAsync(() => filterAction(imageProcessor, parameter), operationName,
+                                             SelectionRoi().IsEmpty ? previewOperation : null, parameter);
+                    }
+                    else
+                    {
+                        ApplyFilter(() => filterAction(imageProcessor, parameter), operationName);
+                    }
                 }
                 else
                 {
@@ -490,10 +571,70 @@ namespace ImageProcessing.ViewModel
             }
         }
 
-        private void ApplyFilter(Func<BitmapImage> filterAction, string operationName)
+        // parameter: AdaptiveThresholdMethod 이름 (메뉴의 CommandParameter)
+        private void ApplyAdaptiveThreshold(string methodName)
+        {
+            if (!Enum.TryParse(methodName, out AdaptiveThresholdMethod method))
+            {
+                method = AdaptiveThresholdMethod.Sauvola;
+            }
+            ExecuteWithParameter($"Adaptive Threshold ({method}) Window",
+                                 (processor, value) => processor.ApplyAdaptiveThreshold(CurrentBitmapImage, method, value, SelectionRoi()), "31");
+        }
+
+        // 입력: "low,high" (그래디언트 크기 임계값)
+        private void ApplyCanny()
+        {
+            if (CurrentBitmapImage == null) return;
+
+            var dialog = new ParameterInputDialog("Canny Thresholds", "낮은 임계값,높은 임계값을 입력하세요:", "50,150")
+            {
+                Owner = Application.Current.MainWindow
+            };
+
+            if (dialog.ShowDialog() == true)
+            {
+                string[] parts = dialog.InputValue.Split(',');
+                if (parts.Length == 2 &&
+                    int.TryParse(parts[0].Trim(), out int low) && int.TryParse(parts[1].Trim(), out int high) &&
+                    low >= 0 && high >= 0)
+                {
+                    ApplyFilter(() => imageProcessor.ApplyCanny(CurrentBitmapImage, low, high, SelectionRoi()), "Canny");
+                }
+                else
+                {
+                    MessageBox.Show("0 이상의 숫자 두 개를 쉼표로 구분해 입력하세요 (예: 50,150).", "잘못된 입력", MessageBoxButton.OK, MessageBoxImage.Warning);
+                }
+            }
+        }
+
+        private void ApplyGaussianSigma()
         {
             if (CurrentBitmapImage == null) return;
 
+            var dialog = new ParameterInputDialog("Gaussian Blur Sigma", "시그마를 입력하세요 (0.5 ~ 50):", "2")
+            {
+                Owner = Application.Current.MainWindow
+            };
+
+            if (dialog.ShowDialog() == true)
+            {
+                if (float.TryParse(dialog.InputValue, NumberStyles.Float, CultureInfo.InvariantCulture, out float sigma) && sigma > 0)
+                {
+                    ApplyFilter(() => imageProcessor.ApplyGaussianBlur(CurrentBitmapImage, sigma, SelectionRoi()), "Gaussian Blur (Sigma)");
+                }
+                else
+                {
+                    MessageBox.Show("0보다 큰 숫자를 입력하세요.", "잘못된 입력", MessageBoxButton.OK, MessageBoxImage.Warning);
+                }
+            }
+        }
+
+        private void ApplyFilter(Func<BitmapSource> filterAction, string operationName)
+        {
+            // 백그라운드 처리 중에는 같은 ImageProcessor를 동시에 쓰지 않는다
+            if (CurrentBitmapImage == null || isProcessing) return;
+
             var stopwatch = Stopwatch.StartNew();
             var newImage = filterAction();
             stopwatch.Stop();
@@ -507,6 +648,89 @@ namespace ImageProcessing.ViewModel
             }
         }
 
+        // 백그라운드에서 처리하고 진행률을 상태 표시줄에 보여 준다. 처리 중에 새 요청이 오면 이전 처리를 취소하고
+        // (엔진이 행 밴드 단위로 바로 멈춘다) 끝나기를 기다린 뒤 시작한다. previewOperation을 주면 축소 해상도
+        // 미리보기를 먼저 보여 준다. 처리 중에는 되돌리기를 막는다
+        private async Task ApplyFilterAsync(Func<BitmapSource> filterAction, string operationName,
+                                            FilterOperation? previewOperation = null, int previewParameter = 0)
+        {
+            if (CurrentBitmapImage == null) return;
+
+            processingCancellation?.Cancel();
+            var cancellation = new CancellationTokenSource();
+            processingCancellation = cancellation;
+            try
+            {
+                // 이전 처리의 오류는 그 호출에서 이미 처리했다. 기다리는 사이 더 새 요청이 오면 이 요청은 버린다
+                await Task.WhenAny(processingTask);
+                if (cancellation.IsCancellationRequested) return;
+
+                var run = RunFilterAsync(filterAction, operationName, previewOperation, previewParameter, cancellation.Token);
+                processingTask = run;
+                await run;
+            }
+            finally
+            {
+                if (processingCancellation == cancellation) processingCancellation = null;
+                cancellation.Dispose();
+            }
+        }
+
+        private async Task RunFilterAsync(Func<BitmapSource> filterAction, string operationName, FilterOperation? previewOperation,
+                                          int previewParameter, CancellationToken cancellationToken)
+        {
+            isProcessing = true;
+            CommandManager.InvalidateRequerySuggested();
+            bool running = true;
+            var stopwatch = Stopwatch.StartNew();
+            try
+            {
+                if (previewOperation.HasValue)
+                {
+                    var source = CurrentBitmapImage;
+                    var preview = await Task.Run(() => imageProcessor.PreviewOperation(source, previewOperation.Value, previewParameter));
+                    if (preview != null && !cancellationToken.IsCancellationRequested)
+                    {
+                        LoadedImage = preview;
+                        ProcessingTime = $"Preview: {stopwatch.ElapsedMilliseconds} ms";
+                    }
+                }
+
+                var progress = new Progress<double>(value =>
+                {
+                    if (running) ProcessingTime = $"Processing: {value * 100:0}%";
+                });
+                var newImage = await imageProcessor.RunAsync(_ => filterAction(), cancellationToken, progress);
+                running = false;
+                stopwatch.Stop();
+
+                if (newImage != null)
+                {
+                    CurrentBitmapImage = newImage;
+                    LoadedImage = CurrentBitmapImage;
+                    ProcessingTime = $"Process Time: {stopwatch.ElapsedMilliseconds} ms";
+                    logService.AddLog(operationName, stopwatch.ElapsedMilliseconds);
+                }
+                else
+                {
+                    LoadedImage = CurrentBitmapImage;
+                }
+            }
+            catch (OperationCanceledException)
+            {
+                // 미리보기를 걷어 내고 처리 전 영상을 보여 준다 (영상과 되돌리기 기록은 그대로)
+                LoadedImage = CurrentBitmapImage;
+                ProcessingTime = $"Canceled: {stopwatch.ElapsedMilliseconds} ms";
+                logService.AddLog($"{operationName} (canceled)", stopwatch.ElapsedMilliseconds);
+            }
+            finally
+            {
+                running = false;
+                isProcessing = false;
+                CommandManager.InvalidateRequerySuggested();
+            }
+        }
+
         private void ApplyIFFT()
         {
             if (!imageProcessor.HasFFTData)
@@ -519,6 +743,101 @@ namespace ImageProcessing.ViewModel
             imageProcessor.ClearFFTData();
         }
 
+        // 선택 영역이 있으면 그 영역을, 없으면 파일에서 불러온 영상을 템플릿으로 찾는다.
+        // 매칭은 백그라운드에서 취소 가능하게 처리하며, 취소되면 결과를 보여 주지 않는다
+        private async Task ExecuteTemplateMatchAsync()
+        {
+            if (CurrentBitmapImage == null) return;
+
+            BitmapSource template = null;
+            if (HasValidSelection())
+            {
+                var imageSelectionRect = ConvertUiRectToImageRect(SelectionRect, ImageControlSize, CurrentBitmapImage);
+                if (!imageSelectionRect.IsEmpty)
+                {
+                    template = Frozen(imageProcessor.Crop(CurrentBitmapImage, imageSelectionRect));
+                }
+            }
+            if (template == null)
+            {
+                var templatePath = fileService.OpenImageFileDialog();
+                if (string.IsNullOrEmpty(templatePath)) return;
+                template = await fileService.LoadImage(templatePath);
+            }
+
+            var dialog = new ParameterInputDialog("Template Match Parameter", "찾을 최대 개수를 입력하세요:", "5")
+            {
+                Owner = Application.Current.MainWindow
+            };
+            if (dialog.ShowDialog() != true) return;
+            if (!int.TryParse(dialog.InputValue, out int maxMatches) || maxMatches < 1)
+            {
+                MessageBox.Show("1 이상의 숫자를 입력하세요.", "잘못된 입력", MessageBoxButton.OK, MessageBoxImage.Warning);
+                return;
+            }
+
+            TemplateMatchResult[] matches = null;
+            var source = CurrentBitmapImage;
+            await ApplyFilterAsync(() =>
+            {
+                var result = imageProcessor.ApplyTemplateMatch(source, template, maxMatches, 0.7f, out var found);
+                matches = found;
+                return result;
+            }, "Template Match");
+            if (matches == null) return; // 취소됨
+
+            if (matches.Length == 0)
+            {
+                MessageBox.Show("일치하는 위치를 찾지 못했습니다.", "템플릿 매칭", MessageBoxButton.OK, MessageBoxImage.Information);
+                return;
+            }
+
+            var lines = matches.Select((m, i) => $"{i + 1}. X={m.X:F2}, Y={m.Y:F2}, Score={m.Score:F3}");
+            MessageBox.Show(string.Join(Environment.NewLine, lines), "템플릿 매칭", MessageBoxButton.OK, MessageBoxImage.Information);
+        }
+
+        // 이진화/형태학 연산 결과의 블롭을 세고 면적 통계를 보여 준다. 평균 밝기는 원본 영상 기준.
+        // 템플릿 매칭과 같이 백그라운드에서 처리한다
+        private async Task ExecuteBlobAnalysisAsync()
+        {
+            if (CurrentBitmapImage == null) return;
+
+            var dialog = new ParameterInputDialog("Blob Analysis Parameter", "연결성을 입력하세요 (4 또는 8):", "8")
+            {
+                Owner = Application.Current.MainWindow
+            };
+            if (dialog.ShowDialog() != true) return;
+            if (!int.TryParse(dialog.InputValue, out int connectivity) || (connectivity != 4 && connectivity != 8))
+            {
+                MessageBox.Show("4 또는 8을 입력하세요.", "잘못된 입력", MessageBoxButton.OK, MessageBoxImage.Warning);
+                return;
+            }
+
+            BlobInfo[] blobs = null;
+            var source = CurrentBitmapImage;
+            var intensitySource = originalImage;
+            await ApplyFilterAsync(() =>
+            {
+                var result = imageProcessor.ApplyBlobAnalysis(source, intensitySource, connectivity == 8, out var found);
+                blobs = found;
+                return result;
+            }, "Blob Analysis");
+            if (blobs == null) return; // 취소됨
+
+            if (blobs.Length == 0)
+            {
+                MessageBox.Show("전경 화소가 없습니다.", "블롭 분석", MessageBoxButton.OK, MessageBoxImage.Information);
+                return;
+            }
+
+            var largest = blobs.OrderByDescending(b => b.Area).Take(10)
+                .Select((b, i) => $"{i + 1}. Area={b.Area}, Box=({b.Left}, {b.Top}, {b.Width}x{b.Height}), " +
+                                  $"Center=({b.CentroidX:F1}, {b.CentroidY:F1}), Mean={b.MeanIntensity:F1}");
+            var summary = $"블롭 수: {blobs.Length}, 평균 면적: {blobs.Average(b => (double)b.Area):F1}" +
+                          Environment.NewLine + Environment.NewLine + string.Join(Environment.NewLine, largest);
+            MessageBox.Show(summary, "블롭 분석", MessageBoxButton.OK, MessageBoxImage.Information);
+        }
+
         private void ExecuteUndo()
         {
             CurrentBitmapImage = imageProcessor.Undo();
@@ -548,34 +867,45 @@ namespace ImageProcessing.ViewModel
             }
         }
 
-        private BitmapImage BitmapSourceToBitmapImage(BitmapSource source)
+        // 연산별 호출 수/지연 백분위수/화소당 시간/작업 메모리/선택된 경로
+        private void ShowPerformanceStats()
         {
-            if (source == null)
-                return null;
-
-            if (source is BitmapImage bitmapImage && bitmapImage.StreamSource == null)
+            var stats = imageProcessor.GetOperationStats();
+            if (stats.Length == 0)
             {
-                return bitmapImage;
+                MessageBox.Show("기록된 연산이 없습니다.", "성능 통계", MessageBoxButton.OK, MessageBoxImage.Information);
+                return;
             }
 
-            var encoder = new PngBitmapEncoder();
-            encoder.Frames.Add(BitmapFrame.Create(source));
-
-            using (var stream = new MemoryStream())
-            {
-                encoder.Save(stream);
-                stream.Seek(0, SeekOrigin.Begin);
+            var lines = stats.OrderByDescending(s => s.TotalMs)
+                .Select(s => $"{s.Name}: {s.Calls}회, 평균 {s.MeanMs:F2} ms (p50 {s.P50Ms:F2}, p95 {s.P95Ms:F2}, 최대 {s.MaxMs:F2}), " +
+                             $"{s.NsPerPixel:F2} ns/pixel, 작업 메모리 {s.ScratchBytes / (1024.0 * 1024.0):F1} MB, " +
+                             $"스레드 {s.Threads}, {s.Backend}");
+            var scratch = imageProcessor.GetScratchStats();
+            var pool = $"작업 버퍼 풀: 사용 중 {scratch.InUseBytes / (1024.0 * 1024.0):F1} MB (최고 {scratch.PeakInUseBytes / (1024.0 * 1024.0):F1}), " +
+                       $"보관 {scratch.ReservedBytes / (1024.0 * 1024.0):F1} MB (최고 {scratch.PeakReservedBytes / (1024.0 * 1024.0):F1}), " +
+                       $"새 할당 {scratch.SystemAllocations} / {scratch.AcquireCount}회";
+            MessageBox.Show(string.Join(Environment.NewLine, lines) + Environment.NewLine + Environment.NewLine + pool, "성능 통계",
+                            MessageBoxButton.OK, MessageBoxImage.Information);
+        }
 
-                var result = new BitmapImage();
-                result.BeginInit();
-                result.CacheOption = BitmapCacheOption.OnLoad;
-                result.StreamSource = stream;
-                result.EndInit();
-                result.Freeze();
+        private void SaveTrace()
+        {
+            var path = fileService.SaveTraceFileDialog();
+            if (string.IsNullOrEmpty(path)) return;
 
-                return result;
+            if (!imageProcessor.SaveTrace(path))
+            {
+                MessageBox.Show("추적 파일을 저장하지 못했습니다.", "추적 저장", MessageBoxButton.OK, MessageBoxImage.Warning);
             }
         }
+
+        // 화면/처리 스레드에서 함께 쓸 수 있도록 고정한다 (인코딩/복사 없음)
+        private static BitmapSource Frozen(BitmapSource source)
+        {
+            if (source != null && !source.IsFrozen) source.Freeze();
+            return source;
+        }
         #endregion
     }
 }
\ No newline at end of file
@@ -4,9 +4,9 @@ namespace ImageProcessing.ViewModels
 {
     public class OriginalImageViewModel
     {
-        public BitmapImage ImageToShow { get; }
+        public BitmapSource ImageToShow { get; }
 
-        public OriginalImageViewModel(BitmapImage image)
+        public OriginalImageViewModel(BitmapSource image)
         {
             ImageToShow = image;
         }
@@ -6,7 +6,7 @@ namespace ImageProcessing.Views
 {
     public partial class OriginalImageView : Window
     {
-        public OriginalImageView(BitmapImage image)
+        public OriginalImageView(BitmapSource image)
         {
             InitializeComponent();
             DataContext = new OriginalImageViewModel(image);